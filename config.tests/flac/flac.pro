@@ -0,0 +1,2 @@
+CONFIG -= qt
+SOURCES = flac.cpp
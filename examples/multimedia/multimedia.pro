@@ -16,10 +16,9 @@ qtHaveModule(widgets) {
 
 qtHaveModule(quick) {
     SUBDIRS += \
+        audioengine \
         declarative-camera \
         declarative-radio \
         video
 }
 
-qtConfig(openal): SUBDIRS += audioengine
-
@@ -0,0 +1,100 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgstaudiobuffer_p.h"
+
+QT_BEGIN_NAMESPACE
+
+QAudioBuffer QGstAudioBuffer::create(GstBuffer *buffer, const QAudioFormat &format, qint64 startTime)
+{
+    if (!buffer || !format.isValid() || format.bytesPerFrame() <= 0)
+        return QAudioBuffer();
+
+    QGstAudioBuffer *provider = new QGstAudioBuffer(buffer, format, startTime);
+    if (!provider->map()) {
+        provider->release();
+        return QAudioBuffer();
+    }
+
+    return QAudioBuffer(provider);
+}
+
+QGstAudioBuffer::QGstAudioBuffer(GstBuffer *buffer, const QAudioFormat &format, qint64 startTime)
+    : m_buffer(buffer)
+#if GST_CHECK_VERSION(1,0,0)
+    , m_mapped(false)
+#endif
+    , m_data(0)
+    , m_frameCount(0)
+    , m_format(format)
+    , m_startTime(startTime)
+{
+    gst_buffer_ref(m_buffer);
+}
+
+QGstAudioBuffer::~QGstAudioBuffer()
+{
+#if GST_CHECK_VERSION(1,0,0)
+    if (m_mapped)
+        gst_buffer_unmap(m_buffer, &m_mapInfo);
+#endif
+    gst_buffer_unref(m_buffer);
+}
+
+bool QGstAudioBuffer::map()
+{
+#if GST_CHECK_VERSION(1,0,0)
+    if (!gst_buffer_map(m_buffer, &m_mapInfo, GST_MAP_READ))
+        return false;
+    m_mapped = true;
+    m_data = m_mapInfo.data;
+    m_frameCount = m_mapInfo.size / m_format.bytesPerFrame();
+#else
+    m_data = m_buffer->data;
+    m_frameCount = m_buffer->size / m_format.bytesPerFrame();
+#endif
+    return true;
+}
+
+void QGstAudioBuffer::release()
+{
+    delete this;
+}
+
+QT_END_NAMESPACE
@@ -39,10 +39,15 @@
 
 #include "qgstreameraudioprobecontrol_p.h"
 #include <private/qgstutils_p.h>
+#include <private/qgstaudiobuffer_p.h>
+#include <private/qmediaaudioprobecontrol_p.h>
+
+#include <QtCore/qmetaobject.h>
 
 QGstreamerAudioProbeControl::QGstreamerAudioProbeControl(QObject *parent)
     : QMediaAudioProbeControl(parent)
 {
+    QMediaAudioProbeControlPrivate::get(this)->setListenersSupported(true);
 }
 
 QGstreamerAudioProbeControl::~QGstreamerAudioProbeControl()
@@ -59,29 +64,45 @@ void QGstreamerAudioProbeControl::probeCaps(GstCaps *caps)
 
 bool QGstreamerAudioProbeControl::probeBuffer(GstBuffer *buffer)
 {
+    QMediaAudioProbeControlPrivate *d = QMediaAudioProbeControlPrivate::get(this);
+    static const QMetaMethod probedSignal = QMetaMethod::fromSignal(&QMediaAudioProbeControl::audioBufferProbed);
+    const bool deliverBuffers = isSignalConnected(probedSignal);
+    if (!deliverBuffers && !d->hasListeners())
+        return true;
+
     qint64 position = GST_BUFFER_TIMESTAMP(buffer);
     position = position >= 0
             ? position / G_GINT64_CONSTANT(1000) // microseconds
             : -1;
 
-    QByteArray data;
-#if GST_CHECK_VERSION(1,0,0)
-    GstMapInfo info;
-    if (gst_buffer_map(buffer, &info, GST_MAP_READ)) {
-        data = QByteArray(reinterpret_cast<const char *>(info.data), info.size);
-        gst_buffer_unmap(buffer, &info);
-    } else {
-        return true;
+    QAudioFormat format;
+    {
+        QMutexLocker locker(&m_bufferMutex);
+        format = m_format;
     }
-#else
-    data = QByteArray(reinterpret_cast<const char *>(buffer->data), buffer->size);
-#endif
+    if (!format.isValid())
+        return true;
 
-    QMutexLocker locker(&m_bufferMutex);
-    if (m_format.isValid()) {
+    // Listeners get the GstBuffer's memory as is, it stays referenced only
+    // while they use it. Buffers delivered later are copied, so that the
+    // pipeline can reuse or modify its buffers in place.
+    const QAudioBuffer audioBuffer = QGstAudioBuffer::create(buffer, format, position);
+    if (!audioBuffer.isValid())
+        return true;
+
+    // Reducing probes do their work right here on the streaming thread
+    d->probeBuffer(audioBuffer);
+
+    if (deliverBuffers) {
+        QAudioBuffer copy(audioBuffer);
+        copy.data(); // detaches
+
+        QMutexLocker locker(&m_bufferMutex);
         if (!m_pendingBuffer.isValid())
             QMetaObject::invokeMethod(this, "bufferProbed", Qt::QueuedConnection);
-        m_pendingBuffer = QAudioBuffer(data, m_format, position);
+        else
+            d->bufferDropped();
+        m_pendingBuffer = copy;
     }
 
     return true;
@@ -41,6 +41,9 @@
 
 #include "qgstutils_p.h"
 #include <private/qgstvideobuffer_p.h>
+#include <private/qmediavideoprobecontrol_p.h>
+
+#include <QtCore/qmetaobject.h>
 
 QGstreamerVideoProbeControl::QGstreamerVideoProbeControl(QObject *parent)
     : QMediaVideoProbeControl(parent)
@@ -62,6 +65,8 @@ void QGstreamerVideoProbeControl::startFlushing()
         m_pendingFrame = QVideoFrame();
     }
 
+    QMediaVideoProbeControlPrivate::get(this)->flush();
+
     // only emit flush if at least one frame was probed
     if (m_frameProbed)
         emit flush();
@@ -92,6 +97,12 @@ void QGstreamerVideoProbeControl::probeCaps(GstCaps *caps)
 
 bool QGstreamerVideoProbeControl::probeBuffer(GstBuffer *buffer)
 {
+    QMediaVideoProbeControlPrivate *d = QMediaVideoProbeControlPrivate::get(this);
+    static const QMetaMethod probedSignal = QMetaMethod::fromSignal(&QMediaVideoProbeControl::videoFrameProbed);
+    const bool deliverFrames = isSignalConnected(probedSignal);
+    if (!deliverFrames && !d->hasListeners())
+        return true;
+
     QMutexLocker locker(&m_frameMutex);
 
     if (m_flushing || !m_format.isValid())
@@ -110,8 +121,20 @@ bool QGstreamerVideoProbeControl::probeBuffer(GstBuffer *buffer)
 
     m_frameProbed = true;
 
+    if (d->hasListeners()) {
+        // Listeners may block on a full queue; don't hold up flushing meanwhile
+        locker.unlock();
+        d->probeFrame(frame);
+        locker.relock();
+    }
+
+    if (!deliverFrames || m_flushing)
+        return true;
+
     if (!m_pendingFrame.isValid())
         QMetaObject::invokeMethod(this, "frameProbed", Qt::QueuedConnection);
+    else
+        d->frameDropped();
     m_pendingFrame = frame;
 
     return true;
@@ -86,6 +86,7 @@ public:
         // Dynamically adding audio engine related objects is only supported through revision 1
         qmlRegisterType<QDeclarativeAudioEngine, 1>(uri, 1, 1, "AudioEngine");
         qmlRegisterType<QDeclarativeSound, 1>(uri, 1, 1, "Sound");
+        qmlRegisterType<QDeclarativeAudioCategory, 1>(uri, 1, 1, "AudioCategory");
     }
 };
 
@@ -3,10 +3,8 @@ TARGET  = declarative_audioengine
 TARGETPATH = QtAudioEngine
 IMPORT_VERSION = 1.1
 
-QT += quick qml multimedia-private
-
-QMAKE_USE += openal
-mac: DEFINES += HEADER_OPENAL_PREFIX
+QT += quick qml multimedia-private core-private
+QT_FOR_CONFIG += multimedia-private
 
 INCLUDEPATH += ../../multimedia/audio
 
@@ -20,10 +18,13 @@ HEADERS += \
         qdeclarative_audiosample_p.h \
         qdeclarative_sound_p.h \
         qsoundinstance_p.h \
+        qaudioengineupdater_p.h \
         qaudioengine_p.h \
         qsoundsource_p.h \
         qsoundbuffer_p.h \
-        qaudioengine_openal_p.h
+        qsoundstream_p.h \
+        qaudioengine_software_p.h \
+        qsoftwaremixer_p.h
 
 SOURCES += \
         audioengine.cpp \
@@ -36,8 +37,23 @@ SOURCES += \
         qdeclarative_audiosample_p.cpp \
         qdeclarative_sound_p.cpp \
         qsoundinstance_p.cpp \
+        qaudioengineupdater_p.cpp \
         qaudioengine_p.cpp \
-        qsoundsource_openal_p.cpp  \
+        qsoundstream_p.cpp \
+        qsoundsource_software_p.cpp \
+        qaudioengine_software_p.cpp \
+        qsoftwaremixer_p.cpp
+
+SSE2_SOURCES += qsoftwaremixer_sse2.cpp
+
+qtConfig(openal) {
+    QMAKE_USE += openal
+    mac: DEFINES += HEADER_OPENAL_PREFIX
+
+    HEADERS += qaudioengine_openal_p.h
+    SOURCES += \
+        qsoundsource_openal_p.cpp \
         qaudioengine_openal_p.cpp
+}
 
 load(qml_plugin)
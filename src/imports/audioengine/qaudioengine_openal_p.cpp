@@ -40,6 +40,7 @@
 #include "qaudioengine_openal_p.h"
 
 #include <QtCore/QMutex>
+#include <QtCore/QSysInfo>
 #include <QtCore/QThread>
 #include <QtNetwork/QNetworkRequest>
 #include <QtNetwork/QNetworkReply>
@@ -58,6 +59,47 @@ QSoundBufferPrivateAL::QSoundBufferPrivateAL(QObject *parent)
 {
 }
 
+void QSoundBufferPrivateAL::setLooping(ALuint alSource, bool looping)
+{
+    alSourcei(alSource, AL_LOOPING, looping ? AL_TRUE : AL_FALSE);
+}
+
+bool QSoundBufferPrivateAL::prepareToPlay(ALuint alSource, bool resume)
+{
+    Q_UNUSED(alSource);
+    Q_UNUSED(resume);
+    return true;
+}
+
+void QSoundBufferPrivateAL::sourceStopped(ALuint alSource)
+{
+    Q_UNUSED(alSource);
+}
+
+bool QSoundBufferPrivateAL::isActive(ALuint alSource) const
+{
+    Q_UNUSED(alSource);
+    return false;
+}
+
+qreal QSoundBufferPrivateAL::remainingDuration(ALuint alSource) const
+{
+    ALint buffer = 0;
+    alGetSourcei(alSource, AL_BUFFER, &buffer);
+    ALint size = 0, bits = 0, channels = 0, frequency = 0;
+    alGetBufferi(buffer, AL_SIZE, &size);
+    alGetBufferi(buffer, AL_BITS, &bits);
+    alGetBufferi(buffer, AL_CHANNELS, &channels);
+    alGetBufferi(buffer, AL_FREQUENCY, &frequency);
+    ALfloat offset = 0;
+    alGetSourcef(alSource, AL_SEC_OFFSET, &offset);
+    if (!QAudioEnginePrivateAL::checkNoError("query remaining time") || bits <= 0 || channels <= 0 || frequency <= 0)
+        return -1;
+
+    const qreal duration = qreal(size) * 8 / (bits * channels) / frequency;
+    return qMax(qreal(0), duration - offset);
+}
+
 
 StaticSoundBufferAL::StaticSoundBufferAL(QObject *parent, const QUrl &url, QSampleCache *sampleLoader)
     : QSoundBufferPrivateAL(parent),
@@ -81,7 +123,7 @@ StaticSoundBufferAL::~StaticSoundBufferAL()
     if (m_alBuffer != 0) {
         alGetError(); // clear error
         alDeleteBuffers(1, &m_alBuffer);
-        QAudioEnginePrivate::checkNoError("delete buffer");
+        QAudioEnginePrivateAL::checkNoError("delete buffer");
     }
 }
 
@@ -158,13 +200,13 @@ void StaticSoundBufferAL::sampleReady()
     }
 
     alGenBuffers(1, &m_alBuffer);
-    if (!QAudioEnginePrivate::checkNoError("create buffer")) {
+    if (!QAudioEnginePrivateAL::checkNoError("create buffer")) {
         decoderError();
         return;
     }
     alBufferData(m_alBuffer, alFormat, m_sample->data().data(),
                  m_sample->data().size(), m_sample->format().sampleRate());
-    if (!QAudioEnginePrivate::checkNoError("fill buffer")) {
+    if (!QAudioEnginePrivateAL::checkNoError("fill buffer")) {
         decoderError();
         return;
     }
@@ -194,10 +236,367 @@ void StaticSoundBufferAL::decoderError()
 
 
 /////////////////////////////////////////////////////////////////
-QAudioEnginePrivate::QAudioEnginePrivate(QObject *parent)
-    : QObject(parent)
+//number and size of the AL buffers queued on each streaming source
+static const int streamBufferCount = 4;
+static const int streamBufferSize = 64 * 1024;
+
+class StreamingSoundBufferAL::Stream : public QSoundStreamService::Client
+{
+public:
+    Stream(ALuint alSource, ALenum alFormat);
+    ~Stream();
+
+    bool open(const QUrl &url);
+    QString errorString() const;
+
+    void setLooping(bool looping);
+    void restart();
+    void resume();
+    void stop();
+    bool isActive() const;
+    qreal remainingDuration() const;
+
+    void service() Q_DECL_OVERRIDE;
+
+private:
+    void unqueueProcessed();
+    void queueFree();
+
+    mutable QMutex m_mutex;
+    ALuint m_alSource;
+    ALenum m_alFormat;
+    QSoundStream m_reader;
+    ALuint m_buffers[streamBufferCount];
+    QHash<ALuint, int> m_queued;
+    QVector<ALuint> m_free;
+    QByteArray m_chunk;
+    qint64 m_queuedBytes;
+    bool m_looping;
+    bool m_active;
+    bool m_startPending;
+};
+
+StreamingSoundBufferAL::Stream::Stream(ALuint alSource, ALenum alFormat)
+    : m_alSource(alSource)
+    , m_alFormat(alFormat)
+    , m_queuedBytes(0)
+    , m_looping(false)
+    , m_active(false)
+    , m_startPending(false)
+{
+    alGetError(); // clear error
+    alGenBuffers(streamBufferCount, m_buffers);
+    if (!QAudioEnginePrivateAL::checkNoError("create stream buffers")) {
+        for (ALuint &buffer : m_buffers)
+            buffer = 0;
+        return;
+    }
+    for (ALuint buffer : m_buffers)
+        m_free.append(buffer);
+}
+
+StreamingSoundBufferAL::Stream::~Stream()
+{
+    alSourceStop(m_alSource);
+    alSourcei(m_alSource, AL_BUFFER, 0);
+    if (m_buffers[0] != 0) {
+        alDeleteBuffers(streamBufferCount, m_buffers);
+        QAudioEnginePrivateAL::checkNoError("delete stream buffers");
+    }
+}
+
+bool StreamingSoundBufferAL::Stream::open(const QUrl &url)
+{
+    if (m_free.isEmpty())
+        return false;
+    if (!m_reader.open(url))
+        return false;
+    const int bytesPerFrame = m_reader.format().bytesPerFrame();
+    m_chunk.resize(qMax(bytesPerFrame, streamBufferSize - streamBufferSize % bytesPerFrame));
+    return true;
+}
+
+QString StreamingSoundBufferAL::Stream::errorString() const
+{
+    return m_free.isEmpty() ? QStringLiteral("no AL buffers") : m_reader.errorString();
+}
+
+void StreamingSoundBufferAL::Stream::setLooping(bool looping)
+{
+    QMutexLocker locker(&m_mutex);
+    m_looping = looping;
+    //the queue gets refilled from the start instead of replaying the same buffers
+    alSourcei(m_alSource, AL_LOOPING, AL_FALSE);
+}
+
+void StreamingSoundBufferAL::Stream::restart()
+{
+    QMutexLocker locker(&m_mutex);
+    alSourceStop(m_alSource);
+    alSourcei(m_alSource, AL_BUFFER, 0);
+    m_queued.clear();
+    m_free.clear();
+    for (ALuint buffer : m_buffers)
+        m_free.append(buffer);
+    m_queuedBytes = 0;
+
+    //the queue is filled and the source started on the streaming thread
+    m_reader.rewind();
+    m_active = true;
+    m_startPending = true;
+}
+
+void StreamingSoundBufferAL::Stream::resume()
+{
+    QMutexLocker locker(&m_mutex);
+    m_active = true;
+}
+
+void StreamingSoundBufferAL::Stream::stop()
+{
+    QMutexLocker locker(&m_mutex);
+    m_active = false;
+    m_startPending = false;
+}
+
+bool StreamingSoundBufferAL::Stream::isActive() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_active;
+}
+
+qreal StreamingSoundBufferAL::Stream::remainingDuration() const
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_looping)
+        return -1;
+    //the byte offset counts from the oldest buffer still in the queue
+    ALint offset = 0;
+    alGetSourcei(m_alSource, AL_BYTE_OFFSET, &offset);
+    const QAudioFormat format = m_reader.format();
+    const qint64 bytes = m_reader.bytesRemaining() + m_queuedBytes - offset;
+    return qreal(qMax<qint64>(0, bytes)) / (format.bytesPerFrame() * format.sampleRate());
+}
+
+void StreamingSoundBufferAL::Stream::service()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_active)
+        return;
+
+    unqueueProcessed();
+    queueFree();
+
+    ALint state = 0, queued = 0;
+    alGetSourcei(m_alSource, AL_SOURCE_STATE, &state);
+    alGetSourcei(m_alSource, AL_BUFFERS_QUEUED, &queued);
+    if (m_startPending) {
+        m_startPending = false;
+        if (queued > 0)
+            alSourcePlay(m_alSource);
+        else
+            m_active = false;
+    } else if (state == AL_STOPPED) {
+        if (queued > 0) {
+            //the queue ran dry before it was refilled
+#ifdef DEBUG_AUDIOENGINE
+            qDebug() << "StreamingSoundBufferAL: underrun on source" << m_alSource;
+#endif
+            alSourcePlay(m_alSource);
+        } else {
+            m_active = false;
+        }
+    }
+}
+
+void StreamingSoundBufferAL::Stream::unqueueProcessed()
+{
+    ALint processed = 0;
+    alGetSourcei(m_alSource, AL_BUFFERS_PROCESSED, &processed);
+    while (processed-- > 0) {
+        ALuint buffer = 0;
+        alSourceUnqueueBuffers(m_alSource, 1, &buffer);
+        if (!QAudioEnginePrivateAL::checkNoError("unqueue stream buffer"))
+            break;
+        m_queuedBytes -= m_queued.take(buffer);
+        m_free.append(buffer);
+    }
+}
+
+void StreamingSoundBufferAL::Stream::queueFree()
+{
+    const QAudioFormat format = m_reader.format();
+    while (!m_free.isEmpty()) {
+        qint64 bytes = m_reader.read(m_chunk.data(), m_chunk.size());
+        if (bytes <= 0 && m_looping && m_reader.dataSize() > 0 && m_reader.rewind())
+            bytes = m_reader.read(m_chunk.data(), m_chunk.size());
+        if (bytes <= 0)
+            break;
+
+        const ALuint buffer = m_free.takeLast();
+        alBufferData(buffer, m_alFormat, m_chunk.constData(), bytes, format.sampleRate());
+        alSourceQueueBuffers(m_alSource, 1, &buffer);
+        if (!QAudioEnginePrivateAL::checkNoError("queue stream buffer")) {
+            m_free.append(buffer);
+            break;
+        }
+        m_queued.insert(buffer, bytes);
+        m_queuedBytes += bytes;
+    }
+}
+
+
+StreamingSoundBufferAL::StreamingSoundBufferAL(QObject *parent, const QUrl &url, QSoundStreamService *streamService)
+    : QSoundBufferPrivateAL(parent),
+      m_ref(1),
+      m_url(url),
+      m_state(Creating),
+      m_alFormat(0),
+      m_streamService(streamService)
+{
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "creating new StreamingSoundBufferAL";
+#endif
+}
+
+StreamingSoundBufferAL::~StreamingSoundBufferAL()
+{
+    for (Stream *stream : qAsConst(m_streams)) {
+        m_streamService->removeClient(stream);
+        delete stream;
+    }
+}
+
+QSoundBuffer::State StreamingSoundBufferAL::state() const
+{
+    return m_state;
+}
+
+void StreamingSoundBufferAL::load()
+{
+    if (m_state == Loading || m_state == Ready)
+        return;
+
+    m_state = Loading;
+    emit stateChanged(m_state);
+
+    //only the header is read here, report it like an asynchronous load
+    QMetaObject::invokeMethod(this, "openStream", Qt::QueuedConnection);
+}
+
+void StreamingSoundBufferAL::openStream()
+{
+    QSoundStream stream;
+    const bool opened = stream.open(m_url);
+    const QAudioFormat format = stream.format();
+
+    m_alFormat = 0;
+    if (!opened) {
+        qWarning() << "source [" << m_url << "] can not be streamed:" << stream.errorString();
+    } else if (format.channelCount() > 2) {
+        qWarning() << "source [" << m_url << "] channel > 2!";
+    } else if (format.sampleSize() == 8 && format.sampleType() == QAudioFormat::UnSignedInt) {
+        m_alFormat = format.channelCount() == 1 ? AL_FORMAT_MONO8 : AL_FORMAT_STEREO8;
+    } else if (format.sampleSize() == 16 && format.sampleType() == QAudioFormat::SignedInt
+               && format.byteOrder() == QAudioFormat::Endian(QSysInfo::ByteOrder)) {
+        m_alFormat = format.channelCount() == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+    } else {
+        qWarning() << "source [" << m_url << "] unsupported sample format:" << format;
+    }
+
+    if (m_alFormat == 0) {
+        m_state = Error;
+        emit stateChanged(m_state);
+        emit error();
+        return;
+    }
+
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "StreamingSoundBufferAL:stream[" << m_url << "] ready" << format;
+#endif
+    m_format = format;
+    m_state = Ready;
+    emit stateChanged(m_state);
+    emit ready();
+}
+
+void StreamingSoundBufferAL::bindToSource(ALuint alSource)
+{
+    Q_ASSERT(m_state == Ready);
+    unbindFromSource(alSource);
+
+    Stream *stream = new Stream(alSource, m_alFormat);
+    if (!stream->open(m_url)) {
+        qWarning() << "source [" << m_url << "] can not be streamed:" << stream->errorString();
+        delete stream;
+        return;
+    }
+    m_streams.insert(alSource, stream);
+    m_streamService->addClient(stream);
+}
+
+void StreamingSoundBufferAL::unbindFromSource(ALuint alSource)
+{
+    Stream *stream = m_streams.take(alSource);
+    if (!stream)
+        return;
+    m_streamService->removeClient(stream);
+    delete stream;
+}
+
+void StreamingSoundBufferAL::setLooping(ALuint alSource, bool looping)
+{
+    if (Stream *stream = m_streams.value(alSource))
+        stream->setLooping(looping);
+}
+
+bool StreamingSoundBufferAL::prepareToPlay(ALuint alSource, bool resume)
+{
+    Stream *stream = m_streams.value(alSource);
+    if (!stream)
+        return true;
+    if (resume) {
+        stream->resume();
+        return true;
+    }
+    stream->restart();
+    m_streamService->requestService();
+    return false;
+}
+
+void StreamingSoundBufferAL::sourceStopped(ALuint alSource)
+{
+    if (Stream *stream = m_streams.value(alSource))
+        stream->stop();
+}
+
+bool StreamingSoundBufferAL::isActive(ALuint alSource) const
+{
+    Stream *stream = m_streams.value(alSource);
+    return stream && stream->isActive();
+}
+
+qreal StreamingSoundBufferAL::remainingDuration(ALuint alSource) const
+{
+    Stream *stream = m_streams.value(alSource);
+    return stream ? stream->remainingDuration() : -1;
+}
+
+
+/////////////////////////////////////////////////////////////////
+QAudioEnginePrivateAL::QAudioEnginePrivateAL(QObject *parent)
+    : QAudioEnginePrivate(parent)
+    , m_context(0)
 {
-    m_updateTimer.setInterval(200);
+    //streaming sources get refilled from their own thread
+    m_streamService = new QSoundStreamService;
+    m_streamService->moveToThread(&m_streamThread);
+    m_streamThread.setObjectName(QStringLiteral("QAudioEngine streaming"));
+    m_streamThread.start();
+    QMetaObject::invokeMethod(m_streamService, "start", Qt::QueuedConnection);
+
+    //checks sources when they are expected to have finished instead of polling them
+    m_updateTimer.setSingleShot(true);
     connect(&m_updateTimer, SIGNAL(timeout()), this, SLOT(updateSoundSources()));
 
     m_sampleLoader = new QSampleCache(this);
@@ -229,17 +628,19 @@ QAudioEnginePrivate::QAudioEnginePrivate(QObject *parent)
     ALCcontext* context = alcCreateContext(device, 0);
     if (!context) {
         qWarning() << "Can not create openal context!";
+        alcCloseDevice(device);
         return;
     }
     alcMakeContextCurrent(context);
+    m_context = context;
     alDistanceModel(AL_NONE);
     alDopplerFactor(0);
 }
 
-QAudioEnginePrivate::~QAudioEnginePrivate()
+QAudioEnginePrivateAL::~QAudioEnginePrivateAL()
 {
 #ifdef DEBUG_AUDIOENGINE
-    qDebug() << "QAudioEnginePrivate::dtor";
+    qDebug() << "QAudioEnginePrivateAL::dtor";
 #endif
     const QObjectList children = this->children();
     for (QObject *child : children) {
@@ -254,26 +655,41 @@ QAudioEnginePrivate::~QAudioEnginePrivate()
     }
     m_staticBufferPool.clear();
 
+    qDeleteAll(m_streamingBufferPool);
+    m_streamingBufferPool.clear();
+
+    QMetaObject::invokeMethod(m_streamService, "stop", Qt::BlockingQueuedConnection);
+    m_streamThread.quit();
+    m_streamThread.wait();
+    delete m_streamService;
+
     delete m_sampleLoader;
 
-    ALCcontext* context = alcGetCurrentContext();
-    ALCdevice *device = alcGetContextsDevice(context);
-    alcDestroyContext(context);
-    alcCloseDevice(device);
+    if (m_context) {
+        ALCdevice *device = alcGetContextsDevice(m_context);
+        alcMakeContextCurrent(0);
+        alcDestroyContext(m_context);
+        alcCloseDevice(device);
+    }
 #ifdef DEBUG_AUDIOENGINE
-    qDebug() << "QAudioEnginePrivate::dtor: all done";
+    qDebug() << "QAudioEnginePrivateAL::dtor: all done";
 #endif
 }
 
-bool QAudioEnginePrivate::isLoading() const
+bool QAudioEnginePrivateAL::isValid() const
+{
+    return m_context != 0;
+}
+
+bool QAudioEnginePrivateAL::isLoading() const
 {
     return m_sampleLoader->isLoading();
 }
 
-QSoundSource* QAudioEnginePrivate::createSoundSource()
+QSoundSource* QAudioEnginePrivateAL::createSoundSource()
 {
 #ifdef DEBUG_AUDIOENGINE
-    qDebug() << "QAudioEnginePrivate::createSoundSource()";
+    qDebug() << "QAudioEnginePrivateAL::createSoundSource()";
 #endif
     QSoundSourcePrivate *instance = NULL;
     if (m_instancePool.count() == 0) {
@@ -286,7 +702,7 @@ QSoundSource* QAudioEnginePrivate::createSoundSource()
     return instance;
 }
 
-void QAudioEnginePrivate::releaseSoundSource(QSoundSource *soundInstance)
+void QAudioEnginePrivateAL::releaseSoundSource(QSoundSource *soundInstance)
 {
     QSoundSourcePrivate *privInstance = static_cast<QSoundSourcePrivate*>(soundInstance);
 #ifdef DEBUG_AUDIOENGINE
@@ -297,7 +713,7 @@ void QAudioEnginePrivate::releaseSoundSource(QSoundSource *soundInstance)
     m_activeInstances.removeOne(privInstance);
 }
 
-QSoundBuffer* QAudioEnginePrivate::getStaticSoundBuffer(const QUrl& url)
+QSoundBuffer* QAudioEnginePrivateAL::getStaticSoundBuffer(const QUrl& url)
 {
     StaticSoundBufferAL *staticBuffer = NULL;
     QMap<QUrl, QSoundBufferPrivateAL*>::iterator it = m_staticBufferPool.find(url);
@@ -311,15 +727,30 @@ QSoundBuffer* QAudioEnginePrivate::getStaticSoundBuffer(const QUrl& url)
     return staticBuffer;
 }
 
-void QAudioEnginePrivate::releaseSoundBuffer(QSoundBuffer *buffer)
+QSoundBuffer* QAudioEnginePrivateAL::getStreamingSoundBuffer(const QUrl& url)
+{
+    StreamingSoundBufferAL *streamingBuffer = m_streamingBufferPool.value(url);
+    if (!streamingBuffer) {
+        streamingBuffer = new StreamingSoundBufferAL(this, url, m_streamService);
+        m_streamingBufferPool.insert(url, streamingBuffer);
+    } else {
+        streamingBuffer->addRef();
+    }
+    return streamingBuffer;
+}
+
+void QAudioEnginePrivateAL::releaseSoundBuffer(QSoundBuffer *buffer)
 {
 #ifdef DEBUG_AUDIOENGINE
-    qDebug() << "QAudioEnginePrivate: recycle sound buffer";
+    qDebug() << "QAudioEnginePrivateAL: recycle sound buffer";
 #endif
     if (StaticSoundBufferAL *staticBuffer = qobject_cast<StaticSoundBufferAL *>(buffer)) {
         //decrement the reference count, still kept in memory for reuse
         staticBuffer->release();
         //TODO implement some resource recycle strategy
+    } else if (StreamingSoundBufferAL *streamingBuffer = qobject_cast<StreamingSoundBufferAL *>(buffer)) {
+        //the per source streams are gone already, only the parsed header is kept
+        streamingBuffer->release();
     } else {
         //TODO
         Q_ASSERT(0);
@@ -327,7 +758,7 @@ void QAudioEnginePrivate::releaseSoundBuffer(QSoundBuffer *buffer)
     }
 }
 
-bool QAudioEnginePrivate::checkNoError(const char *msg)
+bool QAudioEnginePrivateAL::checkNoError(const char *msg)
 {
     ALenum error = alGetError();
     if (error != AL_NO_ERROR) {
@@ -337,7 +768,7 @@ bool QAudioEnginePrivate::checkNoError(const char *msg)
     return true;
 }
 
-QVector3D QAudioEnginePrivate::listenerPosition() const
+QVector3D QAudioEnginePrivateAL::listenerPosition() const
 {
     ALfloat x, y, z;
     alGetListener3f(AL_POSITION, &x, &y, &z);
@@ -345,7 +776,7 @@ QVector3D QAudioEnginePrivate::listenerPosition() const
     return QVector3D(x, y, z);
 }
 
-QVector3D QAudioEnginePrivate::listenerVelocity() const
+QVector3D QAudioEnginePrivateAL::listenerVelocity() const
 {
     ALfloat x, y, z;
     alGetListener3f(AL_VELOCITY, &x, &y, &z);
@@ -353,7 +784,7 @@ QVector3D QAudioEnginePrivate::listenerVelocity() const
     return QVector3D(x, y, z);
 }
 
-qreal QAudioEnginePrivate::listenerGain() const
+qreal QAudioEnginePrivateAL::listenerGain() const
 {
     ALfloat gain;
     alGetListenerf(AL_GAIN, &gain);
@@ -361,13 +792,13 @@ qreal QAudioEnginePrivate::listenerGain() const
     return gain;
 }
 
-void QAudioEnginePrivate::setListenerPosition(const QVector3D& position)
+void QAudioEnginePrivateAL::setListenerPosition(const QVector3D& position)
 {
     alListener3f(AL_POSITION, position.x(), position.y(), position.z());
     checkNoError("set listener position");
 }
 
-void QAudioEnginePrivate::setListenerOrientation(const QVector3D& direction, const QVector3D& up)
+void QAudioEnginePrivateAL::setListenerOrientation(const QVector3D& direction, const QVector3D& up)
 {
     ALfloat orientation[6];
     orientation[0] = direction.x();
@@ -380,29 +811,29 @@ void QAudioEnginePrivate::setListenerOrientation(const QVector3D& direction, con
     checkNoError("set listener orientation");
 }
 
-void QAudioEnginePrivate::setListenerVelocity(const QVector3D& velocity)
+void QAudioEnginePrivateAL::setListenerVelocity(const QVector3D& velocity)
 {
     alListener3f(AL_VELOCITY, velocity.x(), velocity.y(), velocity.z());
     checkNoError("set listener velocity");
 }
 
-void QAudioEnginePrivate::setListenerGain(qreal gain)
+void QAudioEnginePrivateAL::setListenerGain(qreal gain)
 {
     alListenerf(AL_GAIN, gain);
     checkNoError("set listener gain");
 }
 
-void QAudioEnginePrivate::setDopplerFactor(qreal dopplerFactor)
+void QAudioEnginePrivateAL::setDopplerFactor(qreal dopplerFactor)
 {
     alDopplerFactor(dopplerFactor);
 }
 
-void QAudioEnginePrivate::setSpeedOfSound(qreal speedOfSound)
+void QAudioEnginePrivateAL::setSpeedOfSound(qreal speedOfSound)
 {
     alSpeedOfSound(speedOfSound);
 }
 
-void QAudioEnginePrivate::soundSourceActivate(QObject *soundSource)
+void QAudioEnginePrivateAL::soundSourceActivate(QObject *soundSource)
 {
     QSoundSourcePrivate *ss = qobject_cast<QSoundSourcePrivate*>(soundSource);
     ss->checkState();
@@ -410,24 +841,40 @@ void QAudioEnginePrivate::soundSourceActivate(QObject *soundSource)
         return;
     if (!m_activeInstances.contains(ss))
         m_activeInstances.push_back(ss);
-    if (!m_updateTimer.isActive())
-        m_updateTimer.start();
+    scheduleUpdate();
 }
 
-void QAudioEnginePrivate::updateSoundSources()
+void QAudioEnginePrivateAL::updateSoundSources()
 {
-    for (QList<QSoundSourcePrivate*>::Iterator it = m_activeInstances.begin();
-         it != m_activeInstances.end();) {
-        QSoundSourcePrivate *instance = *it;
+    //reporting a stop may recycle other sources, so walk over a copy
+    const QList<QSoundSourcePrivate*> instances = m_activeInstances;
+    for (QSoundSourcePrivate *instance : instances) {
+        if (!m_activeInstances.contains(instance))
+            continue;
         instance->checkState();
-        if (instance->state() == QSoundSource::StoppedState) {
-            it = m_activeInstances.erase(it);
-        } else {
-            ++it;
-        }
+        if (instance->state() == QSoundSource::StoppedState)
+            m_activeInstances.removeOne(instance);
+    }
+
+    scheduleUpdate();
+}
+
+void QAudioEnginePrivateAL::scheduleUpdate()
+{
+    //paused sources make no progress and are picked up again by the next activate()
+    int next = -1;
+    for (QSoundSourcePrivate *instance : qAsConst(m_activeInstances)) {
+        if (instance->state() != QSoundSource::PlayingState)
+            continue;
+        const int remaining = instance->remainingTime();
+        if (remaining >= 0 && (next < 0 || remaining < next))
+            next = remaining;
     }
 
-    if (m_activeInstances.count() == 0) {
+    if (next < 0) {
         m_updateTimer.stop();
+        return;
     }
+    //doppler shift and pitch changes move the end, late sources are simply checked again
+    m_updateTimer.start(qMax(next, 20));
 }
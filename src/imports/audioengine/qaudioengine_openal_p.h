@@ -52,8 +52,10 @@
 //
 
 #include <QObject>
+#include <QHash>
 #include <QList>
 #include <QMap>
+#include <QThread>
 #include <QTimer>
 #include <QUrl>
 
@@ -65,8 +67,10 @@
 #include <AL/alc.h>
 #endif
 
+#include "qaudioengine_p.h"
 #include "qsoundsource_p.h"
 #include "qsoundbuffer_p.h"
+#include "qsoundstream_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -80,6 +84,16 @@ public:
     QSoundBufferPrivateAL(QObject* parent);
     virtual void bindToSource(ALuint alSource) = 0;
     virtual void unbindFromSource(ALuint alSource) = 0;
+
+    virtual void setLooping(ALuint alSource, bool looping);
+    //called before alSource starts playing, resume is true when it was paused
+    //returns false if the buffer starts alSource itself once it has data queued
+    virtual bool prepareToPlay(ALuint alSource, bool resume);
+    virtual void sourceStopped(ALuint alSource);
+    //true while the buffer keeps alSource playing, even if AL reports it stopped
+    virtual bool isActive(ALuint alSource) const;
+    //seconds left until alSource plays out at normal pitch, negative if unknown
+    virtual qreal remainingDuration(ALuint alSource) const;
 };
 
 
@@ -116,6 +130,47 @@ private:
 };
 
 
+//Decodes a long asset while it plays, each bound source keeps a small queue of AL buffers
+class StreamingSoundBufferAL : public QSoundBufferPrivateAL
+{
+    Q_OBJECT
+
+public:
+    StreamingSoundBufferAL(QObject *parent, const QUrl &url, QSoundStreamService *streamService);
+    ~StreamingSoundBufferAL();
+
+    State state() const Q_DECL_OVERRIDE;
+
+    void load() Q_DECL_OVERRIDE;
+
+    void bindToSource(ALuint alSource) Q_DECL_OVERRIDE;
+    void unbindFromSource(ALuint alSource) Q_DECL_OVERRIDE;
+    void setLooping(ALuint alSource, bool looping) Q_DECL_OVERRIDE;
+    bool prepareToPlay(ALuint alSource, bool resume) Q_DECL_OVERRIDE;
+    void sourceStopped(ALuint alSource) Q_DECL_OVERRIDE;
+    bool isActive(ALuint alSource) const Q_DECL_OVERRIDE;
+    qreal remainingDuration(ALuint alSource) const Q_DECL_OVERRIDE;
+
+    inline long addRef() { return ++m_ref; }
+    inline long release() { return --m_ref; }
+    inline long refCount() const { return m_ref; }
+
+private Q_SLOTS:
+    void openStream();
+
+private:
+    class Stream;
+
+    long m_ref;
+    QUrl m_url;
+    State m_state;
+    ALenum m_alFormat;
+    QAudioFormat m_format;
+    QSoundStreamService *m_streamService;
+    QHash<ALuint, Stream*> m_streams;
+};
+
+
 class QSoundSourcePrivate : public QSoundSource
 {
     Q_OBJECT
@@ -147,6 +202,8 @@ public:
     void unbindBuffer() override;
 
     void checkState();
+    //estimated milliseconds until a playing source reaches the end of its buffer, -1 if unknown
+    int remainingTime() const;
 
     void release();
 
@@ -166,49 +223,57 @@ private:
     qreal   m_coneInnerAngle;
     qreal   m_coneOuterAngle;
     qreal   m_coneOuterGain;
+    bool    m_looping;
 };
 
 
-class QAudioEnginePrivate : public QObject
+class QAudioEnginePrivateAL : public QAudioEnginePrivate
 {
     Q_OBJECT
 public:
-    QAudioEnginePrivate(QObject *parent);
-    ~QAudioEnginePrivate();
-
-    bool isLoading() const;
-
-    QSoundSource* createSoundSource();
-    void releaseSoundSource(QSoundSource *soundInstance);
-    QSoundBuffer* getStaticSoundBuffer(const QUrl& url);
-    void releaseSoundBuffer(QSoundBuffer *buffer);
-
-    QVector3D listenerPosition() const;
-    QVector3D listenerVelocity() const;
-    qreal listenerGain() const;
-    void setListenerPosition(const QVector3D& position);
-    void setListenerVelocity(const QVector3D& velocity);
-    void setListenerOrientation(const QVector3D& direction, const QVector3D& up);
-    void setListenerGain(qreal gain);
-    void setDopplerFactor(qreal dopplerFactor);
-    void setSpeedOfSound(qreal speedOfSound);
+    QAudioEnginePrivateAL(QObject *parent);
+    ~QAudioEnginePrivateAL();
+
+    //false if no OpenAL device or context could be created
+    bool isValid() const;
+
+    bool isLoading() const override;
+
+    QSoundSource* createSoundSource() override;
+    void releaseSoundSource(QSoundSource *soundInstance) override;
+    QSoundBuffer* getStaticSoundBuffer(const QUrl& url) override;
+    QSoundBuffer* getStreamingSoundBuffer(const QUrl& url) override;
+    void releaseSoundBuffer(QSoundBuffer *buffer) override;
+
+    QVector3D listenerPosition() const override;
+    QVector3D listenerVelocity() const override;
+    qreal listenerGain() const override;
+    void setListenerPosition(const QVector3D& position) override;
+    void setListenerVelocity(const QVector3D& velocity) override;
+    void setListenerOrientation(const QVector3D& direction, const QVector3D& up) override;
+    void setListenerGain(qreal gain) override;
+    void setDopplerFactor(qreal dopplerFactor) override;
+    void setSpeedOfSound(qreal speedOfSound) override;
 
     static bool checkNoError(const char *msg);
 
-Q_SIGNALS:
-    void isLoadingChanged();
-
 private Q_SLOTS:
     void updateSoundSources();
     void soundSourceActivate(QObject *soundSource);
 
 private:
+    void scheduleUpdate();
+
     QList<QSoundSourcePrivate*> m_activeInstances;
     QList<QSoundSourcePrivate*> m_instancePool;
     QMap<QUrl, QSoundBufferPrivateAL*> m_staticBufferPool;
+    QMap<QUrl, StreamingSoundBufferAL*> m_streamingBufferPool;
 
     QSampleCache *m_sampleLoader;
     QTimer m_updateTimer;
+    QThread m_streamThread;
+    QSoundStreamService *m_streamService;
+    ALCcontext *m_context;
 };
 
 QT_END_NAMESPACE
@@ -41,7 +41,12 @@
 #include "qsoundsource_p.h"
 #include "qdebug.h"
 
+#include <QtMultimedia/private/qtmultimediaglobal_p.h>
+
+#if QT_CONFIG(openal)
 #include "qaudioengine_openal_p.h"
+#endif
+#include "qaudioengine_software_p.h"
 
 #define DEBUG_AUDIOENGINE
 
@@ -57,6 +62,34 @@ QSoundBuffer::QSoundBuffer(QObject *parent)
 {
 }
 
+QAudioEnginePrivate::QAudioEnginePrivate(QObject *parent)
+    : QObject(parent)
+{
+}
+
+//OpenAL is used when available unless QT_AUDIOENGINE_BACKEND=software,
+//the software mixer also takes over when no OpenAL device can be opened
+static QAudioEnginePrivate *createEnginePrivate(QObject *parent)
+{
+    const QByteArray backend = qgetenv("QT_AUDIOENGINE_BACKEND");
+#if QT_CONFIG(openal)
+    if (backend != "software") {
+        QAudioEnginePrivateAL *d = new QAudioEnginePrivateAL(parent);
+        if (d->isValid())
+            return d;
+        qWarning("QAudioEngine: OpenAL is not usable, falling back to the software mixer");
+        delete d;
+    }
+#else
+    if (!backend.isEmpty() && backend != "software")
+        qWarning("QAudioEngine: backend %s is not available, using the software mixer", backend.constData());
+#endif
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "QAudioEngine: using the software mixer";
+#endif
+    return new QAudioEnginePrivateSoftware(parent);
+}
+
 QAudioEngine* QAudioEngine::create(QObject *parent)
 {
     return new QAudioEngine(parent);
@@ -67,7 +100,7 @@ QAudioEngine::QAudioEngine(QObject *parent)
     , m_listenerUp(0, 0, 1)
     , m_listenerDirection(0, 1, 0)
 {
-    d = new QAudioEnginePrivate(this);
+    d = createEnginePrivate(this);
     connect(d, SIGNAL(isLoadingChanged()), this, SIGNAL(isLoadingChanged()));
     setDopplerFactor(1);
     setSpeedOfSound(qreal(343.33));
@@ -86,6 +119,11 @@ QSoundBuffer* QAudioEngine::getStaticSoundBuffer(const QUrl& url)
     return d->getStaticSoundBuffer(url);
 }
 
+QSoundBuffer* QAudioEngine::getStreamingSoundBuffer(const QUrl& url)
+{
+    return d->getStreamingSoundBuffer(url);
+}
+
 void QAudioEngine::releaseSoundBuffer(QSoundBuffer *buffer)
 {
     d->releaseSoundBuffer(buffer);
@@ -72,6 +72,7 @@ public:
     virtual void releaseSoundSource(QSoundSource *soundInstance);
 
     virtual QSoundBuffer* getStaticSoundBuffer(const QUrl& url);
+    virtual QSoundBuffer* getStreamingSoundBuffer(const QUrl& url);
     virtual void releaseSoundBuffer(QSoundBuffer *buffer);
 
     virtual bool isLoading() const;
@@ -110,6 +111,36 @@ private:
     QVector3D m_listenerDirection;
 };
 
+//Backend interface, QAudioEngine::create() picks the OpenAL or the software mixed one
+class QAudioEnginePrivate : public QObject
+{
+    Q_OBJECT
+public:
+    virtual bool isLoading() const = 0;
+
+    virtual QSoundSource* createSoundSource() = 0;
+    virtual void releaseSoundSource(QSoundSource *soundInstance) = 0;
+    virtual QSoundBuffer* getStaticSoundBuffer(const QUrl& url) = 0;
+    virtual QSoundBuffer* getStreamingSoundBuffer(const QUrl& url) = 0;
+    virtual void releaseSoundBuffer(QSoundBuffer *buffer) = 0;
+
+    virtual QVector3D listenerPosition() const = 0;
+    virtual QVector3D listenerVelocity() const = 0;
+    virtual qreal listenerGain() const = 0;
+    virtual void setListenerPosition(const QVector3D& position) = 0;
+    virtual void setListenerVelocity(const QVector3D& velocity) = 0;
+    virtual void setListenerOrientation(const QVector3D& direction, const QVector3D& up) = 0;
+    virtual void setListenerGain(qreal gain) = 0;
+    virtual void setDopplerFactor(qreal dopplerFactor) = 0;
+    virtual void setSpeedOfSound(qreal speedOfSound) = 0;
+
+Q_SIGNALS:
+    void isLoadingChanged();
+
+protected:
+    QAudioEnginePrivate(QObject *parent);
+};
+
 QT_END_NAMESPACE
 
 #endif
@@ -0,0 +1,539 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qaudioengine_software_p.h"
+#include "qsoftwaremixer_p.h"
+
+#include "qsamplecache_p.h"
+#include "qaudiohelpers_p.h"
+
+#include "qdebug.h"
+
+#define DEBUG_AUDIOENGINE
+
+QT_USE_NAMESPACE
+
+StaticSoundBufferSoftware::StaticSoundBufferSoftware(QObject *parent, const QUrl &url, QSampleCache *sampleLoader)
+    : QSoundBuffer(parent),
+      m_ref(1),
+      m_url(url),
+      m_state(Creating),
+      m_sample(0),
+      m_sampleLoader(sampleLoader),
+      m_channelCount(0),
+      m_sampleRate(0)
+{
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "creating new StaticSoundBufferSoftware";
+#endif
+}
+
+StaticSoundBufferSoftware::~StaticSoundBufferSoftware()
+{
+    if (m_sample)
+        m_sample->release();
+}
+
+QSoundBuffer::State StaticSoundBufferSoftware::state() const
+{
+    return m_state;
+}
+
+void StaticSoundBufferSoftware::load()
+{
+    if (m_state == Loading || m_state == Ready)
+        return;
+
+    m_state = Loading;
+    emit stateChanged(m_state);
+
+    m_sample = m_sampleLoader->requestSample(m_url);
+    connect(m_sample, SIGNAL(error()), this, SLOT(decoderError()));
+    connect(m_sample, SIGNAL(ready()), this, SLOT(sampleReady()));
+    switch (m_sample->state()) {
+    case QSample::Ready:
+        sampleReady();
+        break;
+    case QSample::Error:
+        decoderError();
+        break;
+    default:
+        break;
+    }
+}
+
+void StaticSoundBufferSoftware::sampleReady()
+{
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "StaticSoundBufferSoftware:sample[" << m_url << "] loaded";
+#endif
+
+    disconnect(m_sample, SIGNAL(error()), this, SLOT(decoderError()));
+    disconnect(m_sample, SIGNAL(ready()), this, SLOT(sampleReady()));
+
+    const QAudioFormat format = m_sample->format();
+    if (format.channelCount() < 1 || format.channelCount() > 2) {
+        qWarning() << "source [" << m_url << "] channel > 2!";
+        decoderError();
+        return;
+    }
+
+    const int bytesPerFrame = format.bytesPerFrame();
+    const int frames = bytesPerFrame > 0 ? m_sample->data().size() / bytesPerFrame : 0;
+    const int samples = frames * format.channelCount();
+    m_data.resize(samples);
+    if (frames == 0
+        || !QAudioHelperInternal::qConvertSamplesToFloat(format, m_sample->data().constData(),
+                                                         m_data.data(), samples)) {
+        qWarning() << "source [" << m_url << "] unsupported sample format:" << format;
+        m_data.clear();
+        decoderError();
+        return;
+    }
+    m_channelCount = format.channelCount();
+    m_sampleRate = format.sampleRate();
+
+    m_sample->release();
+    m_sample = 0;
+
+    m_state = Ready;
+    emit stateChanged(m_state);
+    emit ready();
+}
+
+void StaticSoundBufferSoftware::decoderError()
+{
+    qWarning() << "loading [" << m_url << "] failed";
+
+    disconnect(m_sample, SIGNAL(error()), this, SLOT(decoderError()));
+    disconnect(m_sample, SIGNAL(ready()), this, SLOT(sampleReady()));
+
+    m_sample->release();
+    m_sample = 0;
+
+    m_state = Error;
+    emit stateChanged(m_state);
+    emit error();
+}
+
+
+/////////////////////////////////////////////////////////////////
+//frames of the ring a streaming voice plays from, and decoded per read
+static const int streamRingFrames = 32768;
+static const int streamChunkFrames = 4096;
+
+StreamingSoundBufferSoftware::StreamingSoundBufferSoftware(QObject *parent, const QUrl &url)
+    : QSoundBuffer(parent),
+      m_ref(1),
+      m_url(url),
+      m_state(Creating)
+{
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "creating new StreamingSoundBufferSoftware";
+#endif
+}
+
+StreamingSoundBufferSoftware::~StreamingSoundBufferSoftware()
+{
+}
+
+QSoundBuffer::State StreamingSoundBufferSoftware::state() const
+{
+    return m_state;
+}
+
+void StreamingSoundBufferSoftware::load()
+{
+    if (m_state == Loading || m_state == Ready)
+        return;
+
+    m_state = Loading;
+    emit stateChanged(m_state);
+
+    //only the header is read here, report it like an asynchronous load
+    QMetaObject::invokeMethod(this, "openStream", Qt::QueuedConnection);
+}
+
+void StreamingSoundBufferSoftware::openStream()
+{
+    //probe the first frame so unsupported formats fail here and not while playing
+    QSoundStream stream;
+    bool supported = stream.open(m_url);
+    if (!supported) {
+        qWarning() << "source [" << m_url << "] can not be streamed:" << stream.errorString();
+    } else {
+        const QAudioFormat format = stream.format();
+        QByteArray frame(format.bytesPerFrame(), 0);
+        float converted[2];
+        supported = format.channelCount() >= 1 && format.channelCount() <= 2
+                && stream.read(frame.data(), frame.size()) == frame.size()
+                && QAudioHelperInternal::qConvertSamplesToFloat(format, frame.constData(),
+                                                                converted, format.channelCount());
+        if (!supported)
+            qWarning() << "source [" << m_url << "] unsupported sample format:" << format;
+    }
+
+    if (!supported) {
+        m_state = Error;
+        emit stateChanged(m_state);
+        emit error();
+        return;
+    }
+
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "StreamingSoundBufferSoftware:stream[" << m_url << "] ready";
+#endif
+    m_state = Ready;
+    emit stateChanged(m_state);
+    emit ready();
+}
+
+
+QSoftwareStream::QSoftwareStream(QSoftwareMixer *mixer, QSoftwareVoice *voice)
+    : m_mixer(mixer)
+    , m_voice(voice)
+{
+}
+
+bool QSoftwareStream::open(const QUrl &url)
+{
+    if (!m_reader.open(url))
+        return false;
+    const QAudioFormat format = m_reader.format();
+    const int channels = format.channelCount();
+    m_chunk.resize(streamChunkFrames * format.bytesPerFrame());
+    m_samples.resize(streamChunkFrames * channels);
+
+    QMutexLocker locker(m_mixer->mutex());
+    m_voice->data = QVector<float>(streamRingFrames * channels, 0.0f);
+    m_voice->channelCount = channels;
+    m_voice->frameCount = streamRingFrames;
+    m_voice->sampleRate = format.sampleRate();
+    m_voice->cursor = 0;
+    m_voice->streaming = true;
+    m_voice->streamWritten = 0;
+    m_voice->streamRead = 0;
+    m_voice->streamEnded = false;
+    m_mixer->resetVoice(m_voice);
+    return true;
+}
+
+QString QSoftwareStream::errorString() const
+{
+    return m_reader.errorString();
+}
+
+void QSoftwareStream::restart()
+{
+    QMutexLocker locker(&m_mutex);
+    m_reader.rewind();
+    {
+        QMutexLocker mixerLocker(m_mixer->mutex());
+        m_voice->cursor = 0;
+        m_voice->streamWritten = 0;
+        m_voice->streamRead = 0;
+        m_voice->streamEnded = false;
+        m_mixer->resetVoice(m_voice);
+    }
+    //refilled by the next service(), the voice stays silent until then
+}
+
+void QSoftwareStream::service()
+{
+    QMutexLocker locker(&m_mutex);
+    fill();
+}
+
+void QSoftwareStream::fill()
+{
+    const QAudioFormat format = m_reader.format();
+    const int bytesPerFrame = format.bytesPerFrame();
+    const int channels = format.channelCount();
+
+    for (;;) {
+        qint64 space;
+        bool looping;
+        {
+            QMutexLocker locker(m_mixer->mutex());
+            if (m_voice->streamEnded)
+                return;
+            space = m_voice->frameCount - (m_voice->streamWritten - qint64(m_voice->streamRead));
+            looping = m_voice->looping;
+        }
+        if (space <= 0)
+            return;
+
+        //decode outside of the mixer lock, the audio thread only waits for the copy
+        const qint64 maxBytes = qMin<qint64>(space, streamChunkFrames) * bytesPerFrame;
+        qint64 bytes = m_reader.read(m_chunk.data(), maxBytes);
+        if (bytes <= 0 && looping && m_reader.dataSize() > 0 && m_reader.rewind())
+            bytes = m_reader.read(m_chunk.data(), maxBytes);
+        const int frames = int(bytes / bytesPerFrame);
+        if (frames <= 0 || !QAudioHelperInternal::qConvertSamplesToFloat(format, m_chunk.constData(),
+                                                                         m_samples.data(), frames * channels)) {
+            QMutexLocker locker(m_mixer->mutex());
+            m_voice->streamEnded = true;
+            return;
+        }
+
+        QMutexLocker locker(m_mixer->mutex());
+        //the audio thread may be mixing from a copy sharing the ring. Writing
+        //without detaching is safe, the free frames written here are never
+        //read by that copy
+        float *ring = const_cast<float *>(m_voice->data.constData());
+        const int index = int(m_voice->streamWritten % m_voice->frameCount);
+        const int head = qMin(frames, m_voice->frameCount - index);
+        memcpy(ring + index * channels, m_samples.constData(), head * channels * sizeof(float));
+        memcpy(ring, m_samples.constData() + head * channels, (frames - head) * channels * sizeof(float));
+        m_voice->streamWritten += frames;
+    }
+}
+
+
+/////////////////////////////////////////////////////////////////
+QAudioEnginePrivateSoftware::QAudioEnginePrivateSoftware(QObject *parent)
+    : QAudioEnginePrivate(parent)
+    , m_listenerGain(1)
+{
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "QAudioEnginePrivateSoftware::ctor";
+#endif
+    m_sampleLoader = new QSampleCache(this);
+    m_sampleLoader->setCapacity(0);
+    connect(m_sampleLoader, SIGNAL(isLoadingChanged()), this, SIGNAL(isLoadingChanged()));
+
+    //the mixer and its QAudioOutput live on the audio thread, finished voices
+    //are reported back instead of being polled
+    m_mixer = new QSoftwareMixer;
+    m_mixer->moveToThread(&m_audioThread);
+    connect(m_mixer, SIGNAL(voicesFinished()), this, SLOT(updateSoundSources()));
+    m_audioThread.setObjectName(QStringLiteral("QAudioEngine mixer"));
+    m_audioThread.start(QThread::TimeCriticalPriority);
+    QMetaObject::invokeMethod(m_mixer, "startOutput", Qt::QueuedConnection);
+
+    //streaming voices get topped up from their own thread
+    m_streamService = new QSoundStreamService;
+    m_streamService->moveToThread(&m_streamThread);
+    m_streamThread.setObjectName(QStringLiteral("QAudioEngine streaming"));
+    m_streamThread.start();
+    QMetaObject::invokeMethod(m_streamService, "start", Qt::QueuedConnection);
+}
+
+QAudioEnginePrivateSoftware::~QAudioEnginePrivateSoftware()
+{
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "QAudioEnginePrivateSoftware::dtor";
+#endif
+    const QObjectList children = this->children();
+    for (QObject *child : children) {
+        QSoundSourceSoftware* s = qobject_cast<QSoundSourceSoftware*>(child);
+        if (!s)
+            continue;
+        s->release();
+    }
+
+    for (StaticSoundBufferSoftware *buffer : qAsConst(m_staticBufferPool)) {
+        delete buffer;
+    }
+    m_staticBufferPool.clear();
+
+    qDeleteAll(m_streamingBufferPool);
+    m_streamingBufferPool.clear();
+
+    QMetaObject::invokeMethod(m_streamService, "stop", Qt::BlockingQueuedConnection);
+    m_streamThread.quit();
+    m_streamThread.wait();
+    delete m_streamService;
+
+    delete m_sampleLoader;
+
+    QMetaObject::invokeMethod(m_mixer, "stopOutput", Qt::BlockingQueuedConnection);
+    m_audioThread.quit();
+    m_audioThread.wait();
+    delete m_mixer;
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "QAudioEnginePrivateSoftware::dtor: all done";
+#endif
+}
+
+bool QAudioEnginePrivateSoftware::isLoading() const
+{
+    return m_sampleLoader->isLoading();
+}
+
+QSoundSource* QAudioEnginePrivateSoftware::createSoundSource()
+{
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "QAudioEnginePrivateSoftware::createSoundSource()";
+#endif
+    QSoundSourceSoftware *instance = NULL;
+    if (m_instancePool.count() == 0) {
+        instance = new QSoundSourceSoftware(m_mixer, m_streamService, this);
+    } else {
+        instance = m_instancePool.front();
+        m_instancePool.pop_front();
+    }
+    connect(instance, SIGNAL(activate(QObject*)), this, SLOT(soundSourceActivate(QObject*)));
+    return instance;
+}
+
+void QAudioEnginePrivateSoftware::releaseSoundSource(QSoundSource *soundInstance)
+{
+    QSoundSourceSoftware *privInstance = static_cast<QSoundSourceSoftware*>(soundInstance);
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "recycle soundInstance" << privInstance;
+#endif
+    disconnect(privInstance, SIGNAL(activate(QObject*)), this, SLOT(soundSourceActivate(QObject*)));
+    privInstance->unbindBuffer();
+    m_instancePool.push_front(privInstance);
+    m_activeInstances.removeOne(privInstance);
+}
+
+QSoundBuffer* QAudioEnginePrivateSoftware::getStaticSoundBuffer(const QUrl& url)
+{
+    StaticSoundBufferSoftware *staticBuffer = NULL;
+    QMap<QUrl, StaticSoundBufferSoftware*>::iterator it = m_staticBufferPool.find(url);
+    if (it == m_staticBufferPool.end()) {
+        staticBuffer = new StaticSoundBufferSoftware(this, url, m_sampleLoader);
+        m_staticBufferPool.insert(url, staticBuffer);
+    } else {
+        staticBuffer = *it;
+        staticBuffer->addRef();
+    }
+    return staticBuffer;
+}
+
+QSoundBuffer* QAudioEnginePrivateSoftware::getStreamingSoundBuffer(const QUrl& url)
+{
+    StreamingSoundBufferSoftware *streamingBuffer = m_streamingBufferPool.value(url);
+    if (!streamingBuffer) {
+        streamingBuffer = new StreamingSoundBufferSoftware(this, url);
+        m_streamingBufferPool.insert(url, streamingBuffer);
+    } else {
+        streamingBuffer->addRef();
+    }
+    return streamingBuffer;
+}
+
+void QAudioEnginePrivateSoftware::releaseSoundBuffer(QSoundBuffer *buffer)
+{
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "QAudioEnginePrivateSoftware: recycle sound buffer";
+#endif
+    if (StaticSoundBufferSoftware *staticBuffer = qobject_cast<StaticSoundBufferSoftware *>(buffer)) {
+        //decrement the reference count, still kept in memory for reuse
+        staticBuffer->release();
+    } else if (StreamingSoundBufferSoftware *streamingBuffer = qobject_cast<StreamingSoundBufferSoftware *>(buffer)) {
+        streamingBuffer->release();
+    } else {
+        Q_ASSERT(0);
+        qWarning() << "Unknown soundbuffer type for recycle" << buffer;
+    }
+}
+
+QVector3D QAudioEnginePrivateSoftware::listenerPosition() const
+{
+    return m_listenerPosition;
+}
+
+QVector3D QAudioEnginePrivateSoftware::listenerVelocity() const
+{
+    return m_listenerVelocity;
+}
+
+qreal QAudioEnginePrivateSoftware::listenerGain() const
+{
+    return m_listenerGain;
+}
+
+void QAudioEnginePrivateSoftware::setListenerPosition(const QVector3D& position)
+{
+    m_listenerPosition = position;
+    m_mixer->setListenerPosition(position);
+}
+
+void QAudioEnginePrivateSoftware::setListenerOrientation(const QVector3D& direction, const QVector3D& up)
+{
+    m_mixer->setListenerOrientation(direction, up);
+}
+
+void QAudioEnginePrivateSoftware::setListenerVelocity(const QVector3D& velocity)
+{
+    m_listenerVelocity = velocity;
+    m_mixer->setListenerVelocity(velocity);
+}
+
+void QAudioEnginePrivateSoftware::setListenerGain(qreal gain)
+{
+    m_listenerGain = gain;
+    m_mixer->setListenerGain(gain);
+}
+
+void QAudioEnginePrivateSoftware::setDopplerFactor(qreal dopplerFactor)
+{
+    m_mixer->setDopplerFactor(dopplerFactor);
+}
+
+void QAudioEnginePrivateSoftware::setSpeedOfSound(qreal speedOfSound)
+{
+    m_mixer->setSpeedOfSound(speedOfSound);
+}
+
+void QAudioEnginePrivateSoftware::soundSourceActivate(QObject *soundSource)
+{
+    QSoundSourceSoftware *ss = qobject_cast<QSoundSourceSoftware*>(soundSource);
+    ss->checkState();
+    if (ss->isLooping())
+        return;
+    if (!m_activeInstances.contains(ss))
+        m_activeInstances.push_back(ss);
+}
+
+void QAudioEnginePrivateSoftware::updateSoundSources()
+{
+    //reporting a stop may recycle other sources, so walk over a copy
+    const QList<QSoundSourceSoftware*> instances = m_activeInstances;
+    for (QSoundSourceSoftware *instance : instances) {
+        if (!m_activeInstances.contains(instance))
+            continue;
+        instance->checkState();
+        if (instance->state() == QSoundSource::StoppedState)
+            m_activeInstances.removeOne(instance);
+    }
+}
@@ -0,0 +1,269 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QAUDIOENGINE_SOFTWARE_P_H
+#define QAUDIOENGINE_SOFTWARE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QThread>
+#include <QUrl>
+#include <QVector>
+
+#include "qaudioengine_p.h"
+#include "qsoundsource_p.h"
+#include "qsoundbuffer_p.h"
+#include "qsoundstream_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class QSample;
+class QSampleCache;
+class QSoftwareMixer;
+struct QSoftwareVoice;
+
+class StaticSoundBufferSoftware : public QSoundBuffer
+{
+    Q_OBJECT
+
+public:
+    StaticSoundBufferSoftware(QObject *parent, const QUrl &url, QSampleCache *sampleLoader);
+    ~StaticSoundBufferSoftware();
+
+    State state() const override;
+
+    void load() override;
+
+    //interleaved samples converted to float, valid once Ready
+    const QVector<float> &data() const { return m_data; }
+    int channelCount() const { return m_channelCount; }
+    int sampleRate() const { return m_sampleRate; }
+
+    inline long addRef() { return ++m_ref; }
+    inline long release() { return --m_ref; }
+    inline long refCount() const { return m_ref; }
+
+public Q_SLOTS:
+    void sampleReady();
+    void decoderError();
+
+private:
+    long m_ref;
+    QUrl m_url;
+    State m_state;
+    QSample *m_sample;
+    QSampleCache *m_sampleLoader;
+    QVector<float> m_data;
+    int m_channelCount;
+    int m_sampleRate;
+};
+
+
+//Keeps only the format of a long asset, every bound source reads it through its own QSoftwareStream
+class StreamingSoundBufferSoftware : public QSoundBuffer
+{
+    Q_OBJECT
+
+public:
+    StreamingSoundBufferSoftware(QObject *parent, const QUrl &url);
+    ~StreamingSoundBufferSoftware();
+
+    State state() const override;
+
+    void load() override;
+
+    QUrl url() const { return m_url; }
+
+    inline long addRef() { return ++m_ref; }
+    inline long release() { return --m_ref; }
+    inline long refCount() const { return m_ref; }
+
+private Q_SLOTS:
+    void openStream();
+
+private:
+    long m_ref;
+    QUrl m_url;
+    State m_state;
+};
+
+
+//Decodes a streaming buffer into the ring of one voice, topped up on the streaming thread
+class QSoftwareStream : public QSoundStreamService::Client
+{
+public:
+    QSoftwareStream(QSoftwareMixer *mixer, QSoftwareVoice *voice);
+
+    bool open(const QUrl &url);
+    QString errorString() const;
+
+    //rewinds to the start and fills the ring before the voice plays again
+    void restart();
+
+    void service() override;
+
+private:
+    void fill();
+
+    QMutex m_mutex;
+    QSoftwareMixer *m_mixer;
+    QSoftwareVoice *m_voice;
+    QSoundStream m_reader;
+    QByteArray m_chunk;
+    QVector<float> m_samples;
+};
+
+
+class QSoundSourceSoftware : public QSoundSource
+{
+    Q_OBJECT
+public:
+    QSoundSourceSoftware(QSoftwareMixer *mixer, QSoundStreamService *streamService, QObject *parent);
+    ~QSoundSourceSoftware();
+
+    void play() override;
+    void pause() override;
+    void stop() override;
+
+    QSoundSource::State state() const override;
+
+    bool isLooping() const;
+    void setLooping(bool looping) override;
+    void setPosition(const QVector3D& position) override;
+    void setDirection(const QVector3D& direction) override;
+    void setVelocity(const QVector3D& velocity) override;
+
+    QVector3D velocity() const override;
+    QVector3D position() const override;
+    QVector3D direction() const override;
+
+    void setGain(qreal gain) override;
+    void setPitch(qreal pitch) override;
+    void setCone(qreal innerAngle, qreal outerAngle, qreal outerGain) override;
+
+    void bindBuffer(QSoundBuffer*) override;
+    void unbindBuffer() override;
+
+    void checkState();
+
+    void release();
+
+Q_SIGNALS:
+    void activate(QObject*);
+
+private:
+    QSoftwareMixer *m_mixer;
+    QSoftwareVoice *m_voice;
+    QSoundStreamService *m_streamService;
+    QSoftwareStream *m_stream;
+    QSoundBuffer *m_bindBuffer;
+    bool                 m_isReady; //true if the sound source is already bound to some sound buffer
+    QSoundSource::State  m_state;
+    bool      m_looping;
+    QVector3D m_position;
+    QVector3D m_direction;
+    QVector3D m_velocity;
+    qreal   m_gain;
+    qreal   m_pitch;
+};
+
+
+//Mixes all sound sources in process and plays the result through one QAudioOutput
+//owned by a dedicated audio thread
+class QAudioEnginePrivateSoftware : public QAudioEnginePrivate
+{
+    Q_OBJECT
+public:
+    QAudioEnginePrivateSoftware(QObject *parent);
+    ~QAudioEnginePrivateSoftware();
+
+    bool isLoading() const override;
+
+    QSoundSource* createSoundSource() override;
+    void releaseSoundSource(QSoundSource *soundInstance) override;
+    QSoundBuffer* getStaticSoundBuffer(const QUrl& url) override;
+    QSoundBuffer* getStreamingSoundBuffer(const QUrl& url) override;
+    void releaseSoundBuffer(QSoundBuffer *buffer) override;
+
+    QVector3D listenerPosition() const override;
+    QVector3D listenerVelocity() const override;
+    qreal listenerGain() const override;
+    void setListenerPosition(const QVector3D& position) override;
+    void setListenerVelocity(const QVector3D& velocity) override;
+    void setListenerOrientation(const QVector3D& direction, const QVector3D& up) override;
+    void setListenerGain(qreal gain) override;
+    void setDopplerFactor(qreal dopplerFactor) override;
+    void setSpeedOfSound(qreal speedOfSound) override;
+
+private Q_SLOTS:
+    void updateSoundSources();
+    void soundSourceActivate(QObject *soundSource);
+
+private:
+    QList<QSoundSourceSoftware*> m_activeInstances;
+    QList<QSoundSourceSoftware*> m_instancePool;
+    QMap<QUrl, StaticSoundBufferSoftware*> m_staticBufferPool;
+    QMap<QUrl, StreamingSoundBufferSoftware*> m_streamingBufferPool;
+
+    QSampleCache *m_sampleLoader;
+    QSoftwareMixer *m_mixer;
+    QThread m_audioThread;
+    QSoundStreamService *m_streamService;
+    QThread m_streamThread;
+
+    QVector3D m_listenerPosition;
+    QVector3D m_listenerVelocity;
+    qreal m_listenerGain;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,330 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qaudioengineupdater_p.h"
+#include "qsoundsource_p.h"
+#include "qdeclarative_attenuationmodel_p.h"
+
+#include <QtCore/QTimer>
+
+#include "qdebug.h"
+
+#define DEBUG_AUDIOENGINE
+
+QT_USE_NAMESPACE
+
+QAudioEngineUpdater::QAudioEngineUpdater(QObject *parent)
+    : QObject(parent)
+    , m_listenerDirty(false)
+    , m_interval(100)
+    , m_applyContext(new QObject)
+    , m_timer(0)
+{
+}
+
+QAudioEngineUpdater::~QAudioEngineUpdater()
+{
+    //also discards a pending applyPending() call
+    delete m_applyContext;
+    qDeleteAll(m_entries);
+}
+
+int QAudioEngineUpdater::interval() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_interval;
+}
+
+void QAudioEngineUpdater::setInterval(int msec)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_interval = msec;
+    }
+    QMetaObject::invokeMethod(this, "wake", Qt::QueuedConnection);
+}
+
+void QAudioEngineUpdater::addSource(QSoundSource *source, const QDeclarativeAttenuationModel *attenuationModel)
+{
+    //the model is a QML object, only read it on this thread
+    const QAudioAttenuation attenuation = attenuationModel ? attenuationModel->attenuation() : QAudioAttenuation();
+
+    QMutexLocker locker(&m_mutex);
+    Entry *e = m_entries.value(source);
+    if (!e) {
+        e = new Entry;
+        e->source = source;
+        e->extrapolated = false;
+        e->gain = 1;
+        e->dirty = 0;
+        m_entries.insert(source, e);
+        if (m_entries.count() == 1)
+            QMetaObject::invokeMethod(this, "wake", Qt::QueuedConnection);
+    }
+    e->attenuation = attenuation;
+    markDirty(e, PositionDirty | VelocityDirty | GainDirty);
+}
+
+void QAudioEngineUpdater::removeSource(QSoundSource *source)
+{
+    QMutexLocker locker(&m_mutex);
+    Entry *e = m_entries.take(source);
+    if (!e)
+        return;
+    m_dirty.removeAll(e);
+    m_pending.remove(source);
+    delete e;
+}
+
+void QAudioEngineUpdater::setExtrapolated(QSoundSource *source, bool extrapolated)
+{
+    QMutexLocker locker(&m_mutex);
+    if (Entry *e = entry(source))
+        e->extrapolated = extrapolated;
+}
+
+void QAudioEngineUpdater::setPosition(QSoundSource *source, const QVector3D& position)
+{
+    QMutexLocker locker(&m_mutex);
+    Entry *e = entry(source);
+    if (!e || (e->position == position && !(e->dirty & PositionDirty)))
+        return;
+    e->position = position;
+    markDirty(e, PositionDirty);
+}
+
+void QAudioEngineUpdater::setVelocity(QSoundSource *source, const QVector3D& velocity)
+{
+    QMutexLocker locker(&m_mutex);
+    Entry *e = entry(source);
+    if (!e || (e->velocity == velocity && !(e->dirty & VelocityDirty)))
+        return;
+    e->velocity = velocity;
+    markDirty(e, VelocityDirty);
+}
+
+void QAudioEngineUpdater::setGain(QSoundSource *source, qreal gain)
+{
+    QMutexLocker locker(&m_mutex);
+    Entry *e = entry(source);
+    if (!e || (e->gain == gain && !(e->dirty & GainDirty)))
+        return;
+    e->gain = gain;
+    markDirty(e, GainDirty);
+}
+
+qreal QAudioEngineUpdater::audibleGain(QSoundSource *source) const
+{
+    QMutexLocker locker(&m_mutex);
+    const Entry *e = entry(source);
+    if (!e)
+        return 0;
+    if (e->attenuation.isNull())
+        return e->gain;
+    return e->gain * e->attenuation.calculateGain(m_listenerPosition, e->position);
+}
+
+void QAudioEngineUpdater::commit(QSoundSource *source)
+{
+    Update update;
+    {
+        QMutexLocker locker(&m_mutex);
+        Entry *e = entry(source);
+        if (!e)
+            return;
+        //what the update thread posted is older than the current state
+        update = m_pending.take(source);
+        Update current;
+        collect(e, true, &current);
+        merge(&update, current);
+    }
+    apply(source, update);
+}
+
+void QAudioEngineUpdater::setListenerPosition(const QVector3D& position)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_listenerPosition == position)
+        return;
+    m_listenerPosition = position;
+    m_listenerDirty = true;
+}
+
+void QAudioEngineUpdater::start()
+{
+    if (m_timer)
+        return;
+    m_timer = new QTimer(this);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(update()));
+    wake();
+}
+
+void QAudioEngineUpdater::stop()
+{
+    delete m_timer;
+    m_timer = 0;
+}
+
+void QAudioEngineUpdater::wake()
+{
+    if (!m_timer)
+        return;
+
+    int interval;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_entries.isEmpty())
+            return;
+        interval = m_interval;
+    }
+    if (!m_timer->isActive())
+        m_clock.start();
+    if (!m_timer->isActive() || m_timer->interval() != interval)
+        m_timer->start(interval);
+}
+
+void QAudioEngineUpdater::update()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_entries.isEmpty()) {
+        //woken up again by the next addSource()
+        m_timer->stop();
+        return;
+    }
+
+    const bool post = m_pending.isEmpty();
+    const qreal elapsed = m_clock.restart() / qreal(1000);
+    for (Entry *e : qAsConst(m_entries)) {
+        if (e->extrapolated && !e->velocity.isNull()) {
+            e->position += e->velocity * elapsed;
+            markDirty(e, PositionDirty);
+        }
+    }
+
+    if (m_listenerDirty) {
+        for (Entry *e : qAsConst(m_entries))
+            queue(e, true);
+        m_listenerDirty = false;
+    } else {
+        for (Entry *e : qAsConst(m_dirty))
+            queue(e, false);
+    }
+    m_dirty.clear();
+
+    if (post && !m_pending.isEmpty())
+        QMetaObject::invokeMethod(m_applyContext, [this] { applyPending(); }, Qt::QueuedConnection);
+}
+
+void QAudioEngineUpdater::applyPending()
+{
+    QHash<QSoundSource*, Update> pending;
+    {
+        QMutexLocker locker(&m_mutex);
+        pending.swap(m_pending);
+    }
+    //removeSource() runs on this thread as well, so all sources are still alive
+    for (auto it = pending.cbegin(), end = pending.cend(); it != end; ++it)
+        apply(it.key(), it.value());
+}
+
+QAudioEngineUpdater::Entry *QAudioEngineUpdater::entry(QSoundSource *source) const
+{
+    return m_entries.value(source);
+}
+
+void QAudioEngineUpdater::markDirty(Entry *entry, int flags)
+{
+    if (entry->dirty == 0)
+        m_dirty.append(entry);
+    entry->dirty |= flags;
+}
+
+void QAudioEngineUpdater::collect(Entry *entry, bool listenerMoved, Update *update)
+{
+    const int dirty = entry->dirty;
+    entry->dirty = 0;
+
+    if (dirty & PositionDirty) {
+        update->position = entry->position;
+        update->dirty |= PositionDirty;
+    }
+    if (dirty & VelocityDirty) {
+        update->velocity = entry->velocity;
+        update->dirty |= VelocityDirty;
+    }
+
+    if (!entry->attenuation.isNull()) {
+        if (listenerMoved || (dirty & (PositionDirty | GainDirty))) {
+            update->gain = entry->gain * entry->attenuation.calculateGain(m_listenerPosition, entry->position);
+            update->dirty |= GainDirty;
+        }
+    } else if (dirty & GainDirty) {
+        update->gain = entry->gain;
+        update->dirty |= GainDirty;
+    }
+}
+
+void QAudioEngineUpdater::queue(Entry *entry, bool listenerMoved)
+{
+    Update update;
+    collect(entry, listenerMoved, &update);
+    if (update.dirty)
+        merge(&m_pending[entry->source], update);
+}
+
+void QAudioEngineUpdater::merge(Update *into, const Update &update)
+{
+    if (update.dirty & PositionDirty)
+        into->position = update.position;
+    if (update.dirty & VelocityDirty)
+        into->velocity = update.velocity;
+    if (update.dirty & GainDirty)
+        into->gain = update.gain;
+    into->dirty |= update.dirty;
+}
+
+void QAudioEngineUpdater::apply(QSoundSource *source, const Update &update)
+{
+    if (update.dirty & PositionDirty)
+        source->setPosition(update.position);
+    if (update.dirty & VelocityDirty)
+        source->setVelocity(update.velocity);
+    if (update.dirty & GainDirty)
+        source->setGain(update.gain);
+}
@@ -0,0 +1,166 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QAUDIOENGINEUPDATER_P_H
+#define QAUDIOENGINEUPDATER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/QObject>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+#include <QtGui/qvector3d.h>
+
+#include "qdeclarative_attenuationmodel_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class QTimer;
+class QSoundSource;
+
+//Collects position, velocity and gain changes of sound sources and computes them,
+//together with the distance attenuation, in batches on the update thread it is
+//moved to. The results are posted back to the thread that created the updater,
+//which applies them to the sound sources, so these are only ever touched there.
+//All public functions may be called from the GUI thread.
+class QAudioEngineUpdater : public QObject
+{
+    Q_OBJECT
+public:
+    QAudioEngineUpdater(QObject *parent = 0);
+    ~QAudioEngineUpdater();
+
+    int interval() const;
+    void setInterval(int msec);
+
+    void addSource(QSoundSource *source, const QDeclarativeAttenuationModel *attenuationModel);
+    void removeSource(QSoundSource *source);
+
+    //sources of fire and forget instances keep moving with their velocity
+    void setExtrapolated(QSoundSource *source, bool extrapolated);
+
+    void setPosition(QSoundSource *source, const QVector3D& position);
+    void setVelocity(QSoundSource *source, const QVector3D& velocity);
+    //gain before distance attenuation
+    void setGain(QSoundSource *source, qreal gain);
+    //gain including the distance attenuation at the latest position
+    qreal audibleGain(QSoundSource *source) const;
+
+    //applies the pending state of source right away, used before it starts playing.
+    //Must be called from the thread that created the updater.
+    void commit(QSoundSource *source);
+
+    void setListenerPosition(const QVector3D& position);
+
+public Q_SLOTS:
+    void start();
+    void stop();
+
+private Q_SLOTS:
+    void update();
+    void wake();
+
+private:
+    enum DirtyFlag
+    {
+        PositionDirty = 0x1,
+        VelocityDirty = 0x2,
+        GainDirty = 0x4
+    };
+
+    struct Entry
+    {
+        QSoundSource *source;
+        QAudioAttenuation attenuation;
+        bool extrapolated;
+        QVector3D position;
+        QVector3D velocity;
+        qreal gain;
+        int dirty;
+    };
+
+    //values to set on a sound source, dirty tells which
+    struct Update
+    {
+        Update() : dirty(0), gain(1) {}
+
+        int dirty;
+        QVector3D position;
+        QVector3D velocity;
+        qreal gain;
+    };
+
+    Entry *entry(QSoundSource *source) const;
+    void markDirty(Entry *entry, int flags);
+    void collect(Entry *entry, bool listenerMoved, Update *update);
+    void queue(Entry *entry, bool listenerMoved);
+    static void merge(Update *into, const Update &update);
+    static void apply(QSoundSource *source, const Update &update);
+    void applyPending();
+
+    mutable QMutex m_mutex;
+    QHash<QSoundSource*, Entry*> m_entries;
+    QVector<Entry*> m_dirty;
+    QHash<QSoundSource*, Update> m_pending;
+    QVector3D m_listenerPosition;
+    bool m_listenerDirty;
+    int m_interval;
+
+    //lives in the creating thread to run applyPending() there
+    QObject *m_applyContext;
+
+    //only touched on the engine thread
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIOENGINEUPDATER_P_H
@@ -45,6 +45,42 @@
 
 QT_USE_NAMESPACE
 
+QAudioAttenuation::QAudioAttenuation()
+    : m_type(None)
+    , m_start(0)
+    , m_end(0)
+    , m_rolloff(0)
+{
+}
+
+QAudioAttenuation::QAudioAttenuation(Type type, qreal start, qreal end, qreal rolloff)
+    : m_type(type)
+    , m_start(start)
+    , m_end(end)
+    , m_rolloff(rolloff)
+{
+}
+
+qreal QAudioAttenuation::calculateGain(const QVector3D &listenerPosition, const QVector3D &sourcePosition) const
+{
+    switch (m_type) {
+    case Linear: {
+        qreal md = m_end - m_start;
+        if (md == 0)
+            return 1;
+        qreal d = qBound(qreal(0), (listenerPosition - sourcePosition).length() - m_start, md);
+        return qreal(1) - (d / md);
+    }
+    case Inverse:
+        //start is the reference and end the maximum distance
+        Q_ASSERT(m_start > 0);
+        return m_start / (m_start + (qBound<qreal>(m_start, (listenerPosition - sourcePosition).length(), m_end) - m_start) * m_rolloff);
+    case None:
+        break;
+    }
+    return 1;
+}
+
 QDeclarativeAttenuationModel::QDeclarativeAttenuationModel(QObject *parent)
     : QObject(parent)
     , m_engine(0)
@@ -195,11 +231,12 @@ void QDeclarativeAttenuationModelLinear::setEndDistance(qreal endDist)
 
 qreal QDeclarativeAttenuationModelLinear::calculateGain(const QVector3D &listenerPosition, const QVector3D &sourcePosition) const
 {
-    qreal md = m_end - m_start;
-    if (md == 0)
-        return 1;
-    qreal d = qBound(qreal(0), (listenerPosition - sourcePosition).length() - m_start, md);
-    return qreal(1) - (d / md);
+    return attenuation().calculateGain(listenerPosition, sourcePosition);
+}
+
+QAudioAttenuation QDeclarativeAttenuationModelLinear::attenuation() const
+{
+    return QAudioAttenuation(QAudioAttenuation::Linear, m_start, m_end);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -356,7 +393,11 @@ void QDeclarativeAttenuationModelInverse::setRolloffFactor(qreal rolloffFactor)
 
 qreal QDeclarativeAttenuationModelInverse::calculateGain(const QVector3D &listenerPosition, const QVector3D &sourcePosition) const
 {
-    Q_ASSERT(m_ref > 0);
-    return m_ref / (m_ref + (qBound<qreal>(m_ref, (listenerPosition - sourcePosition).length(), m_max) - m_ref) * m_rolloff);
+    return attenuation().calculateGain(listenerPosition, sourcePosition);
+}
+
+QAudioAttenuation QDeclarativeAttenuationModelInverse::attenuation() const
+{
+    return QAudioAttenuation(QAudioAttenuation::Inverse, m_ref, m_max, m_rolloff);
 }
 
@@ -58,6 +58,32 @@ QT_BEGIN_NAMESPACE
 
 class QDeclarativeAudioEngine;
 
+//The parameters of an attenuation model, copied so the attenuation can be
+//calculated on another thread. Models can't change once they are in use.
+class QAudioAttenuation
+{
+public:
+    enum Type
+    {
+        None,
+        Linear,
+        Inverse
+    };
+
+    QAudioAttenuation();
+    QAudioAttenuation(Type type, qreal start, qreal end, qreal rolloff = 1);
+
+    bool isNull() const { return m_type == None; }
+
+    qreal calculateGain(const QVector3D &listenerPosition, const QVector3D &sourcePosition) const;
+
+private:
+    Type m_type;
+    qreal m_start;
+    qreal m_end;
+    qreal m_rolloff;
+};
+
 class QDeclarativeAttenuationModel : public QObject
 {
     Q_OBJECT
@@ -71,6 +97,7 @@ public:
     void setName(const QString& name);
 
     virtual qreal calculateGain(const QVector3D &listenerPosition, const QVector3D &sourcePosition) const = 0;
+    virtual QAudioAttenuation attenuation() const = 0;
 
     virtual void setEngine(QDeclarativeAudioEngine *engine);
 
@@ -98,6 +125,7 @@ public:
     void setEndDistance(qreal endDist);
 
     qreal calculateGain(const QVector3D &listenerPosition, const QVector3D &sourcePosition) const override;
+    QAudioAttenuation attenuation() const override;
 
     void setEngine(QDeclarativeAudioEngine *engine) override;
 
@@ -127,6 +155,7 @@ public:
     void setRolloffFactor(qreal rolloffFactor);
 
     qreal calculateGain(const QVector3D &listenerPosition, const QVector3D &sourcePosition) const override;
+    QAudioAttenuation attenuation() const override;
 
     void setEngine(QDeclarativeAudioEngine *engine) override;
 
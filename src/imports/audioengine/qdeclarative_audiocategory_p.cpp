@@ -107,6 +107,7 @@ QT_USE_NAMESPACE
 QDeclarativeAudioCategory::QDeclarativeAudioCategory(QObject *parent)
     : QObject(parent)
     , m_volume(1)
+    , m_priority(0)
     , m_engine(0)
 {
 }
@@ -162,6 +163,24 @@ QString QDeclarativeAudioCategory::name() const
     return m_name;
 }
 
+/*!
+    \qmlproperty int QtAudioEngine::AudioCategory::priority
+    \since 5.11
+
+    This property holds the priority shared by all sounds of the category. It is added to
+    the \l{Sound::priority}{priority} of each sound when the engine has to choose which
+    playing instance to stop for a new one. The default value is 0.
+*/
+int QDeclarativeAudioCategory::priority() const
+{
+    return m_priority;
+}
+
+void QDeclarativeAudioCategory::setPriority(int priority)
+{
+    m_priority = priority;
+}
+
 /*!
     \qmlmethod QtAudioEngine::AudioCategory::stop()
 
@@ -62,6 +62,7 @@ class QDeclarativeAudioCategory : public QObject
     Q_OBJECT
     Q_PROPERTY(qreal volume READ volume WRITE setVolume NOTIFY volumeChanged)
     Q_PROPERTY(QString name READ name WRITE setName)
+    Q_PROPERTY(int priority READ priority WRITE setPriority REVISION 1)
 
 public:
     QDeclarativeAudioCategory(QObject *parent = 0);
@@ -73,6 +74,9 @@ public:
     QString name() const;
     void setName(const QString& name);
 
+    int priority() const;
+    void setPriority(int priority);
+
     void setEngine(QDeclarativeAudioEngine *engine);
 
 Q_SIGNALS:
@@ -90,6 +94,7 @@ private:
     Q_DISABLE_COPY(QDeclarativeAudioCategory);
     QString m_name;
     qreal m_volume;
+    int m_priority;
     QDeclarativeAudioEngine *m_engine;
 };
 
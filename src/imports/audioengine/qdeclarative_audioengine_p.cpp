@@ -46,6 +46,7 @@
 #include "qdeclarative_attenuationmodel_p.h"
 #include "qdeclarative_soundinstance_p.h"
 #include "qsoundinstance_p.h"
+#include "qaudioengineupdater_p.h"
 #include <QtQml/qqmlengine.h>
 #include "qdebug.h"
 
@@ -108,6 +109,11 @@ QT_BEGIN_NAMESPACE
     It is mostly used as a container to access other types such as AudioCategory, AudioSample and
     Sound.
 
+    Sounds are rendered with OpenAL when it is available. Otherwise, or when the
+    \c QT_AUDIOENGINE_BACKEND environment variable is set to \c software, all sounds are
+    mixed in process, including panning and doppler shift, and played through a single
+    audio output.
+
     \sa AudioCategory, AudioSample, Sound, SoundInstance, AttenuationModelLinear, AttenuationModelInverse
 */
 
@@ -117,13 +123,21 @@ QDeclarativeAudioEngine::QDeclarativeAudioEngine(QObject *parent)
     , m_defaultCategory(0)
     , m_defaultAttenuationModel(0)
     , m_audioEngine(0)
+    , m_maxVoices(0)
+    , m_updater(0)
 {
     m_audioEngine = QAudioEngine::create(this);
     connect(m_audioEngine, SIGNAL(isLoadingChanged()), this, SIGNAL(isLoadingChanged()));
     connect(m_audioEngine, SIGNAL(isLoadingChanged()), this, SLOT(handleLoadingChanged()));
+
+    //sound instance positions, velocities and gains are applied from this thread
+    m_updater = new QAudioEngineUpdater;
+    m_updater->moveToThread(&m_updateThread);
+    m_updateThread.setObjectName(QStringLiteral("AudioEngine updater"));
+    m_updateThread.start();
+    QMetaObject::invokeMethod(m_updater, "start", Qt::QueuedConnection);
+
     m_listener = new QDeclarativeAudioListener(this);
-    m_updateTimer.setInterval(100);
-    connect(&m_updateTimer, SIGNAL(timeout()), this, SLOT(updateSoundInstances()));
 }
 
 QDeclarativeAudioEngine::~QDeclarativeAudioEngine()
@@ -141,6 +155,11 @@ QDeclarativeAudioEngine::~QDeclarativeAudioEngine()
 #endif
     qDeleteAll(m_soundInstancePool);
     m_soundInstancePool.clear();
+
+    QMetaObject::invokeMethod(m_updater, "stop", Qt::BlockingQueuedConnection);
+    m_updateThread.quit();
+    m_updateThread.wait();
+    delete m_updater;
 }
 
 void QDeclarativeAudioEngine::classBegin()
@@ -157,6 +176,11 @@ QAudioEngine* QDeclarativeAudioEngine::engine() const
     return m_audioEngine;
 }
 
+QAudioEngineUpdater* QDeclarativeAudioEngine::updater() const
+{
+    return m_updater;
+}
+
 QDeclarativeSoundInstance* QDeclarativeAudioEngine::newDeclarativeSoundInstance(bool managed)
 {
 #ifdef DEBUG_AUDIOENGINE
@@ -171,6 +195,10 @@ QDeclarativeSoundInstance* QDeclarativeAudioEngine::newDeclarativeSoundInstance(
             instance = new QDeclarativeSoundInstance(this);
             qmlEngine(instance)->setObjectOwnership(instance, QQmlEngine::CppOwnership);
             instance->setEngine(this);
+            instance->setManaged(true);
+            //queued, the instance is still busy reporting its state when it stops
+            connect(instance, SIGNAL(stateChanged()), this, SLOT(handleManagedInstanceStateChanged()),
+                    Qt::QueuedConnection);
         }
         m_managedDeclSoundInstances.push_back(instance);
     } else {
@@ -187,6 +215,16 @@ void QDeclarativeAudioEngine::releaseManagedDeclarativeSoundInstance(QDeclarativ
     m_managedDeclSndInstancePool.push_back(declSndInstance);
 }
 
+void QDeclarativeAudioEngine::collectManagedDeclarativeSoundInstance(QDeclarativeSoundInstance* declSndInstance)
+{
+    if (!m_managedDeclSoundInstances.removeOne(declSndInstance))
+        return;
+    releaseManagedDeclarativeSoundInstance(declSndInstance);
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "AudioEngine removed managed sounce instance";
+#endif
+}
+
 /*!
     \qmlproperty int QtAudioEngine::AudioEngine::liveInstances
 
@@ -208,8 +246,6 @@ QSoundInstance* QDeclarativeAudioEngine::newSoundInstance(const QString &name)
     }
     instance->bindSoundDescription(qobject_cast<QDeclarativeSound*>(qvariant_cast<QObject*>(m_sounds.value(name))));
     m_activeSoundInstances.push_back(instance);
-    if (!m_updateTimer.isActive())
-        m_updateTimer.start();
     emit liveInstanceCountChanged();
     return instance;
 }
@@ -222,6 +258,53 @@ void QDeclarativeAudioEngine::releaseSoundInstance(QSoundInstance* instance)
     emit liveInstanceCountChanged();
 }
 
+bool QDeclarativeAudioEngine::acquireVoice(QSoundInstance *instance)
+{
+    if (m_voices.contains(instance))
+        return true;
+
+    if (m_maxVoices > 0 && m_voices.count() >= m_maxVoices) {
+        QSoundInstance *victim = voiceToSteal();
+        if (victim->priority() > instance->priority()) {
+#ifdef DEBUG_AUDIOENGINE
+            qDebug() << "AudioEngine: all voices busy, not playing" << instance;
+#endif
+            return false;
+        }
+#ifdef DEBUG_AUDIOENGINE
+        qDebug() << "AudioEngine: stealing voice of" << victim << "for" << instance;
+#endif
+        victim->stop();
+        releaseVoice(victim);
+    }
+
+    m_voices.append(instance);
+    return true;
+}
+
+void QDeclarativeAudioEngine::releaseVoice(QSoundInstance *instance)
+{
+    m_voices.removeOne(instance);
+}
+
+QSoundInstance *QDeclarativeAudioEngine::voiceToSteal() const
+{
+    //lowest priority first, then the quietest and then the oldest one
+    QSoundInstance *victim = 0;
+    int victimPriority = 0;
+    qreal victimGain = 0;
+    for (QSoundInstance *voice : m_voices) {
+        const int priority = voice->priority();
+        const qreal gain = voice->audibleGain();
+        if (!victim || priority < victimPriority || (priority == victimPriority && gain < victimGain)) {
+            victim = voice;
+            victimPriority = priority;
+            victimGain = gain;
+        }
+    }
+    return victim;
+}
+
 void QDeclarativeAudioEngine::initAudioSample(QDeclarativeAudioSample *sample)
 {
     sample->init();
@@ -490,33 +573,12 @@ void QDeclarativeAudioEngine::componentComplete()
     emit ready();
 }
 
-void QDeclarativeAudioEngine::updateSoundInstances()
+void QDeclarativeAudioEngine::handleManagedInstanceStateChanged()
 {
-    for (QList<QDeclarativeSoundInstance*>::Iterator it = m_managedDeclSoundInstances.begin();
-         it != m_managedDeclSoundInstances.end();) {
-        QDeclarativeSoundInstance *declSndInstance = *it;
-        if (declSndInstance->state() == QDeclarativeSoundInstance::StoppedState) {
-            it = m_managedDeclSoundInstances.erase(it);
-            releaseManagedDeclarativeSoundInstance(declSndInstance);
-#ifdef DEBUG_AUDIOENGINE
-    qDebug() << "AudioEngine removed managed sounce instance";
-#endif
-        } else {
-            declSndInstance->updatePosition(qreal(0.1));
-            ++it;
-        }
-    }
-
-    QVector3D listenerPosition = this->listener()->position();
-    for (QSoundInstance *instance : qAsConst(m_activeSoundInstances)) {
-        if (instance->state() == QSoundInstance::PlayingState
-            &&  instance->attenuationEnabled()) {
-            instance->update3DVolume(listenerPosition);
-        }
-    }
-
-    if (m_activeSoundInstances.count() == 0)
-        m_updateTimer.stop();
+    QDeclarativeSoundInstance *declSndInstance = qobject_cast<QDeclarativeSoundInstance*>(sender());
+    if (!declSndInstance || declSndInstance->state() != QDeclarativeSoundInstance::StoppedState)
+        return;
+    collectManagedDeclarativeSoundInstance(declSndInstance);
 }
 
 void QDeclarativeAudioEngine::appendFunction(QQmlListProperty<QObject> *property, QObject *value)
@@ -635,6 +697,63 @@ void QDeclarativeAudioEngine::setSpeedOfSound(qreal speedOfSound)
     m_audioEngine->setSpeedOfSound(speedOfSound);
 }
 
+/*!
+    \qmlproperty int QtAudioEngine::AudioEngine::updateInterval
+    \since 5.11
+
+    This property holds the interval in milliseconds at which position, velocity and gain
+    changes of sound instances, and the distance attenuation that follows from them, are
+    applied. The updates run on a thread of their own. The default is 100.
+*/
+int QDeclarativeAudioEngine::updateInterval() const
+{
+    return m_updater->interval();
+}
+
+void QDeclarativeAudioEngine::setUpdateInterval(int interval)
+{
+    if (interval <= 0) {
+        qWarning("AudioEngine: updateInterval must be greater than 0");
+        return;
+    }
+    if (interval == m_updater->interval())
+        return;
+    m_updater->setInterval(interval);
+    emit updateIntervalChanged();
+}
+
+/*!
+    \qmlproperty int QtAudioEngine::AudioEngine::maxVoices
+    \since 5.11
+
+    This property holds the maximum number of sound instances playing at the same time.
+    Once it is reached, starting another instance stops the playing one with the lowest
+    \l{Sound::priority}{priority}, among those the quietest one after distance attenuation
+    and then the oldest one. An instance with a lower priority than all playing ones is
+    not started. A value of 0, the default, removes the limit.
+*/
+int QDeclarativeAudioEngine::maxVoices() const
+{
+    return m_maxVoices;
+}
+
+void QDeclarativeAudioEngine::setMaxVoices(int maxVoices)
+{
+    if (maxVoices < 0) {
+        qWarning("AudioEngine: maxVoices must not be negative");
+        return;
+    }
+    if (m_maxVoices == maxVoices)
+        return;
+    m_maxVoices = maxVoices;
+    while (m_maxVoices > 0 && m_voices.count() > m_maxVoices) {
+        QSoundInstance *victim = voiceToSteal();
+        victim->stop();
+        releaseVoice(victim);
+    }
+    emit maxVoicesChanged();
+}
+
 /*!
     \qmlproperty bool QtAudioEngine::AudioEngine::loading
 
@@ -56,7 +56,7 @@
 #include <QtQml/qqmlpropertymap.h>
 #include <QtCore/QMap>
 #include <QtCore/QList>
-#include <QTimer>
+#include <QtCore/QThread>
 #include "qaudioengine_p.h"
 
 QT_BEGIN_NAMESPACE
@@ -70,6 +70,7 @@ class QDeclarativePlayVariation;
 class QAudioCategory;
 class QDeclarativeAttenuationModel;
 class QSoundInstance;
+class QAudioEngineUpdater;
 
 class QDeclarativeAudioEngine : public QObject, public QQmlParserStatus
 {
@@ -84,6 +85,8 @@ class QDeclarativeAudioEngine : public QObject, public QQmlParserStatus
     Q_PROPERTY(QDeclarativeAudioListener* listener READ listener CONSTANT)
     Q_PROPERTY(qreal dopplerFactor READ dopplerFactor WRITE setDopplerFactor)
     Q_PROPERTY(qreal speedOfSound READ speedOfSound WRITE setSpeedOfSound)
+    Q_PROPERTY(int updateInterval READ updateInterval WRITE setUpdateInterval NOTIFY updateIntervalChanged REVISION 1)
+    Q_PROPERTY(int maxVoices READ maxVoices WRITE setMaxVoices NOTIFY maxVoicesChanged REVISION 1)
     Q_CLASSINFO("DefaultProperty", "bank")
 
 public:
@@ -109,6 +112,12 @@ public:
     qreal speedOfSound() const;
     void setSpeedOfSound(qreal speedOfSound);
 
+    int updateInterval() const;
+    void setUpdateInterval(int interval);
+
+    int maxVoices() const;
+    void setMaxVoices(int maxVoices);
+
     bool isLoading() const;
 
     int liveInstanceCount() const;
@@ -116,10 +125,13 @@ public:
     //for child elements
     bool isReady() const;
     QAudioEngine* engine() const;
+    QAudioEngineUpdater* updater() const;
 
     //if managed, then the instance should start playing immediately and will be collected
     //when the playback finished
     QDeclarativeSoundInstance* newDeclarativeSoundInstance(bool managed);
+    //returns a managed instance which is not going to play to the pool
+    void collectManagedDeclarativeSoundInstance(QDeclarativeSoundInstance* declSndInstance);
 
     //internal sound instance is different from declarativeSoundInstance
     //declarative instance is more like a soundInstance helper which can
@@ -128,6 +140,11 @@ public:
     QSoundInstance* newSoundInstance(const QString &name);
     void releaseSoundInstance(QSoundInstance* instance);
 
+    //a sound instance holds a voice while it is playing, acquiring one may stop
+    //another instance. Returns false if all voices are taken by more important instances.
+    bool acquireVoice(QSoundInstance *instance);
+    void releaseVoice(QSoundInstance *instance);
+
     Q_REVISION(1) Q_INVOKABLE void addAudioSample(QDeclarativeAudioSample *);
     Q_REVISION(1) Q_INVOKABLE void addSound(QDeclarativeSound *);
     Q_REVISION(1) Q_INVOKABLE void addAudioCategory(QDeclarativeAudioCategory *);
@@ -138,9 +155,11 @@ Q_SIGNALS:
     void liveInstanceCountChanged();
     void isLoadingChanged();
     void finishedLoading();
+    Q_REVISION(1) void updateIntervalChanged();
+    Q_REVISION(1) void maxVoicesChanged();
 
 private Q_SLOTS:
-    void updateSoundInstances();
+    void handleManagedInstanceStateChanged();
     void handleLoadingChanged();
 
 private:
@@ -166,8 +185,14 @@ private:
     //for execution stage management
     QList<QSoundInstance*> m_soundInstancePool;
     QList<QSoundInstance*> m_activeSoundInstances;
+    //playing instances, oldest first
+    QList<QSoundInstance*> m_voices;
+    int m_maxVoices;
+    QSoundInstance *voiceToSteal() const;
+
+    QThread m_updateThread;
+    QAudioEngineUpdater *m_updater;
 
-    QTimer m_updateTimer;
     QList<QDeclarativeSoundInstance*> m_managedDeclSoundInstances;
     QList<QDeclarativeSoundInstance*> m_managedDeclSndInstancePool;
     void releaseManagedDeclarativeSoundInstance(QDeclarativeSoundInstance* declSndInstance);
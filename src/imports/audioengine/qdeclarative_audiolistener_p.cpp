@@ -39,6 +39,7 @@
 
 #include "qdeclarative_audiolistener_p.h"
 #include "qdeclarative_audioengine_p.h"
+#include "qaudioengineupdater_p.h"
 #include "qdebug.h"
 
 #define DEBUG_AUDIOENGINE
@@ -174,6 +175,7 @@ void QDeclarativeAudioListener::setPosition(const QVector3D &position)
     qDebug() << "QDeclarativeAudioListener::setPosition";
 #endif
     m_engine->engine()->setListenerPosition(position);
+    m_engine->updater()->setListenerPosition(position);
     emit positionChanged();
 }
 
@@ -111,6 +111,18 @@ void QDeclarativeAudioSample::setSource(const QUrl& url)
     m_url = url;
 }
 
+/*!
+    \qmlproperty bool QtAudioEngine::AudioSample::streaming
+    \since 5.11
+
+    This property indicates whether this sample is decoded while it plays
+    instead of being loaded into memory as a whole. Streaming keeps memory
+    use small for long assets such as music or ambience; each playing
+    instance reads the file through a small ring of buffers of its own.
+
+    Only uncompressed wave files available as local files or Qt resources
+    can be streamed. The default is \c false.
+*/
 bool QDeclarativeAudioSample::isStreaming() const
 {
     return m_streaming;
@@ -213,19 +225,18 @@ void QDeclarativeAudioSample::init()
 {
     Q_ASSERT(m_engine != 0);
 
-    if (m_streaming) {
-        //TODO
+    if (m_streaming)
+        m_soundBuffer = m_engine->engine()->getStreamingSoundBuffer(m_url);
+    else
+        m_soundBuffer = m_engine->engine()->getStaticSoundBuffer(m_url);
 
+    if (m_soundBuffer->state() == QSoundBuffer::Ready) {
+        emit loadedChanged();
     } else {
-        m_soundBuffer = m_engine->engine()->getStaticSoundBuffer(m_url);
-        if (m_soundBuffer->state() == QSoundBuffer::Ready) {
-            emit loadedChanged();
-        } else {
-            connect(m_soundBuffer, SIGNAL(ready()), this, SIGNAL(loadedChanged()));
-        }
-        if (m_preloaded) {
-            m_soundBuffer->load();
-        }
+        connect(m_soundBuffer, SIGNAL(ready()), this, SIGNAL(loadedChanged()));
+    }
+    if (m_preloaded) {
+        m_soundBuffer->load();
     }
 }
 
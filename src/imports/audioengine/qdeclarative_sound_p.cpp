@@ -219,6 +219,7 @@ void QDeclarativeSoundCone::setEngine(QDeclarativeAudioEngine *engine)
 QDeclarativeSound::QDeclarativeSound(QObject *parent)
     : QObject(parent)
     , m_playType(Random)
+    , m_priority(0)
     , m_attenuationModelObject(0)
     , m_categoryObject(0)
     , m_engine(0)
@@ -305,6 +306,33 @@ QString QDeclarativeSound::attenuationModel() const
     return m_attenuationModel;
 }
 
+/*!
+    \qmlproperty int QtAudioEngine::Sound::priority
+    \since 5.11
+
+    This property holds the priority of the sound, added to the priority of its
+    \l category. When \l{AudioEngine::maxVoices}{AudioEngine.maxVoices} sounds
+    are already playing, a new one stops the playing instance with the lowest
+    priority, among those the quietest and then the oldest one. It is not played
+    at all if every playing instance has a higher priority than itself.
+
+    The default value is 0.
+*/
+int QDeclarativeSound::priority() const
+{
+    return m_priority;
+}
+
+void QDeclarativeSound::setPriority(int priority)
+{
+    m_priority = priority;
+}
+
+int QDeclarativeSound::effectivePriority() const
+{
+    return m_priority + (m_categoryObject ? m_categoryObject->priority() : 0);
+}
+
 int QDeclarativeSound::genVariationIndex(int oldVariationIndex)
 {
     if (m_playlist.count() == 0)
@@ -579,6 +607,9 @@ void QDeclarativeSound::play(const QVector3D& position, const QVector3D& velocit
     instance->setConeOuterAngle(cone()->outerAngle());
     instance->setConeOuterGain(cone()->outerGain());
     instance->play();
+    //refused by the voice limit, a stop will never be reported to collect it
+    if (instance->state() == QDeclarativeSoundInstance::StoppedState)
+        m_engine->collectManagedDeclarativeSoundInstance(instance);
 #ifdef DEBUG_AUDIOENGINE
     qDebug() << "Sound[" << m_name << "] play ("
              << position << ","
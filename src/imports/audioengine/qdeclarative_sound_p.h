@@ -103,6 +103,7 @@ class QDeclarativeSound : public QObject
     Q_PROPERTY(QDeclarativeSoundCone* cone READ cone CONSTANT)
     Q_PROPERTY(QString attenuationModel READ attenuationModel WRITE setAttenuationModel)
     Q_PROPERTY(QQmlListProperty<QDeclarativePlayVariation> playVariationlist READ playVariationlist CONSTANT)
+    Q_PROPERTY(int priority READ priority WRITE setPriority REVISION 1)
     Q_CLASSINFO("DefaultProperty", "playVariationlist")
 
     Q_ENUMS(PlayType)
@@ -128,6 +129,11 @@ public:
     QString attenuationModel() const;
     void setAttenuationModel(const QString &attenuationModel);
 
+    int priority() const;
+    void setPriority(int priority);
+    //sound priority plus the one of its category, used when voices are stolen
+    int effectivePriority() const;
+
     QDeclarativeAudioEngine *engine() const;
     void setEngine(QDeclarativeAudioEngine *);
 
@@ -170,6 +176,7 @@ private:
     QString m_name;
     QString m_category;
     QString m_attenuationModel;
+    int m_priority;
     QList<QDeclarativePlayVariation*> m_playlist;
     QDeclarativeSoundCone *m_cone;
 
@@ -166,6 +166,7 @@ QDeclarativeSoundInstance::QDeclarativeSoundInstance(QObject *parent)
     , m_coneInnerAngle(360)
     , m_coneOuterAngle(360)
     , m_coneOuterGain(0)
+    , m_managed(false)
     , m_instance(0)
     , m_engine(0)
 {
@@ -259,6 +260,7 @@ void QDeclarativeSoundInstance::setSound(const QString& sound)
     if (!m_sound.isEmpty()) {
         m_instance = m_engine->newSoundInstance(m_sound);
         connect(m_instance, SIGNAL(stateChanged(QSoundInstance::State)), this, SLOT(handleStateChanged()));
+        m_instance->setExtrapolated(m_managed);
         m_instance->setPosition(m_position);
         m_instance->setDirection(m_direction);
         m_instance->setVelocity(m_velocity);
@@ -364,6 +366,13 @@ void QDeclarativeSoundInstance::updatePosition(qreal deltaTime)
     setPosition(m_position + m_velocity * deltaTime);
 }
 
+void QDeclarativeSoundInstance::setManaged(bool managed)
+{
+    m_managed = managed;
+    if (m_instance)
+        m_instance->setExtrapolated(m_managed);
+}
+
 /*!
     \qmlproperty vector3d QtAudioEngine::SoundInstance::position
 
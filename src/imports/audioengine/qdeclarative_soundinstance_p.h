@@ -113,6 +113,9 @@ public:
     void setConeOuterAngle(qreal outerAngle);
     void setConeOuterGain(qreal outerGain);
 
+    //managed instances are played fire and forget and keep moving with their velocity
+    void setManaged(bool managed);
+
 Q_SIGNALS:
     void stateChanged();
     void positionChanged();
@@ -145,6 +148,8 @@ private:
     qreal m_coneOuterAngle;
     qreal m_coneOuterGain;
 
+    bool m_managed;
+
     void dropInstance();
 
     QSoundInstance *m_instance;
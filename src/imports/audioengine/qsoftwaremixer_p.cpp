@@ -0,0 +1,546 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qsoftwaremixer_p.h"
+
+#include <QtCore/qmath.h>
+#include <QtCore/QSysInfo>
+#include <QtMultimedia/QAudioDeviceInfo>
+#include <QtMultimedia/QAudioOutput>
+
+#include <QtCore/private/qsimd_p.h>
+
+#include <climits>
+#include <cmath>
+
+#include "qdebug.h"
+
+#define DEBUG_AUDIOENGINE
+
+QT_USE_NAMESPACE
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+int QT_FASTCALL qt_mix_mono_sse2(const float *src, float *dest, int frames,
+                                 float left, float right, float deltaLeft, float deltaRight);
+int QT_FASTCALL qt_mix_stereo_sse2(const float *src, float *dest, int frames,
+                                   float left, float right, float deltaLeft, float deltaRight);
+int QT_FASTCALL qt_convert_to_int16_sse2(const float *src, qint16 *dest, int samples);
+#endif
+
+namespace
+{
+enum {
+    // Spatial parameters are evaluated and gain ramps restart once per block
+    MixBlockFrames = 256,
+    OutputBufferDurationUs = 40000
+};
+
+const double MaximumStep = 16;
+const float MinimumDistance = 1e-4f;
+
+// Adds a mono block to the interleaved stereo mix, ramping both gains linearly
+void mixMono(const float *src, float *dest, int frames,
+             float left, float right, float deltaLeft, float deltaRight)
+{
+    int i = 0;
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+    if (qCpuHasFeature(SSE2)) {
+        i = qt_mix_mono_sse2(src, dest, frames, left, right, deltaLeft, deltaRight);
+        left += deltaLeft * i;
+        right += deltaRight * i;
+    }
+#endif
+    for (; i < frames; ++i) {
+        dest[2 * i] += src[i] * left;
+        dest[2 * i + 1] += src[i] * right;
+        left += deltaLeft;
+        right += deltaRight;
+    }
+}
+
+void mixStereo(const float *src, float *dest, int frames,
+               float left, float right, float deltaLeft, float deltaRight)
+{
+    int i = 0;
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+    if (qCpuHasFeature(SSE2)) {
+        i = qt_mix_stereo_sse2(src, dest, frames, left, right, deltaLeft, deltaRight);
+        left += deltaLeft * i;
+        right += deltaRight * i;
+    }
+#endif
+    for (; i < frames; ++i) {
+        dest[2 * i] += src[2 * i] * left;
+        dest[2 * i + 1] += src[2 * i + 1] * right;
+        left += deltaLeft;
+        right += deltaRight;
+    }
+}
+
+void convertToInt16(const float *src, qint16 *dest, int samples)
+{
+    int i = 0;
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+    if (qCpuHasFeature(SSE2))
+        i = qt_convert_to_int16_sse2(src, dest, samples);
+#endif
+    for (; i < samples; ++i)
+        dest[i] = qint16(qRound(qBound(-1.0f, src[i], 1.0f) * 32767.0f));
+}
+
+void convertToFloat(const float *src, float *dest, int samples)
+{
+    for (int i = 0; i < samples; ++i)
+        dest[i] = qBound(-1.0f, src[i], 1.0f);
+}
+
+// Linear interpolation from the voice cursor, wrapping around for looping and streaming voices.
+// Returns the number of frames produced, less than requested if a non looping voice ends.
+int resample(QSoftwareVoice *voice, double step, float *dest, int frames)
+{
+    const float *data = voice->data.constData();
+    const int channels = voice->channelCount;
+    const int last = voice->frameCount - 1;
+    double cursor = voice->cursor;
+    int i = 0;
+    for (; i < frames; ++i) {
+        if (cursor >= voice->frameCount) {
+            if (!voice->wraps())
+                break;
+            cursor = std::fmod(cursor, double(voice->frameCount));
+        }
+        const int i0 = int(cursor);
+        const int i1 = i0 < last ? i0 + 1 : (voice->wraps() ? 0 : i0);
+        const float t = float(cursor - i0);
+        for (int c = 0; c < channels; ++c) {
+            const float a = data[i0 * channels + c];
+            const float b = data[i1 * channels + c];
+            *dest++ = a + (b - a) * t;
+        }
+        cursor += step;
+    }
+    voice->cursor = cursor;
+    return i;
+}
+}
+
+QSoftwareVoice::QSoftwareVoice()
+    : channelCount(0)
+    , frameCount(0)
+    , sampleRate(0)
+    , state(QSoundSource::StoppedState)
+    , looping(false)
+    , gain(1)
+    , pitch(1)
+    , coneInnerAngle(360)
+    , coneOuterAngle(360)
+    , coneOuterGain(0)
+    , cursor(0)
+    , leftGain(0)
+    , rightGain(0)
+    , primed(false)
+    , streaming(false)
+    , streamWritten(0)
+    , streamRead(0)
+    , streamEnded(false)
+    , generation(0)
+{
+}
+
+QSoftwareMixer::Listener::Listener()
+    : right(1, 0, 0)
+    , gain(1)
+    , dopplerFactor(1)
+    , speedOfSound(343.33f)
+{
+}
+
+QSoftwareMixer::QSoftwareMixer(QObject *parent)
+    : QIODevice(parent)
+    , m_generation(0)
+    , m_output(0)
+{
+    m_mixBuffer.resize(MixBlockFrames * 2);
+    m_resampleBuffer.resize(MixBlockFrames * 2);
+}
+
+QSoftwareMixer::~QSoftwareMixer()
+{
+    qDeleteAll(m_voices);
+}
+
+QSoftwareVoice *QSoftwareMixer::createVoice()
+{
+    QSoftwareVoice *voice = new QSoftwareVoice;
+    QMutexLocker locker(&m_mutex);
+    resetVoice(voice);
+    m_voices.append(voice);
+    return voice;
+}
+
+void QSoftwareMixer::destroyVoice(QSoftwareVoice *voice)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_voices.removeOne(voice);
+    }
+    delete voice;
+}
+
+void QSoftwareMixer::resetVoice(QSoftwareVoice *voice)
+{
+    //unique across voices, so a new voice allocated where a destroyed one was
+    //doesn't match the copy the audio thread still has of the old one
+    voice->generation = ++m_generation;
+}
+
+void QSoftwareMixer::setListenerPosition(const QVector3D& position)
+{
+    QMutexLocker locker(&m_mutex);
+    m_listener.position = position;
+}
+
+void QSoftwareMixer::setListenerVelocity(const QVector3D& velocity)
+{
+    QMutexLocker locker(&m_mutex);
+    m_listener.velocity = velocity;
+}
+
+void QSoftwareMixer::setListenerOrientation(const QVector3D& direction, const QVector3D& up)
+{
+    QMutexLocker locker(&m_mutex);
+    m_listener.right = QVector3D::crossProduct(direction, up).normalized();
+}
+
+void QSoftwareMixer::setListenerGain(float gain)
+{
+    QMutexLocker locker(&m_mutex);
+    m_listener.gain = gain;
+}
+
+void QSoftwareMixer::setDopplerFactor(float dopplerFactor)
+{
+    QMutexLocker locker(&m_mutex);
+    m_listener.dopplerFactor = dopplerFactor;
+}
+
+void QSoftwareMixer::setSpeedOfSound(float speedOfSound)
+{
+    QMutexLocker locker(&m_mutex);
+    m_listener.speedOfSound = speedOfSound;
+}
+
+bool QSoftwareMixer::isSequential() const
+{
+    return true;
+}
+
+void QSoftwareMixer::startOutput()
+{
+    if (m_output)
+        return;
+
+    const QAudioDeviceInfo device = QAudioDeviceInfo::defaultOutputDevice();
+    if (device.isNull()) {
+        qWarning() << "QSoftwareMixer: no audio output device available";
+        return;
+    }
+
+    const int preferredRate = device.preferredFormat().sampleRate();
+    QAudioFormat format;
+    format.setSampleRate(preferredRate > 0 ? preferredRate : 48000);
+    format.setChannelCount(2);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::Endian(QSysInfo::ByteOrder));
+    format.setCodec(QLatin1String("audio/pcm"));
+    if (!device.isFormatSupported(format))
+        format = device.nearestFormat(format);
+
+    const bool isInt16 = format.sampleSize() == 16 && format.sampleType() == QAudioFormat::SignedInt;
+    const bool isFloat = format.sampleSize() == 32 && format.sampleType() == QAudioFormat::Float;
+    if (format.channelCount() != 2 || (!isInt16 && !isFloat)
+        || format.byteOrder() != QAudioFormat::Endian(QSysInfo::ByteOrder)) {
+        qWarning() << "QSoftwareMixer: unsupported output format" << format;
+        return;
+    }
+
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "QSoftwareMixer: output" << device.deviceName() << format;
+#endif
+    m_format = format;
+    open(QIODevice::ReadOnly);
+    m_output = new QAudioOutput(device, format, this);
+    m_output->setBufferSize(format.bytesForDuration(OutputBufferDurationUs));
+    m_output->start(this);
+}
+
+void QSoftwareMixer::stopOutput()
+{
+    if (!m_output)
+        return;
+    m_output->stop();
+    delete m_output;
+    m_output = 0;
+    close();
+}
+
+qint64 QSoftwareMixer::readData(char *data, qint64 maxlen)
+{
+    const int bytesPerFrame = m_format.bytesPerFrame();
+    if (bytesPerFrame <= 0)
+        return 0;
+
+    const int frames = int(qMin(maxlen / bytesPerFrame, qint64(INT_MAX)));
+    const bool isFloat = m_format.sampleType() == QAudioFormat::Float;
+    float *mix = m_mixBuffer.data();
+    bool finished = false;
+
+    for (int done = 0; done < frames;) {
+        const int n = qMin(frames - done, int(MixBlockFrames));
+        memset(mix, 0, n * 2 * sizeof(float));
+
+        //the mutex is only held to copy the voices and to write back how far
+        //they advanced, so parameter changes never wait for a block to mix
+        {
+            QMutexLocker locker(&m_mutex);
+            m_mixListener = m_listener;
+            for (QSoftwareVoice *voice : qAsConst(m_voices)) {
+                if (voice->state != QSoundSource::PlayingState)
+                    continue;
+                m_mixVoices.append(*voice);
+                m_mixSources.append(voice);
+            }
+        }
+
+        for (int i = 0; i < m_mixVoices.size(); ++i)
+            mixVoice(&m_mixVoices[i], mix, n);
+
+        {
+            QMutexLocker locker(&m_mutex);
+            for (int i = 0; i < m_mixSources.size(); ++i) {
+                QSoftwareVoice *voice = m_mixSources.at(i);
+                const QSoftwareVoice &mixed = m_mixVoices.at(i);
+                //skip voices destroyed or reset while mixing
+                if (!m_voices.contains(voice) || voice->generation != mixed.generation)
+                    continue;
+                voice->cursor = mixed.cursor;
+                voice->leftGain = mixed.leftGain;
+                voice->rightGain = mixed.rightGain;
+                voice->primed = mixed.primed;
+                voice->streamRead = mixed.streamRead;
+                if (mixed.state == QSoundSource::StoppedState && voice->state != QSoundSource::StoppedState) {
+                    voice->state = QSoundSource::StoppedState;
+                    finished = true;
+                }
+            }
+        }
+        //keeps the capacity, only releases the copies' references to the voice data
+        m_mixVoices.resize(0);
+        m_mixSources.resize(0);
+
+        char *out = data + qint64(done) * bytesPerFrame;
+        if (isFloat)
+            convertToFloat(mix, reinterpret_cast<float *>(out), n * 2);
+        else
+            convertToInt16(mix, reinterpret_cast<qint16 *>(out), n * 2);
+        done += n;
+    }
+
+    if (finished)
+        emit voicesFinished();
+
+    return qint64(frames) * bytesPerFrame;
+}
+
+qint64 QSoftwareMixer::writeData(const char *data, qint64 len)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+    return -1;
+}
+
+void QSoftwareMixer::mixVoice(QSoftwareVoice *voice, float *dest, int frames)
+{
+    if (voice->frameCount <= 0) {
+        voice->state = QSoundSource::StoppedState;
+        return;
+    }
+
+    float left;
+    float right;
+    double step;
+    spatialize(voice, &left, &right, &step);
+    if (!voice->primed) {
+        voice->leftGain = left;
+        voice->rightGain = right;
+        voice->primed = true;
+    }
+
+    const double start = voice->cursor;
+    if (voice->streaming) {
+        //only play what the feeder wrote so far, interpolating needs one frame more
+        const double available = voice->streamWritten - voice->streamRead - (voice->streamEnded ? 0 : 1);
+        frames = step > 0 ? qBound(0, int(available / step), frames) : frames;
+        if (frames == 0) {
+            if (voice->streamEnded) {
+                voice->state = QSoundSource::StoppedState;
+                voice->primed = false;
+            }
+            //otherwise an underrun, silent until the feeder caught up
+            return;
+        }
+    }
+
+    float currentLeft = voice->leftGain;
+    float currentRight = voice->rightGain;
+    const float deltaLeft = (left - currentLeft) / frames;
+    const float deltaRight = (right - currentRight) / frames;
+    voice->leftGain = left;
+    voice->rightGain = right;
+
+    if (currentLeft == 0 && currentRight == 0 && left == 0 && right == 0) {
+        //inaudible, only keep the voice in time
+        voice->cursor += step * frames;
+    } else {
+        const float *data = voice->data.constData();
+        const int channels = voice->channelCount;
+        int done = 0;
+        while (done < frames) {
+            int n = frames - done;
+            const float *src;
+            if (step == 1 && voice->cursor == std::floor(voice->cursor)) {
+                const int index = int(voice->cursor);
+                n = qMin(n, voice->frameCount - index);
+                src = data + index * channels;
+                voice->cursor += n;
+            } else {
+                n = resample(voice, step, m_resampleBuffer.data(), n);
+                src = m_resampleBuffer.constData();
+            }
+
+            if (channels == 1)
+                mixMono(src, dest + 2 * done, n, currentLeft, currentRight, deltaLeft, deltaRight);
+            else
+                mixStereo(src, dest + 2 * done, n, currentLeft, currentRight, deltaLeft, deltaRight);
+            currentLeft += deltaLeft * n;
+            currentRight += deltaRight * n;
+            done += n;
+
+            if (voice->cursor >= voice->frameCount) {
+                if (!voice->wraps())
+                    break;
+                voice->cursor = std::fmod(voice->cursor, double(voice->frameCount));
+            }
+        }
+    }
+
+    if (voice->cursor >= voice->frameCount) {
+        if (voice->wraps()) {
+            voice->cursor = std::fmod(voice->cursor, double(voice->frameCount));
+        } else {
+            voice->state = QSoundSource::StoppedState;
+            voice->cursor = 0;
+            voice->primed = false;
+        }
+    }
+
+    if (voice->streaming) {
+        //a block advances far less than the ring size, so it wraps at most once
+        double advanced = voice->cursor - start;
+        if (advanced < 0)
+            advanced += voice->frameCount;
+        voice->streamRead += advanced;
+        if (voice->streamEnded && voice->streamRead >= voice->streamWritten) {
+            voice->state = QSoundSource::StoppedState;
+            voice->primed = false;
+        }
+    }
+}
+
+void QSoftwareMixer::spatialize(const QSoftwareVoice *voice, float *left, float *right, double *step) const
+{
+    const Listener &listener = m_mixListener;
+    float gain = voice->gain * listener.gain;
+    float shift = 1;
+
+    //as with OpenAL, only mono sources are positioned
+    if (voice->channelCount == 1) {
+        float pan = 0;
+        const QVector3D toSource = voice->position - listener.position;
+        const float distance = toSource.length();
+        if (distance > MinimumDistance) {
+            const QVector3D unit = toSource / distance;
+            pan = qBound(-1.0f, QVector3D::dotProduct(unit, listener.right), 1.0f);
+
+            if (voice->coneInnerAngle < 360 && !voice->direction.isNull()) {
+                const float cosine = QVector3D::dotProduct(voice->direction.normalized(), -unit);
+                const float angle = 2 * qRadiansToDegrees(qAcos(qBound(-1.0f, cosine, 1.0f)));
+                if (angle >= voice->coneOuterAngle) {
+                    gain *= voice->coneOuterGain;
+                } else if (angle > voice->coneInnerAngle) {
+                    gain *= 1 + (voice->coneOuterGain - 1) * (angle - voice->coneInnerAngle)
+                                / (voice->coneOuterAngle - voice->coneInnerAngle);
+                }
+            }
+
+            if (listener.dopplerFactor > 0 && listener.speedOfSound > 0) {
+                //OpenAL 1.1 model, velocities projected on the source to listener axis
+                const float limit = listener.speedOfSound / listener.dopplerFactor;
+                const float listenerSpeed = qMin(QVector3D::dotProduct(listener.velocity, -unit), limit);
+                const float sourceSpeed = qMin(QVector3D::dotProduct(voice->velocity, -unit), limit);
+                const float denominator = listener.speedOfSound - listener.dopplerFactor * sourceSpeed;
+                shift = denominator > 0
+                        ? (listener.speedOfSound - listener.dopplerFactor * listenerSpeed) / denominator
+                        : float(MaximumStep);
+            }
+        }
+
+        //equal power panning
+        const float angle = (pan + 1) * float(M_PI / 4);
+        *left = gain * qCos(angle);
+        *right = gain * qSin(angle);
+    } else {
+        *left = gain;
+        *right = gain;
+    }
+
+    *step = qBound(0.0, double(voice->pitch) * shift * voice->sampleRate / m_format.sampleRate(),
+                   MaximumStep);
+}
@@ -0,0 +1,178 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSOFTWAREMIXER_P_H
+#define QSOFTWAREMIXER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/QIODevice>
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+#include <QtGui/qvector3d.h>
+#include <QtMultimedia/qaudioformat.h>
+
+#include "qsoundsource_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class QAudioOutput;
+
+//One playing sound inside QSoftwareMixer.
+//All members are guarded by QSoftwareMixer::mutex(). The audio thread mixes
+//a copy taken under the mutex and writes back how far it advanced.
+struct QSoftwareVoice
+{
+    QSoftwareVoice();
+
+    //set from the GUI thread
+    QVector<float> data; //interleaved, one or two channels
+    int channelCount;
+    int frameCount;
+    int sampleRate;
+
+    QSoundSource::State state;
+    bool looping;
+    QVector3D position;
+    QVector3D velocity;
+    QVector3D direction;
+    float gain;
+    float pitch;
+    float coneInnerAngle;
+    float coneOuterAngle;
+    float coneOuterGain;
+
+    //advanced by the audio thread
+    double cursor;
+    float leftGain;
+    float rightGain;
+    bool primed;
+
+    //a streaming voice plays data as a ring of frameCount frames, written ahead
+    //of the cursor by its feeder. Both counters are in frames since the start.
+    bool streaming;
+    qint64 streamWritten;
+    double streamRead;
+    bool streamEnded;
+
+    //see QSoftwareMixer::resetVoice()
+    quint32 generation;
+
+    bool wraps() const { return looping || streaming; }
+};
+
+class QSoftwareMixer : public QIODevice
+{
+    Q_OBJECT
+public:
+    QSoftwareMixer(QObject *parent = 0);
+    ~QSoftwareMixer();
+
+    QMutex *mutex() { return &m_mutex; }
+
+    QSoftwareVoice *createVoice();
+    void destroyVoice(QSoftwareVoice *voice);
+    //call with mutex() held after changing the data, cursor or stream
+    //position of a voice, so the audio thread drops a block it is mixing
+    void resetVoice(QSoftwareVoice *voice);
+
+    void setListenerPosition(const QVector3D& position);
+    void setListenerVelocity(const QVector3D& velocity);
+    void setListenerOrientation(const QVector3D& direction, const QVector3D& up);
+    void setListenerGain(float gain);
+    void setDopplerFactor(float dopplerFactor);
+    void setSpeedOfSound(float speedOfSound);
+
+    bool isSequential() const override;
+
+public Q_SLOTS:
+    void startOutput();
+    void stopOutput();
+
+Q_SIGNALS:
+    //emitted from the audio thread when non looping voices reached their end
+    void voicesFinished();
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    struct Listener
+    {
+        Listener();
+
+        QVector3D position;
+        QVector3D velocity;
+        QVector3D right;
+        float gain;
+        float dopplerFactor;
+        float speedOfSound;
+    };
+
+    void mixVoice(QSoftwareVoice *voice, float *dest, int frames);
+    void spatialize(const QSoftwareVoice *voice, float *left, float *right, double *step) const;
+
+    QMutex m_mutex;
+    QVector<QSoftwareVoice*> m_voices;
+    Listener m_listener;
+    quint32 m_generation;
+
+    //only touched on the audio thread
+    QAudioOutput *m_output;
+    QAudioFormat m_format;
+    QVector<float> m_mixBuffer;
+    QVector<float> m_resampleBuffer;
+    Listener m_mixListener;
+    QVector<QSoftwareVoice> m_mixVoices;
+    QVector<QSoftwareVoice*> m_mixSources;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSOFTWAREMIXER_P_H
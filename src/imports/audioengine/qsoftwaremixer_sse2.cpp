@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtCore/private/qsimd_p.h>
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+
+QT_USE_NAMESPACE
+
+// Adds a mono block to the interleaved stereo mix, ramping both gains linearly.
+// Returns the number of frames mixed, a multiple of four.
+int QT_FASTCALL qt_mix_mono_sse2(const float *src, float *dest, int frames,
+                                 float left, float right, float deltaLeft, float deltaRight)
+{
+    __m128 gain = _mm_setr_ps(left, right, left + deltaLeft, right + deltaRight);
+    const __m128 gainStep = _mm_setr_ps(2 * deltaLeft, 2 * deltaRight, 2 * deltaLeft, 2 * deltaRight);
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 s = _mm_loadu_ps(src + i);
+        __m128 d0 = _mm_loadu_ps(dest + 2 * i);
+        __m128 d1 = _mm_loadu_ps(dest + 2 * i + 4);
+        d0 = _mm_add_ps(d0, _mm_mul_ps(_mm_unpacklo_ps(s, s), gain));
+        gain = _mm_add_ps(gain, gainStep);
+        d1 = _mm_add_ps(d1, _mm_mul_ps(_mm_unpackhi_ps(s, s), gain));
+        gain = _mm_add_ps(gain, gainStep);
+        _mm_storeu_ps(dest + 2 * i, d0);
+        _mm_storeu_ps(dest + 2 * i + 4, d1);
+    }
+    return i;
+}
+
+int QT_FASTCALL qt_mix_stereo_sse2(const float *src, float *dest, int frames,
+                                   float left, float right, float deltaLeft, float deltaRight)
+{
+    __m128 gain = _mm_setr_ps(left, right, left + deltaLeft, right + deltaRight);
+    const __m128 gainStep = _mm_setr_ps(2 * deltaLeft, 2 * deltaRight, 2 * deltaLeft, 2 * deltaRight);
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        __m128 d0 = _mm_loadu_ps(dest + 2 * i);
+        __m128 d1 = _mm_loadu_ps(dest + 2 * i + 4);
+        d0 = _mm_add_ps(d0, _mm_mul_ps(_mm_loadu_ps(src + 2 * i), gain));
+        gain = _mm_add_ps(gain, gainStep);
+        d1 = _mm_add_ps(d1, _mm_mul_ps(_mm_loadu_ps(src + 2 * i + 4), gain));
+        gain = _mm_add_ps(gain, gainStep);
+        _mm_storeu_ps(dest + 2 * i, d0);
+        _mm_storeu_ps(dest + 2 * i + 4, d1);
+    }
+    return i;
+}
+
+// Returns the number of samples converted, a multiple of eight.
+int QT_FASTCALL qt_convert_to_int16_sse2(const float *src, qint16 *dest, int samples)
+{
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        const __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), minusOne), one);
+        const __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), minusOne), one);
+        const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)),
+                                               _mm_cvtps_epi32(_mm_mul_ps(b, scale)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), packed);
+    }
+    return i;
+}
+
+#endif
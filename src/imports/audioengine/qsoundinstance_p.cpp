@@ -47,6 +47,7 @@
 #include "qdeclarative_playvariation_p.h"
 #include "qdeclarative_audioengine_p.h"
 #include "qdeclarative_audiolistener_p.h"
+#include "qaudioengineupdater_p.h"
 
 #include "qdebug.h"
 
@@ -62,7 +63,6 @@ QSoundInstance::QSoundInstance(QObject *parent)
     , m_variationIndex(-1)
     , m_isReady(false)
     , m_gain(1)
-    , m_attenuationGain(1)
     , m_varGain(1)
     , m_pitch(1)
     , m_varPitch(1)
@@ -90,7 +90,6 @@ void QSoundInstance::bindSoundDescription(QDeclarativeSound *sound)
         disconnect(m_sound->categoryObject(), SIGNAL(stopped()), this, SLOT(stop()));
         disconnect(m_sound->categoryObject(), SIGNAL(resumed()), this, SLOT(resume()));
     }
-    m_attenuationGain = 1;
     m_gain = 1;
 
     m_sound = sound;
@@ -101,9 +100,11 @@ void QSoundInstance::bindSoundDescription(QDeclarativeSound *sound)
             connect(m_soundSource, SIGNAL(stateChanged(QSoundSource::State)),
                     this, SLOT(handleSourceStateChanged(QSoundSource::State)));
         }
+        m_engine->updater()->addSource(m_soundSource, sound->attenuationModelObject());
     } else {
         if (m_soundSource) {
             detach();
+            m_engine->updater()->removeSource(m_soundSource);
             m_engine->engine()->releaseSoundSource(m_soundSource);
             m_soundSource = 0;
         }
@@ -129,6 +130,7 @@ QSoundInstance::~QSoundInstance()
 #endif
     if (m_soundSource) {
         detach();
+        m_engine->updater()->removeSource(m_soundSource);
         m_engine->engine()->releaseSoundSource(m_soundSource);
     }
 }
@@ -198,6 +200,8 @@ void QSoundInstance::setState(State state)
 {
     if (state == m_state)
         return;
+    if (m_state == QSoundInstance::PlayingState)
+        m_engine->releaseVoice(this);
     m_state = state;
     emit stateChanged(m_state);
 }
@@ -238,6 +242,8 @@ void QSoundInstance::play()
 #endif
     if (!m_soundSource || m_state == QSoundInstance::PlayingState)
         return;
+    if (!m_engine->acquireVoice(this))
+        return;
     if (!m_isReady) {
         setState(QSoundInstance::PlayingState);
         return;
@@ -248,8 +254,9 @@ void QSoundInstance::play()
 
 void QSoundInstance::sourcePlay()
 {
-    update3DVolume(m_engine->listener()->position());
     Q_ASSERT(m_soundSource);
+    //start with the current position and attenuation rather than waiting for the next update
+    m_engine->updater()->commit(m_soundSource);
     m_soundSource->play();
 }
 
@@ -296,11 +303,23 @@ QSoundInstance::State QSoundInstance::state() const
     return m_state;
 }
 
+int QSoundInstance::priority() const
+{
+    return m_sound ? m_sound->effectivePriority() : 0;
+}
+
+qreal QSoundInstance::audibleGain() const
+{
+    if (!m_soundSource)
+        return 0;
+    return m_engine->updater()->audibleGain(m_soundSource);
+}
+
 void QSoundInstance::setPosition(const QVector3D& position)
 {
     if (!m_soundSource)
         return;
-    m_soundSource->setPosition(position);
+    m_engine->updater()->setPosition(m_soundSource, position);
 }
 
 void QSoundInstance::setDirection(const QVector3D& direction)
@@ -314,7 +333,14 @@ void QSoundInstance::setVelocity(const QVector3D& velocity)
 {
     if (!m_soundSource)
         return;
-    m_soundSource->setVelocity(velocity);
+    m_engine->updater()->setVelocity(m_soundSource, velocity);
+}
+
+void QSoundInstance::setExtrapolated(bool extrapolated)
+{
+    if (!m_soundSource)
+        return;
+    m_engine->updater()->setExtrapolated(m_soundSource, extrapolated);
 }
 
 void QSoundInstance::setGain(qreal gain)
@@ -340,24 +366,6 @@ void QSoundInstance::setCone(qreal innerAngle, qreal outerAngle, qreal outerGain
     m_soundSource->setCone(innerAngle, outerAngle, outerGain);
 }
 
-bool QSoundInstance::attenuationEnabled() const
-{
-    if (!m_sound || !m_sound->attenuationModelObject())
-        return false;
-    return true;
-}
-
-void QSoundInstance::update3DVolume(const QVector3D& listenerPosition)
-{
-    if (!m_sound || !m_soundSource)
-        return;
-    QDeclarativeAttenuationModel *attenModel = m_sound->attenuationModelObject();
-    if (!attenModel)
-        return;
-    m_attenuationGain = attenModel->calculateGain(listenerPosition, m_soundSource->position());
-    updateGain();
-}
-
 void QSoundInstance::updateVariationParameters(qreal varPitch, qreal varGain, bool looping)
 {
     if (!m_soundSource)
@@ -379,7 +387,8 @@ void QSoundInstance::updatePitch()
 
 void QSoundInstance::updateGain()
 {
-    m_soundSource->setGain(m_gain * m_varGain * m_attenuationGain * categoryVolume());
+    //distance attenuation is applied on top by the updater
+    m_engine->updater()->setGain(m_soundSource, m_gain * m_varGain * categoryVolume());
 }
 
 QT_END_NAMESPACE
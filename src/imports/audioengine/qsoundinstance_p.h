@@ -80,6 +80,8 @@ public:
     void setPosition(const QVector3D& position);
     void setDirection(const QVector3D& direction);
     void setVelocity(const QVector3D& velocity);
+    //keeps moving the position with the velocity between updates
+    void setExtrapolated(bool extrapolated);
 
     //this gain and pitch is used for dynamic user control during execution
     void setGain(qreal gain);
@@ -91,9 +93,9 @@ public:
 
     void bindSoundDescription(QDeclarativeSound *sound);
 
-    void update3DVolume(const QVector3D& listenerPosition);
-
-    bool attenuationEnabled() const;
+    //used to pick the voice to stop when the engine runs out of them
+    int priority() const;
+    qreal audibleGain() const;
 
 Q_SIGNALS:
     void stateChanged(QSoundInstance::State state);
@@ -129,7 +131,6 @@ private:
 
     bool                 m_isReady; //true if the sound source is already bound to some sound buffer
     qreal                m_gain;
-    qreal                m_attenuationGain;
     qreal                m_varGain;
     qreal                m_pitch;
     qreal                m_varPitch;
@@ -38,6 +38,7 @@
 ****************************************************************************/
 
 #include "qaudioengine_openal_p.h"
+#include <QtCore/qmath.h>
 #include "qdebug.h"
 
 #define DEBUG_AUDIOENGINE
@@ -55,12 +56,13 @@ QSoundSourcePrivate::QSoundSourcePrivate(QObject *parent)
     , m_coneInnerAngle(0)
     , m_coneOuterAngle(0)
     , m_coneOuterGain(1)
+    , m_looping(false)
 {
 #ifdef DEBUG_AUDIOENGINE
     qDebug() << "creating new QSoundSourcePrivate";
 #endif
     alGenSources(1, &m_alSource);
-    QAudioEnginePrivate::checkNoError("create source");
+    QAudioEnginePrivateAL::checkNoError("create source");
     setGain(1);
     setPitch(1);
     setCone(360, 360, 0);
@@ -83,7 +85,7 @@ void QSoundSourcePrivate::release()
         stop();
         unbindBuffer();
         alDeleteSources(1, &m_alSource);
-        QAudioEnginePrivate::checkNoError("delete source");
+        QAudioEnginePrivateAL::checkNoError("delete source");
         m_alSource = 0;
     }
 }
@@ -94,6 +96,7 @@ void QSoundSourcePrivate::bindBuffer(QSoundBuffer* soundBuffer)
     Q_ASSERT(soundBuffer->state() == QSoundBuffer::Ready);
     m_bindBuffer = qobject_cast<QSoundBufferPrivateAL*>(soundBuffer);
     m_bindBuffer->bindToSource(m_alSource);
+    m_bindBuffer->setLooping(m_alSource, m_looping);
     m_isReady = true;
 }
 
@@ -114,20 +117,19 @@ void QSoundSourcePrivate::play()
 {
     if (!m_alSource || !m_isReady)
         return;
-    alSourcePlay(m_alSource);
+    ALint state = 0;
+    alGetSourcei(m_alSource, AL_SOURCE_STATE, &state);
+    if (m_bindBuffer->prepareToPlay(m_alSource, state == AL_PAUSED))
+        alSourcePlay(m_alSource);
 #ifdef DEBUG_AUDIOENGINE
-    QAudioEnginePrivate::checkNoError("play");
+    QAudioEnginePrivateAL::checkNoError("play");
 #endif
     emit activate(this);
 }
 
 bool QSoundSourcePrivate::isLooping() const
 {
-    if (!m_alSource)
-        return false;
-    ALint looping = 0;
-    alGetSourcei(m_alSource, AL_LOOPING, &looping);
-    return looping == AL_TRUE ? true : false;
+    return m_alSource && m_looping;
 }
 
 void QSoundSourcePrivate::pause()
@@ -136,7 +138,7 @@ void QSoundSourcePrivate::pause()
         return;
     alSourcePause(m_alSource);
 #ifdef DEBUG_AUDIOENGINE
-    QAudioEnginePrivate::checkNoError("pause");
+    QAudioEnginePrivateAL::checkNoError("pause");
 #endif
 }
 
@@ -144,9 +146,11 @@ void QSoundSourcePrivate::stop()
 {
     if (!m_alSource)
         return;
+    if (m_bindBuffer)
+        m_bindBuffer->sourceStopped(m_alSource);
     alSourceStop(m_alSource);
 #ifdef DEBUG_AUDIOENGINE
-    QAudioEnginePrivate::checkNoError("stop");
+    QAudioEnginePrivateAL::checkNoError("stop");
 #endif
 }
 
@@ -169,6 +173,11 @@ void QSoundSourcePrivate::checkState()
         case AL_PAUSED:
             st = QSoundSource::PausedState;
             break;
+        default:
+            //a streaming source is stopped while its queue is filled or refilled
+            if (m_bindBuffer->isActive(m_alSource))
+                st = QSoundSource::PlayingState;
+            break;
         }
     }
     if (st == m_state)
@@ -177,11 +186,27 @@ void QSoundSourcePrivate::checkState()
     emit stateChanged(m_state);
 }
 
+int QSoundSourcePrivate::remainingTime() const
+{
+    if (!m_alSource || !m_isReady)
+        return -1;
+
+    const qreal remaining = m_bindBuffer->remainingDuration(m_alSource);
+    if (remaining < 0)
+        return -1;
+    const qreal pitch = m_pitch > 0 ? m_pitch : 1;
+    return qCeil(remaining / pitch * 1000);
+}
+
 void QSoundSourcePrivate::setLooping(bool looping)
 {
     if (!m_alSource)
         return;
-    alSourcei(m_alSource, AL_LOOPING, looping ? AL_TRUE : AL_FALSE);
+    m_looping = looping;
+    if (m_bindBuffer)
+        m_bindBuffer->setLooping(m_alSource, looping);
+    else
+        alSourcei(m_alSource, AL_LOOPING, looping ? AL_TRUE : AL_FALSE);
 }
 
 void QSoundSourcePrivate::setPosition(const QVector3D& position)
@@ -190,7 +215,7 @@ void QSoundSourcePrivate::setPosition(const QVector3D& position)
         return;
     alSource3f(m_alSource, AL_POSITION, position.x(), position.y(), position.z());
 #ifdef DEBUG_AUDIOENGINE
-    QAudioEnginePrivate::checkNoError("source set position");
+    QAudioEnginePrivateAL::checkNoError("source set position");
 #endif
 }
 
@@ -200,7 +225,7 @@ void QSoundSourcePrivate::setDirection(const QVector3D& direction)
         return;
     alSource3f(m_alSource, AL_DIRECTION, direction.x(), direction.y(), direction.z());
 #ifdef DEBUG_AUDIOENGINE
-    QAudioEnginePrivate::checkNoError("source set direction");
+    QAudioEnginePrivateAL::checkNoError("source set direction");
 #endif
 }
 
@@ -210,7 +235,7 @@ void QSoundSourcePrivate::setVelocity(const QVector3D& velocity)
         return;
     alSource3f(m_alSource, AL_VELOCITY, velocity.x(), velocity.y(), velocity.z());
 #ifdef DEBUG_AUDIOENGINE
-    QAudioEnginePrivate::checkNoError("source set velocity");
+    QAudioEnginePrivateAL::checkNoError("source set velocity");
 #endif
 }
 
@@ -247,7 +272,7 @@ void QSoundSourcePrivate::setGain(qreal gain)
         return;
     alSourcef(m_alSource, AL_GAIN, gain);
 #ifdef DEBUG_AUDIOENGINE
-    QAudioEnginePrivate::checkNoError("source set gain");
+    QAudioEnginePrivateAL::checkNoError("source set gain");
 #endif
     m_gain = gain;
 }
@@ -258,7 +283,7 @@ void QSoundSourcePrivate::setPitch(qreal pitch)
         return;
     alSourcef(m_alSource, AL_PITCH, pitch);
 #ifdef DEBUG_AUDIOENGINE
-    QAudioEnginePrivate::checkNoError("source set pitch");
+    QAudioEnginePrivateAL::checkNoError("source set pitch");
 #endif
     m_pitch = pitch;
 }
@@ -274,14 +299,14 @@ void QSoundSourcePrivate::setCone(qreal innerAngle, qreal outerAngle, qreal oute
         if (m_coneOuterAngle != outerAngle) {
             alSourcef(m_alSource, AL_CONE_OUTER_ANGLE, outerAngle);
 #ifdef DEBUG_AUDIOENGINE
-            QAudioEnginePrivate::checkNoError("source set cone outerAngle");
+            QAudioEnginePrivateAL::checkNoError("source set cone outerAngle");
 #endif
             m_coneOuterAngle = outerAngle;
         }
         if (m_coneInnerAngle != innerAngle) {
             alSourcef(m_alSource, AL_CONE_INNER_ANGLE, innerAngle);
 #ifdef DEBUG_AUDIOENGINE
-            QAudioEnginePrivate::checkNoError("source set cone innerAngle");
+            QAudioEnginePrivateAL::checkNoError("source set cone innerAngle");
 #endif
             m_coneInnerAngle = innerAngle;
         }
@@ -289,14 +314,14 @@ void QSoundSourcePrivate::setCone(qreal innerAngle, qreal outerAngle, qreal oute
         if (m_coneInnerAngle != innerAngle) {
             alSourcef(m_alSource, AL_CONE_INNER_ANGLE, innerAngle);
 #ifdef DEBUG_AUDIOENGINE
-            QAudioEnginePrivate::checkNoError("source set cone innerAngle");
+            QAudioEnginePrivateAL::checkNoError("source set cone innerAngle");
 #endif
             m_coneInnerAngle = innerAngle;
         }
         if (m_coneOuterAngle != outerAngle) {
             alSourcef(m_alSource, AL_CONE_OUTER_ANGLE, outerAngle);
 #ifdef DEBUG_AUDIOENGINE
-            QAudioEnginePrivate::checkNoError("source set cone outerAngle");
+            QAudioEnginePrivateAL::checkNoError("source set cone outerAngle");
 #endif
             m_coneOuterAngle = outerAngle;
         }
@@ -305,7 +330,7 @@ void QSoundSourcePrivate::setCone(qreal innerAngle, qreal outerAngle, qreal oute
     if (outerGain != m_coneOuterGain) {
         alSourcef(m_alSource, AL_CONE_OUTER_GAIN, outerGain);
 #ifdef DEBUG_AUDIOENGINE
-        QAudioEnginePrivate::checkNoError("source set cone outerGain");
+        QAudioEnginePrivateAL::checkNoError("source set cone outerGain");
 #endif
         m_coneOuterGain = outerGain;
     }
@@ -0,0 +1,304 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qaudioengine_software_p.h"
+#include "qsoftwaremixer_p.h"
+
+#include <QtCore/QMutexLocker>
+
+#include "qdebug.h"
+
+#define DEBUG_AUDIOENGINE
+
+QT_USE_NAMESPACE
+
+QSoundSourceSoftware::QSoundSourceSoftware(QSoftwareMixer *mixer, QSoundStreamService *streamService, QObject *parent)
+    : QSoundSource(parent)
+    , m_mixer(mixer)
+    , m_voice(0)
+    , m_streamService(streamService)
+    , m_stream(0)
+    , m_bindBuffer(0)
+    , m_isReady(false)
+    , m_state(QSoundSource::StoppedState)
+    , m_looping(false)
+    , m_gain(1)
+    , m_pitch(1)
+{
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "creating new QSoundSourceSoftware";
+#endif
+    m_voice = m_mixer->createVoice();
+}
+
+QSoundSourceSoftware::~QSoundSourceSoftware()
+{
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "QSoundSourceSoftware::dtor";
+#endif
+    release();
+}
+
+void QSoundSourceSoftware::release()
+{
+    if (m_voice) {
+#ifdef DEBUG_AUDIOENGINE
+    qDebug() << "QSoundSourceSoftware::release";
+#endif
+        stop();
+        unbindBuffer();
+        m_mixer->destroyVoice(m_voice);
+        m_voice = 0;
+    }
+}
+
+void QSoundSourceSoftware::bindBuffer(QSoundBuffer* soundBuffer)
+{
+    unbindBuffer();
+    Q_ASSERT(soundBuffer->state() == QSoundBuffer::Ready);
+    if (!m_voice)
+        return;
+
+    if (StreamingSoundBufferSoftware *streamingBuffer = qobject_cast<StreamingSoundBufferSoftware*>(soundBuffer)) {
+        QSoftwareStream *stream = new QSoftwareStream(m_mixer, m_voice);
+        if (!stream->open(streamingBuffer->url())) {
+            qWarning() << "source [" << streamingBuffer->url() << "] can not be streamed:" << stream->errorString();
+            delete stream;
+            return;
+        }
+        m_stream = stream;
+        m_streamService->addClient(m_stream);
+        m_bindBuffer = streamingBuffer;
+        m_isReady = true;
+        return;
+    }
+
+    StaticSoundBufferSoftware *staticBuffer = qobject_cast<StaticSoundBufferSoftware*>(soundBuffer);
+    if (!staticBuffer)
+        return;
+
+    QMutexLocker locker(m_mixer->mutex());
+    m_voice->data = staticBuffer->data();
+    m_voice->channelCount = staticBuffer->channelCount();
+    m_voice->frameCount = m_voice->data.size() / m_voice->channelCount;
+    m_voice->sampleRate = staticBuffer->sampleRate();
+    m_voice->cursor = 0;
+    m_mixer->resetVoice(m_voice);
+    m_bindBuffer = staticBuffer;
+    m_isReady = true;
+}
+
+void QSoundSourceSoftware::unbindBuffer()
+{
+    if (m_stream) {
+        //after this the streaming thread does not touch the voice anymore
+        m_streamService->removeClient(m_stream);
+        delete m_stream;
+        m_stream = 0;
+    }
+    if (m_bindBuffer) {
+        if (m_voice) {
+            QMutexLocker locker(m_mixer->mutex());
+            m_voice->state = QSoundSource::StoppedState;
+            m_voice->data = QVector<float>();
+            m_voice->frameCount = 0;
+            m_voice->streaming = false;
+            m_mixer->resetVoice(m_voice);
+        }
+        m_bindBuffer = 0;
+    }
+    m_isReady = false;
+    if (m_state != QSoundSource::StoppedState) {
+        m_state = QSoundSource::StoppedState;
+        emit stateChanged(m_state);
+    }
+}
+
+void QSoundSourceSoftware::play()
+{
+    if (!m_voice || !m_isReady)
+        return;
+    if (m_stream) {
+        bool paused;
+        {
+            QMutexLocker locker(m_mixer->mutex());
+            paused = m_voice->state == QSoundSource::PausedState;
+        }
+        if (!paused) {
+            m_stream->restart();
+            m_streamService->requestService();
+        }
+    }
+    {
+        QMutexLocker locker(m_mixer->mutex());
+        //like alSourcePlay, playing a playing or stopped source starts it over
+        if (m_voice->state != QSoundSource::PausedState) {
+            m_voice->cursor = 0;
+            m_mixer->resetVoice(m_voice);
+        }
+        m_voice->state = QSoundSource::PlayingState;
+        m_voice->primed = false;
+    }
+    emit activate(this);
+}
+
+bool QSoundSourceSoftware::isLooping() const
+{
+    return m_looping;
+}
+
+void QSoundSourceSoftware::pause()
+{
+    if (!m_voice || !m_isReady)
+        return;
+    QMutexLocker locker(m_mixer->mutex());
+    if (m_voice->state == QSoundSource::PlayingState)
+        m_voice->state = QSoundSource::PausedState;
+}
+
+void QSoundSourceSoftware::stop()
+{
+    if (!m_voice)
+        return;
+    QMutexLocker locker(m_mixer->mutex());
+    m_voice->state = QSoundSource::StoppedState;
+    m_voice->cursor = 0;
+    m_mixer->resetVoice(m_voice);
+}
+
+QSoundSource::State QSoundSourceSoftware::state() const
+{
+    return m_state;
+}
+
+void QSoundSourceSoftware::checkState()
+{
+    QSoundSource::State st = QSoundSource::StoppedState;
+    if (m_voice && m_isReady) {
+        QMutexLocker locker(m_mixer->mutex());
+        st = m_voice->state;
+    }
+    if (st == m_state)
+        return;
+    m_state = st;
+    emit stateChanged(m_state);
+}
+
+void QSoundSourceSoftware::setLooping(bool looping)
+{
+    if (!m_voice)
+        return;
+    m_looping = looping;
+    QMutexLocker locker(m_mixer->mutex());
+    m_voice->looping = looping;
+}
+
+void QSoundSourceSoftware::setPosition(const QVector3D& position)
+{
+    if (!m_voice)
+        return;
+    m_position = position;
+    QMutexLocker locker(m_mixer->mutex());
+    m_voice->position = position;
+}
+
+void QSoundSourceSoftware::setDirection(const QVector3D& direction)
+{
+    if (!m_voice)
+        return;
+    m_direction = direction;
+    QMutexLocker locker(m_mixer->mutex());
+    m_voice->direction = direction;
+}
+
+void QSoundSourceSoftware::setVelocity(const QVector3D& velocity)
+{
+    if (!m_voice)
+        return;
+    m_velocity = velocity;
+    QMutexLocker locker(m_mixer->mutex());
+    m_voice->velocity = velocity;
+}
+
+QVector3D QSoundSourceSoftware::velocity() const
+{
+    return m_velocity;
+}
+
+QVector3D QSoundSourceSoftware::position() const
+{
+    return m_position;
+}
+
+QVector3D QSoundSourceSoftware::direction() const
+{
+    return m_direction;
+}
+
+void QSoundSourceSoftware::setGain(qreal gain)
+{
+    if (!m_voice || gain == m_gain)
+        return;
+    m_gain = gain;
+    QMutexLocker locker(m_mixer->mutex());
+    m_voice->gain = gain;
+}
+
+void QSoundSourceSoftware::setPitch(qreal pitch)
+{
+    if (!m_voice || m_pitch == pitch)
+        return;
+    m_pitch = pitch;
+    QMutexLocker locker(m_mixer->mutex());
+    m_voice->pitch = pitch;
+}
+
+void QSoundSourceSoftware::setCone(qreal innerAngle, qreal outerAngle, qreal outerGain)
+{
+    if (!m_voice)
+        return;
+    if (innerAngle > outerAngle)
+        outerAngle = innerAngle;
+    Q_ASSERT(outerAngle <= 360 && innerAngle >= 0);
+
+    QMutexLocker locker(m_mixer->mutex());
+    m_voice->coneInnerAngle = innerAngle;
+    m_voice->coneOuterAngle = outerAngle;
+    m_voice->coneOuterGain = outerGain;
+}
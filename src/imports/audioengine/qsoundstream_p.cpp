@@ -0,0 +1,280 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qsoundstream_p.h"
+
+#include <QtCore/QTimer>
+#include <QtCore/qendian.h>
+#include <QtQml/qqmlfile.h>
+
+#include "qdebug.h"
+
+#define DEBUG_AUDIOENGINE
+
+QT_USE_NAMESPACE
+
+static const int serviceInterval = 50;
+
+static inline quint16 read16(const char *p, bool bigEndian)
+{
+    return bigEndian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p);
+}
+
+static inline quint32 read32(const char *p, bool bigEndian)
+{
+    return bigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+}
+
+QSoundStream::QSoundStream()
+    : m_dataStart(0)
+    , m_dataSize(0)
+    , m_position(0)
+{
+}
+
+bool QSoundStream::open(const QUrl &url)
+{
+    close();
+
+    const QString fileName = QQmlFile::urlToLocalFileOrQrc(url);
+    if (fileName.isEmpty()) {
+        m_errorString = QStringLiteral("streaming is only supported for local files");
+        return false;
+    }
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+    if (!readHeader()) {
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+void QSoundStream::close()
+{
+    m_file.close();
+    m_format = QAudioFormat();
+    m_dataStart = m_dataSize = m_position = 0;
+    m_errorString.clear();
+}
+
+QString QSoundStream::errorString() const
+{
+    return m_errorString;
+}
+
+QAudioFormat QSoundStream::format() const
+{
+    return m_format;
+}
+
+qint64 QSoundStream::dataSize() const
+{
+    return m_dataSize;
+}
+
+qint64 QSoundStream::bytesRemaining() const
+{
+    return m_dataSize - m_position;
+}
+
+qint64 QSoundStream::read(char *data, qint64 maxlen)
+{
+    const qint64 bytes = m_file.read(data, qMin(maxlen, m_dataSize - m_position));
+    if (bytes > 0)
+        m_position += bytes;
+    return bytes;
+}
+
+bool QSoundStream::atEnd() const
+{
+    return m_position >= m_dataSize;
+}
+
+bool QSoundStream::rewind()
+{
+    if (!m_file.seek(m_dataStart))
+        return false;
+    m_position = 0;
+    return true;
+}
+
+bool QSoundStream::readHeader()
+{
+    char riff[12];
+    if (m_file.read(riff, sizeof(riff)) != qint64(sizeof(riff))
+            || (memcmp(riff, "RIFF", 4) != 0 && memcmp(riff, "RIFX", 4) != 0)
+            || memcmp(riff + 8, "WAVE", 4) != 0) {
+        m_errorString = QStringLiteral("not a wave file");
+        return false;
+    }
+    const bool bigEndian = riff[3] == 'X';
+
+    bool formatKnown = false;
+    char chunk[8];
+    while (m_file.read(chunk, sizeof(chunk)) == qint64(sizeof(chunk))) {
+        const quint32 size = read32(chunk + 4, bigEndian);
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            const QByteArray fmt = m_file.read(size);
+            if (size < 16 || fmt.size() != int(size))
+                break;
+            const char *p = fmt.constData();
+            quint16 tag = read16(p, bigEndian);
+            const quint16 bits = read16(p + 14, bigEndian);
+            //WAVE_FORMAT_EXTENSIBLE keeps the actual format tag in the subformat GUID
+            if (tag == 0xfffe && size >= 40)
+                tag = read16(p + 24, bigEndian);
+            if (tag == 1) {
+                m_format.setSampleType(bits == 8 ? QAudioFormat::UnSignedInt : QAudioFormat::SignedInt);
+            } else if (tag == 3 && bits == 32) {
+                m_format.setSampleType(QAudioFormat::Float);
+            } else {
+                m_errorString = QStringLiteral("unsupported wave format %1").arg(tag);
+                return false;
+            }
+            m_format.setChannelCount(read16(p + 2, bigEndian));
+            m_format.setSampleRate(read32(p + 4, bigEndian));
+            m_format.setSampleSize(bits);
+            m_format.setByteOrder(bigEndian ? QAudioFormat::BigEndian : QAudioFormat::LittleEndian);
+            m_format.setCodec(QStringLiteral("audio/pcm"));
+            formatKnown = m_format.isValid();
+            if (size & 1)
+                m_file.seek(m_file.pos() + 1);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!formatKnown)
+                break;
+            m_dataStart = m_file.pos();
+            //the size of files written by a stream that never got finalized is unreliable
+            m_dataSize = qMin<qint64>(size, m_file.size() - m_dataStart);
+            m_dataSize -= m_dataSize % m_format.bytesPerFrame();
+            m_position = 0;
+            return true;
+        } else if (!m_file.seek(m_file.pos() + size + (size & 1))) {
+            break;
+        }
+    }
+
+    m_errorString = QStringLiteral("no audio data found");
+    return false;
+}
+
+
+QSoundStreamService::QSoundStreamService(QObject *parent)
+    : QObject(parent)
+    , m_current(0)
+    , m_timer(0)
+{
+}
+
+QSoundStreamService::~QSoundStreamService()
+{
+}
+
+void QSoundStreamService::addClient(Client *client)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_clients.append(client);
+    }
+    QMetaObject::invokeMethod(this, "wake", Qt::QueuedConnection);
+}
+
+void QSoundStreamService::removeClient(Client *client)
+{
+    QMutexLocker locker(&m_mutex);
+    m_clients.removeAll(client);
+    while (m_current == client)
+        m_serviced.wait(&m_mutex);
+}
+
+void QSoundStreamService::requestService()
+{
+    QMetaObject::invokeMethod(this, "serviceClients", Qt::QueuedConnection);
+}
+
+void QSoundStreamService::start()
+{
+    if (m_timer)
+        return;
+    m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(serviceClients()));
+    wake();
+}
+
+void QSoundStreamService::stop()
+{
+    delete m_timer;
+    m_timer = 0;
+}
+
+void QSoundStreamService::wake()
+{
+    if (!m_timer || m_timer->isActive())
+        return;
+    QMutexLocker locker(&m_mutex);
+    if (!m_clients.isEmpty())
+        m_timer->start(serviceInterval);
+}
+
+void QSoundStreamService::serviceClients()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_clients.isEmpty()) {
+        //woken up again by the next addClient()
+        if (m_timer)
+            m_timer->stop();
+        return;
+    }
+    //servicing reads from disk, only the client being serviced blocks removeClient()
+    const QVector<Client*> clients = m_clients;
+    for (Client *client : clients) {
+        if (!m_clients.contains(client))
+            continue;
+        m_current = client;
+        locker.unlock();
+        client->service();
+        locker.relock();
+        m_current = 0;
+        m_serviced.wakeAll();
+    }
+}
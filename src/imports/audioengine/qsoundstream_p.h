@@ -0,0 +1,137 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSOUNDSTREAM_P_H
+#define QSOUNDSTREAM_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/QObject>
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QUrl>
+#include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
+#include <QtMultimedia/qaudioformat.h>
+
+QT_BEGIN_NAMESPACE
+
+class QTimer;
+
+//Reads the PCM data of a local or resource wave file piece by piece
+class QSoundStream
+{
+public:
+    QSoundStream();
+
+    bool open(const QUrl &url);
+    void close();
+    QString errorString() const;
+
+    QAudioFormat format() const;
+    qint64 dataSize() const;
+    qint64 bytesRemaining() const;
+
+    //reads at most maxlen bytes of sample data
+    qint64 read(char *data, qint64 maxlen);
+    bool atEnd() const;
+    bool rewind();
+
+private:
+    bool readHeader();
+
+    QFile m_file;
+    QAudioFormat m_format;
+    qint64 m_dataStart;
+    qint64 m_dataSize;
+    qint64 m_position;
+    QString m_errorString;
+};
+
+
+//Periodically tops up the buffers of all playing streams from one thread
+class QSoundStreamService : public QObject
+{
+    Q_OBJECT
+public:
+    class Client
+    {
+    public:
+        virtual ~Client() {}
+        //called on the streaming thread
+        virtual void service() = 0;
+    };
+
+    QSoundStreamService(QObject *parent = 0);
+    ~QSoundStreamService();
+
+    void addClient(Client *client);
+    //returns once client is not serviced anymore
+    void removeClient(Client *client);
+    //services all clients as soon as possible instead of on the next tick
+    void requestService();
+
+public Q_SLOTS:
+    void start();
+    void stop();
+
+private Q_SLOTS:
+    void serviceClients();
+    void wake();
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_serviced;
+    QVector<Client*> m_clients;
+    Client *m_current;
+    QTimer *m_timer;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSOUNDSTREAM_P_H
@@ -1,6 +1,3 @@
 TEMPLATE = subdirs
-QT_FOR_CONFIG += multimedia-private
-
-SUBDIRS += multimedia
-qtConfig(openal): SUBDIRS += audioengine
 
+SUBDIRS += multimedia audioengine
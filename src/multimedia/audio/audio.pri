@@ -7,25 +7,37 @@ PUBLIC_HEADERS += \
            audio/qaudioinput.h \
            audio/qaudiooutput.h \
            audio/qaudiodeviceinfo.h \
+           audio/qaudiodevicewatcher.h \
            audio/qaudiosystemplugin.h \
            audio/qaudiosystem.h  \
            audio/qsoundeffect.h \
            audio/qsound.h \
            audio/qaudioprobe.h \
-           audio/qaudiodecoder.h
+           audio/qaudiodecoder.h \
+           audio/qaudiobatchdecoder.h \
+           audio/qaudioloudness.h \
+           audio/qaudiospectrumprobe.h
 
 PRIVATE_HEADERS += \
            audio/qaudiobuffer_p.h \
+           audio/qaudiofft_p.h \
            audio/qaudiodevicefactory_p.h \
            audio/qwavedecoder_p.h \
            audio/qsamplecache_p.h \
            audio/qaudiohelpers_p.h \
-           audio/qaudiosystempluginext_p.h
+           audio/qaudiolevelreducer_p.h \
+           audio/qaudioloudnessmeter_p.h \
+           audio/qaudioprobedispatcher_p.h \
+           audio/qaudiospectrumanalyser_p.h \
+           audio/qaudiostreamstats_p.h \
+           audio/qaudiosystempluginext_p.h \
+           audio/qaudiosystemext_p.h
 
 SOURCES += \
            audio/qaudio.cpp \
            audio/qaudioformat.cpp  \
            audio/qaudiodeviceinfo.cpp \
+           audio/qaudiodevicewatcher.cpp \
            audio/qaudiooutput.cpp \
            audio/qaudioinput.cpp \
            audio/qaudiosystemplugin.cpp \
@@ -38,7 +50,21 @@ SOURCES += \
            audio/qaudiobuffer.cpp \
            audio/qaudioprobe.cpp \
            audio/qaudiodecoder.cpp \
-           audio/qaudiohelpers.cpp
+           audio/qaudiobatchdecoder.cpp \
+           audio/qaudiofft.cpp \
+           audio/qaudiohelpers.cpp \
+           audio/qaudiolevelreducer.cpp \
+           audio/qaudioloudness.cpp \
+           audio/qaudioloudnessmeter.cpp \
+           audio/qaudioprobedispatcher.cpp \
+           audio/qaudiospectrumanalyser.cpp \
+           audio/qaudiospectrumprobe.cpp \
+           audio/qaudiostreamstats.cpp
+
+SSE2_SOURCES += \
+           audio/qaudiofft_sse2.cpp \
+           audio/qaudiohelpers_sse2.cpp \
+           audio/qaudioloudnessmeter_sse2.cpp
 
 qtConfig(pulseaudio) {
     QMAKE_USE_FOR_PRIVATE += pulseaudio
@@ -140,6 +140,38 @@ Q_CONSTRUCTOR_FUNCTION(qRegisterAudioMetaTypes)
     \sa QAudio::convertVolume()
 */
 
+/*!
+    \typedef QAudio::RenderCallback
+    \since 5.11
+
+    A function called by QAudioOutput to render audio into \c data, which
+    holds room for \c len bytes in the format of the output.  The callback
+    must fill the whole buffer; \c userData is the pointer passed to
+    QAudioOutput::start().
+
+    The callback runs on the audio thread of the backend.  It must not
+    allocate memory, take locks, or otherwise block, or the device will
+    underrun.
+
+    \sa QAudioOutput::start()
+*/
+
+/*!
+    \typedef QAudio::CaptureCallback
+    \since 5.11
+
+    A function called by QAudioInput with \c len bytes of captured audio
+    in \c data, in the format of the input.  The data is only valid for
+    the duration of the call; \c userData is the pointer passed to
+    QAudioInput::start().
+
+    The callback runs on the audio thread of the backend.  It must not
+    allocate memory, take locks, or otherwise block, or captured audio
+    will be lost.
+
+    \sa QAudioInput::start()
+*/
+
 namespace QAudio
 {
 
@@ -78,6 +78,9 @@ namespace QAudio
         DecibelVolumeScale
     };
 
+    typedef void (*RenderCallback)(char *data, int len, void *userData);
+    typedef void (*CaptureCallback)(const char *data, int len, void *userData);
+
     Q_MULTIMEDIA_EXPORT qreal convertVolume(qreal volume, VolumeScale from, VolumeScale to);
 }
 
@@ -0,0 +1,520 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+/*!
+    \class QAudioBatchDecoder
+    \inmodule QtMultimedia
+    \since 5.11
+
+    \ingroup multimedia
+    \ingroup multimedia_audio
+
+    \brief The QAudioBatchDecoder class decodes whole audio files as fast as possible.
+
+    QAudioDecoder delivers decoded audio one buffer at a time through the
+    bufferReady() signal, which makes every buffer a round trip through the
+    event loop of the thread that owns the decoder. That is appropriate for
+    streaming, but slow when the application only wants the complete decoded
+    data of one or more files, for example to draw a waveform or to build an
+    index.
+
+    QAudioBatchDecoder decodes each added source on a worker thread pool,
+    several sources concurrently, and collects the decoded samples either
+    into one contiguous QByteArray per source or into a caller provided
+    QIODevice. No signal is emitted per buffer; instead progress() is reported
+    at most once every progressInterval() milliseconds per source.
+
+    \code
+        QAudioBatchDecoder *decoder = new QAudioBatchDecoder(this);
+        for (const QString &fileName : fileNames)
+            decoder->addSource(fileName);
+        connect(decoder, &QAudioBatchDecoder::sourceFinished, this, [=](int index) {
+            buildWaveform(decoder->format(index), decoder->data(index));
+        });
+        decoder->start();
+    \endcode
+
+    All signals are emitted from the worker threads, so connections to
+    receivers living in other threads are queued. Pass a context object when
+    connecting a lambda, as above, so that it runs in that object's thread
+    rather than on a worker thread.
+
+    \sa QAudioDecoder
+*/
+
+#include "qaudiobatchdecoder.h"
+#include "qaudiobuffer.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qeventloop.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qvector.h>
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+struct QAudioBatchDecodeSource
+{
+    QAudioBatchDecodeSource() : output(0), error(QAudioDecoder::NoError), cancelled(false) {}
+
+    QString fileName;
+    QIODevice *output;
+    QAudioFormat format;
+    QByteArray data;
+    QAudioDecoder::Error error;
+    QString errorString;
+    bool cancelled;
+};
+
+class QAudioBatchDecoderPrivate
+{
+public:
+    QAudioBatchDecoderPrivate(QAudioBatchDecoder *q)
+        : q(q)
+        , progressInterval(100)
+    {}
+
+    QAudioBatchDecoder *q;
+    QThreadPool pool;
+    QAudioFormat format;
+    int progressInterval;
+
+    mutable QMutex mutex;
+    QVector<QAudioBatchDecodeSource> sources;
+
+    QAtomicInt pending;
+    QAtomicInt cancelled;
+};
+
+class QAudioBatchDecodeTask : public QRunnable
+{
+public:
+    QAudioBatchDecodeTask(QAudioBatchDecoderPrivate *d, int index)
+        : d(d)
+        , index(index)
+    {}
+
+    void run() override;
+
+private:
+    QAudioBatchDecoderPrivate *d;
+    int index;
+};
+
+void QAudioBatchDecodeTask::run()
+{
+    QString fileName;
+    QIODevice *output;
+    {
+        QMutexLocker locker(&d->mutex);
+        fileName = d->sources.at(index).fileName;
+        output = d->sources.at(index).output;
+    }
+
+    QAudioFormat format;
+    QByteArray data;
+    QAudioDecoder::Error error = QAudioDecoder::NoError;
+    QString errorString;
+    qint64 position = 0;
+    qint64 duration = -1;
+    bool cancelled = d->cancelled.load();
+
+    if (!cancelled) {
+        // The decoder lives in this pool thread and its queued buffer
+        // notifications are handled by a local event loop, so the thread
+        // that started the batch is never involved per buffer.
+        QEventLoop loop;
+        QAudioDecoder decoder;
+        if (d->format.isValid())
+            decoder.setAudioFormat(d->format);
+        decoder.setSourceFilename(fileName);
+
+        QElapsedTimer progressTimer;
+        progressTimer.start();
+        qint64 nextProgress = 0;
+
+        auto drain = [&]() {
+            while (decoder.bufferAvailable()) {
+                if (d->cancelled.load()) {
+                    cancelled = true;
+                    decoder.stop();
+                    loop.quit();
+                    return;
+                }
+
+                const QAudioBuffer buffer = decoder.read();
+                if (!buffer.isValid())
+                    continue;
+
+                if (!format.isValid()) {
+                    format = buffer.format();
+                    duration = decoder.duration();
+                    // Size the contiguous output for the whole file once
+                    // instead of growing it buffer by buffer.
+                    if (!output && duration > 0) {
+                        const qint64 expected = qint64(format.bytesPerFrame())
+                                * format.sampleRate() * duration / 1000;
+                        if (expected > 0 && expected < std::numeric_limits<int>::max())
+                            data.reserve(int(expected));
+                    }
+                }
+
+                const char *samples = static_cast<const char *>(buffer.constData());
+                if (output)
+                    output->write(samples, buffer.byteCount());
+                else
+                    data.append(samples, buffer.byteCount());
+
+                if (buffer.startTime() >= 0)
+                    position = (buffer.startTime() + buffer.duration()) / 1000;
+                if (progressTimer.elapsed() >= nextProgress) {
+                    nextProgress = progressTimer.elapsed() + d->progressInterval;
+                    emit d->q->progress(index, position, duration);
+                }
+            }
+        };
+
+        QObject::connect(&decoder, &QAudioDecoder::bufferReady, drain);
+        QObject::connect(&decoder, &QAudioDecoder::durationChanged, [&](qint64 newDuration) {
+            if (newDuration > 0)
+                duration = newDuration;
+        });
+        QObject::connect(&decoder, &QAudioDecoder::finished, [&]() {
+            drain();
+            loop.quit();
+        });
+        QObject::connect(&decoder,
+                         static_cast<void (QAudioDecoder::*)(QAudioDecoder::Error)>(&QAudioDecoder::error),
+                         [&](QAudioDecoder::Error decoderError) {
+            error = decoderError;
+            errorString = decoder.errorString();
+            loop.quit();
+        });
+
+        decoder.start();
+        loop.exec();
+    }
+
+    {
+        QMutexLocker locker(&d->mutex);
+        QAudioBatchDecodeSource &source = d->sources[index];
+        source.format = format;
+        source.data = data;
+        source.error = error;
+        source.errorString = errorString;
+        source.cancelled = cancelled;
+    }
+
+    if (error == QAudioDecoder::NoError && !cancelled)
+        emit d->q->progress(index, position, duration);
+    emit d->q->sourceFinished(index);
+
+    if (!d->pending.deref())
+        emit d->q->finished();
+}
+
+/*!
+    Constructs a batch decoder with the given \a parent.
+*/
+QAudioBatchDecoder::QAudioBatchDecoder(QObject *parent)
+    : QObject(parent)
+    , d(new QAudioBatchDecoderPrivate(this))
+{
+}
+
+/*!
+    Destroys the batch decoder, cancelling and waiting for any running decode.
+*/
+QAudioBatchDecoder::~QAudioBatchDecoder()
+{
+    cancel();
+    d->pool.waitForDone();
+    delete d;
+}
+
+/*!
+    Returns the format the sources are decoded to.
+
+    \sa setAudioFormat()
+*/
+QAudioFormat QAudioBatchDecoder::audioFormat() const
+{
+    return d->format;
+}
+
+/*!
+    Sets the \a format all sources are decoded to. When no valid format is
+    set, each source is decoded to the format chosen by the backend, which
+    is reported by format().
+
+    Changing the format while decoding has no effect on the running batch.
+
+    \sa QAudioDecoder::setAudioFormat()
+*/
+void QAudioBatchDecoder::setAudioFormat(const QAudioFormat &format)
+{
+    if (isRunning())
+        return;
+    d->format = format;
+}
+
+/*!
+    Returns the maximum number of sources decoded concurrently.
+    The default is QThread::idealThreadCount().
+*/
+int QAudioBatchDecoder::maxThreadCount() const
+{
+    return d->pool.maxThreadCount();
+}
+
+/*!
+    Sets the maximum number of sources decoded concurrently to \a count.
+*/
+void QAudioBatchDecoder::setMaxThreadCount(int count)
+{
+    d->pool.setMaxThreadCount(count);
+}
+
+/*!
+    Returns the minimum interval in milliseconds between two progress()
+    signals for the same source. The default is 100 milliseconds.
+*/
+int QAudioBatchDecoder::progressInterval() const
+{
+    return d->progressInterval;
+}
+
+/*!
+    Sets the minimum interval between progress() signals to \a msecs.
+*/
+void QAudioBatchDecoder::setProgressInterval(int msecs)
+{
+    if (isRunning())
+        return;
+    d->progressInterval = qMax(0, msecs);
+}
+
+/*!
+    Adds the audio file \a fileName to the batch and returns its index.
+
+    If \a output is not null, the decoded samples are written to it instead
+    of being collected in data(). The device must be open for writing and
+    is written to from a worker thread, so it must not be accessed from
+    anywhere else until sourceFinished() has been emitted for this index.
+
+    Sources cannot be added while decoding.
+*/
+int QAudioBatchDecoder::addSource(const QString &fileName, QIODevice *output)
+{
+    if (isRunning())
+        return -1;
+
+    QMutexLocker locker(&d->mutex);
+    QAudioBatchDecodeSource source;
+    source.fileName = fileName;
+    source.output = output;
+    d->sources.append(source);
+    return d->sources.size() - 1;
+}
+
+/*!
+    Returns the number of sources in the batch.
+*/
+int QAudioBatchDecoder::sourceCount() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->sources.size();
+}
+
+/*!
+    Removes all sources and their decoded data.
+*/
+void QAudioBatchDecoder::clear()
+{
+    if (isRunning())
+        return;
+
+    QMutexLocker locker(&d->mutex);
+    d->sources.clear();
+}
+
+/*!
+    Returns true while sources are being decoded.
+*/
+bool QAudioBatchDecoder::isRunning() const
+{
+    return d->pending.load() > 0;
+}
+
+/*!
+    Blocks until all sources have been decoded or \a msecs milliseconds
+    have passed. A negative value waits without a timeout.
+
+    Returns true if decoding has finished.
+*/
+bool QAudioBatchDecoder::waitForFinished(int msecs)
+{
+    return d->pool.waitForDone(msecs);
+}
+
+/*!
+    Returns the error that stopped decoding the source at \a index.
+*/
+QAudioDecoder::Error QAudioBatchDecoder::error(int index) const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->sources.value(index).error;
+}
+
+/*!
+    Returns a description of the error that stopped decoding the source at \a index.
+*/
+QString QAudioBatchDecoder::errorString(int index) const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->sources.value(index).errorString;
+}
+
+/*!
+    Returns true if decoding the source at \a index was cancelled before it
+    was complete, either while it was being decoded or before it was started.
+    error() is QAudioDecoder::NoError for such a source, and its data is
+    incomplete or empty.
+
+    \sa cancel()
+*/
+bool QAudioBatchDecoder::isCancelled(int index) const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->sources.value(index).cancelled;
+}
+
+/*!
+    Returns the format of the decoded samples of the source at \a index, or
+    an invalid format if nothing has been decoded.
+*/
+QAudioFormat QAudioBatchDecoder::format(int index) const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->sources.value(index).format;
+}
+
+/*!
+    Returns the decoded samples of the source at \a index as one contiguous
+    block. The data is available once sourceFinished() has been emitted for
+    the source, and is empty for sources decoded into an output device.
+*/
+QByteArray QAudioBatchDecoder::data(int index) const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->sources.value(index).data;
+}
+
+/*!
+    Starts decoding all sources. Results of a previous run are discarded.
+*/
+void QAudioBatchDecoder::start()
+{
+    if (isRunning())
+        return;
+
+    QMutexLocker locker(&d->mutex);
+    d->cancelled.store(0);
+
+    if (d->sources.isEmpty()) {
+        QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection);
+        return;
+    }
+
+    for (QAudioBatchDecodeSource &source : d->sources) {
+        source.format = QAudioFormat();
+        source.data.clear();
+        source.error = QAudioDecoder::NoError;
+        source.errorString.clear();
+        source.cancelled = false;
+    }
+
+    d->pending.store(d->sources.size());
+    for (int i = 0; i < d->sources.size(); ++i)
+        d->pool.start(new QAudioBatchDecodeTask(d, i));
+}
+
+/*!
+    Stops decoding. Sources that have not been started yet are skipped, and
+    sources being decoded keep the data decoded so far. sourceFinished() and
+    finished() are still emitted, and isCancelled() returns true for every
+    source that was not decoded completely.
+*/
+void QAudioBatchDecoder::cancel()
+{
+    d->cancelled.store(1);
+}
+
+/*!
+    \fn void QAudioBatchDecoder::progress(int index, qint64 position, qint64 duration)
+
+    Signals that the source at \a index has been decoded up to \a position
+    milliseconds out of \a duration milliseconds. \a duration is -1 when the
+    backend cannot tell the length of the source.
+
+    \sa progressInterval()
+*/
+
+/*!
+    \fn void QAudioBatchDecoder::sourceFinished(int index)
+
+    Signals that the source at \a index has been decoded completely, has
+    failed, or was cancelled. Check error() and isCancelled() to tell these
+    apart.
+*/
+
+/*!
+    \fn void QAudioBatchDecoder::finished()
+
+    Signals that all sources have been processed.
+*/
+
+QT_END_NAMESPACE
+
+#include "moc_qaudiobatchdecoder.cpp"
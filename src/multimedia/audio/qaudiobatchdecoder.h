@@ -0,0 +1,100 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QAUDIOBATCHDECODER_H
+#define QAUDIOBATCHDECODER_H
+
+#include <QtCore/qobject.h>
+#include <QtMultimedia/qtmultimediaglobal.h>
+#include <QtMultimedia/qaudioformat.h>
+#include <QtMultimedia/qaudiodecoder.h>
+
+QT_BEGIN_NAMESPACE
+
+class QIODevice;
+
+class QAudioBatchDecoderPrivate;
+class Q_MULTIMEDIA_EXPORT QAudioBatchDecoder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QAudioBatchDecoder(QObject *parent = Q_NULLPTR);
+    ~QAudioBatchDecoder();
+
+    QAudioFormat audioFormat() const;
+    void setAudioFormat(const QAudioFormat &format);
+
+    int maxThreadCount() const;
+    void setMaxThreadCount(int count);
+
+    int progressInterval() const;
+    void setProgressInterval(int msecs);
+
+    int addSource(const QString &fileName, QIODevice *output = Q_NULLPTR);
+    int sourceCount() const;
+    void clear();
+
+    bool isRunning() const;
+    bool waitForFinished(int msecs = -1);
+
+    QAudioDecoder::Error error(int index) const;
+    QString errorString(int index) const;
+    bool isCancelled(int index) const;
+    QAudioFormat format(int index) const;
+    QByteArray data(int index) const;
+
+public Q_SLOTS:
+    void start();
+    void cancel();
+
+Q_SIGNALS:
+    void progress(int index, qint64 position, qint64 duration);
+    void sourceFinished(int index);
+    void finished();
+
+private:
+    Q_DISABLE_COPY(QAudioBatchDecoder)
+    QAudioBatchDecoderPrivate *d;
+    friend class QAudioBatchDecoderPrivate;
+    friend class QAudioBatchDecodeTask;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIOBATCHDECODER_H
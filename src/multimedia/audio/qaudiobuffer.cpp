@@ -39,9 +39,13 @@
 
 #include "qaudiobuffer.h"
 #include "qaudiobuffer_p.h"
+#include "qaudiohelpers_p.h"
 
 #include <QObject>
 #include <QDebug>
+#include <QMutex>
+#include <QVarLengthArray>
+#include <QVector>
 
 QT_BEGIN_NAMESPACE
 
@@ -57,9 +61,10 @@ Q_CONSTRUCTOR_FUNCTION(qRegisterAudioBufferMetaTypes)
 class QAudioBufferPrivate : public QSharedData
 {
 public:
-    QAudioBufferPrivate(QAbstractAudioBuffer *provider)
+    QAudioBufferPrivate(QAbstractAudioBuffer *provider, QAudioBuffer::Layout layout = QAudioBuffer::Interleaved)
         : mProvider(provider)
         , mCount(1)
+        , mLayout(layout)
     {
     }
 
@@ -95,12 +100,13 @@ public:
 
     QAbstractAudioBuffer *mProvider;
     QAtomicInt mCount;
+    QAudioBuffer::Layout mLayout;
 };
 
 // Private class to go in .cpp file
 class QMemoryAudioBufferProvider : public QAbstractAudioBuffer {
 public:
-    QMemoryAudioBufferProvider(const void *data, int frameCount, const QAudioFormat &format, qint64 startTime)
+    QMemoryAudioBufferProvider(const void *data, int frameCount, const QAudioFormat &format, qint64 startTime, bool fill = true)
         : mStartTime(startTime)
         , mFrameCount(frameCount)
         , mFormat(format)
@@ -117,7 +123,7 @@ public:
                 // Allocated, see if we have data to copy
                 if (data) {
                     memcpy(mBuffer, data, numBytes);
-                } else {
+                } else if (fill) {
                     // We have to fill with the zero value..
                     switch (format.sampleType()) {
                         case QAudioFormat::SignedInt:
@@ -174,13 +180,107 @@ QAudioBufferPrivate *QAudioBufferPrivate::clone()
         }
 
         if (abuf) {
-            return new QAudioBufferPrivate(abuf);
+            return new QAudioBufferPrivate(abuf, mLayout);
         }
     }
 
     return 0;
 }
 
+class QPooledAudioBufferProvider;
+
+class QAudioBufferPoolPrivate
+{
+public:
+    QAudioBufferPoolPrivate(int maximumFree)
+        : ref(1)
+        , maximumFree(qMax(maximumFree, 0))
+        , alive(true)
+    {
+        freeBuffers.reserve(this->maximumFree);
+    }
+
+    void deref()
+    {
+        if (!ref.deref())
+            delete this;
+    }
+
+    void recycle(QPooledAudioBufferProvider *buffer);
+
+    // One reference for the pool, plus one per buffer handed out
+    QAtomicInt ref;
+    mutable QMutex mutex;
+    QVector<QPooledAudioBufferProvider *> freeBuffers;
+    int maximumFree;
+    bool alive;
+};
+
+class QPooledAudioBufferProvider : public QAbstractAudioBuffer {
+public:
+    QPooledAudioBufferProvider(QAudioBufferPoolPrivate *pool)
+        : mPool(pool)
+        , mBuffer(0)
+        , mCapacity(0)
+        , mStartTime(-1)
+        , mFrameCount(0)
+    {
+    }
+
+    ~QPooledAudioBufferProvider()
+    {
+        if (mBuffer)
+            free(mBuffer);
+    }
+
+    bool reserve(int numBytes)
+    {
+        if (numBytes <= mCapacity)
+            return true;
+        void *buffer = realloc(mBuffer, numBytes);
+        if (!buffer)
+            return false;
+        mBuffer = buffer;
+        mCapacity = numBytes;
+        return true;
+    }
+
+    void release() override {mPool->recycle(this);}
+    QAudioFormat format() const override {return mFormat;}
+    qint64 startTime() const override {return mStartTime;}
+    int frameCount() const override {return mFrameCount;}
+
+    void *constData() const override {return mBuffer;}
+
+    void *writableData() override {return mBuffer;}
+    QAbstractAudioBuffer *clone() const override
+    {
+        // Copies are not pooled, they may outlive the pool
+        return new QMemoryAudioBufferProvider(mBuffer, mFrameCount, mFormat, mStartTime);
+    }
+
+    QAudioBufferPoolPrivate *mPool;
+    void *mBuffer;
+    int mCapacity;
+    qint64 mStartTime;
+    int mFrameCount;
+    QAudioFormat mFormat;
+};
+
+void QAudioBufferPoolPrivate::recycle(QPooledAudioBufferProvider *buffer)
+{
+    {
+        QMutexLocker locker(&mutex);
+        if (alive && freeBuffers.size() < maximumFree) {
+            freeBuffers.append(buffer);
+            buffer = 0;
+        }
+    }
+
+    delete buffer;
+    deref();
+}
+
 /*!
     \class QAbstractAudioBuffer
     \internal
@@ -264,6 +364,39 @@ QAudioBuffer::QAudioBuffer(int numFrames, const QAudioFormat &format, qint64 sta
         d = 0;
 }
 
+/*!
+    \enum QAudioBuffer::Layout
+    \since 5.11
+
+    Describes how the samples of the different channels are arranged in a buffer.
+
+    \value Interleaved The samples of each frame are stored next to each other,
+    so a stereo buffer holds left, right, left, right and so on.
+    \value Planar The samples of each channel are stored contiguously, one plane
+    per channel, with the planes following each other in channel order.
+*/
+
+/*!
+    \since 5.11
+
+    Creates a new audio buffer with space for \a numFrames frames of
+    the given \a format, arranged in the given \a layout.  The individual
+    samples will be initialized to the default for the format.
+
+    \a startTime (in microseconds) indicates when this buffer
+    starts in the stream.
+    If this buffer is not part of a stream, set it to -1.
+
+    \sa layout(), constChannelData()
+ */
+QAudioBuffer::QAudioBuffer(int numFrames, const QAudioFormat &format, Layout layout, qint64 startTime)
+{
+    if (format.isValid())
+        d = new QAudioBufferPrivate(new QMemoryAudioBufferProvider(0, numFrames, format, startTime), layout);
+    else
+        d = 0;
+}
+
 /*!
     Assigns the \a other buffer to this.
  */
@@ -374,6 +507,105 @@ qint64 QAudioBuffer::startTime() const
     return d->mProvider->startTime();
 }
 
+/*!
+    \since 5.11
+
+    Returns how the samples of the different channels are arranged in this
+    buffer.  Buffers are \l Interleaved unless they were created as
+    \l Planar.
+
+    \sa toPlanar(), toInterleaved()
+ */
+QAudioBuffer::Layout QAudioBuffer::layout() const
+{
+    if (!isValid())
+        return Interleaved;
+    return d->mLayout;
+}
+
+/*!
+    \since 5.11
+
+    Returns a planar copy of this buffer, with the same format and start
+    time.  If this buffer is already planar, or invalid, it is returned
+    as is.
+
+    \sa toInterleaved(), layout()
+ */
+QAudioBuffer QAudioBuffer::toPlanar() const
+{
+    if (!isValid() || d->mLayout == Planar)
+        return *this;
+
+    const QAudioFormat f(format());
+    const int frames = frameCount();
+    const int channels = f.channelCount();
+    const int sampleBytes = f.sampleSize() / 8;
+
+    // Every byte is written below, so skip the silence fill
+    QAudioBuffer planar(new QMemoryAudioBufferProvider(0, frames, f, startTime(), false));
+    if (!planar.isValid())
+        return QAudioBuffer();
+    planar.d->mLayout = Planar;
+
+    char *dest = static_cast<char *>(planar.data());
+    QVarLengthArray<void *, 8> planes(channels);
+    for (int c = 0; c < channels; ++c)
+        planes[c] = dest + c * frames * sampleBytes;
+
+    QAudioHelperInternal::qDeinterleaveSamples(constData(), planes.constData(), frames, channels, sampleBytes);
+    return planar;
+}
+
+/*!
+    \since 5.11
+
+    Returns an interleaved copy of this buffer, with the same format and
+    start time.  If this buffer is already interleaved, or invalid, it is
+    returned as is.
+
+    \sa toPlanar(), layout()
+ */
+QAudioBuffer QAudioBuffer::toInterleaved() const
+{
+    if (!isValid() || d->mLayout == Interleaved)
+        return *this;
+
+    const QAudioFormat f(format());
+    const int frames = frameCount();
+    const int channels = f.channelCount();
+    const int sampleBytes = f.sampleSize() / 8;
+
+    QAudioBuffer interleaved(new QMemoryAudioBufferProvider(0, frames, f, startTime(), false));
+    if (!interleaved.isValid())
+        return QAudioBuffer();
+
+    const char *src = static_cast<const char *>(constData());
+    QVarLengthArray<const void *, 8> planes(channels);
+    for (int c = 0; c < channels; ++c)
+        planes[c] = src + c * frames * sampleBytes;
+
+    QAudioHelperInternal::qInterleaveSamples(planes.constData(), interleaved.data(), frames, channels, sampleBytes);
+    return interleaved;
+}
+
+/*!
+    \since 5.11
+
+    Converts every sample of this buffer to a float in the range [-1, 1]
+    and writes them to \a dest, which must have room for \l sampleCount()
+    floats.  The samples keep the \l layout() of this buffer.
+
+    Returns false if this buffer is invalid or its sample format can not
+    be converted, in which case \a dest is left untouched.
+ */
+bool QAudioBuffer::convertToFloat(float *dest) const
+{
+    if (!isValid() || !dest)
+        return false;
+    return QAudioHelperInternal::qConvertSamplesToFloat(format(), constData(), dest, sampleCount());
+}
+
 /*!
     Returns a pointer to this buffer's data.  You can only read it.
 
@@ -492,6 +724,204 @@ void *QAudioBuffer::data()
     return 0;
 }
 
+/*!
+    \since 5.11
+
+    Returns a pointer to the samples of \a channel in a \l Planar buffer.
+    You can only read them.  The plane holds \l frameCount() samples.
+
+    Returns a null pointer if this buffer is not planar, or if \a channel
+    is out of range.
+
+    There is also a templatized version of this function that returns
+    a specific type of pointer, without any checking of the format.
+
+    \code
+    // With a planar float buffer:
+    const float *right = buffer.constChannelData<float>(1);
+    \endcode
+
+    \sa channelData(), constData()
+ */
+const void *QAudioBuffer::constChannelData(int channel) const
+{
+    if (!isValid() || d->mLayout != Planar)
+        return 0;
+
+    const QAudioFormat f(format());
+    if (channel < 0 || channel >= f.channelCount())
+        return 0;
+
+    return static_cast<const char *>(constData()) + channel * frameCount() * (f.sampleSize() / 8);
+}
+
+/*!
+    \since 5.11
+
+    Returns a pointer to the samples of \a channel in a \l Planar buffer.
+    You can modify the samples through the returned pointer.
+
+    Like \l data(), this will make a deep copy if the samples are shared
+    with other buffers.  Returns a null pointer if this buffer is not planar,
+    or if \a channel is out of range.
+
+    \sa constChannelData()
+ */
+void *QAudioBuffer::channelData(int channel)
+{
+    if (!isValid() || d->mLayout != Planar)
+        return 0;
+
+    const QAudioFormat f(format());
+    if (channel < 0 || channel >= f.channelCount())
+        return 0;
+
+    char *buffer = static_cast<char *>(data());
+    if (!buffer)
+        return 0;
+    return buffer + channel * frameCount() * (f.sampleSize() / 8);
+}
+
+/*!
+    \class QAudioBufferPool
+    \inmodule QtMultimedia
+    \ingroup multimedia
+    \ingroup multimedia_audio
+    \since 5.11
+    \brief The QAudioBufferPool class recycles the sample storage of audio buffers.
+
+    Probes, decoders and processing code that produce a buffer per period
+    would otherwise allocate and free a block of samples every time.  Buffers
+    acquired from a pool give their storage back to the pool once the last
+    QAudioBuffer referring to it is destroyed, so that in a steady state the
+    next acquire() reuses it.
+
+    Buffers may be released from any thread, and may outlive the pool.
+    Storage released after the pool is destroyed is simply freed.
+
+    \code
+    QAudioBufferPool pool;
+    ...
+    QAudioBuffer buffer = pool.acquire(frames, format, QAudioBuffer::Planar);
+    fill(buffer.channelData<float>(0), buffer.channelData<float>(1), frames);
+    emit bufferReady(buffer);
+    \endcode
+*/
+
+/*!
+    Constructs a pool that keeps at most \a maximumFreeBuffers idle blocks of
+    sample storage for reuse.
+ */
+QAudioBufferPool::QAudioBufferPool(int maximumFreeBuffers)
+    : d(new QAudioBufferPoolPrivate(maximumFreeBuffers))
+{
+}
+
+/*!
+    Destroys the pool and frees its idle storage.  Buffers that are still
+    in use stay valid.
+ */
+QAudioBufferPool::~QAudioBufferPool()
+{
+    {
+        QMutexLocker locker(&d->mutex);
+        d->alive = false;
+        qDeleteAll(d->freeBuffers);
+        d->freeBuffers.clear();
+    }
+    d->deref();
+}
+
+/*!
+    Returns an interleaved buffer with room for \a numFrames frames of
+    the given \a format, starting at \a startTime (in microseconds).
+
+    Unlike the QAudioBuffer constructors, the samples are not initialized.
+    Returns an invalid buffer if \a format is invalid or \a numFrames is
+    not positive.
+ */
+QAudioBuffer QAudioBufferPool::acquire(int numFrames, const QAudioFormat &format, qint64 startTime)
+{
+    return acquire(numFrames, format, QAudioBuffer::Interleaved, startTime);
+}
+
+/*!
+    \overload
+
+    Returns a buffer arranged in the given \a layout.
+ */
+QAudioBuffer QAudioBufferPool::acquire(int numFrames, const QAudioFormat &format,
+                                       QAudioBuffer::Layout layout, qint64 startTime)
+{
+    const int numBytes = format.isValid() ? format.bytesForFrames(numFrames) : 0;
+    if (numBytes <= 0)
+        return QAudioBuffer();
+
+    QPooledAudioBufferProvider *buffer = 0;
+    {
+        QMutexLocker locker(&d->mutex);
+        // Take the smallest block that fits, so small requests don't hold
+        // on to the large ones.  Otherwise grow the most recently freed one.
+        int best = -1;
+        for (int i = 0; i < d->freeBuffers.size(); ++i) {
+            const int capacity = d->freeBuffers.at(i)->mCapacity;
+            if (capacity >= numBytes && (best < 0 || capacity < d->freeBuffers.at(best)->mCapacity))
+                best = i;
+        }
+        if (best < 0)
+            best = d->freeBuffers.size() - 1;
+        if (best >= 0) {
+            buffer = d->freeBuffers.at(best);
+            d->freeBuffers.remove(best);
+        }
+    }
+
+    if (!buffer)
+        buffer = new QPooledAudioBufferProvider(d);
+
+    if (!buffer->reserve(numBytes)) {
+        delete buffer;
+        return QAudioBuffer();
+    }
+
+    buffer->mFormat = format;
+    buffer->mFrameCount = numFrames;
+    buffer->mStartTime = startTime;
+
+    d->ref.ref();
+    QAudioBuffer result(buffer);
+    result.d->mLayout = layout;
+    return result;
+}
+
+/*!
+    Returns the maximum number of idle blocks this pool keeps for reuse.
+ */
+int QAudioBufferPool::maximumFreeBuffers() const
+{
+    return d->maximumFree;
+}
+
+/*!
+    Returns the number of idle blocks currently held for reuse.
+ */
+int QAudioBufferPool::freeBufferCount() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->freeBuffers.size();
+}
+
+/*!
+    Frees all idle storage held by the pool.  Buffers that are still in
+    use are not affected, and return to the pool as usual.
+ */
+void QAudioBufferPool::clear()
+{
+    QMutexLocker locker(&d->mutex);
+    qDeleteAll(d->freeBuffers);
+    d->freeBuffers.clear();
+}
+
 // Template helper classes worth documenting
 
 /*!
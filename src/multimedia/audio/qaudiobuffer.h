@@ -52,14 +52,19 @@ QT_BEGIN_NAMESPACE
 
 class QAbstractAudioBuffer;
 class QAudioBufferPrivate;
+class QAudioBufferPool;
+class QAudioBufferPoolPrivate;
 class Q_MULTIMEDIA_EXPORT QAudioBuffer
 {
 public:
+    enum Layout { Interleaved, Planar };
+
     QAudioBuffer();
     QAudioBuffer(QAbstractAudioBuffer *provider);
     QAudioBuffer(const QAudioBuffer &other);
     QAudioBuffer(const QByteArray &data, const QAudioFormat &format, qint64 startTime = -1);
     QAudioBuffer(int numFrames, const QAudioFormat &format, qint64 startTime = -1); // Initialized to empty
+    QAudioBuffer(int numFrames, const QAudioFormat &format, Layout layout, qint64 startTime = -1);
 
     QAudioBuffer& operator=(const QAudioBuffer &other);
 
@@ -76,6 +81,12 @@ public:
     qint64 duration() const;
     qint64 startTime() const;
 
+    Layout layout() const;
+    QAudioBuffer toInterleaved() const;
+    QAudioBuffer toPlanar() const;
+
+    bool convertToFloat(float *dest) const;
+
     // Data modification
     // void clear();
     // Other ideas
@@ -87,6 +98,10 @@ public:
     const void* data() const; // Does not detach
     void *data(); // detaches
 
+    // Per channel access to planar buffers
+    const void *constChannelData(int channel) const; // Does not detach
+    void *channelData(int channel); // detaches
+
     // Structures for easier access to stereo data
     template <typename T> struct StereoFrameDefault { enum { Default = 0 }; };
 
@@ -136,13 +151,38 @@ public:
     template <typename T> T* data() {
         return static_cast<T*>(data());
     }
+    template <typename T> const T* constChannelData(int channel) const {
+        return static_cast<const T*>(constChannelData(channel));
+    }
+    template <typename T> T* channelData(int channel) {
+        return static_cast<T*>(channelData(channel));
+    }
 private:
+    friend class QAudioBufferPool;
     QAudioBufferPrivate *d;
 };
 
 template <> struct QAudioBuffer::StereoFrameDefault<unsigned char> { enum { Default = 128 }; };
 template <> struct QAudioBuffer::StereoFrameDefault<unsigned short> { enum { Default = 32768 }; };
 
+class Q_MULTIMEDIA_EXPORT QAudioBufferPool
+{
+public:
+    explicit QAudioBufferPool(int maximumFreeBuffers = 8);
+    ~QAudioBufferPool();
+
+    QAudioBuffer acquire(int numFrames, const QAudioFormat &format, qint64 startTime = -1);
+    QAudioBuffer acquire(int numFrames, const QAudioFormat &format,
+                         QAudioBuffer::Layout layout, qint64 startTime = -1);
+
+    int maximumFreeBuffers() const;
+    int freeBufferCount() const;
+    void clear();
+
+private:
+    Q_DISABLE_COPY(QAudioBufferPool)
+    QAudioBufferPoolPrivate *d;
+};
 
 QT_END_NAMESPACE
 
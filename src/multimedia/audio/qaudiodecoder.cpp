@@ -399,6 +399,63 @@ qint64 QAudioDecoder::duration() const
     return -1;
 }
 
+/*!
+    \property QAudioDecoder::startPosition
+    \brief the position (in milliseconds) of the source decoding starts at.
+    \since 5.11
+
+    When the start position is greater than 0, the decoder seeks to it before
+    decoding, and samples before it are trimmed from the first buffer. Only
+    the requested range has to be decoded, so extracting a short clip from a
+    long recording costs time proportional to the length of the clip.
+
+    The range is applied the next time \l start() is called. It is ignored
+    by backends that do not support decoding time ranges, in which case the
+    property keeps its default value of 0.
+
+    \sa endPosition
+*/
+qint64 QAudioDecoder::startPosition() const
+{
+    Q_D(const QAudioDecoder);
+    if (d->control)
+        return d->control->startPosition();
+    return 0;
+}
+
+void QAudioDecoder::setStartPosition(qint64 position)
+{
+    Q_D(QAudioDecoder);
+    if (d->control)
+        d->control->setStartPosition(qMax(qint64(0), position));
+}
+
+/*!
+    \property QAudioDecoder::endPosition
+    \brief the position (in milliseconds) of the source decoding stops at.
+    \since 5.11
+
+    When set, \l finished() is emitted once the end position has been reached,
+    and samples after it are trimmed from the last buffer. The default value
+    of -1 decodes to the end of the source.
+
+    \sa startPosition
+*/
+qint64 QAudioDecoder::endPosition() const
+{
+    Q_D(const QAudioDecoder);
+    if (d->control)
+        return d->control->endPosition();
+    return -1;
+}
+
+void QAudioDecoder::setEndPosition(qint64 position)
+{
+    Q_D(QAudioDecoder);
+    if (d->control)
+        d->control->setEndPosition(position < 0 ? -1 : position);
+}
+
 /*!
     Read a buffer from the decoder, if one is available. Returns an invalid buffer
     if there are no decoded buffers currently available, or on failure.  In both cases
@@ -407,6 +464,14 @@ qint64 QAudioDecoder::duration() const
     You should either respond to the \l bufferReady() signal or check the
     \l bufferAvailable() function before calling read() to make sure
     you get useful data.
+
+    \note The returned buffer may share its memory with the decoder. With the
+    GStreamer backend the decoded GstBuffer stays referenced and mapped for as
+    long as any copy of the QAudioBuffer exists, so memory the decoder could
+    otherwise reuse stays pinned. Calling the non-const
+    \l{QAudioBuffer::data()}{data()} detaches the buffer into a copy of its
+    own and releases the decoder's memory. Do that, or drop the buffer, before
+    keeping it for long.
 */
 
 QAudioBuffer QAudioDecoder::read() const
@@ -55,6 +55,8 @@ class Q_MULTIMEDIA_EXPORT QAudioDecoder : public QMediaObject
     Q_PROPERTY(State state READ state NOTIFY stateChanged)
     Q_PROPERTY(QString error READ errorString)
     Q_PROPERTY(bool bufferAvailable READ bufferAvailable NOTIFY bufferAvailableChanged)
+    Q_PROPERTY(qint64 startPosition READ startPosition WRITE setStartPosition)
+    Q_PROPERTY(qint64 endPosition READ endPosition WRITE setEndPosition)
 
     Q_ENUMS(State)
     Q_ENUMS(Error)
@@ -100,6 +102,12 @@ public:
     qint64 position() const;
     qint64 duration() const;
 
+    qint64 startPosition() const;
+    void setStartPosition(qint64 position);
+
+    qint64 endPosition() const;
+    void setEndPosition(qint64 position);
+
 public Q_SLOTS:
     void start();
     void stop();
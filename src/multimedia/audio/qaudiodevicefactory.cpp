@@ -50,7 +50,10 @@ QT_BEGIN_NAMESPACE
 
 static QString defaultKey()
 {
-    return QStringLiteral("default");
+    // QT_AUDIO_DEFAULT_REALM picks another plugin for the default devices,
+    // for example "null" to run without audio hardware
+    const QString realm = qEnvironmentVariable("QT_AUDIO_DEFAULT_REALM");
+    return realm.isEmpty() ? QStringLiteral("default") : realm;
 }
 
 #if !defined (QT_NO_LIBRARY) && !defined(QT_NO_SETTINGS)
@@ -140,6 +143,22 @@ QList<QAudioDeviceInfo> QAudioDeviceFactory::availableDevices(QAudio::Mode mode)
     return devices;
 }
 
+QList<QAudioSystemPlugin *> QAudioDeviceFactory::plugins()
+{
+    QList<QAudioSystemPlugin *> result;
+#if !defined (QT_NO_LIBRARY) && !defined(QT_NO_SETTINGS)
+    QMediaPluginLoader* l = audioLoader();
+    const auto keys = l->keys();
+    for (const QString& key : keys) {
+        QAudioSystemPlugin *plugin = qobject_cast<QAudioSystemPlugin *>(l->instance(key));
+        if (plugin && !result.contains(plugin))
+            result << plugin;
+    }
+#endif
+
+    return result;
+}
+
 QAudioDeviceInfo QAudioDeviceFactory::defaultDevice(QAudio::Mode mode)
 {
 #if !defined (QT_NO_LIBRARY) && !defined(QT_NO_SETTINGS)
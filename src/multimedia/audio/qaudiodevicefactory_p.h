@@ -65,6 +65,7 @@ QT_BEGIN_NAMESPACE
 class QAbstractAudioInput;
 class QAbstractAudioOutput;
 class QAbstractAudioDeviceInfo;
+class QAudioSystemPlugin;
 
 class QAudioDeviceFactory
 {
@@ -73,6 +74,8 @@ public:
 
     static QAudioDeviceInfo defaultDevice(QAudio::Mode mode);
 
+    static QList<QAudioSystemPlugin *> plugins();
+
     static QAbstractAudioDeviceInfo* audioDeviceInfo(const QString &realm, const QByteArray &handle, QAudio::Mode mode);
 
     static QAbstractAudioInput* createDefaultInputDevice(QAudioFormat const &format);
@@ -0,0 +1,166 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+/*!
+    \class QAudioDeviceWatcher
+    \inmodule QtMultimedia
+    \since 5.11
+
+    \ingroup multimedia
+    \ingroup multimedia_audio
+
+    \brief The QAudioDeviceWatcher class notifies about audio devices being added or removed.
+
+    Audio backends cache their device lists, so QAudioDeviceInfo::availableDevices()
+    is cheap to call repeatedly. Instead of polling it to detect hotplugged devices,
+    create a QAudioDeviceWatcher and connect to its signals:
+
+    \code
+        QAudioDeviceWatcher *watcher = new QAudioDeviceWatcher(this);
+        connect(watcher, &QAudioDeviceWatcher::deviceAdded,
+                this, &MyWidget::addDeviceToMenu);
+        connect(watcher, &QAudioDeviceWatcher::deviceRemoved,
+                this, &MyWidget::removeDeviceFromMenu);
+    \endcode
+
+    Notifications are only delivered by backends that can detect device changes,
+    such as ALSA (by watching \c /dev/snd) and PulseAudio (through server
+    subscription events).
+
+    \sa QAudioDeviceInfo, QAudioSystemPlugin::availableDevicesChanged()
+*/
+
+#include "qaudiodevicewatcher.h"
+#include "qaudiosystemplugin.h"
+#include "qaudiodevicefactory_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class QAudioDeviceWatcherPrivate
+{
+public:
+    QAudioDeviceWatcherPrivate(QAudioDeviceWatcher *q) : q(q) {}
+
+    void update(QAudio::Mode mode);
+
+    QAudioDeviceWatcher *q;
+    QList<QAudioDeviceInfo> inputs;
+    QList<QAudioDeviceInfo> outputs;
+};
+
+void QAudioDeviceWatcherPrivate::update(QAudio::Mode mode)
+{
+    QList<QAudioDeviceInfo> &devices = mode == QAudio::AudioInput ? inputs : outputs;
+    const QList<QAudioDeviceInfo> current = QAudioDeviceFactory::availableDevices(mode);
+    if (current == devices)
+        return;
+
+    const QList<QAudioDeviceInfo> previous = devices;
+    devices = current;
+
+    for (const QAudioDeviceInfo &device : previous) {
+        if (!current.contains(device))
+            emit q->deviceRemoved(device);
+    }
+    for (const QAudioDeviceInfo &device : current) {
+        if (!previous.contains(device))
+            emit q->deviceAdded(device);
+    }
+    emit q->availableDevicesChanged(mode);
+}
+
+/*!
+    Creates a new device watcher with the given \a parent.
+
+    The current device lists are recorded on construction; signals are only
+    emitted for changes that happen afterwards.
+*/
+QAudioDeviceWatcher::QAudioDeviceWatcher(QObject *parent)
+    : QObject(parent)
+    , d(new QAudioDeviceWatcherPrivate(this))
+{
+    d->inputs = QAudioDeviceFactory::availableDevices(QAudio::AudioInput);
+    d->outputs = QAudioDeviceFactory::availableDevices(QAudio::AudioOutput);
+
+    const auto plugins = QAudioDeviceFactory::plugins();
+    for (QAudioSystemPlugin *plugin : plugins) {
+        connect(plugin, &QAudioSystemPlugin::availableDevicesChanged,
+                this, [this](QAudio::Mode mode) { d->update(mode); });
+    }
+}
+
+/*!
+    Destroys the device watcher.
+*/
+QAudioDeviceWatcher::~QAudioDeviceWatcher()
+{
+    delete d;
+}
+
+/*!
+    Returns the devices for \a mode as last seen by this watcher.
+*/
+QList<QAudioDeviceInfo> QAudioDeviceWatcher::availableDevices(QAudio::Mode mode) const
+{
+    return mode == QAudio::AudioInput ? d->inputs : d->outputs;
+}
+
+/*!
+    \fn void QAudioDeviceWatcher::deviceAdded(const QAudioDeviceInfo &device)
+
+    Signals that \a device has become available.
+*/
+
+/*!
+    \fn void QAudioDeviceWatcher::deviceRemoved(const QAudioDeviceInfo &device)
+
+    Signals that \a device is no longer available. The \a device object can
+    still be compared against stored instances, but can no longer be opened.
+*/
+
+/*!
+    \fn void QAudioDeviceWatcher::availableDevicesChanged(QAudio::Mode mode)
+
+    Signals that the list of devices for \a mode has changed. This is emitted
+    once after the corresponding deviceAdded() and deviceRemoved() signals.
+*/
+
+QT_END_NAMESPACE
+
+#include "moc_qaudiodevicewatcher.cpp"
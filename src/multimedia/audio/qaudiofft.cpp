@@ -0,0 +1,176 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qaudiofft_p.h"
+
+#include <private/qsimd_p.h>
+#include <QtCore/qmath.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal
+{
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+void QT_FASTCALL qt_fft_butterflies_sse2(float *re, float *im, const float *twiddleRe,
+                                         const float *twiddleIm, int size, int half);
+#endif
+
+static void qt_fft_butterflies_c(float *re, float *im, const float *twiddleRe,
+                                 const float *twiddleIm, int size, int half)
+{
+    for (int i = 0; i < size; i += 2 * half) {
+        for (int j = 0; j < half; ++j) {
+            const int a = i + j;
+            const int b = a + half;
+            const float tr = twiddleRe[j] * re[b] - twiddleIm[j] * im[b];
+            const float ti = twiddleRe[j] * im[b] + twiddleIm[j] * re[b];
+            re[b] = re[a] - tr;
+            im[b] = im[a] - ti;
+            re[a] += tr;
+            im[a] += ti;
+        }
+    }
+}
+
+}
+
+/*
+    A radix-2 decimation in time FFT of real input. The size real samples
+    are transformed as size / 2 complex samples, with the even samples as
+    real and the odd samples as imaginary parts, and the spectrum is split
+    apart afterwards. Real and imaginary parts are kept in separate arrays
+    so that the butterflies of all but the first two stages vectorize four
+    at a time without shuffling.
+*/
+QAudioFft::QAudioFft(int size)
+    : m_size(0)
+{
+    if (size > 0)
+        setSize(size);
+}
+
+void QAudioFft::setSize(int size)
+{
+    Q_ASSERT(size >= 4 && (size & (size - 1)) == 0);
+    if (size == m_size)
+        return;
+
+    m_size = size;
+    const int half = size / 2;
+
+    m_re.resize(half);
+    m_im.resize(half);
+
+    int bits = 0;
+    while ((1 << bits) < half)
+        ++bits;
+    m_bitReverse.resize(half);
+    for (int i = 0; i < half; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b)
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        m_bitReverse[i] = reversed;
+    }
+
+    // The twiddles of the stage with n butterflies per block start at n - 1
+    m_twiddleRe.resize(qMax(1, half - 1));
+    m_twiddleIm.resize(qMax(1, half - 1));
+    for (int n = 1; n < half; n *= 2) {
+        for (int j = 0; j < n; ++j) {
+            const double angle = -M_PI * j / n;
+            m_twiddleRe[n - 1 + j] = float(qCos(angle));
+            m_twiddleIm[n - 1 + j] = float(qSin(angle));
+        }
+    }
+
+    m_splitRe.resize(half + 1);
+    m_splitIm.resize(half + 1);
+    for (int k = 0; k <= half; ++k) {
+        const double angle = -2 * M_PI * k / size;
+        m_splitRe[k] = float(qCos(angle));
+        m_splitIm[k] = float(qSin(angle));
+    }
+}
+
+void QAudioFft::magnitudes(const float *input, float *output)
+{
+    Q_ASSERT(m_size > 0);
+    const int half = m_size / 2;
+    float *re = m_re.data();
+    float *im = m_im.data();
+    const int *bitReverse = m_bitReverse.constData();
+
+    for (int i = 0; i < half; ++i) {
+        re[bitReverse[i]] = input[2 * i];
+        im[bitReverse[i]] = input[2 * i + 1];
+    }
+
+    const float *twiddleRe = m_twiddleRe.constData();
+    const float *twiddleIm = m_twiddleIm.constData();
+    for (int n = 1; n < half; n *= 2) {
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+        if (n >= 4 && qCpuHasFeature(SSE2)) {
+            QAudioHelperInternal::qt_fft_butterflies_sse2(re, im, twiddleRe + n - 1, twiddleIm + n - 1,
+                                                          half, n);
+            continue;
+        }
+#endif
+        QAudioHelperInternal::qt_fft_butterflies_c(re, im, twiddleRe + n - 1, twiddleIm + n - 1,
+                                                   half, n);
+    }
+
+    // Separate the spectra of the even and odd samples and combine them:
+    // X[k] = E[k] + W^k O[k], with E and O from Z[k] and conj(Z[half - k])
+    const float *splitRe = m_splitRe.constData();
+    const float *splitIm = m_splitIm.constData();
+    for (int k = 0; k <= half; ++k) {
+        const int a = k == half ? 0 : k;
+        const int b = k == 0 ? 0 : half - k;
+        const float evenRe = 0.5f * (re[a] + re[b]);
+        const float evenIm = 0.5f * (im[a] - im[b]);
+        const float oddRe = 0.5f * (im[a] + im[b]);
+        const float oddIm = -0.5f * (re[a] - re[b]);
+        const float xr = evenRe + splitRe[k] * oddRe - splitIm[k] * oddIm;
+        const float xi = evenIm + splitRe[k] * oddIm + splitIm[k] * oddRe;
+        output[k] = qSqrt(xr * xr + xi * xi);
+    }
+}
+
+QT_END_NAMESPACE
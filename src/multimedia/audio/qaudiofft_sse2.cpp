@@ -0,0 +1,82 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qaudiofft_p.h"
+#include <private/qsimd_p.h>
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal
+{
+
+void QT_FASTCALL qt_fft_butterflies_sse2(float *re, float *im, const float *twiddleRe,
+                                         const float *twiddleIm, int size, int half)
+{
+    // half is a power of two of at least 4, so blocks split into whole vectors
+    Q_ASSERT(half >= 4 && half % 4 == 0);
+
+    for (int i = 0; i < size; i += 2 * half) {
+        float *re0 = re + i;
+        float *im0 = im + i;
+        float *re1 = re0 + half;
+        float *im1 = im0 + half;
+        for (int j = 0; j < half; j += 4) {
+            const __m128 wr = _mm_loadu_ps(twiddleRe + j);
+            const __m128 wi = _mm_loadu_ps(twiddleIm + j);
+            const __m128 br = _mm_loadu_ps(re1 + j);
+            const __m128 bi = _mm_loadu_ps(im1 + j);
+            const __m128 tr = _mm_sub_ps(_mm_mul_ps(wr, br), _mm_mul_ps(wi, bi));
+            const __m128 ti = _mm_add_ps(_mm_mul_ps(wr, bi), _mm_mul_ps(wi, br));
+            const __m128 ar = _mm_loadu_ps(re0 + j);
+            const __m128 ai = _mm_loadu_ps(im0 + j);
+            _mm_storeu_ps(re1 + j, _mm_sub_ps(ar, tr));
+            _mm_storeu_ps(im1 + j, _mm_sub_ps(ai, ti));
+            _mm_storeu_ps(re0 + j, _mm_add_ps(ar, tr));
+            _mm_storeu_ps(im0 + j, _mm_add_ps(ai, ti));
+        }
+    }
+}
+
+}
+
+QT_END_NAMESPACE
+
+#endif
@@ -40,6 +40,10 @@
 #include "qaudiohelpers_p.h"
 
 #include <QDebug>
+#include <QtCore/qendian.h>
+#include <private/qsimd_p.h>
+
+#include <string.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -110,6 +114,225 @@ void qMultiplySamples(qreal factor, const QAudioFormat &format, const void* src,
             QAudioHelperInternal::adjustSamples<float>(factor,src,dest,samplesCount);
     }
 }
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+void QT_FASTCALL qt_convert_int16_to_float_sse2(const qint16 *src, float *dest, int samples);
+void QT_FASTCALL qt_accumulate_levels_sse2(const float *src, int frames, int channels,
+                                           float *minimum, float *maximum, float *sumOfSquares);
+void QT_FASTCALL qt_deinterleave_stereo16_sse2(const quint16 *src, quint16 *left, quint16 *right, int frames);
+void QT_FASTCALL qt_deinterleave_stereo32_sse2(const quint32 *src, quint32 *left, quint32 *right, int frames);
+void QT_FASTCALL qt_interleave_stereo16_sse2(const quint16 *left, const quint16 *right, quint16 *dest, int frames);
+void QT_FASTCALL qt_interleave_stereo32_sse2(const quint32 *left, const quint32 *right, quint32 *dest, int frames);
+#endif
+
+template<class T> inline T loadSample(const uchar *src, bool littleEndian)
+{
+    return littleEndian ? qFromLittleEndian<T>(src) : qFromBigEndian<T>(src);
+}
+
+template<> inline qint8 loadSample<qint8>(const uchar *src, bool)
+{
+    return qint8(*src);
+}
+
+template<> inline quint8 loadSample<quint8>(const uchar *src, bool)
+{
+    return *src;
+}
+
+template<class T> void convertSignedToFloat(const void *src, float *dest, int samples, bool littleEndian)
+{
+    const float scale = 1.0f / float(quint64(1) << (sizeof(T) * 8 - 1));
+    const uchar *pSrc = static_cast<const uchar *>(src);
+    for (int i = 0; i < samples; ++i, pSrc += sizeof(T))
+        dest[i] = float(loadSample<T>(pSrc, littleEndian)) * scale;
+}
+
+template<class T> void convertUnsignedToFloat(const void *src, float *dest, int samples, bool littleEndian)
+{
+    const float scale = 1.0f / float(signedVersion<T>::offset);
+    const uchar *pSrc = static_cast<const uchar *>(src);
+    for (int i = 0; i < samples; ++i, pSrc += sizeof(T))
+        dest[i] = (float(loadSample<T>(pSrc, littleEndian)) - float(signedVersion<T>::offset)) * scale;
+}
+
+static void convertFloatToFloat(const void *src, float *dest, int samples, bool littleEndian)
+{
+    const uchar *pSrc = static_cast<const uchar *>(src);
+    for (int i = 0; i < samples; ++i, pSrc += sizeof(float)) {
+        const quint32 bits = loadSample<quint32>(pSrc, littleEndian);
+        memcpy(dest + i, &bits, sizeof(float));
+    }
+}
+
+bool qConvertSamplesToFloat(const QAudioFormat &format, const void *src, float *dest, int samples)
+{
+    const bool littleEndian = format.byteOrder() == QAudioFormat::LittleEndian;
+    const bool nativeEndian = littleEndian == (Q_BYTE_ORDER == Q_LITTLE_ENDIAN);
+
+    switch (format.sampleSize()) {
+    case 8:
+        if (format.sampleType() == QAudioFormat::SignedInt)
+            convertSignedToFloat<qint8>(src, dest, samples, littleEndian);
+        else if (format.sampleType() == QAudioFormat::UnSignedInt)
+            convertUnsignedToFloat<quint8>(src, dest, samples, littleEndian);
+        else
+            return false;
+        return true;
+    case 16:
+        if (format.sampleType() == QAudioFormat::SignedInt) {
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+            if (nativeEndian && qCpuHasFeature(SSE2)) {
+                qt_convert_int16_to_float_sse2(static_cast<const qint16 *>(src), dest, samples);
+                return true;
+            }
+#endif
+            convertSignedToFloat<qint16>(src, dest, samples, littleEndian);
+        } else if (format.sampleType() == QAudioFormat::UnSignedInt) {
+            convertUnsignedToFloat<quint16>(src, dest, samples, littleEndian);
+        } else {
+            return false;
+        }
+        return true;
+    case 32:
+        if (format.sampleType() == QAudioFormat::SignedInt) {
+            convertSignedToFloat<qint32>(src, dest, samples, littleEndian);
+        } else if (format.sampleType() == QAudioFormat::UnSignedInt) {
+            convertUnsignedToFloat<quint32>(src, dest, samples, littleEndian);
+        } else if (format.sampleType() == QAudioFormat::Float) {
+            if (nativeEndian)
+                memcpy(dest, src, samples * sizeof(float));
+            else
+                convertFloatToFloat(src, dest, samples, littleEndian);
+        } else {
+            return false;
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+void qAccumulateLevels(const float *src, int frames, int channels,
+                       float *minimum, float *maximum, float *sumOfSquares)
+{
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+    // Four lanes hold whole frames for these layouts
+    if ((channels == 1 || channels == 2 || channels == 4) && qCpuHasFeature(SSE2)) {
+        qt_accumulate_levels_sse2(src, frames, channels, minimum, maximum, sumOfSquares);
+        return;
+    }
+#endif
+
+    for (int i = 0; i < frames; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            const float value = *src++;
+            minimum[c] = qMin(minimum[c], value);
+            maximum[c] = qMax(maximum[c], value);
+            sumOfSquares[c] += value * value;
+        }
+    }
+}
+
+template<class T> void deinterleaveSamples(const void *src, void *const *planes, int frames, int channels)
+{
+    const T *pSrc = static_cast<const T *>(src);
+    for (int c = 0; c < channels; ++c) {
+        T *plane = static_cast<T *>(planes[c]);
+        for (int i = 0; i < frames; ++i)
+            plane[i] = pSrc[i * channels + c];
+    }
+}
+
+template<class T> void interleaveSamples(const void *const *planes, void *dest, int frames, int channels)
+{
+    T *pDest = static_cast<T *>(dest);
+    for (int c = 0; c < channels; ++c) {
+        const T *plane = static_cast<const T *>(planes[c]);
+        for (int i = 0; i < frames; ++i)
+            pDest[i * channels + c] = plane[i];
+    }
+}
+
+void qDeinterleaveSamples(const void *src, void *const *planes, int frames, int channels, int sampleBytes)
+{
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+    if (channels == 2 && qCpuHasFeature(SSE2)) {
+        if (sampleBytes == 2) {
+            qt_deinterleave_stereo16_sse2(static_cast<const quint16 *>(src),
+                                          static_cast<quint16 *>(planes[0]),
+                                          static_cast<quint16 *>(planes[1]), frames);
+            return;
+        }
+        if (sampleBytes == 4) {
+            qt_deinterleave_stereo32_sse2(static_cast<const quint32 *>(src),
+                                          static_cast<quint32 *>(planes[0]),
+                                          static_cast<quint32 *>(planes[1]), frames);
+            return;
+        }
+    }
+#endif
+
+    switch (sampleBytes) {
+    case 1:
+        deinterleaveSamples<quint8>(src, planes, frames, channels);
+        break;
+    case 2:
+        deinterleaveSamples<quint16>(src, planes, frames, channels);
+        break;
+    case 4:
+        deinterleaveSamples<quint32>(src, planes, frames, channels);
+        break;
+    default: {
+        const uchar *pSrc = static_cast<const uchar *>(src);
+        for (int i = 0; i < frames; ++i) {
+            for (int c = 0; c < channels; ++c, pSrc += sampleBytes)
+                memcpy(static_cast<uchar *>(planes[c]) + i * sampleBytes, pSrc, sampleBytes);
+        }
+        break;
+    }
+    }
+}
+
+void qInterleaveSamples(const void *const *planes, void *dest, int frames, int channels, int sampleBytes)
+{
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+    if (channels == 2 && qCpuHasFeature(SSE2)) {
+        if (sampleBytes == 2) {
+            qt_interleave_stereo16_sse2(static_cast<const quint16 *>(planes[0]),
+                                        static_cast<const quint16 *>(planes[1]),
+                                        static_cast<quint16 *>(dest), frames);
+            return;
+        }
+        if (sampleBytes == 4) {
+            qt_interleave_stereo32_sse2(static_cast<const quint32 *>(planes[0]),
+                                        static_cast<const quint32 *>(planes[1]),
+                                        static_cast<quint32 *>(dest), frames);
+            return;
+        }
+    }
+#endif
+
+    switch (sampleBytes) {
+    case 1:
+        interleaveSamples<quint8>(planes, dest, frames, channels);
+        break;
+    case 2:
+        interleaveSamples<quint16>(planes, dest, frames, channels);
+        break;
+    case 4:
+        interleaveSamples<quint32>(planes, dest, frames, channels);
+        break;
+    default: {
+        uchar *pDest = static_cast<uchar *>(dest);
+        for (int i = 0; i < frames; ++i) {
+            for (int c = 0; c < channels; ++c, pDest += sampleBytes)
+                memcpy(pDest, static_cast<const uchar *>(planes[c]) + i * sampleBytes, sampleBytes);
+        }
+        break;
+    }
+    }
+}
 }
 
 QT_END_NAMESPACE
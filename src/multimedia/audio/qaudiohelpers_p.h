@@ -52,12 +52,58 @@
 //
 
 #include <qaudioformat.h>
+#include <QtCore/qatomic.h>
+
+#include <string.h>
 
 QT_BEGIN_NAMESPACE
 
 namespace QAudioHelperInternal
 {
 Q_MULTIMEDIA_EXPORT void qMultiplySamples(qreal factor, const QAudioFormat& format, const void *src, void* dest, int len);
+
+// Converts samples interleaved samples to floats in the range [-1, 1].
+// Returns false if the sample format is not supported.
+Q_MULTIMEDIA_EXPORT bool qConvertSamplesToFloat(const QAudioFormat &format, const void *src, float *dest, int samples);
+
+// Folds frames of interleaved floats into the per channel minimum, maximum
+// and sum of squares, which are updated in place.
+Q_MULTIMEDIA_EXPORT void qAccumulateLevels(const float *src, int frames, int channels,
+                                           float *minimum, float *maximum, float *sumOfSquares);
+
+// Copies frames of interleaved samples, each sampleBytes wide, into one plane
+// per channel, and back.  Samples are moved bit for bit.
+Q_MULTIMEDIA_EXPORT void qDeinterleaveSamples(const void *src, void *const *planes,
+                                              int frames, int channels, int sampleBytes);
+Q_MULTIMEDIA_EXPORT void qInterleaveSamples(const void *const *planes, void *dest,
+                                            int frames, int channels, int sampleBytes);
+
+// A volume set on the owner thread and applied by an audio thread. It is
+// kept as the bits of a float, so neither side ever waits for the other.
+class AtomicVolume
+{
+public:
+    AtomicVolume(qreal volume = 1.0) { store(volume); }
+
+    void store(qreal volume)
+    {
+        const float value = float(volume);
+        quint32 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        m_bits.store(bits);
+    }
+
+    qreal load() const
+    {
+        const quint32 bits = m_bits.load();
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+private:
+    QAtomicInteger<quint32> m_bits;
+};
 }
 
 QT_END_NAMESPACE
@@ -0,0 +1,191 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qaudiohelpers_p.h"
+#include <private/qsimd_p.h>
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal
+{
+
+void QT_FASTCALL qt_convert_int16_to_float_sse2(const qint16 *src, float *dest, int samples)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+
+    int i = 0;
+    for (; i < samples - 7; i += 8) {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        // Sign extend to 32 bit by shifting the samples into the high halves
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(data, data), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(data, data), 16);
+        _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+
+    // leftovers
+    for (; i < samples; ++i)
+        dest[i] = float(src[i]) * (1.0f / 32768.0f);
+}
+
+void QT_FASTCALL qt_accumulate_levels_sse2(const float *src, int frames, int channels,
+                                           float *minimum, float *maximum, float *sumOfSquares)
+{
+    // channels is 1, 2 or 4, so lane n always carries channel n % channels
+    Q_ASSERT(channels == 1 || channels == 2 || channels == 4);
+
+    float lanes[4];
+    for (int n = 0; n < 4; ++n)
+        lanes[n] = minimum[n % channels];
+    __m128 vmin = _mm_loadu_ps(lanes);
+    for (int n = 0; n < 4; ++n)
+        lanes[n] = maximum[n % channels];
+    __m128 vmax = _mm_loadu_ps(lanes);
+    __m128 vsum = _mm_setzero_ps();
+
+    const int samples = frames * channels;
+    int i = 0;
+    for (; i < samples - 3; i += 4) {
+        const __m128 value = _mm_loadu_ps(src + i);
+        vmin = _mm_min_ps(vmin, value);
+        vmax = _mm_max_ps(vmax, value);
+        vsum = _mm_add_ps(vsum, _mm_mul_ps(value, value));
+    }
+
+    _mm_storeu_ps(lanes, vmin);
+    for (int n = 0; n < 4; ++n)
+        minimum[n % channels] = qMin(minimum[n % channels], lanes[n]);
+    _mm_storeu_ps(lanes, vmax);
+    for (int n = 0; n < 4; ++n)
+        maximum[n % channels] = qMax(maximum[n % channels], lanes[n]);
+    _mm_storeu_ps(lanes, vsum);
+    for (int n = 0; n < 4; ++n)
+        sumOfSquares[n % channels] += lanes[n];
+
+    // leftovers, the vector loop always stops at a frame boundary
+    for (int c = 0; i < samples; ++i, c = (c + 1) % channels) {
+        const float value = src[i];
+        minimum[c] = qMin(minimum[c], value);
+        maximum[c] = qMax(maximum[c], value);
+        sumOfSquares[c] += value * value;
+    }
+}
+
+void QT_FASTCALL qt_deinterleave_stereo16_sse2(const quint16 *src, quint16 *left, quint16 *right, int frames)
+{
+    int i = 0;
+    for (; i < frames - 7; i += 8) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i + 8));
+        // Sign extend each half of the 32 bit frames so the saturating pack is exact
+        const __m128i leftA = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        const __m128i leftB = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        const __m128i rightA = _mm_srai_epi32(a, 16);
+        const __m128i rightB = _mm_srai_epi32(b, 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(left + i), _mm_packs_epi32(leftA, leftB));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(right + i), _mm_packs_epi32(rightA, rightB));
+    }
+
+    // leftovers
+    for (; i < frames; ++i) {
+        left[i] = src[2 * i];
+        right[i] = src[2 * i + 1];
+    }
+}
+
+void QT_FASTCALL qt_deinterleave_stereo32_sse2(const quint32 *src, quint32 *left, quint32 *right, int frames)
+{
+    // Samples are only moved, so the float shuffles serve any 32 bit type
+    const float *pSrc = reinterpret_cast<const float *>(src);
+    int i = 0;
+    for (; i < frames - 3; i += 4) {
+        const __m128 a = _mm_loadu_ps(pSrc + 2 * i);
+        const __m128 b = _mm_loadu_ps(pSrc + 2 * i + 4);
+        _mm_storeu_ps(reinterpret_cast<float *>(left + i), _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(reinterpret_cast<float *>(right + i), _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+
+    // leftovers
+    for (; i < frames; ++i) {
+        left[i] = src[2 * i];
+        right[i] = src[2 * i + 1];
+    }
+}
+
+void QT_FASTCALL qt_interleave_stereo16_sse2(const quint16 *left, const quint16 *right, quint16 *dest, int frames)
+{
+    int i = 0;
+    for (; i < frames - 7; i += 8) {
+        const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(left + i));
+        const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(right + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + 2 * i), _mm_unpacklo_epi16(l, r));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + 2 * i + 8), _mm_unpackhi_epi16(l, r));
+    }
+
+    // leftovers
+    for (; i < frames; ++i) {
+        dest[2 * i] = left[i];
+        dest[2 * i + 1] = right[i];
+    }
+}
+
+void QT_FASTCALL qt_interleave_stereo32_sse2(const quint32 *left, const quint32 *right, quint32 *dest, int frames)
+{
+    int i = 0;
+    for (; i < frames - 3; i += 4) {
+        const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(left + i));
+        const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(right + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + 2 * i), _mm_unpacklo_epi32(l, r));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + 2 * i + 4), _mm_unpackhi_epi32(l, r));
+    }
+
+    // leftovers
+    for (; i < frames; ++i) {
+        dest[2 * i] = left[i];
+        dest[2 * i + 1] = right[i];
+    }
+}
+
+}
+
+QT_END_NAMESPACE
+
+#endif
@@ -44,9 +44,23 @@
 #include "qaudioinput.h"
 
 #include "qaudiodevicefactory_p.h"
+#include "qaudiosystemext_p.h"
+#include "qaudioloudnessmeter_p.h"
 
 QT_BEGIN_NAMESPACE
 
+// Null for backends that only implement QAbstractAudioInput
+static QAudioInputExtension *inputExtension(QAbstractAudioInput *d)
+{
+    return qobject_cast<QAudioInputExtension *>(d);
+}
+
+static QAudioLoudnessMeter *loudnessMeter(QAbstractAudioInput *d)
+{
+    QAudioInputExtension *ext = inputExtension(d);
+    return ext ? ext->loudnessMeter() : Q_NULLPTR;
+}
+
 /*!
     \class QAudioInput
     \brief The QAudioInput class provides an interface for receiving audio data from an audio input device.
@@ -123,6 +137,8 @@ QAudioInput::QAudioInput(const QAudioFormat &format, QObject *parent):
     d = QAudioDeviceFactory::createDefaultInputDevice(format);
     connect(d, SIGNAL(notify()), SIGNAL(notify()));
     connect(d, SIGNAL(stateChanged(QAudio::State)), SIGNAL(stateChanged(QAudio::State)));
+    if (QAudioLoudnessMeter *meter = loudnessMeter(d))
+        connect(meter, SIGNAL(loudnessChanged(QAudioLoudness)), SIGNAL(loudnessChanged(QAudioLoudness)));
 }
 
 /*!
@@ -137,6 +153,8 @@ QAudioInput::QAudioInput(const QAudioDeviceInfo &audioDevice, const QAudioFormat
     d = QAudioDeviceFactory::createInputDevice(audioDevice, format);
     connect(d, SIGNAL(notify()), SIGNAL(notify()));
     connect(d, SIGNAL(stateChanged(QAudio::State)), SIGNAL(stateChanged(QAudio::State)));
+    if (QAudioLoudnessMeter *meter = loudnessMeter(d))
+        connect(meter, SIGNAL(loudnessChanged(QAudioLoudness)), SIGNAL(loudnessChanged(QAudioLoudness)));
 }
 
 /*!
@@ -191,6 +209,40 @@ QIODevice* QAudioInput::start()
     return d->start();
 }
 
+/*!
+    \since 5.11
+
+    Starts the input in callback mode.  Instead of writing to a QIODevice,
+    the input calls \a callback with \a userData for every period of
+    captured audio, passing exactly periodSize() bytes that are only valid
+    during the call.
+
+    Where the backend supports it, the callback runs on its audio thread,
+    without a round trip through the thread that owns this QAudioInput.
+    The callback must therefore not allocate memory, take locks or block,
+    and any state it shares with the rest of the application has to be
+    exchanged without locking, for example through atomics or lock free
+    queues.  Backends without an audio thread call it from the thread of
+    this QAudioInput instead.
+
+    The callback is not called anymore once stop() returns.
+
+    If a problem occurs, error() returns QAudio::OpenError, state() returns
+    QAudio::StoppedState and the stateChanged() signal is emitted.
+
+    \sa QAudio::CaptureCallback, periodSize()
+*/
+void QAudioInput::start(QAudio::CaptureCallback callback, void *userData)
+{
+    if (!callback) {
+        qWarning("QAudioInput::start: no capture callback");
+        return;
+    }
+    QAudioInputExtension *ext = inputExtension(d);
+    if (!ext || !ext->startCallback(callback, userData))
+        qt_startAudioCallback(d, callback, userData);
+}
+
 /*!
     Returns the QAudioFormat being used.
 */
@@ -304,6 +356,202 @@ int QAudioInput::periodSize() const
     return d->periodSize();
 }
 
+/*!
+    \since 5.11
+
+    Reads the next chunk of captured audio data, usually one period, and
+    returns it as a QAudioBuffer. Only valid after start() was called
+    without a device, as an alternative to reading from the returned
+    QIODevice.
+
+    The buffer's \l{QAudioBuffer::startTime()}{startTime()} is the capture
+    time of its first frame in microseconds, taken from the hardware where
+    possible. It is on the same monotonic clock as QElapsedTimer, so it can
+    be used to line up captured audio with other media.
+
+    Returns an invalid QAudioBuffer if no data is available, or if the
+    backend does not support timestamped reads.
+
+    \note The buffer may refer directly to the memory the backend captured
+    into, rather than to a copy. While it, or any copy of the QAudioBuffer,
+    is alive, capture stalls: further calls return invalid buffers and the
+    device may overrun. Release the buffer before reading the next one, and
+    copy the samples out if they have to be kept longer.
+
+    \sa bytesReady(), periodSize()
+*/
+
+QAudioBuffer QAudioInput::readBuffer()
+{
+    QAudioInputExtension *ext = inputExtension(d);
+    return ext ? ext->readBuffer() : QAudioBuffer();
+}
+
+/*!
+    \since 5.11
+
+    Requests an end-to-end latency of \a microseconds, i.e. the time between a sample being captured and it becoming available to read.
+    The backend translates this into its own buffering parameters
+    instead of its defaults, so there is no need to tune setBufferSize()
+    per platform for low latency use.
+
+    Zero, the default, leaves the latency up to the backend.
+
+    \note Like setBufferSize(), this takes effect on the next start().
+    The backend may not be able to honor the request exactly; call
+    latency() after start() for the latency actually configured.
+
+    \sa latency()
+*/
+void QAudioInput::setTargetLatency(qint64 microseconds)
+{
+    if (QAudioInputExtension *ext = inputExtension(d))
+        ext->setTargetLatency(qMax<qint64>(0, microseconds));
+}
+
+/*!
+    \since 5.11
+
+    Returns the latency requested with setTargetLatency(), in microseconds,
+    or zero if the backend does not support requesting a latency.
+*/
+qint64 QAudioInput::targetLatency() const
+{
+    QAudioInputExtension *ext = inputExtension(d);
+    return ext ? ext->targetLatency() : 0;
+}
+
+/*!
+    \since 5.11
+
+    Returns the latency in microseconds the backend configured on start(),
+    or -1 if it is not known.
+
+    \sa setTargetLatency()
+*/
+qint64 QAudioInput::latency() const
+{
+    QAudioInputExtension *ext = inputExtension(d);
+    return ext ? ext->latency() : -1;
+}
+
+/*!
+    \since 5.11
+
+    Returns instrumentation collected by the backend since the last start(),
+    or an empty map if the backend does not collect any.
+
+    The map contains:
+    \table
+    \header \li Key \li Value
+    \row \li \c underruns \li Number of times the device was read from while empty.
+    \row \li \c overruns \li Number of times captured audio had to be dropped because the buffer was full.
+    \row \li \c bytes \li Bytes transferred from the device.
+    \row \li \c feedIntervalUs \li Histogram of the time between two transfers.
+    \row \li \c bytesFreeAtFeed \li Histogram of the audio ready to be read when a transfer began.
+    \row \li \c feedDurationUs \li Histogram of the time a transfer took.
+    \endtable
+
+    Each histogram is a QVariantMap with the \c count, \c min, \c max and
+    \c mean of the recorded values, and a \c buckets list in which entry \e n
+    counts the values in the range [2\sup{n}, 2\sup{n+1}), entry 0 also
+    counting zero.
+
+    The same figures are logged when the stream is closed if the
+    \c qt.multimedia.audio.stats logging category is enabled.
+*/
+QVariantMap QAudioInput::statistics() const
+{
+    QAudioInputExtension *ext = inputExtension(d);
+    return ext ? ext->statistics() : QVariantMap();
+}
+
+/*!
+    \since 5.11
+
+    Enables loudness metering of the audio read by the application, after the volume is applied
+    if \a enabled is true.
+
+    The meter measures momentary, short-term and integrated loudness and the
+    true peak as described by ITU-R BS.1770-4 and EBU R 128. It runs on the
+    thread that exchanges audio with the device. When started with a
+    callback, the audio thread only copies the audio aside and it is
+    measured on the thread of this object. The measurement restarts with
+    every start() and resetLoudness().
+
+    Metering is disabled by default. It is supported by the ALSA and
+    PulseAudio backends; isLoudnessMeteringEnabled() returns false on
+    others.
+
+    \sa loudness(), loudnessChanged()
+*/
+void QAudioInput::setLoudnessMeteringEnabled(bool enabled)
+{
+    if (QAudioLoudnessMeter *meter = loudnessMeter(d))
+        meter->setEnabled(enabled);
+}
+
+/*!
+    \since 5.11
+
+    Returns true if the loudness of the captured audio is measured.
+*/
+bool QAudioInput::isLoudnessMeteringEnabled() const
+{
+    QAudioLoudnessMeter *meter = loudnessMeter(d);
+    return meter && meter->isEnabled();
+}
+
+/*!
+    \since 5.11
+
+    Sets the interval of captured audio after which loudnessChanged() is
+    emitted to \a milliSeconds. The default is 100 milliseconds, 0 disables
+    the signal. The loudness is updated every 100 milliseconds, so shorter
+    intervals don't give more frequent measurements.
+*/
+void QAudioInput::setLoudnessNotifyInterval(int milliSeconds)
+{
+    if (QAudioLoudnessMeter *meter = loudnessMeter(d))
+        meter->setNotifyInterval(milliSeconds);
+}
+
+/*!
+    \since 5.11
+
+    Returns the interval of captured audio after which loudnessChanged() is
+    emitted, in milliseconds.
+*/
+int QAudioInput::loudnessNotifyInterval() const
+{
+    QAudioLoudnessMeter *meter = loudnessMeter(d);
+    return meter ? meter->notifyInterval() : 0;
+}
+
+/*!
+    \since 5.11
+
+    Returns the latest loudness measurement, or an invalid one if metering
+    isn't enabled or nothing has been measured yet.
+*/
+QAudioLoudness QAudioInput::loudness() const
+{
+    QAudioLoudnessMeter *meter = loudnessMeter(d);
+    return meter ? meter->loudness() : QAudioLoudness();
+}
+
+/*!
+    \since 5.11
+
+    Restarts the loudness measurement, discarding the integrated loudness
+    and the true peak measured so far.
+*/
+void QAudioInput::resetLoudness()
+{
+    if (QAudioLoudnessMeter *meter = loudnessMeter(d))
+        meter->reset();
+}
+
 /*!
     Sets the interval for notify() signal to be emitted.
     This is based on the \a ms of audio data processed
@@ -401,6 +649,16 @@ QAudio::State QAudioInput::state() const
     This signal is emitted when the device \a state has changed.
 */
 
+/*!
+    \fn QAudioInput::loudnessChanged(const QAudioLoudness &loudness)
+    \since 5.11
+
+    This signal is emitted with the current \a loudness every
+    loudnessNotifyInterval() of captured audio while loudness metering is enabled.
+
+    \sa setLoudnessMeteringEnabled()
+*/
+
 /*!
     \fn QAudioInput::notify()
     This signal is emitted when x ms of audio data has been processed
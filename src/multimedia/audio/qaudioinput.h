@@ -42,6 +42,7 @@
 #define QAUDIOINPUT_H
 
 #include <QtCore/qiodevice.h>
+#include <QtCore/qvariant.h>
 
 #include <QtMultimedia/qtmultimediaglobal.h>
 #include <QtMultimedia/qmultimedia.h>
@@ -49,6 +50,8 @@
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudioformat.h>
 #include <QtMultimedia/qaudiodeviceinfo.h>
+#include <QtMultimedia/qaudioloudness.h>
+#include <QtMultimedia/qaudiobuffer.h>
 
 
 QT_BEGIN_NAMESPACE
@@ -70,6 +73,7 @@ public:
 
     void start(QIODevice *device);
     QIODevice* start();
+    void start(QAudio::CaptureCallback callback, void *userData);
 
     void stop();
     void reset();
@@ -79,9 +83,23 @@ public:
     void setBufferSize(int bytes);
     int bufferSize() const;
 
+    void setTargetLatency(qint64 microseconds);
+    qint64 targetLatency() const;
+    qint64 latency() const;
+    QVariantMap statistics() const;
+
+    void setLoudnessMeteringEnabled(bool enabled);
+    bool isLoudnessMeteringEnabled() const;
+    void setLoudnessNotifyInterval(int milliSeconds);
+    int loudnessNotifyInterval() const;
+    QAudioLoudness loudness() const;
+    void resetLoudness();
+
     int bytesReady() const;
     int periodSize() const;
 
+    QAudioBuffer readBuffer();
+
     void setNotifyInterval(int milliSeconds);
     int notifyInterval() const;
 
@@ -97,6 +115,7 @@ public:
 Q_SIGNALS:
     void stateChanged(QAudio::State);
     void notify();
+    void loudnessChanged(const QAudioLoudness &loudness);
 
 private:
     Q_DISABLE_COPY(QAudioInput)
@@ -0,0 +1,249 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qaudiolevelreducer_p.h"
+#include "qaudiohelpers_p.h"
+#include "qaudiobuffer.h"
+
+#include <QtCore/qmath.h>
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+// Samples are converted to float in chunks of this many frames
+static const int ChunkFrames = 1024;
+
+// Timestamps further off than this from where the previous buffer ended
+// mark a seek or a gap. Smaller offsets are taken as rounding.
+static const qint64 DiscontinuityUs = 1000;
+
+/*
+    Reduces probed audio to per channel peak, RMS or min/max envelope values
+    over fixed windows. Reduction runs on the thread the backend probes buffers
+    on; finished windows are collected and handed to the owner's thread in
+    batches, so a late receiver gets every window instead of the latest one.
+    A batch only holds back to back windows of one channel layout, a new one
+    starts after a seek, a gap or a format change.
+*/
+QAudioLevelReducer::QAudioLevelReducer(QObject *parent)
+    : QObject(parent)
+    , m_mode(QAudioProbe::PeakReduction)
+    , m_window(50)
+    , m_windowFrames(0)
+    , m_framesInWindow(0)
+    , m_windowStart(0)
+    , m_expectedStart(-1)
+    , m_pendingChannels(0)
+    , m_pendingStart(-1)
+    , m_deliveryQueued(false)
+{
+    qRegisterMetaType<QVector<float> >();
+}
+
+QAudioLevelReducer::~QAudioLevelReducer()
+{
+}
+
+void QAudioLevelReducer::setMode(QAudioProbe::ReductionMode mode)
+{
+    QMutexLocker locker(&m_mutex);
+    m_mode = mode;
+    m_format = QAudioFormat();
+    m_closed.clear();
+    m_pending.clear();
+}
+
+void QAudioLevelReducer::setWindow(int msecs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_window = qMax(1, msecs);
+    m_format = QAudioFormat();
+    m_closed.clear();
+    m_pending.clear();
+}
+
+void QAudioLevelReducer::audioBufferProbed(const QAudioBuffer &buffer)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const QAudioFormat format = buffer.format();
+    const int channels = format.channelCount();
+    if (channels <= 0 || format.bytesPerFrame() <= 0)
+        return;
+
+    if (format != m_format) {
+        // The running window is dropped, so the batch doesn't continue
+        closeBatch();
+
+        m_format = format;
+        m_windowFrames = qMax(1, int(qint64(format.sampleRate()) * m_window / 1000));
+        m_minimum.resize(channels);
+        m_maximum.resize(channels);
+        m_sumOfSquares.resize(channels);
+        m_chunkSums.resize(channels);
+        m_scratch.resize(ChunkFrames * channels);
+        m_windowStart = buffer.startTime() >= 0 ? buffer.startTime() : 0;
+        m_expectedStart = -1;
+        resetWindow();
+    }
+
+    const int bytesPerFrame = format.bytesPerFrame();
+    const char *data = buffer.constData<char>();
+    const int frameCount = buffer.frameCount();
+
+    if (buffer.startTime() >= 0) {
+        if (m_expectedStart >= 0 && qAbs(buffer.startTime() - m_expectedStart) > DiscontinuityUs) {
+            // The running window ends early, windows after the jump start a new batch
+            if (m_framesInWindow > 0)
+                finishWindow();
+            closeBatch();
+        }
+        m_expectedStart = buffer.startTime() + format.durationForFrames(frameCount);
+    } else {
+        m_expectedStart = -1;
+    }
+
+    int offset = 0;
+    while (offset < frameCount) {
+        const int frames = qMin(qMin(frameCount - offset, ChunkFrames),
+                                m_windowFrames - m_framesInWindow);
+
+        // Prefer the backend's timestamps, they account for gaps and seeks
+        if (m_framesInWindow == 0 && buffer.startTime() >= 0)
+            m_windowStart = buffer.startTime() + format.durationForFrames(offset);
+
+        if (!QAudioHelperInternal::qConvertSamplesToFloat(format, data + offset * bytesPerFrame,
+                                                          m_scratch.data(), frames * channels)) {
+            return;
+        }
+
+        m_chunkSums.fill(0.0f);
+        QAudioHelperInternal::qAccumulateLevels(m_scratch.constData(), frames, channels,
+                                                m_minimum.data(), m_maximum.data(),
+                                                m_chunkSums.data());
+        for (int c = 0; c < channels; ++c)
+            m_sumOfSquares[c] += m_chunkSums.at(c);
+
+        m_framesInWindow += frames;
+        offset += frames;
+
+        if (m_framesInWindow == m_windowFrames)
+            finishWindow();
+    }
+
+    if (!m_pending.isEmpty() || !m_closed.isEmpty())
+        queueDelivery();
+}
+
+void QAudioLevelReducer::resetWindow()
+{
+    m_framesInWindow = 0;
+    m_minimum.fill(std::numeric_limits<float>::max());
+    m_maximum.fill(-std::numeric_limits<float>::max());
+    m_sumOfSquares.fill(0.0);
+}
+
+void QAudioLevelReducer::finishWindow()
+{
+    const int channels = m_format.channelCount();
+
+    if (m_pending.isEmpty()) {
+        m_pendingChannels = channels;
+        m_pendingStart = m_windowStart;
+    }
+
+    switch (m_mode) {
+    case QAudioProbe::PeakReduction:
+        for (int c = 0; c < channels; ++c)
+            m_pending.append(qMax(qAbs(m_minimum.at(c)), qAbs(m_maximum.at(c))));
+        break;
+    case QAudioProbe::RmsReduction:
+        for (int c = 0; c < channels; ++c)
+            m_pending.append(float(qSqrt(m_sumOfSquares.at(c) / m_framesInWindow)));
+        break;
+    case QAudioProbe::EnvelopeReduction:
+        for (int c = 0; c < channels; ++c) {
+            m_pending.append(m_minimum.at(c));
+            m_pending.append(m_maximum.at(c));
+        }
+        break;
+    case QAudioProbe::NoReduction:
+        break;
+    }
+
+    m_windowStart += m_format.durationForFrames(m_framesInWindow);
+    resetWindow();
+}
+
+void QAudioLevelReducer::closeBatch()
+{
+    if (m_pending.isEmpty())
+        return;
+
+    const Batch batch = { m_pending, m_pendingChannels, m_pendingStart };
+    m_closed.append(batch);
+    m_pending.clear();
+}
+
+void QAudioLevelReducer::queueDelivery()
+{
+    if (!m_deliveryQueued) {
+        m_deliveryQueued = true;
+        QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+    }
+}
+
+void QAudioLevelReducer::deliver()
+{
+    QVector<Batch> batches;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_deliveryQueued = false;
+        closeBatch();
+        batches.swap(m_closed);
+    }
+
+    for (const Batch &batch : qAsConst(batches))
+        emit levelsReady(batch.levels, batch.channels, batch.startTime);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qaudiolevelreducer_p.cpp"
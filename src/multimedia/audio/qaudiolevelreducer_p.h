@@ -0,0 +1,122 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QAUDIOLEVELREDUCER_P_H
+#define QAUDIOLEVELREDUCER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <qtmultimediaglobal.h>
+#include <qaudioformat.h>
+#include <qaudioprobe.h>
+#include <private/qmediaaudioprobecontrol_p.h>
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+class Q_MULTIMEDIA_EXPORT QAudioLevelReducer : public QObject, public QAudioProbeListener
+{
+    Q_OBJECT
+public:
+    explicit QAudioLevelReducer(QObject *parent = Q_NULLPTR);
+    ~QAudioLevelReducer();
+
+    void setMode(QAudioProbe::ReductionMode mode);
+    void setWindow(int msecs);
+
+    // Called on the streaming thread
+    void audioBufferProbed(const QAudioBuffer &buffer) override;
+
+Q_SIGNALS:
+    void levelsReady(const QVector<float> &levels, int channelCount, qint64 startTime);
+
+private Q_SLOTS:
+    void deliver();
+
+private:
+    void resetWindow();
+    void finishWindow();
+    void closeBatch();
+    void queueDelivery();
+
+    struct Batch
+    {
+        QVector<float> levels;
+        int channels;
+        qint64 startTime;
+    };
+
+    QMutex m_mutex;
+    QAudioProbe::ReductionMode m_mode;
+    int m_window;
+
+    QAudioFormat m_format;
+    int m_windowFrames;
+    int m_framesInWindow;
+    qint64 m_windowStart;
+    qint64 m_expectedStart;
+    QVector<float> m_minimum;
+    QVector<float> m_maximum;
+    QVector<double> m_sumOfSquares;
+    QVector<float> m_chunkSums;
+    QVector<float> m_scratch;
+
+    // Windows of a batch are contiguous, closed batches wait for deliver()
+    QVector<Batch> m_closed;
+    QVector<float> m_pending;
+    int m_pendingChannels;
+    qint64 m_pendingStart;
+    bool m_deliveryQueued;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIOLEVELREDUCER_P_H
@@ -0,0 +1,246 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <QDebug>
+#include <qaudioloudness.h>
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+static void qRegisterAudioLoudnessMetaTypes()
+{
+    qRegisterMetaType<QAudioLoudness>();
+}
+
+Q_CONSTRUCTOR_FUNCTION(qRegisterAudioLoudnessMetaTypes)
+
+class QAudioLoudnessPrivate : public QSharedData
+{
+public:
+    QAudioLoudnessPrivate()
+        : momentary(-std::numeric_limits<qreal>::infinity())
+        , shortTerm(-std::numeric_limits<qreal>::infinity())
+        , integrated(-std::numeric_limits<qreal>::infinity())
+        , truePeak(-std::numeric_limits<qreal>::infinity())
+        , duration(0)
+    {
+    }
+
+    qreal momentary;
+    qreal shortTerm;
+    qreal integrated;
+    qreal truePeak;
+    qint64 duration;
+};
+
+/*!
+    \class QAudioLoudness
+    \brief The QAudioLoudness class holds loudness and true peak measurements
+    of an audio stream.
+    \since 5.11
+
+    \inmodule QtMultimedia
+    \ingroup multimedia
+    \ingroup multimedia_audio
+
+    The measurements follow ITU-R BS.1770-4 and EBU R 128: the audio is
+    K-weighted and the channels are summed with their weights, ignoring the
+    LFE channel of a 5.1 stream.
+
+    \table
+        \header
+            \li Measurement
+            \li Description
+        \row
+            \li Momentary
+            \li Loudness of the last 400 milliseconds, in LUFS.
+        \row
+            \li Short-term
+            \li Loudness of the last 3 seconds, in LUFS.
+        \row
+            \li Integrated
+            \li Gated loudness of everything measured since the meter was
+               reset, in LUFS.
+        \row
+            \li True peak
+            \li Maximum of the four times oversampled signal since the meter
+               was reset, in dBTP.
+    \endtable
+
+    Loudness that hasn't been measured yet, or that is below the absolute
+    gate of -70 LUFS, is reported as negative infinity. Silence has a true
+    peak of negative infinity.
+
+    \sa QAudioOutput::loudness(), QAudioInput::loudness(), QMediaPlayer::loudness()
+*/
+
+/*!
+    Constructs an invalid loudness measurement.
+*/
+QAudioLoudness::QAudioLoudness()
+    : d(new QAudioLoudnessPrivate)
+{
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QAudioLoudness::QAudioLoudness(const QAudioLoudness &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Destroys this loudness measurement.
+*/
+QAudioLoudness::~QAudioLoudness()
+{
+}
+
+/*!
+    Assigns \a other to this loudness measurement.
+*/
+QAudioLoudness &QAudioLoudness::operator=(const QAudioLoudness &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    Returns true if any audio has been measured.
+*/
+bool QAudioLoudness::isValid() const
+{
+    return d->duration > 0;
+}
+
+/*!
+    Returns the momentary loudness in LUFS.
+*/
+qreal QAudioLoudness::momentary() const
+{
+    return d->momentary;
+}
+
+/*!
+    Sets the momentary loudness to \a lufs.
+*/
+void QAudioLoudness::setMomentary(qreal lufs)
+{
+    d->momentary = lufs;
+}
+
+/*!
+    Returns the short-term loudness in LUFS.
+*/
+qreal QAudioLoudness::shortTerm() const
+{
+    return d->shortTerm;
+}
+
+/*!
+    Sets the short-term loudness to \a lufs.
+*/
+void QAudioLoudness::setShortTerm(qreal lufs)
+{
+    d->shortTerm = lufs;
+}
+
+/*!
+    Returns the integrated loudness in LUFS.
+*/
+qreal QAudioLoudness::integrated() const
+{
+    return d->integrated;
+}
+
+/*!
+    Sets the integrated loudness to \a lufs.
+*/
+void QAudioLoudness::setIntegrated(qreal lufs)
+{
+    d->integrated = lufs;
+}
+
+/*!
+    Returns the maximum true peak in dBTP.
+*/
+qreal QAudioLoudness::truePeak() const
+{
+    return d->truePeak;
+}
+
+/*!
+    Sets the maximum true peak to \a dbtp.
+*/
+void QAudioLoudness::setTruePeak(qreal dbtp)
+{
+    d->truePeak = dbtp;
+}
+
+/*!
+    Returns the duration of the measured audio in microseconds.
+*/
+qint64 QAudioLoudness::duration() const
+{
+    return d->duration;
+}
+
+/*!
+    Sets the duration of the measured audio to \a microseconds.
+*/
+void QAudioLoudness::setDuration(qint64 microseconds)
+{
+    d->duration = microseconds;
+}
+
+#ifndef QT_NO_DEBUG_STREAM
+QDebug operator<<(QDebug dbg, const QAudioLoudness &loudness)
+{
+    QDebugStateSaver saver(dbg);
+    dbg.nospace();
+    dbg << "QAudioLoudness(M=" << loudness.momentary() << " LUFS, S="
+        << loudness.shortTerm() << " LUFS, I=" << loudness.integrated()
+        << " LUFS, TP=" << loudness.truePeak() << " dBTP, duration="
+        << loudness.duration() << "us)";
+    return dbg;
+}
+#endif
+
+QT_END_NAMESPACE
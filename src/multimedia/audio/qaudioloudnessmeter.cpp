@@ -0,0 +1,523 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include "qaudioloudnessmeter_p.h"
+#include "qaudiohelpers_p.h"
+#include "qaudiobuffer.h"
+
+#include <private/qsimd_p.h>
+#include <QtCore/qmath.h>
+
+#include <limits>
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal
+{
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+void QT_FASTCALL qt_loudness_process_pair_sse2(const float *src, int frames, int channels, int offset,
+                                               const QLoudnessCoefficients &c, QLoudnessChannelPair *pair);
+#endif
+
+static void qt_loudness_process_pair_c(const float *src, int frames, int channels, int offset, int lanes,
+                                       const QLoudnessCoefficients &c, QLoudnessChannelPair *pair)
+{
+    int pos = pair->historyPos;
+
+    for (int lane = 0; lane < lanes; ++lane) {
+        double z0 = pair->z[0][lane];
+        double z1 = pair->z[1][lane];
+        double z2 = pair->z[2][lane];
+        double z3 = pair->z[3][lane];
+        double sum = 0.0;
+        double peak = pair->peak[lane];
+        pos = pair->historyPos;
+
+        const float *in = src + offset + lane;
+        for (int i = 0; i < frames; ++i, in += channels) {
+            const double x = *in;
+
+            const double y1 = c.shelf[0] * x + z0;
+            z0 = c.shelf[1] * x - c.shelf[3] * y1 + z1;
+            z1 = c.shelf[2] * x - c.shelf[4] * y1;
+            const double y2 = c.highPass[0] * y1 + z2;
+            z2 = c.highPass[1] * y1 - c.highPass[3] * y2 + z3;
+            z3 = c.highPass[2] * y1 - c.highPass[4] * y2;
+            sum += y2 * y2;
+
+            if (c.oversample) {
+                pair->history[pos][lane] = pair->history[pos + 12][lane] = x;
+                pos = pos == 11 ? 0 : pos + 1;
+                for (int phase = 0; phase < 4; ++phase) {
+                    double y = 0.0;
+                    for (int tap = 0; tap < 12; ++tap)
+                        y += c.taps[phase][tap] * pair->history[pos + tap][lane];
+                    peak = qMax(peak, qAbs(y));
+                }
+            } else {
+                peak = qMax(peak, qAbs(x));
+            }
+        }
+
+        pair->z[0][lane] = z0;
+        pair->z[1][lane] = z1;
+        pair->z[2][lane] = z2;
+        pair->z[3][lane] = z3;
+        pair->sumOfSquares[lane] += sum;
+        pair->peak[lane] = peak;
+    }
+
+    pair->historyPos = pos;
+}
+
+void qt_loudness_process_pair(const float *src, int frames, int channels, int offset, int lanes,
+                              const QLoudnessCoefficients &c, QLoudnessChannelPair *pair)
+{
+    Q_ASSERT(lanes == 1 || lanes == 2);
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+    // Both channels of a pair are filtered in one register
+    if (lanes == 2 && qCpuHasFeature(SSE2)) {
+        qt_loudness_process_pair_sse2(src, frames, channels, offset, c, pair);
+        return;
+    }
+#endif
+
+    qt_loudness_process_pair_c(src, frames, channels, offset, lanes, c, pair);
+}
+
+}
+
+using namespace QAudioHelperInternal;
+
+// Interpolation filter of ITU-R BS.1770-4 Annex 2, one row per phase
+static const double truePeakTaps[4][12] = {
+    {  0.0017089843750,  0.0109863281250, -0.0196533203125,  0.0332031250000,
+      -0.0594482421875,  0.1373291015625,  0.9721679687500, -0.1022949218750,
+       0.0476074218750, -0.0266113281250,  0.0148925781250, -0.0083007812500 },
+    { -0.0291748046875,  0.0292968750000, -0.0517578125000,  0.0891113281250,
+      -0.1665039062500,  0.4650878906250,  0.7797851562500, -0.2003173828125,
+       0.1015625000000, -0.0582275390625,  0.0330810546875, -0.0189208984375 },
+    { -0.0189208984375,  0.0330810546875, -0.0582275390625,  0.1015625000000,
+      -0.2003173828125,  0.7797851562500,  0.4650878906250, -0.1665039062500,
+       0.0891113281250, -0.0517578125000,  0.0292968750000, -0.0291748046875 },
+    { -0.0083007812500,  0.0148925781250, -0.0266113281250,  0.0476074218750,
+      -0.1022949218750,  0.9721679687500,  0.1373291015625, -0.0594482421875,
+       0.0332031250000, -0.0196533203125,  0.0109863281250,  0.0017089843750 }
+};
+
+static const double absoluteGate = -70.0;
+static const double relativeGate = -10.0;
+
+static inline double loudnessForEnergy(double energy)
+{
+    return energy > 0.0 ? -0.691 + 10.0 * std::log10(energy)
+                        : -std::numeric_limits<double>::infinity();
+}
+
+static inline int histogramBin(double lufs)
+{
+    return qBound(0, int((lufs - absoluteGate) * 10.0), 999);
+}
+
+/*
+    Loudness meter following ITU-R BS.1770-4 and EBU R 128. Audio is filtered
+    through the K-weighting in 100 ms blocks; momentary and short-term loudness
+    are the means of the last 4 and 30 blocks, and every 400 ms gating block
+    above the absolute gate goes into a histogram from which the integrated
+    loudness is computed, so memory use doesn't grow with the stream length.
+    Below 96 kHz the true peak is taken from the four times oversampled
+    signal, at higher rates from the samples.
+
+    process() runs on the audio thread. The snapshot read by loudness() is
+    refreshed every block, loudnessChanged() is emitted every notify
+    interval of processed audio.
+*/
+QAudioLoudnessMeter::QAudioLoudnessMeter(QObject *parent)
+    : QObject(parent)
+    , m_enabled(0)
+    , m_notifyInterval(100)
+    , m_blockFrames(0)
+    , m_framesInBlock(0)
+    , m_notifyFrames(0)
+    , m_framesSinceNotify(0)
+{
+    resetMeasurement();
+}
+
+QAudioLoudnessMeter::~QAudioLoudnessMeter()
+{
+}
+
+void QAudioLoudnessMeter::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled ? 1 : 0);
+}
+
+int QAudioLoudnessMeter::notifyInterval() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_notifyInterval;
+}
+
+void QAudioLoudnessMeter::setNotifyInterval(int milliSeconds)
+{
+    QMutexLocker locker(&m_mutex);
+    m_notifyInterval = qMax(0, milliSeconds);
+    if (m_format.isValid())
+        m_notifyFrames = m_format.framesForDuration(qint64(m_notifyInterval) * 1000);
+}
+
+void QAudioLoudnessMeter::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    resetMeasurement();
+    m_format = QAudioFormat();
+}
+
+QAudioLoudness QAudioLoudnessMeter::loudness() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_snapshot;
+}
+
+void QAudioLoudnessMeter::audioBufferProbed(const QAudioBuffer &buffer)
+{
+    process(buffer.format(), buffer.constData(), buffer.byteCount());
+}
+
+void QAudioLoudnessMeter::process(const QAudioFormat &format, const void *data, qint64 bytes)
+{
+    if (!isEnabled())
+        return;
+
+    const int bytesPerFrame = format.bytesPerFrame();
+    if (format.channelCount() <= 0 || bytesPerFrame <= 0 || format.sampleRate() <= 0)
+        return;
+
+    QAudioLoudness notification;
+    bool notify = false;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (format != m_format)
+            configure(format);
+
+        const char *src = static_cast<const char *>(data);
+
+        // Complete a frame split over two calls first
+        if (!m_partialFrame.isEmpty()) {
+            const int missing = int(qMin<qint64>(bytesPerFrame - m_partialFrame.size(), bytes));
+            m_partialFrame.append(src, missing);
+            src += missing;
+            bytes -= missing;
+            if (m_partialFrame.size() < bytesPerFrame)
+                return;
+            notify |= processFrames(m_partialFrame.constData(), 1);
+            m_partialFrame.clear();
+        }
+
+        const qint64 frames = bytes / bytesPerFrame;
+        notify |= processFrames(src, frames);
+        m_partialFrame = QByteArray(src + frames * bytesPerFrame, int(bytes - frames * bytesPerFrame));
+
+        // Keep decaying filter state out of the denormal range
+        for (QLoudnessChannelPair &pair : m_pairs) {
+            for (int i = 0; i < 4; ++i) {
+                for (int lane = 0; lane < 2; ++lane) {
+                    if (qAbs(pair.z[i][lane]) < 1e-30)
+                        pair.z[i][lane] = 0.0;
+                }
+            }
+        }
+
+        if (notify)
+            notification = m_snapshot;
+    }
+
+    if (notify)
+        emit loudnessChanged(notification);
+}
+
+void QAudioLoudnessMeter::prepareDeferred(const QAudioFormat &format)
+{
+    // At least half a second of audio, the owner thread may fall that far
+    // behind. A power of two keeps the index continuous when positions wrap.
+    m_deferredFormat = format;
+    const int bytes = format.isValid() ? format.bytesForDuration(500000) : 0;
+    m_deferred.resize(bytes > 0 ? int(qNextPowerOfTwo(quint32(bytes - 1))) : 0);
+    m_deferredWritten.store(0);
+    m_deferredRead.store(0);
+}
+
+void QAudioLoudnessMeter::processDeferred(const void *data, qint64 bytes)
+{
+    if (!isEnabled() || m_deferred.isEmpty() || bytes <= 0)
+        return;
+
+    // Audio that doesn't fit is not metered
+    const quint32 capacity = quint32(m_deferred.size());
+    const quint32 written = m_deferredWritten.load();
+    const quint32 used = written - m_deferredRead.loadAcquire();
+    if (bytes > qint64(capacity - used))
+        return;
+
+    const char *src = static_cast<const char *>(data);
+    char *ring = m_deferred.data();
+    const quint32 index = written & (capacity - 1);
+    const quint32 head = qMin(quint32(bytes), capacity - index);
+    memcpy(ring + index, src, head);
+    memcpy(ring, src + head, bytes - head);
+    m_deferredWritten.storeRelease(written + quint32(bytes));
+}
+
+void QAudioLoudnessMeter::processPending()
+{
+    if (m_deferred.isEmpty())
+        return;
+
+    const quint32 capacity = quint32(m_deferred.size());
+    const quint32 read = m_deferredRead.load();
+    const quint32 available = m_deferredWritten.loadAcquire() - read;
+    if (available == 0)
+        return;
+
+    const quint32 index = read & (capacity - 1);
+    const quint32 head = qMin(available, capacity - index);
+    process(m_deferredFormat, m_deferred.constData() + index, head);
+    if (head < available)
+        process(m_deferredFormat, m_deferred.constData(), available - head);
+    m_deferredRead.storeRelease(read + available);
+}
+
+bool QAudioLoudnessMeter::processFrames(const char *src, qint64 frameCount)
+{
+    const int channels = m_format.channelCount();
+    const int bytesPerFrame = m_format.bytesPerFrame();
+    bool notify = false;
+
+    while (frameCount > 0) {
+        const int frames = int(qMin<qint64>(qMin<qint64>(frameCount, ChunkFrames),
+                                            m_blockFrames - m_framesInBlock));
+        if (!qConvertSamplesToFloat(m_format, src, m_scratch.data(), frames * channels))
+            return notify;
+
+        for (int i = 0; i < m_pairs.size(); ++i) {
+            qt_loudness_process_pair(m_scratch.constData(), frames, channels, 2 * i,
+                                     qMin(2, channels - 2 * i), m_coefficients, &m_pairs[i]);
+        }
+
+        src += frames * bytesPerFrame;
+        frameCount -= frames;
+        m_framesInBlock += frames;
+        m_duration += double(frames) / m_format.sampleRate();
+
+        if (m_framesInBlock == m_blockFrames)
+            finishBlock();
+
+        m_framesSinceNotify += frames;
+        if (m_notifyFrames > 0 && m_framesSinceNotify >= m_notifyFrames) {
+            m_framesSinceNotify %= m_notifyFrames;
+            notify = true;
+        }
+    }
+
+    return notify;
+}
+
+void QAudioLoudnessMeter::configure(const QAudioFormat &format)
+{
+    // The measurement carries on across format changes, only the filters
+    // and the unfinished block start over
+    m_format = format;
+
+    const double rate = format.sampleRate();
+    {
+        const double f0 = 1681.974450955533;
+        const double gain = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan(M_PI * f0 / rate);
+        const double vh = std::pow(10.0, gain / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        m_coefficients.shelf[0] = (vh + vb * k / q + k * k) / a0;
+        m_coefficients.shelf[1] = 2.0 * (k * k - vh) / a0;
+        m_coefficients.shelf[2] = (vh - vb * k / q + k * k) / a0;
+        m_coefficients.shelf[3] = 2.0 * (k * k - 1.0) / a0;
+        m_coefficients.shelf[4] = (1.0 - k / q + k * k) / a0;
+    }
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan(M_PI * f0 / rate);
+        const double a0 = 1.0 + k / q + k * k;
+        m_coefficients.highPass[0] = 1.0;
+        m_coefficients.highPass[1] = -2.0;
+        m_coefficients.highPass[2] = 1.0;
+        m_coefficients.highPass[3] = 2.0 * (k * k - 1.0) / a0;
+        m_coefficients.highPass[4] = (1.0 - k / q + k * k) / a0;
+    }
+    memcpy(m_coefficients.taps, truePeakTaps, sizeof(truePeakTaps));
+    m_coefficients.oversample = format.sampleRate() < 96000;
+
+    const int channels = format.channelCount();
+    QLoudnessChannelPair pair;
+    memset(&pair, 0, sizeof(pair));
+    m_pairs.fill(pair, (channels + 1) / 2);
+
+    // Channel weights of BS.1770 assuming the usual channel order, the LFE
+    // of a 5.1 stream doesn't count and the surround channels count more
+    m_weights.fill(1.0, channels);
+    if (channels == 5) {
+        m_weights[3] = m_weights[4] = 1.41;
+    } else if (channels == 6) {
+        m_weights[3] = 0.0;
+        m_weights[4] = m_weights[5] = 1.41;
+    }
+
+    m_scratch.resize(ChunkFrames * channels);
+    m_partialFrame.clear();
+    m_blockFrames = qMax(1, format.sampleRate() / 10);
+    m_framesInBlock = 0;
+    m_notifyFrames = format.framesForDuration(qint64(m_notifyInterval) * 1000);
+    m_framesSinceNotify = 0;
+}
+
+void QAudioLoudnessMeter::resetMeasurement()
+{
+    for (int i = 0; i < ShortTermBlocks; ++i)
+        m_blocks[i] = 0.0;
+    m_blockIndex = 0;
+    m_blockCount = 0;
+    for (int i = 0; i < HistogramBins; ++i) {
+        m_histogramEnergy[i] = 0.0;
+        m_histogramCount[i] = 0;
+    }
+    m_peak = 0.0;
+    m_duration = 0.0;
+    m_framesInBlock = 0;
+    m_framesSinceNotify = 0;
+    m_partialFrame.clear();
+    m_snapshot = QAudioLoudness();
+}
+
+void QAudioLoudnessMeter::finishBlock()
+{
+    double energy = 0.0;
+    for (int i = 0; i < m_pairs.size(); ++i) {
+        QLoudnessChannelPair &pair = m_pairs[i];
+        for (int lane = 0; lane < 2 && 2 * i + lane < m_weights.size(); ++lane) {
+            energy += m_weights.at(2 * i + lane) * pair.sumOfSquares[lane];
+            m_peak = qMax(m_peak, pair.peak[lane]);
+        }
+        pair.sumOfSquares[0] = pair.sumOfSquares[1] = 0.0;
+        pair.peak[0] = pair.peak[1] = 0.0;
+    }
+
+    m_blockIndex = (m_blockIndex + 1) % ShortTermBlocks;
+    m_blocks[m_blockIndex] = energy / m_framesInBlock;
+    m_blockCount = qMin(m_blockCount + 1, int(ShortTermBlocks));
+    m_framesInBlock = 0;
+
+    // Gating blocks of 400 ms overlap by 75%, one ends with every block
+    if (m_blockCount >= MomentaryBlocks) {
+        double momentary = 0.0;
+        for (int i = 0; i < MomentaryBlocks; ++i)
+            momentary += m_blocks[(m_blockIndex - i + ShortTermBlocks) % ShortTermBlocks];
+        momentary /= MomentaryBlocks;
+
+        const double lufs = loudnessForEnergy(momentary);
+        if (lufs >= absoluteGate) {
+            const int bin = histogramBin(lufs);
+            m_histogramEnergy[bin] += momentary;
+            ++m_histogramCount[bin];
+        }
+    }
+
+    updateSnapshot();
+}
+
+void QAudioLoudnessMeter::updateSnapshot()
+{
+    // Blocks before the start of the stream count as silence
+    double momentary = 0.0;
+    double shortTerm = 0.0;
+    for (int i = 0; i < ShortTermBlocks; ++i) {
+        const double energy = m_blocks[(m_blockIndex - i + ShortTermBlocks) % ShortTermBlocks];
+        if (i < MomentaryBlocks)
+            momentary += energy;
+        shortTerm += energy;
+    }
+
+    double total = 0.0;
+    quint64 count = 0;
+    for (int i = 0; i < HistogramBins; ++i) {
+        total += m_histogramEnergy[i];
+        count += m_histogramCount[i];
+    }
+
+    double integrated = -std::numeric_limits<double>::infinity();
+    if (count > 0) {
+        const int first = histogramBin(loudnessForEnergy(total / count) + relativeGate);
+        total = 0.0;
+        count = 0;
+        for (int i = first; i < HistogramBins; ++i) {
+            total += m_histogramEnergy[i];
+            count += m_histogramCount[i];
+        }
+        if (count > 0)
+            integrated = loudnessForEnergy(total / count);
+    }
+
+    const double momentaryLufs = loudnessForEnergy(momentary / MomentaryBlocks);
+    const double shortTermLufs = loudnessForEnergy(shortTerm / ShortTermBlocks);
+
+    m_snapshot = QAudioLoudness();
+    m_snapshot.setMomentary(momentaryLufs >= absoluteGate ? momentaryLufs : -std::numeric_limits<double>::infinity());
+    m_snapshot.setShortTerm(shortTermLufs >= absoluteGate ? shortTermLufs : -std::numeric_limits<double>::infinity());
+    m_snapshot.setIntegrated(integrated);
+    m_snapshot.setTruePeak(m_peak > 0.0 ? 20.0 * std::log10(m_peak)
+                                        : -std::numeric_limits<double>::infinity());
+    m_snapshot.setDuration(qint64(m_duration * 1000000.0));
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qaudioloudnessmeter_p.cpp"
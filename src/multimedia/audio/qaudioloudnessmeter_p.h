@@ -0,0 +1,179 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QAUDIOLOUDNESSMETER_P_H
+#define QAUDIOLOUDNESSMETER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <qtmultimediaglobal.h>
+#include <qaudioformat.h>
+#include <qaudioloudness.h>
+#include <private/qmediaaudioprobecontrol_p.h>
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal
+{
+// K-weighting biquads and true peak interpolation filter for one sample rate
+struct QLoudnessCoefficients
+{
+    double shelf[5];    // b0, b1, b2, a1, a2
+    double highPass[5];
+    double taps[4][12]; // polyphase 4x interpolation filter of BS.1770-4
+    bool oversample;
+};
+
+// Filter state of two channels processed side by side, lane n carrying
+// channel offset + n
+struct QLoudnessChannelPair
+{
+    double z[4][2];         // transposed direct form II state of both biquads
+    double history[24][2];  // last 12 inputs, stored twice for a contiguous window
+    int historyPos;
+    double sumOfSquares[2];
+    double peak[2];
+};
+
+// Filters frames of interleaved floats through the K-weighting, adding the
+// squared output to sumOfSquares, and tracks the (true) peak. lanes is 1 or 2.
+void qt_loudness_process_pair(const float *src, int frames, int channels, int offset, int lanes,
+                              const QLoudnessCoefficients &c, QLoudnessChannelPair *pair);
+}
+
+class Q_MULTIMEDIA_EXPORT QAudioLoudnessMeter : public QObject, public QAudioProbeListener
+{
+    Q_OBJECT
+public:
+    explicit QAudioLoudnessMeter(QObject *parent = Q_NULLPTR);
+    ~QAudioLoudnessMeter();
+
+    bool isEnabled() const { return m_enabled.load() != 0; }
+    void setEnabled(bool enabled);
+
+    int notifyInterval() const;
+    void setNotifyInterval(int milliSeconds);
+
+    void reset();
+
+    QAudioLoudness loudness() const;
+
+    // Called on the thread feeding the device or the streaming thread
+    void process(const QAudioFormat &format, const void *data, qint64 bytes);
+    void audioBufferProbed(const QAudioBuffer &buffer) override;
+
+    // Metering for real-time threads, which must not wait for loudness().
+    // prepareDeferred() sizes a hand-off buffer while no such thread runs,
+    // processDeferred() only copies into it, without locking or allocating,
+    // and processPending() meters the copied audio on the owner thread.
+    void prepareDeferred(const QAudioFormat &format);
+    void processDeferred(const void *data, qint64 bytes);
+    void processPending();
+
+Q_SIGNALS:
+    // Emitted on the thread calling process()
+    void loudnessChanged(const QAudioLoudness &loudness);
+
+private:
+    enum {
+        ChunkFrames = 1024,
+        ShortTermBlocks = 30,
+        MomentaryBlocks = 4,
+        HistogramBins = 1000
+    };
+
+    void configure(const QAudioFormat &format);
+    bool processFrames(const char *src, qint64 frameCount);
+    void resetMeasurement();
+    void finishBlock();
+    void updateSnapshot();
+
+    QAtomicInt m_enabled;
+
+    mutable QMutex m_mutex;
+    int m_notifyInterval;
+
+    QAudioFormat m_format;
+    QAudioHelperInternal::QLoudnessCoefficients m_coefficients;
+    QVector<QAudioHelperInternal::QLoudnessChannelPair> m_pairs;
+    QVector<double> m_weights;
+    QVector<float> m_scratch;
+    QByteArray m_partialFrame;
+    int m_blockFrames;
+    int m_framesInBlock;
+    int m_notifyFrames;
+    int m_framesSinceNotify;
+
+    // Mean squares of the last 100 ms blocks, newest at m_blockIndex
+    double m_blocks[ShortTermBlocks];
+    int m_blockIndex;
+    int m_blockCount;
+    // Gating blocks above the absolute gate, in 0.1 LU bins from -70 LUFS
+    double m_histogramEnergy[HistogramBins];
+    quint32 m_histogramCount[HistogramBins];
+    double m_peak;
+    double m_duration;
+
+    QAudioLoudness m_snapshot;
+
+    // Single producer, single consumer, the positions count bytes and wrap
+    QAudioFormat m_deferredFormat;
+    QByteArray m_deferred;
+    QAtomicInteger<quint32> m_deferredWritten;
+    QAtomicInteger<quint32> m_deferredRead;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIOLOUDNESSMETER_P_H
@@ -0,0 +1,123 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qaudioloudnessmeter_p.h"
+#include <private/qsimd_p.h>
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal
+{
+
+void QT_FASTCALL qt_loudness_process_pair_sse2(const float *src, int frames, int channels, int offset,
+                                               const QLoudnessCoefficients &c, QLoudnessChannelPair *pair)
+{
+    const __m128d s0 = _mm_set1_pd(c.shelf[0]);
+    const __m128d s1 = _mm_set1_pd(c.shelf[1]);
+    const __m128d s2 = _mm_set1_pd(c.shelf[2]);
+    const __m128d s3 = _mm_set1_pd(c.shelf[3]);
+    const __m128d s4 = _mm_set1_pd(c.shelf[4]);
+    const __m128d h0 = _mm_set1_pd(c.highPass[0]);
+    const __m128d h1 = _mm_set1_pd(c.highPass[1]);
+    const __m128d h2 = _mm_set1_pd(c.highPass[2]);
+    const __m128d h3 = _mm_set1_pd(c.highPass[3]);
+    const __m128d h4 = _mm_set1_pd(c.highPass[4]);
+    const __m128d signMask = _mm_set1_pd(-0.0);
+
+    __m128d taps[4][12];
+    for (int phase = 0; phase < 4; ++phase) {
+        for (int tap = 0; tap < 12; ++tap)
+            taps[phase][tap] = _mm_set1_pd(c.taps[phase][tap]);
+    }
+
+    __m128d z0 = _mm_loadu_pd(pair->z[0]);
+    __m128d z1 = _mm_loadu_pd(pair->z[1]);
+    __m128d z2 = _mm_loadu_pd(pair->z[2]);
+    __m128d z3 = _mm_loadu_pd(pair->z[3]);
+    __m128d sum = _mm_setzero_pd();
+    __m128d peak = _mm_loadu_pd(pair->peak);
+    int pos = pair->historyPos;
+
+    const float *in = src + offset;
+    for (int i = 0; i < frames; ++i, in += channels) {
+        // Two adjacent floats widened to doubles
+        const __m128d x = _mm_cvtps_pd(_mm_castsi128_ps(
+                                           _mm_loadl_epi64(reinterpret_cast<const __m128i *>(in))));
+
+        const __m128d y1 = _mm_add_pd(_mm_mul_pd(s0, x), z0);
+        z0 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(s1, x), _mm_mul_pd(s3, y1)), z1);
+        z1 = _mm_sub_pd(_mm_mul_pd(s2, x), _mm_mul_pd(s4, y1));
+        const __m128d y2 = _mm_add_pd(_mm_mul_pd(h0, y1), z2);
+        z2 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(h1, y1), _mm_mul_pd(h3, y2)), z3);
+        z3 = _mm_sub_pd(_mm_mul_pd(h2, y1), _mm_mul_pd(h4, y2));
+        sum = _mm_add_pd(sum, _mm_mul_pd(y2, y2));
+
+        if (c.oversample) {
+            _mm_storeu_pd(pair->history[pos], x);
+            _mm_storeu_pd(pair->history[pos + 12], x);
+            pos = pos == 11 ? 0 : pos + 1;
+
+            const double *window = pair->history[pos];
+            for (int phase = 0; phase < 4; ++phase) {
+                __m128d y = _mm_mul_pd(taps[phase][0], _mm_loadu_pd(window));
+                for (int tap = 1; tap < 12; ++tap)
+                    y = _mm_add_pd(y, _mm_mul_pd(taps[phase][tap], _mm_loadu_pd(window + 2 * tap)));
+                peak = _mm_max_pd(peak, _mm_andnot_pd(signMask, y));
+            }
+        } else {
+            peak = _mm_max_pd(peak, _mm_andnot_pd(signMask, x));
+        }
+    }
+
+    _mm_storeu_pd(pair->z[0], z0);
+    _mm_storeu_pd(pair->z[1], z1);
+    _mm_storeu_pd(pair->z[2], z2);
+    _mm_storeu_pd(pair->z[3], z3);
+    _mm_storeu_pd(pair->sumOfSquares, _mm_add_pd(_mm_loadu_pd(pair->sumOfSquares), sum));
+    _mm_storeu_pd(pair->peak, peak);
+    pair->historyPos = pos;
+}
+
+}
+
+QT_END_NAMESPACE
+
+#endif
@@ -44,10 +44,24 @@
 #include "qaudiooutput.h"
 
 #include "qaudiodevicefactory_p.h"
+#include "qaudiosystemext_p.h"
+#include "qaudioloudnessmeter_p.h"
 
 
 QT_BEGIN_NAMESPACE
 
+// Null for backends that only implement QAbstractAudioOutput
+static QAudioOutputExtension *outputExtension(QAbstractAudioOutput *d)
+{
+    return qobject_cast<QAudioOutputExtension *>(d);
+}
+
+static QAudioLoudnessMeter *loudnessMeter(QAbstractAudioOutput *d)
+{
+    QAudioOutputExtension *ext = outputExtension(d);
+    return ext ? ext->loudnessMeter() : Q_NULLPTR;
+}
+
 /*!
     \class QAudioOutput
     \brief The QAudioOutput class provides an interface for sending audio data to an audio output device.
@@ -124,6 +138,8 @@ QAudioOutput::QAudioOutput(const QAudioFormat &format, QObject *parent):
     d = QAudioDeviceFactory::createDefaultOutputDevice(format);
     connect(d, SIGNAL(notify()), SIGNAL(notify()));
     connect(d, SIGNAL(stateChanged(QAudio::State)), SIGNAL(stateChanged(QAudio::State)));
+    if (QAudioLoudnessMeter *meter = loudnessMeter(d))
+        connect(meter, SIGNAL(loudnessChanged(QAudioLoudness)), SIGNAL(loudnessChanged(QAudioLoudness)));
 }
 
 /*!
@@ -137,6 +153,8 @@ QAudioOutput::QAudioOutput(const QAudioDeviceInfo &audioDevice, const QAudioForm
     d = QAudioDeviceFactory::createOutputDevice(audioDevice, format);
     connect(d, SIGNAL(notify()), SIGNAL(notify()));
     connect(d, SIGNAL(stateChanged(QAudio::State)), SIGNAL(stateChanged(QAudio::State)));
+    if (QAudioLoudnessMeter *meter = loudnessMeter(d))
+        connect(meter, SIGNAL(loudnessChanged(QAudioLoudness)), SIGNAL(loudnessChanged(QAudioLoudness)));
 }
 
 /*!
@@ -199,6 +217,42 @@ QIODevice* QAudioOutput::start()
     return d->start();
 }
 
+/*!
+    \since 5.11
+
+    Starts the output in callback mode.  Instead of reading from a QIODevice,
+    the output calls \a callback with \a userData whenever it needs audio,
+    passing a buffer of exactly periodSize() bytes that the callback must
+    fill completely.
+
+    Where the backend supports it, the callback runs on its audio thread,
+    without a round trip through the thread that owns this QAudioOutput.
+    The callback must therefore not allocate memory, take locks or block,
+    and any state it shares with the rest of the application has to be
+    exchanged without locking, for example through atomics or lock free
+    queues.  Backends without an audio thread call it from the thread of
+    this QAudioOutput instead.
+
+    The output never runs dry in this mode, so state() stays at
+    QAudio::ActiveState until the output is suspended or stopped.  The
+    callback is not called anymore once stop() returns.
+
+    If a problem occurs, error() returns QAudio::OpenError, state() returns
+    QAudio::StoppedState and the stateChanged() signal is emitted.
+
+    \sa QAudio::RenderCallback, periodSize()
+*/
+void QAudioOutput::start(QAudio::RenderCallback callback, void *userData)
+{
+    if (!callback) {
+        qWarning("QAudioOutput::start: no render callback");
+        return;
+    }
+    QAudioOutputExtension *ext = outputExtension(d);
+    if (!ext || !ext->startCallback(callback, userData))
+        qt_startAudioCallback(d, callback, userData);
+}
+
 /*!
     Stops the audio output, detaching from the system resource.
 
@@ -293,6 +347,54 @@ int QAudioOutput::bufferSize() const
     return d->bufferSize();
 }
 
+/*!
+    \since 5.11
+
+    Requests an end-to-end latency of \a microseconds, i.e. the time between writing a sample and hearing it.
+    The backend translates this into its own buffering parameters
+    instead of its defaults, so there is no need to tune setBufferSize()
+    per platform for low latency use.
+
+    Zero, the default, leaves the latency up to the backend.
+
+    \note Like setBufferSize(), this takes effect on the next start().
+    The backend may not be able to honor the request exactly; call
+    latency() after start() for the latency actually configured.
+
+    \sa latency()
+*/
+void QAudioOutput::setTargetLatency(qint64 microseconds)
+{
+    if (QAudioOutputExtension *ext = outputExtension(d))
+        ext->setTargetLatency(qMax<qint64>(0, microseconds));
+}
+
+/*!
+    \since 5.11
+
+    Returns the latency requested with setTargetLatency(), in microseconds,
+    or zero if the backend does not support requesting a latency.
+*/
+qint64 QAudioOutput::targetLatency() const
+{
+    QAudioOutputExtension *ext = outputExtension(d);
+    return ext ? ext->targetLatency() : 0;
+}
+
+/*!
+    \since 5.11
+
+    Returns the latency in microseconds the backend configured on start(),
+    or -1 if it is not known.
+
+    \sa setTargetLatency()
+*/
+qint64 QAudioOutput::latency() const
+{
+    QAudioOutputExtension *ext = outputExtension(d);
+    return ext ? ext->latency() : -1;
+}
+
 /*!
     Sets the interval for notify() signal to be emitted.
     This is based on the \a ms of audio data processed,
@@ -323,6 +425,151 @@ qint64 QAudioOutput::processedUSecs() const
     return d->processedUSecs();
 }
 
+/*!
+    \since 5.11
+
+    Returns the position, in microseconds since start(), of the sample that is
+    currently leaving the audio device.
+
+    Unlike processedUSecs(), which counts the data handed to the backend, this
+    accounts for the audio still buffered between the application and the
+    speaker, and is interpolated between the device's position updates. It is
+    monotonic while the output is started and cheap enough to be called once
+    per displayed frame, which makes it suitable as the master clock when
+    synchronizing video to audio.
+
+    \sa processedUSecs(), latency()
+*/
+qint64 QAudioOutput::presentedUSecs() const
+{
+    QAudioOutputExtension *ext = outputExtension(d);
+    const qint64 presented = ext ? ext->presentedUSecs() : -1;
+    if (presented >= 0)
+        return presented;
+
+    // Best effort for backends without a playback position of their own
+    const qint64 processed = d->processedUSecs();
+    const qint64 deviceLatency = latency();
+    return deviceLatency > 0 ? qMax<qint64>(0, processed - deviceLatency) : processed;
+}
+
+/*!
+    \since 5.11
+
+    Returns instrumentation collected by the backend since the last start(),
+    or an empty map if the backend does not collect any.
+
+    The map contains:
+    \table
+    \header \li Key \li Value
+    \row \li \c underruns \li Number of times the device ran out of data to play.
+    \row \li \c overruns \li Number of times more data was written than the stream could hold.
+    \row \li \c bytes \li Bytes transferred to the device.
+    \row \li \c feedIntervalUs \li Histogram of the time between two transfers.
+    \row \li \c bytesFreeAtFeed \li Histogram of the free space in the device buffer when a transfer began.
+    \row \li \c feedDurationUs \li Histogram of the time a transfer took.
+    \endtable
+
+    Each histogram is a QVariantMap with the \c count, \c min, \c max and
+    \c mean of the recorded values, and a \c buckets list in which entry \e n
+    counts the values in the range [2\sup{n}, 2\sup{n+1}), entry 0 also
+    counting zero.
+
+    The same figures are logged when the stream is closed if the
+    \c qt.multimedia.audio.stats logging category is enabled.
+*/
+QVariantMap QAudioOutput::statistics() const
+{
+    QAudioOutputExtension *ext = outputExtension(d);
+    return ext ? ext->statistics() : QVariantMap();
+}
+
+/*!
+    \since 5.11
+
+    Enables loudness metering of the audio written by the application
+    if \a enabled is true.
+
+    The meter measures momentary, short-term and integrated loudness and the
+    true peak as described by ITU-R BS.1770-4 and EBU R 128. It runs on the
+    thread that exchanges audio with the device. When started with a
+    callback, the audio thread only copies the audio aside and it is
+    measured on the thread of this object. The measurement restarts with
+    every start() and resetLoudness().
+
+    Metering is disabled by default. It is supported by the ALSA and
+    PulseAudio backends; isLoudnessMeteringEnabled() returns false on
+    others.
+
+    \sa loudness(), loudnessChanged()
+*/
+void QAudioOutput::setLoudnessMeteringEnabled(bool enabled)
+{
+    if (QAudioLoudnessMeter *meter = loudnessMeter(d))
+        meter->setEnabled(enabled);
+}
+
+/*!
+    \since 5.11
+
+    Returns true if the loudness of the played audio is measured.
+*/
+bool QAudioOutput::isLoudnessMeteringEnabled() const
+{
+    QAudioLoudnessMeter *meter = loudnessMeter(d);
+    return meter && meter->isEnabled();
+}
+
+/*!
+    \since 5.11
+
+    Sets the interval of played audio after which loudnessChanged() is
+    emitted to \a milliSeconds. The default is 100 milliseconds, 0 disables
+    the signal. The loudness is updated every 100 milliseconds, so shorter
+    intervals don't give more frequent measurements.
+*/
+void QAudioOutput::setLoudnessNotifyInterval(int milliSeconds)
+{
+    if (QAudioLoudnessMeter *meter = loudnessMeter(d))
+        meter->setNotifyInterval(milliSeconds);
+}
+
+/*!
+    \since 5.11
+
+    Returns the interval of played audio after which loudnessChanged() is
+    emitted, in milliseconds.
+*/
+int QAudioOutput::loudnessNotifyInterval() const
+{
+    QAudioLoudnessMeter *meter = loudnessMeter(d);
+    return meter ? meter->notifyInterval() : 0;
+}
+
+/*!
+    \since 5.11
+
+    Returns the latest loudness measurement, or an invalid one if metering
+    isn't enabled or nothing has been measured yet.
+*/
+QAudioLoudness QAudioOutput::loudness() const
+{
+    QAudioLoudnessMeter *meter = loudnessMeter(d);
+    return meter ? meter->loudness() : QAudioLoudness();
+}
+
+/*!
+    \since 5.11
+
+    Restarts the loudness measurement, discarding the integrated loudness
+    and the true peak measured so far.
+*/
+void QAudioOutput::resetLoudness()
+{
+    if (QAudioLoudnessMeter *meter = loudnessMeter(d))
+        meter->reset();
+}
+
 /*!
     Returns the microseconds since start() was called, including time in Idle and
     Suspend states.
@@ -417,6 +664,16 @@ void QAudioOutput::setCategory(const QString &category)
     This is the current state of the audio output.
 */
 
+/*!
+    \fn QAudioOutput::loudnessChanged(const QAudioLoudness &loudness)
+    \since 5.11
+
+    This signal is emitted with the current \a loudness every
+    loudnessNotifyInterval() of played audio while loudness metering is enabled.
+
+    \sa setLoudnessMeteringEnabled()
+*/
+
 /*!
     \fn QAudioOutput::notify()
     This signal is emitted when a certain interval of milliseconds
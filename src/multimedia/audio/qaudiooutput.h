@@ -42,6 +42,7 @@
 #define QAUDIOOUTPUT_H
 
 #include <QtCore/qiodevice.h>
+#include <QtCore/qvariant.h>
 
 #include <QtMultimedia/qtmultimediaglobal.h>
 #include <QtMultimedia/qmultimedia.h>
@@ -49,6 +50,7 @@
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudioformat.h>
 #include <QtMultimedia/qaudiodeviceinfo.h>
+#include <QtMultimedia/qaudioloudness.h>
 
 
 QT_BEGIN_NAMESPACE
@@ -70,6 +72,7 @@ public:
 
     void start(QIODevice *device);
     QIODevice* start();
+    void start(QAudio::RenderCallback callback, void *userData);
 
     void stop();
     void reset();
@@ -79,6 +82,10 @@ public:
     void setBufferSize(int bytes);
     int bufferSize() const;
 
+    void setTargetLatency(qint64 microseconds);
+    qint64 targetLatency() const;
+    qint64 latency() const;
+
     int bytesFree() const;
     int periodSize() const;
 
@@ -86,6 +93,15 @@ public:
     int notifyInterval() const;
 
     qint64 processedUSecs() const;
+    qint64 presentedUSecs() const;
+    QVariantMap statistics() const;
+
+    void setLoudnessMeteringEnabled(bool enabled);
+    bool isLoudnessMeteringEnabled() const;
+    void setLoudnessNotifyInterval(int milliSeconds);
+    int loudnessNotifyInterval() const;
+    QAudioLoudness loudness() const;
+    void resetLoudness();
     qint64 elapsedUSecs() const;
 
     QAudio::Error error() const;
@@ -100,6 +116,7 @@ public:
 Q_SIGNALS:
     void stateChanged(QAudio::State);
     void notify();
+    void loudnessChanged(const QAudioLoudness &loudness);
 
 private:
     Q_DISABLE_COPY(QAudioOutput)
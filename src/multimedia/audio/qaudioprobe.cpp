@@ -64,6 +64,9 @@
 
 #include "qaudioprobe.h"
 #include "qmediaaudioprobecontrol.h"
+#include "qmediaaudioprobecontrol_p.h"
+#include "qaudiolevelreducer_p.h"
+#include "qaudioprobedispatcher_p.h"
 #include "qmediaservice.h"
 #include "qmediarecorder.h"
 #include "qsharedpointer.h"
@@ -73,10 +76,81 @@ QT_BEGIN_NAMESPACE
 
 class QAudioProbePrivate {
 public:
+    QAudioProbePrivate(QAudioProbe *q)
+        : q(q)
+        , reductionMode(QAudioProbe::NoReduction)
+        , reductionWindow(50)
+        , reducer(0)
+        , deliveryMode(QAudioProbe::LatestDelivery)
+        , queueLimit(8)
+        , overflowPolicy(QAudioProbe::DropOldest)
+        , callback(Q_NULLPTR)
+        , userData(Q_NULLPTR)
+        , dispatcher(0)
+        , droppedBase(0)
+    {}
+
+    void connectControl();
+    void disconnectControl();
+
+    QAudioProbe *q;
     QPointer<QMediaObject> source;
     QPointer<QMediaAudioProbeControl> probee;
+    QAudioProbe::ReductionMode reductionMode;
+    int reductionWindow;
+    QAudioLevelReducer *reducer;
+
+    QAudioProbe::DeliveryMode deliveryMode;
+    int queueLimit;
+    QAudioProbe::OverflowPolicy overflowPolicy;
+    QAudioProbe::BufferCallback callback;
+    void *userData;
+    QAudioProbeDispatcher *dispatcher;
+    quint64 droppedBase;
 };
 
+void QAudioProbePrivate::connectControl()
+{
+    if (reductionMode == QAudioProbe::NoReduction && deliveryMode == QAudioProbe::LatestDelivery) {
+        droppedBase = QMediaAudioProbeControlPrivate::get(probee.data())->droppedBufferCount();
+        QObject::connect(probee.data(), SIGNAL(audioBufferProbed(QAudioBuffer)), q, SIGNAL(audioBufferProbed(QAudioBuffer)));
+    } else if (reductionMode == QAudioProbe::NoReduction) {
+        if (!dispatcher) {
+            dispatcher = new QAudioProbeDispatcher(q);
+            QObject::connect(dispatcher, SIGNAL(bufferReady(QAudioBuffer)),
+                             q, SIGNAL(audioBufferProbed(QAudioBuffer)));
+        }
+        dispatcher->setDirect(deliveryMode == QAudioProbe::DirectDelivery, callback, userData);
+        dispatcher->queue().setLimit(queueLimit);
+        dispatcher->queue().setBlocking(overflowPolicy == QAudioProbe::Block);
+        dispatcher->queue().setClosed(false);
+        QMediaAudioProbeControlPrivate::get(probee.data())->addListener(dispatcher);
+    } else {
+        if (!reducer) {
+            reducer = new QAudioLevelReducer(q);
+            QObject::connect(reducer, SIGNAL(levelsReady(QVector<float>,int,qint64)),
+                             q, SIGNAL(levelsProbed(QVector<float>,int,qint64)));
+        }
+        reducer->setMode(reductionMode);
+        reducer->setWindow(reductionWindow);
+        QMediaAudioProbeControlPrivate::get(probee.data())->addListener(reducer);
+    }
+    QObject::connect(probee.data(), SIGNAL(flush()), q, SIGNAL(flush()));
+}
+
+void QAudioProbePrivate::disconnectControl()
+{
+    QObject::disconnect(probee.data(), SIGNAL(audioBufferProbed(QAudioBuffer)), q, SIGNAL(audioBufferProbed(QAudioBuffer)));
+    QObject::disconnect(probee.data(), SIGNAL(flush()), q, SIGNAL(flush()));
+    if (reducer)
+        QMediaAudioProbeControlPrivate::get(probee.data())->removeListener(reducer);
+    if (dispatcher) {
+        // Release a streaming thread waiting for room in the queue first
+        dispatcher->queue().setClosed(true);
+        QMediaAudioProbeControlPrivate::get(probee.data())->removeListener(dispatcher);
+    }
+}
+
 /*!
     Creates a new QAudioProbe class with a \a parent.  After setting the
     source to monitor with \l setSource(), the \l audioBufferProbed()
@@ -85,7 +159,7 @@ public:
  */
 QAudioProbe::QAudioProbe(QObject *parent)
     : QObject(parent)
-    , d(new QAudioProbePrivate)
+    , d(new QAudioProbePrivate(this))
 {
 }
 
@@ -97,10 +171,8 @@ QAudioProbe::~QAudioProbe()
 {
     if (d->source) {
         // Disconnect
-        if (d->probee) {
-            disconnect(d->probee.data(), SIGNAL(audioBufferProbed(QAudioBuffer)), this, SIGNAL(audioBufferProbed(QAudioBuffer)));
-            disconnect(d->probee.data(), SIGNAL(flush()), this, SIGNAL(flush()));
-        }
+        if (d->probee)
+            d->disconnectControl();
         d->source.data()->service()->releaseControl(d->probee.data());
     }
 }
@@ -127,16 +199,14 @@ bool QAudioProbe::setSource(QMediaObject *source)
 
     // in case source was destroyed but probe control is still valid
     if (!d->source && d->probee) {
-        disconnect(d->probee.data(), SIGNAL(audioBufferProbed(QAudioBuffer)), this, SIGNAL(audioBufferProbed(QAudioBuffer)));
-        disconnect(d->probee.data(), SIGNAL(flush()), this, SIGNAL(flush()));
+        d->disconnectControl();
         d->probee.clear();
     }
 
     if (source != d->source.data()) {
         if (d->source) {
             Q_ASSERT(d->probee);
-            disconnect(d->probee.data(), SIGNAL(audioBufferProbed(QAudioBuffer)), this, SIGNAL(audioBufferProbed(QAudioBuffer)));
-            disconnect(d->probee.data(), SIGNAL(flush()), this, SIGNAL(flush()));
+            d->disconnectControl();
             d->source.data()->service()->releaseControl(d->probee.data());
             d->source.clear();
             d->probee.clear();
@@ -149,8 +219,7 @@ bool QAudioProbe::setSource(QMediaObject *source)
             }
 
             if (d->probee) {
-                connect(d->probee.data(), SIGNAL(audioBufferProbed(QAudioBuffer)), this, SIGNAL(audioBufferProbed(QAudioBuffer)));
-                connect(d->probee.data(), SIGNAL(flush()), this, SIGNAL(flush()));
+                d->connectControl();
                 d->source = source;
             }
         }
@@ -198,6 +267,258 @@ bool QAudioProbe::isActive() const
     return d->probee != 0;
 }
 
+/*!
+    \enum QAudioProbe::ReductionMode
+    \since 5.11
+
+    Selects what the probe delivers.
+
+    \value NoReduction       Every audio buffer is delivered with \l audioBufferProbed().
+    \value PeakReduction     The peak absolute sample value of each channel in a window
+                             is delivered with \l levelsProbed().
+    \value RmsReduction      The root mean square of each channel in a window is
+                             delivered with \l levelsProbed().
+    \value EnvelopeReduction The minimum and maximum sample value of each channel in a
+                             window are delivered with \l levelsProbed(), which is a
+                             decimated envelope suitable for drawing waveforms.
+*/
+
+/*!
+    \since 5.11
+
+    Returns the reduction applied to probed audio. The default is
+    \l NoReduction.
+*/
+QAudioProbe::ReductionMode QAudioProbe::reductionMode() const
+{
+    return d->reductionMode;
+}
+
+/*!
+    \since 5.11
+
+    Sets the reduction applied to probed audio to \a mode.
+
+    With any mode other than \l NoReduction the audio is reduced on the
+    thread the media backend produces it on, and only the resulting levels
+    are delivered to the probe's thread. Level meters therefore neither pay
+    for copying every buffer to the GUI thread nor miss peaks when the GUI
+    thread is busy: all windows reduced while the probe's thread was blocked
+    are delivered together. \l audioBufferProbed() is not emitted in these
+    modes.
+*/
+void QAudioProbe::setReductionMode(ReductionMode mode)
+{
+    if (d->reductionMode == mode)
+        return;
+
+    if (d->probee)
+        d->disconnectControl();
+    d->reductionMode = mode;
+    if (d->probee)
+        d->connectControl();
+}
+
+/*!
+    \since 5.11
+
+    Returns the length of a reduction window in milliseconds. The default is
+    50 milliseconds.
+*/
+int QAudioProbe::reductionWindow() const
+{
+    return d->reductionWindow;
+}
+
+/*!
+    \since 5.11
+
+    Sets the length of a reduction window to \a msecs milliseconds.
+
+    \sa setReductionMode()
+*/
+void QAudioProbe::setReductionWindow(int msecs)
+{
+    msecs = qMax(1, msecs);
+    if (d->reductionWindow == msecs)
+        return;
+
+    d->reductionWindow = msecs;
+    if (d->reducer)
+        d->reducer->setWindow(msecs);
+}
+
+/*!
+    \enum QAudioProbe::DeliveryMode
+    \since 5.11
+
+    Selects how audio buffers are handed to the application.
+
+    \value LatestDelivery  Buffers are delivered with \l audioBufferProbed() on the
+                           probe's thread. If that thread is busy, only the most
+                           recent buffer is delivered once it gets to it.
+    \value QueuedDelivery  Buffers are queued up to \l queueLimit() and all of them
+                           are delivered with \l audioBufferProbed() on the probe's
+                           thread. When the queue is full the \l overflowPolicy()
+                           applies and dropped buffers are counted.
+    \value DirectDelivery  The callback set with \l setBufferCallback() is invoked
+                           for every buffer on the thread the media backend
+                           produces it on, without involving the probe's thread.
+
+    \sa setDeliveryMode()
+*/
+
+/*!
+    \enum QAudioProbe::OverflowPolicy
+    \since 5.11
+
+    Selects what happens when the queue of a probe in \l QueuedDelivery mode
+    is full.
+
+    \value DropOldest The oldest queued buffer is dropped.
+    \value Block      The media backend waits for the probe's thread to catch
+                      up. To avoid deadlocks with an application stopping
+                      playback, it never waits longer than half a second per
+                      buffer and drops the oldest buffer afterwards.
+*/
+
+/*!
+    \typedef QAudioProbe::BufferCallback
+    \since 5.11
+
+    The callback invoked for every buffer in \l DirectDelivery mode, a
+    pointer to a function of the form
+    \c{void callback(const QAudioBuffer &buffer, void *userData)}.
+*/
+
+/*!
+    \since 5.11
+
+    Returns how audio buffers are handed to the application. The default is
+    \l LatestDelivery.
+*/
+QAudioProbe::DeliveryMode QAudioProbe::deliveryMode() const
+{
+    return d->deliveryMode;
+}
+
+/*!
+    \since 5.11
+
+    Sets how audio buffers are handed to the application to \a mode.
+
+    \l QueuedDelivery and \l DirectDelivery need support from the media
+    backend, which is currently provided by the GStreamer, audio capture,
+    DirectShow and Windows Media Foundation backends. They have no effect
+    while a \l reductionMode() is set.
+
+    Buffers delivered on the probe's thread are copies, so keeping them does
+    not keep the media backend's memory in use. In \l DirectDelivery mode
+    the callback gets the backend's buffer without a copy, which the
+    GStreamer backend can't reuse or modify in place while the buffer is
+    referenced.
+*/
+void QAudioProbe::setDeliveryMode(DeliveryMode mode)
+{
+    if (d->deliveryMode == mode)
+        return;
+
+    if (d->probee)
+        d->disconnectControl();
+    d->deliveryMode = mode;
+    if (d->probee)
+        d->connectControl();
+}
+
+/*!
+    \since 5.11
+
+    Returns the maximum number of buffers queued in \l QueuedDelivery mode.
+    The default is 8.
+*/
+int QAudioProbe::queueLimit() const
+{
+    return d->queueLimit;
+}
+
+/*!
+    \since 5.11
+
+    Sets the maximum number of buffers queued in \l QueuedDelivery mode to
+    \a buffers.
+*/
+void QAudioProbe::setQueueLimit(int buffers)
+{
+    d->queueLimit = qMax(1, buffers);
+    if (d->dispatcher)
+        d->dispatcher->queue().setLimit(d->queueLimit);
+}
+
+/*!
+    \since 5.11
+
+    Returns what happens when the queue is full in \l QueuedDelivery mode.
+    The default is \l DropOldest.
+*/
+QAudioProbe::OverflowPolicy QAudioProbe::overflowPolicy() const
+{
+    return d->overflowPolicy;
+}
+
+/*!
+    \since 5.11
+
+    Sets what happens when the queue is full in \l QueuedDelivery mode to
+    \a policy.
+*/
+void QAudioProbe::setOverflowPolicy(OverflowPolicy policy)
+{
+    d->overflowPolicy = policy;
+    if (d->dispatcher)
+        d->dispatcher->queue().setBlocking(policy == Block);
+}
+
+/*!
+    \since 5.11
+
+    Sets the \a callback invoked for every buffer in \l DirectDelivery mode,
+    which is passed \a userData along with the buffer.
+
+    The callback runs on the media backend's streaming thread and must be
+    thread-safe. It must return quickly, since the backend can't process
+    more media until it does. The buffer's data is only guaranteed to be
+    valid until the callback returns; copy it to keep it longer. Once the
+    callback has been replaced, or the probe's source or delivery mode has
+    changed, the previous callback is no longer called.
+*/
+void QAudioProbe::setBufferCallback(BufferCallback callback, void *userData)
+{
+    if (d->probee)
+        d->disconnectControl();
+    d->callback = callback;
+    d->userData = userData;
+    if (d->probee)
+        d->connectControl();
+}
+
+/*!
+    \since 5.11
+
+    Returns the number of buffers dropped because the queue was full in
+    \l QueuedDelivery mode. In \l LatestDelivery mode it is the number of
+    buffers replaced by a newer one before they could be delivered since the
+    probe was connected, as far as the media backend reports them.
+*/
+quint64 QAudioProbe::droppedBufferCount() const
+{
+    if (d->reductionMode == NoReduction && d->deliveryMode == LatestDelivery) {
+        return d->probee
+                ? QMediaAudioProbeControlPrivate::get(d->probee.data())->droppedBufferCount() - d->droppedBase
+                : 0;
+    }
+    return d->dispatcher ? d->dispatcher->queue().dropped() : 0;
+}
+
 /*!
     \fn QAudioProbe::audioBufferProbed(const QAudioBuffer &buffer)
 
@@ -206,6 +527,21 @@ bool QAudioProbe::isActive() const
 */
 
 
+/*!
+    \fn QAudioProbe::levelsProbed(const QVector<float> &levels, int channelCount, qint64 startTime)
+    \since 5.11
+
+    This signal is emitted when reduced audio levels are available.
+
+    \a levels holds one or more consecutive windows of \a channelCount
+    channels each. In \l PeakReduction and \l RmsReduction mode a window has
+    one value per channel, in \l EnvelopeReduction mode it has a minimum and
+    a maximum value per channel. Values are normalized to the range [-1, 1].
+    \a startTime is the start time of the first window in microseconds.
+
+    \sa setReductionMode()
+*/
+
 /*!
     \fn QAudioProbe::flush()
 
@@ -41,6 +41,7 @@
 #define QAUDIOPROBE_H
 
 #include <QtCore/qobject.h>
+#include <QtCore/qvector.h>
 #include <QtMultimedia/qaudiobuffer.h>
 
 QT_BEGIN_NAMESPACE
@@ -53,6 +54,32 @@ class Q_MULTIMEDIA_EXPORT QAudioProbe : public QObject
 {
     Q_OBJECT
 public:
+    enum ReductionMode
+    {
+        NoReduction,
+        PeakReduction,
+        RmsReduction,
+        EnvelopeReduction
+    };
+    Q_ENUM(ReductionMode)
+
+    enum DeliveryMode
+    {
+        LatestDelivery,
+        QueuedDelivery,
+        DirectDelivery
+    };
+    Q_ENUM(DeliveryMode)
+
+    enum OverflowPolicy
+    {
+        DropOldest,
+        Block
+    };
+    Q_ENUM(OverflowPolicy)
+
+    typedef void (*BufferCallback)(const QAudioBuffer &buffer, void *userData);
+
     explicit QAudioProbe(QObject *parent = Q_NULLPTR);
     ~QAudioProbe();
 
@@ -61,9 +88,29 @@ public:
 
     bool isActive() const;
 
+    ReductionMode reductionMode() const;
+    void setReductionMode(ReductionMode mode);
+
+    int reductionWindow() const;
+    void setReductionWindow(int msecs);
+
+    DeliveryMode deliveryMode() const;
+    void setDeliveryMode(DeliveryMode mode);
+
+    int queueLimit() const;
+    void setQueueLimit(int buffers);
+
+    OverflowPolicy overflowPolicy() const;
+    void setOverflowPolicy(OverflowPolicy policy);
+
+    void setBufferCallback(BufferCallback callback, void *userData);
+
+    quint64 droppedBufferCount() const;
+
 Q_SIGNALS:
     void audioBufferProbed(const QAudioBuffer &audioBuffer);
     void flush();
+    void levelsProbed(const QVector<float> &levels, int channelCount, qint64 startTime);
 
 private:
     QAudioProbePrivate *d;
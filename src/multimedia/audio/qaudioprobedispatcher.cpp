@@ -0,0 +1,98 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qaudioprobedispatcher_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*
+    Delivers probed buffers either by calling a callback right on the
+    streaming thread, or through a bounded queue drained on the owner's
+    thread, which unlike the backend's single pending buffer counts every
+    buffer it has to drop.
+
+    Queued buffers are copied, so that up to the queue limit of them don't
+    keep the backend's memory referenced, which for zero-copy backends
+    would hold on to GStreamer buffers meant to be reused or modified in
+    place. Only direct delivery hands out the backend's buffer as is.
+*/
+QAudioProbeDispatcher::QAudioProbeDispatcher(QObject *parent)
+    : QObject(parent)
+    , m_direct(false)
+    , m_callback(Q_NULLPTR)
+    , m_userData(Q_NULLPTR)
+{
+}
+
+QAudioProbeDispatcher::~QAudioProbeDispatcher()
+{
+}
+
+void QAudioProbeDispatcher::setDirect(bool direct, QAudioProbe::BufferCallback callback, void *userData)
+{
+    m_direct = direct;
+    m_callback = callback;
+    m_userData = userData;
+}
+
+void QAudioProbeDispatcher::audioBufferProbed(const QAudioBuffer &buffer)
+{
+    if (m_direct) {
+        if (m_callback)
+            m_callback(buffer, m_userData);
+        return;
+    }
+
+    QAudioBuffer copy(buffer);
+    copy.data(); // detaches
+
+    if (m_queue.enqueue(copy))
+        QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+}
+
+void QAudioProbeDispatcher::deliver()
+{
+    const QQueue<QAudioBuffer> buffers = m_queue.takeAll();
+    for (const QAudioBuffer &buffer : buffers)
+        emit bufferReady(buffer);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qaudioprobedispatcher_p.cpp"
@@ -0,0 +1,357 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qaudiospectrumanalyser_p.h"
+#include "qaudiohelpers_p.h"
+#include "qaudiobuffer.h"
+
+#include <QtCore/qmath.h>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+// Samples are converted to float in chunks of this many frames
+static const int ChunkFrames = 1024;
+
+// Timestamps further off than this are taken as a seek or a gap
+static const qint64 MaximumJitter = 10000;
+
+/*
+    Mixes probed audio down to mono on the streaming thread and computes
+    windowed FFTs of it on the thread the analyser lives on. Spectra
+    computed between two deliveries are combined by keeping the largest
+    magnitude of every bin, so a lower delivery rate doesn't hide short
+    transients. Unprocessed audio is limited to two seconds; if the worker
+    falls further behind, the oldest audio is dropped. The incoming buffer
+    is swapped with one the worker keeps, so neither is reallocated while
+    the format stays the same.
+*/
+QAudioSpectrumAnalyser::QAudioSpectrumAnalyser(QObject *parent)
+    : QObject(parent)
+    , m_settingsChanged(true)
+    , m_incomingStart(0)
+    , m_nextTime(0)
+    , m_discontinuity(false)
+    , m_processQueued(false)
+    , m_sampleRate(0)
+    , m_hop(1)
+    , m_deliveryInterval(0)
+    , m_untilDelivery(0)
+    , m_windowScale(0)
+    , m_bufferStart(0)
+    , m_accumulatedFrames(0)
+    , m_accumulatedStart(0)
+{
+    qRegisterMetaType<QVector<float> >();
+}
+
+QAudioSpectrumAnalyser::~QAudioSpectrumAnalyser()
+{
+}
+
+void QAudioSpectrumAnalyser::setSettings(const Settings &settings)
+{
+    QMutexLocker locker(&m_mutex);
+    m_settings = settings;
+    m_settingsChanged = true;
+}
+
+void QAudioSpectrumAnalyser::audioBufferProbed(const QAudioBuffer &buffer)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const QAudioFormat format = buffer.format();
+    const int channels = format.channelCount();
+    if (channels <= 0 || format.bytesPerFrame() <= 0 || format.sampleRate() <= 0)
+        return;
+
+    const qint64 startTime = buffer.startTime();
+    if (format != m_format) {
+        m_format = format;
+        m_scratch.resize(ChunkFrames * channels);
+        m_incoming.resize(0);
+        m_incoming.reserve(qMax(2 * format.sampleRate(), 2 * m_settings.fftSize) + ChunkFrames);
+        m_nextTime = startTime >= 0 ? startTime : 0;
+        m_discontinuity = true;
+    } else if (startTime >= 0 && qAbs(startTime - m_nextTime) > MaximumJitter) {
+        // Spectra must not span a seek
+        m_incoming.resize(0);
+        m_nextTime = startTime;
+        m_discontinuity = true;
+    }
+
+    if (m_incoming.isEmpty())
+        m_incomingStart = startTime >= 0 ? startTime : m_nextTime;
+
+    const int bytesPerFrame = format.bytesPerFrame();
+    const char *data = buffer.constData<char>();
+    const int frameCount = buffer.frameCount();
+
+    for (int offset = 0; offset < frameCount; offset += ChunkFrames) {
+        const int frames = qMin(frameCount - offset, ChunkFrames);
+        if (!QAudioHelperInternal::qConvertSamplesToFloat(format, data + offset * bytesPerFrame,
+                                                          m_scratch.data(), frames * channels)) {
+            return;
+        }
+
+        const int size = m_incoming.size();
+        m_incoming.resize(size + frames);
+        float *out = m_incoming.data() + size;
+        if (channels == 1) {
+            memcpy(out, m_scratch.constData(), frames * sizeof(float));
+        } else {
+            const float *in = m_scratch.constData();
+            const float scale = 1.0f / channels;
+            for (int i = 0; i < frames; ++i) {
+                float sum = 0.0f;
+                for (int c = 0; c < channels; ++c)
+                    sum += *in++;
+                out[i] = sum * scale;
+            }
+        }
+    }
+
+    m_nextTime = (startTime >= 0 ? startTime : m_nextTime) + format.durationForFrames(frameCount);
+
+    const int limit = qMax(2 * format.sampleRate(), 2 * m_settings.fftSize);
+    if (m_incoming.size() > limit) {
+        const int excess = m_incoming.size() - limit;
+        m_incoming.remove(0, excess);
+        m_incomingStart += format.durationForFrames(excess);
+        m_discontinuity = true;
+    }
+
+    if (!m_processQueued) {
+        m_processQueued = true;
+        QMetaObject::invokeMethod(this, "process", Qt::QueuedConnection);
+    }
+}
+
+void QAudioSpectrumAnalyser::process()
+{
+    qint64 startTime;
+    bool discontinuity;
+    bool reconfigure = false;
+    int sampleRate;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_processQueued = false;
+        m_processing.swap(m_incoming);
+        startTime = m_incomingStart;
+        discontinuity = m_discontinuity;
+        m_discontinuity = false;
+        if (m_settingsChanged) {
+            m_active = m_settings;
+            m_settingsChanged = false;
+            reconfigure = true;
+        }
+        sampleRate = m_format.sampleRate();
+    }
+
+    if (sampleRate <= 0) {
+        m_processing.resize(0);
+        return;
+    }
+
+    if (reconfigure || sampleRate != m_sampleRate) {
+        m_sampleRate = sampleRate;
+        configure();
+        discontinuity = true;
+    }
+
+    if (discontinuity) {
+        m_buffer.clear();
+        m_accumulatedFrames = 0;
+        m_untilDelivery = 0;
+    }
+
+    if (m_buffer.isEmpty())
+        m_bufferStart = startTime;
+    m_buffer += m_processing;
+    m_processing.resize(0);
+
+    const int size = m_active.fftSize;
+    int offset = 0;
+    while (m_buffer.size() - offset >= size) {
+        analyseFrame(m_buffer.constData() + offset,
+                     m_bufferStart + qint64(offset) * 1000000 / m_sampleRate);
+        offset += m_hop;
+    }
+
+    if (offset > 0) {
+        m_buffer.remove(0, offset);
+        m_bufferStart += qint64(offset) * 1000000 / m_sampleRate;
+    }
+}
+
+void QAudioSpectrumAnalyser::configure()
+{
+    const int size = m_active.fftSize;
+    const int half = size / 2;
+
+    m_fft.setSize(size);
+    m_hop = qBound(1, qRound(size * (1.0 - m_active.overlap)), size);
+    m_deliveryInterval = m_active.targetRate > 0 ? qreal(m_sampleRate) / m_active.targetRate : 0;
+
+    m_window.resize(size);
+    double sum = 0;
+    for (int i = 0; i < size; ++i) {
+        const double phase = 2 * M_PI * i / size;
+        double w = 1.0;
+        switch (m_active.windowFunction) {
+        case QAudioSpectrumProbe::RectangularWindow:
+            break;
+        case QAudioSpectrumProbe::HannWindow:
+            w = 0.5 - 0.5 * qCos(phase);
+            break;
+        case QAudioSpectrumProbe::BlackmanHarrisWindow:
+            w = 0.35875 - 0.48829 * qCos(phase) + 0.14128 * qCos(2 * phase) - 0.01168 * qCos(3 * phase);
+            break;
+        }
+        m_window[i] = float(w);
+        sum += w;
+    }
+    // A full scale sine centered on a bin reads 1
+    m_windowScale = float(2.0 / sum);
+
+    m_windowed.resize(size);
+    m_bins.resize(half + 1);
+    m_accumulated.resize(half + 1);
+
+    const qreal binWidth = qreal(m_sampleRate) / size;
+    QVector<float> frequencies;
+    if (m_active.bandCount > 0) {
+        const int count = m_active.bandCount;
+        const qreal nyquist = m_sampleRate / 2.0;
+        qreal high = qMin(m_active.maximumFrequency, nyquist);
+        qreal low = qMin(qMax(m_active.minimumFrequency, qreal(1.0)), high / 2);
+        if (high <= 0) {
+            high = nyquist;
+            low = nyquist / 1000;
+        }
+
+        m_bandFirst.resize(count);
+        m_bandLast.resize(count);
+        frequencies.resize(count);
+        for (int b = 0; b < count; ++b) {
+            const qreal lower = low * qPow(high / low, qreal(b) / count);
+            const qreal upper = low * qPow(high / low, qreal(b + 1) / count);
+            const qreal center = qSqrt(lower * upper);
+            int first = qCeil(lower / binWidth);
+            int last = b == count - 1 ? qFloor(upper / binWidth) : qCeil(upper / binWidth) - 1;
+            if (last < first) {
+                // Bands narrower than a bin take the bin they fall into
+                first = last = qRound(center / binWidth);
+            }
+            m_bandFirst[b] = qBound(0, first, half);
+            m_bandLast[b] = qBound(0, last, half);
+            frequencies[b] = float(center);
+        }
+    } else {
+        m_bandFirst.clear();
+        m_bandLast.clear();
+        frequencies.resize(half + 1);
+        for (int k = 0; k <= half; ++k)
+            frequencies[k] = float(k * binWidth);
+    }
+
+    emit frequenciesReady(frequencies);
+}
+
+void QAudioSpectrumAnalyser::analyseFrame(const float *samples, qint64 startTime)
+{
+    const int size = m_active.fftSize;
+    const float *window = m_window.constData();
+    float *windowed = m_windowed.data();
+    for (int i = 0; i < size; ++i)
+        windowed[i] = samples[i] * window[i];
+
+    m_fft.magnitudes(windowed, m_bins.data());
+
+    const int bins = m_bins.size();
+    if (m_accumulatedFrames == 0) {
+        m_accumulatedStart = startTime;
+        memcpy(m_accumulated.data(), m_bins.constData(), bins * sizeof(float));
+    } else {
+        const float *in = m_bins.constData();
+        float *out = m_accumulated.data();
+        for (int k = 0; k < bins; ++k)
+            out[k] = qMax(out[k], in[k]);
+    }
+    ++m_accumulatedFrames;
+
+    m_untilDelivery -= m_hop;
+    if (m_untilDelivery <= 0) {
+        deliver();
+        m_untilDelivery = qMax(m_untilDelivery + m_deliveryInterval, qreal(0));
+    }
+}
+
+void QAudioSpectrumAnalyser::deliver()
+{
+    const int half = m_active.fftSize / 2;
+    float *accumulated = m_accumulated.data();
+
+    // DC and Nyquist have no negative frequency counterpart
+    for (int k = 1; k < half; ++k)
+        accumulated[k] *= m_windowScale;
+    accumulated[0] *= 0.5f * m_windowScale;
+    accumulated[half] *= 0.5f * m_windowScale;
+
+    QVector<float> magnitudes;
+    if (m_active.bandCount > 0) {
+        magnitudes.resize(m_active.bandCount);
+        for (int b = 0; b < m_active.bandCount; ++b) {
+            float value = 0.0f;
+            for (int k = m_bandFirst.at(b); k <= m_bandLast.at(b); ++k)
+                value = qMax(value, accumulated[k]);
+            magnitudes[b] = value;
+        }
+    } else {
+        magnitudes = m_accumulated;
+    }
+
+    m_accumulatedFrames = 0;
+    emit spectrumReady(magnitudes, m_accumulatedStart);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qaudiospectrumanalyser_p.cpp"
@@ -0,0 +1,147 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QAUDIOSPECTRUMANALYSER_P_H
+#define QAUDIOSPECTRUMANALYSER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <qtmultimediaglobal.h>
+#include <qaudioformat.h>
+#include <qaudiospectrumprobe.h>
+#include <private/qaudiofft_p.h>
+#include <private/qmediaaudioprobecontrol_p.h>
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+class Q_MULTIMEDIA_EXPORT QAudioSpectrumAnalyser : public QObject, public QAudioProbeListener
+{
+    Q_OBJECT
+public:
+    struct Settings
+    {
+        Settings()
+            : fftSize(2048)
+            , overlap(0.5)
+            , windowFunction(QAudioSpectrumProbe::HannWindow)
+            , bandCount(0)
+            , minimumFrequency(20.0)
+            , maximumFrequency(20000.0)
+            , targetRate(30)
+        {}
+
+        int fftSize;
+        qreal overlap;
+        QAudioSpectrumProbe::WindowFunction windowFunction;
+        int bandCount;
+        qreal minimumFrequency;
+        qreal maximumFrequency;
+        int targetRate;
+    };
+
+    explicit QAudioSpectrumAnalyser(QObject *parent = Q_NULLPTR);
+    ~QAudioSpectrumAnalyser();
+
+    // May be called from any thread, takes effect with the next buffer
+    void setSettings(const Settings &settings);
+
+    // Called on the streaming thread
+    void audioBufferProbed(const QAudioBuffer &buffer) override;
+
+Q_SIGNALS:
+    void spectrumReady(const QVector<float> &magnitudes, qint64 startTime);
+    void frequenciesReady(const QVector<float> &frequencies);
+
+private Q_SLOTS:
+    void process();
+
+private:
+    void configure();
+    void analyseFrame(const float *samples, qint64 startTime);
+    void deliver();
+
+    // Shared with the streaming thread, guarded by m_mutex
+    QMutex m_mutex;
+    Settings m_settings;
+    bool m_settingsChanged;
+    QAudioFormat m_format;
+    QVector<float> m_scratch;
+    QVector<float> m_incoming;
+    qint64 m_incomingStart;
+    qint64 m_nextTime;
+    bool m_discontinuity;
+    bool m_processQueued;
+
+    // Only used on the worker thread
+    Settings m_active;
+    int m_sampleRate;
+    int m_hop;
+    qreal m_deliveryInterval;
+    qreal m_untilDelivery;
+    QAudioFft m_fft;
+    QVector<float> m_processing;
+    QVector<float> m_window;
+    float m_windowScale;
+    QVector<float> m_buffer;
+    qint64 m_bufferStart;
+    QVector<float> m_windowed;
+    QVector<float> m_bins;
+    QVector<float> m_accumulated;
+    int m_accumulatedFrames;
+    qint64 m_accumulatedStart;
+    QVector<int> m_bandFirst;
+    QVector<int> m_bandLast;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIOSPECTRUMANALYSER_P_H
@@ -0,0 +1,473 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+/*!
+    \class QAudioSpectrumProbe
+    \inmodule QtMultimedia
+    \since 5.11
+
+    \ingroup multimedia
+    \ingroup multimedia_audio
+
+    \brief The QAudioSpectrumProbe class computes the frequency spectrum of
+    audio being played or recorded.
+
+    The probe attaches to a media object or recorder like QAudioProbe, but
+    instead of the audio buffers it delivers magnitude spectra with
+    \l spectrumProbed(). The audio is mixed down to mono and windowed FFTs of
+    \l fftSize() samples are computed on a worker thread owned by the probe,
+    so neither the media backend nor the probe's thread pay for the
+    transforms.
+
+    \code
+        QMediaPlayer *player = new QMediaPlayer;
+        QAudioSpectrumProbe *probe = new QAudioSpectrumProbe;
+
+        probe->setBandCount(32);
+        probe->setTargetRate(60);
+        connect(probe, &QAudioSpectrumProbe::spectrumProbed, this, &Visualizer::updateBars);
+
+        probe->setSource(player); // Returns true, hopefully.
+    \endcode
+
+    \sa QAudioProbe
+*/
+
+#include "qaudiospectrumprobe.h"
+#include "qaudiospectrumanalyser_p.h"
+#include "qmediaaudioprobecontrol.h"
+#include "qmediaaudioprobecontrol_p.h"
+#include "qmediaservice.h"
+#include "qmediarecorder.h"
+#include "qpointer.h"
+
+#include <QtCore/qthread.h>
+
+QT_BEGIN_NAMESPACE
+
+class QAudioSpectrumProbePrivate {
+public:
+    QAudioSpectrumProbePrivate(QAudioSpectrumProbe *q)
+        : q(q)
+        , analyser(0)
+    {}
+
+    void connectControl();
+    void disconnectControl();
+    void updateSettings();
+
+    QAudioSpectrumProbe *q;
+    QPointer<QMediaObject> source;
+    QPointer<QMediaAudioProbeControl> probee;
+    QAudioSpectrumAnalyser::Settings settings;
+    QVector<float> frequencies;
+
+    QThread thread;
+    QAudioSpectrumAnalyser *analyser;
+};
+
+void QAudioSpectrumProbePrivate::connectControl()
+{
+    if (!analyser) {
+        analyser = new QAudioSpectrumAnalyser;
+        analyser->setSettings(settings);
+        analyser->moveToThread(&thread);
+        QObject::connect(analyser, SIGNAL(spectrumReady(QVector<float>,qint64)),
+                         q, SIGNAL(spectrumProbed(QVector<float>,qint64)));
+        QObject::connect(analyser, &QAudioSpectrumAnalyser::frequenciesReady, q,
+                         [this](const QVector<float> &newFrequencies) {
+            frequencies = newFrequencies;
+            emit q->frequenciesChanged(frequencies);
+        });
+        thread.setObjectName(QLatin1String("QAudioSpectrumProbe"));
+        thread.start();
+    }
+    QMediaAudioProbeControlPrivate::get(probee.data())->addListener(analyser);
+}
+
+void QAudioSpectrumProbePrivate::disconnectControl()
+{
+    if (analyser)
+        QMediaAudioProbeControlPrivate::get(probee.data())->removeListener(analyser);
+}
+
+void QAudioSpectrumProbePrivate::updateSettings()
+{
+    if (analyser)
+        analyser->setSettings(settings);
+}
+
+/*!
+    Creates a new QAudioSpectrumProbe with a \a parent. After setting the
+    source to monitor with \l setSource(), the \l spectrumProbed() signal
+    will be emitted while audio flows in the source media object.
+*/
+QAudioSpectrumProbe::QAudioSpectrumProbe(QObject *parent)
+    : QObject(parent)
+    , d(new QAudioSpectrumProbePrivate(this))
+{
+}
+
+/*!
+    Destroys this probe, disconnects from any media object and stops the
+    worker thread.
+*/
+QAudioSpectrumProbe::~QAudioSpectrumProbe()
+{
+    if (d->source) {
+        if (d->probee)
+            d->disconnectControl();
+        d->source.data()->service()->releaseControl(d->probee.data());
+    }
+
+    d->thread.quit();
+    d->thread.wait();
+    delete d->analyser;
+    delete d;
+}
+
+/*!
+    Sets the media object to monitor to \a source.
+
+    If \a source is zero, this probe will be deactivated
+    and this function will return true.
+
+    If the media object does not support monitoring
+    audio, or its backend can't hand audio to the analyser on the thread
+    it produces the audio on, this function will return false.
+
+    The previous object will no longer be monitored.
+    Passing in the same object will be ignored, but
+    monitoring will continue.
+*/
+bool QAudioSpectrumProbe::setSource(QMediaObject *source)
+{
+    // in case source was destroyed but probe control is still valid
+    if (!d->source && d->probee) {
+        d->disconnectControl();
+        d->probee.clear();
+    }
+
+    if (source != d->source.data()) {
+        if (d->source) {
+            Q_ASSERT(d->probee);
+            d->disconnectControl();
+            d->source.data()->service()->releaseControl(d->probee.data());
+            d->source.clear();
+            d->probee.clear();
+        }
+
+        if (source) {
+            QMediaService *service = source->service();
+            if (service)
+                d->probee = service->requestControl<QMediaAudioProbeControl*>();
+
+            // The analyser is fed on the streaming thread, which backends
+            // that only emit audioBufferProbed() can't do
+            if (d->probee && !QMediaAudioProbeControlPrivate::get(d->probee.data())->listenersSupported()) {
+                service->releaseControl(d->probee.data());
+                d->probee.clear();
+            }
+
+            if (d->probee) {
+                d->connectControl();
+                d->source = source;
+            }
+        }
+    }
+
+    return (!source || d->probee != 0);
+}
+
+/*!
+    Starts monitoring the given \a mediaRecorder.
+
+    Returns true on success.
+
+    If there is no mediaObject associated with \a mediaRecorder, or if it is
+    zero, this probe will be deactivated and this function will return true.
+
+    If the media recorder instance does not support monitoring
+    audio, this function will return false.
+*/
+bool QAudioSpectrumProbe::setSource(QMediaRecorder *mediaRecorder)
+{
+    QMediaObject *source = mediaRecorder ? mediaRecorder->mediaObject() : 0;
+    bool result = setSource(source);
+
+    if (!mediaRecorder)
+        return true;
+
+    if (mediaRecorder && !source)
+        return false;
+
+    return result;
+}
+
+/*!
+    Returns true if this probe is monitoring something, or false otherwise.
+
+    The source being monitored does not need to be active.
+*/
+bool QAudioSpectrumProbe::isActive() const
+{
+    return d->probee != 0;
+}
+
+/*!
+    \enum QAudioSpectrumProbe::WindowFunction
+
+    Selects the window applied to the audio before each transform.
+
+    \value RectangularWindow    No window. Gives the narrowest peaks but the
+                                most leakage between bins.
+    \value HannWindow           The Hann window, a good general purpose choice.
+    \value BlackmanHarrisWindow The four term Blackman-Harris window, which
+                                suppresses leakage by more than 90 dB at the
+                                cost of wider peaks.
+*/
+
+/*!
+    Returns the number of samples transformed at a time. The default is 2048.
+*/
+int QAudioSpectrumProbe::fftSize() const
+{
+    return d->settings.fftSize;
+}
+
+/*!
+    Sets the number of samples transformed at a time to \a size.
+
+    The size is rounded up to a power of two between 64 and 65536. A
+    transform of \c N samples yields \c{N / 2 + 1} bins spaced by the sample
+    rate divided by \c N, so larger sizes resolve frequencies more finely
+    at the cost of timing.
+*/
+void QAudioSpectrumProbe::setFftSize(int size)
+{
+    size = qBound(64, size, 65536);
+    int powerOfTwo = 64;
+    while (powerOfTwo < size)
+        powerOfTwo *= 2;
+
+    if (d->settings.fftSize == powerOfTwo)
+        return;
+
+    d->settings.fftSize = powerOfTwo;
+    d->updateSettings();
+}
+
+/*!
+    Returns the fraction by which consecutive transforms overlap. The
+    default is 0.5.
+*/
+qreal QAudioSpectrumProbe::overlap() const
+{
+    return d->settings.overlap;
+}
+
+/*!
+    Sets the fraction by which consecutive transforms overlap to \a overlap,
+    which is clamped to the range [0, 0.95].
+
+    With an overlap of 0 every sample is transformed once; with an overlap
+    of 0.75 a transform starts every quarter \l fftSize().
+*/
+void QAudioSpectrumProbe::setOverlap(qreal overlap)
+{
+    overlap = qBound(qreal(0), overlap, qreal(0.95));
+    if (qFuzzyCompare(d->settings.overlap, overlap))
+        return;
+
+    d->settings.overlap = overlap;
+    d->updateSettings();
+}
+
+/*!
+    Returns the window applied before each transform. The default is
+    \l HannWindow.
+*/
+QAudioSpectrumProbe::WindowFunction QAudioSpectrumProbe::windowFunction() const
+{
+    return d->settings.windowFunction;
+}
+
+/*!
+    Sets the window applied before each transform to \a function.
+*/
+void QAudioSpectrumProbe::setWindowFunction(WindowFunction function)
+{
+    if (d->settings.windowFunction == function)
+        return;
+
+    d->settings.windowFunction = function;
+    d->updateSettings();
+}
+
+/*!
+    Returns the number of bands the spectrum is aggregated to, or 0 if
+    every bin is delivered. The default is 0.
+*/
+int QAudioSpectrumProbe::bandCount() const
+{
+    return d->settings.bandCount;
+}
+
+/*!
+    Sets the number of bands the spectrum is aggregated to to \a count.
+
+    The frequency range set with \l setFrequencyRange() is split into
+    \a count logarithmically spaced bands, and each band reports the
+    largest magnitude of the bins it covers. A band narrower than a bin
+    reports the bin its center falls into. With a \a count of 0 all
+    \c{fftSize() / 2 + 1} bins are delivered.
+*/
+void QAudioSpectrumProbe::setBandCount(int count)
+{
+    count = qMax(0, count);
+    if (d->settings.bandCount == count)
+        return;
+
+    d->settings.bandCount = count;
+    d->updateSettings();
+}
+
+/*!
+    Returns the lowest frequency covered by the bands in Hz. The default is
+    20 Hz.
+*/
+qreal QAudioSpectrumProbe::minimumFrequency() const
+{
+    return d->settings.minimumFrequency;
+}
+
+/*!
+    Returns the highest frequency covered by the bands in Hz. The default is
+    20 kHz. Frequencies above half the sample rate are not covered.
+*/
+qreal QAudioSpectrumProbe::maximumFrequency() const
+{
+    return d->settings.maximumFrequency;
+}
+
+/*!
+    Sets the frequency range split into bands to \a minimum to \a maximum
+    Hz. It has no effect while \l bandCount() is 0.
+*/
+void QAudioSpectrumProbe::setFrequencyRange(qreal minimum, qreal maximum)
+{
+    minimum = qMax(qreal(1), minimum);
+    maximum = qMax(minimum, maximum);
+    if (qFuzzyCompare(d->settings.minimumFrequency, minimum)
+            && qFuzzyCompare(d->settings.maximumFrequency, maximum)) {
+        return;
+    }
+
+    d->settings.minimumFrequency = minimum;
+    d->settings.maximumFrequency = maximum;
+    d->updateSettings();
+}
+
+/*!
+    Returns the number of spectra delivered per second of audio. The default
+    is 30.
+*/
+int QAudioSpectrumProbe::targetRate() const
+{
+    return d->settings.targetRate;
+}
+
+/*!
+    Sets the number of spectra delivered per second of audio to
+    \a spectraPerSecond.
+
+    When transforms are computed more often, the spectra computed between
+    two deliveries are combined by keeping the largest magnitude of every
+    bin or band, so short transients are not missed. When they are
+    computed less often, every spectrum is delivered. With a rate of 0
+    every spectrum is delivered as well.
+*/
+void QAudioSpectrumProbe::setTargetRate(int spectraPerSecond)
+{
+    spectraPerSecond = qMax(0, spectraPerSecond);
+    if (d->settings.targetRate == spectraPerSecond)
+        return;
+
+    d->settings.targetRate = spectraPerSecond;
+    d->updateSettings();
+}
+
+/*!
+    Returns the frequency in Hz of every value delivered with
+    \l spectrumProbed(), the center frequency of each band or the frequency
+    of each bin.
+
+    The frequencies depend on the sample rate of the audio, so they are
+    empty until audio has been probed.
+
+    \sa frequenciesChanged()
+*/
+QVector<float> QAudioSpectrumProbe::frequencies() const
+{
+    return d->frequencies;
+}
+
+/*!
+    \fn QAudioSpectrumProbe::spectrumProbed(const QVector<float> &magnitudes, qint64 startTime)
+
+    This signal is emitted when a spectrum has been computed.
+
+    \a magnitudes holds the magnitude of every band or bin, scaled so that a
+    full scale sine reads 1. \a startTime is the start time of the first
+    transform combined into this spectrum in microseconds.
+
+    \sa frequencies()
+*/
+
+/*!
+    \fn QAudioSpectrumProbe::frequenciesChanged(const QVector<float> &frequencies)
+
+    This signal is emitted before the first spectrum whose values correspond
+    to different \a frequencies than the previous one, which happens when
+    the settings or the sample rate change.
+*/
+
+QT_END_NAMESPACE
+
+#include "moc_qaudiospectrumprobe.cpp"
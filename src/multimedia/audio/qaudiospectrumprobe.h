@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QAUDIOSPECTRUMPROBE_H
+#define QAUDIOSPECTRUMPROBE_H
+
+#include <QtCore/qobject.h>
+#include <QtCore/qvector.h>
+#include <QtMultimedia/qtmultimediaglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+class QMediaObject;
+class QMediaRecorder;
+
+class QAudioSpectrumProbePrivate;
+class Q_MULTIMEDIA_EXPORT QAudioSpectrumProbe : public QObject
+{
+    Q_OBJECT
+public:
+    enum WindowFunction
+    {
+        RectangularWindow,
+        HannWindow,
+        BlackmanHarrisWindow
+    };
+    Q_ENUM(WindowFunction)
+
+    explicit QAudioSpectrumProbe(QObject *parent = Q_NULLPTR);
+    ~QAudioSpectrumProbe();
+
+    bool setSource(QMediaObject *source);
+    bool setSource(QMediaRecorder *source);
+
+    bool isActive() const;
+
+    int fftSize() const;
+    void setFftSize(int size);
+
+    qreal overlap() const;
+    void setOverlap(qreal overlap);
+
+    WindowFunction windowFunction() const;
+    void setWindowFunction(WindowFunction function);
+
+    int bandCount() const;
+    void setBandCount(int count);
+
+    qreal minimumFrequency() const;
+    qreal maximumFrequency() const;
+    void setFrequencyRange(qreal minimum, qreal maximum);
+
+    int targetRate() const;
+    void setTargetRate(int spectraPerSecond);
+
+    QVector<float> frequencies() const;
+
+Q_SIGNALS:
+    void spectrumProbed(const QVector<float> &magnitudes, qint64 startTime);
+    void frequenciesChanged(const QVector<float> &frequencies);
+
+private:
+    QAudioSpectrumProbePrivate *d;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIOSPECTRUMPROBE_H
@@ -0,0 +1,156 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qaudiostreamstats_p.h"
+
+#include <QtCore/qloggingcategory.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(qLcAudioStats, "qt.multimedia.audio.stats")
+
+void QAudioStreamStats::Histogram::reset()
+{
+    for (int i = 0; i < BucketCount; ++i)
+        buckets[i].store(0);
+    count.store(0);
+    sum.store(0);
+    min.store(0);
+    max.store(0);
+}
+
+void QAudioStreamStats::Histogram::add(qint64 value)
+{
+    value = qMax<qint64>(0, value);
+
+    int bucket = 0;
+    for (qint64 v = value >> 1; v && bucket < BucketCount - 1; v >>= 1)
+        ++bucket;
+    buckets[bucket].store(buckets[bucket].load() + 1);
+
+    const qint64 n = count.load();
+    min.store(n ? qMin(min.load(), value) : value);
+    max.store(qMax(max.load(), value));
+    sum.store(sum.load() + value);
+    count.storeRelease(n + 1);
+}
+
+QVariantMap QAudioStreamStats::Histogram::toVariantMap() const
+{
+    const qint64 n = count.loadAcquire();
+
+    QVariantList counts;
+    int last = BucketCount - 1;
+    while (last > 0 && !buckets[last].load())
+        --last;
+    for (int i = 0; i <= last; ++i)
+        counts.append(buckets[i].load());
+
+    QVariantMap map;
+    map.insert(QStringLiteral("count"), n);
+    map.insert(QStringLiteral("min"), min.load());
+    map.insert(QStringLiteral("max"), max.load());
+    map.insert(QStringLiteral("mean"), n ? sum.load() / n : 0);
+    map.insert(QStringLiteral("buckets"), counts);
+    return map;
+}
+
+QAudioStreamStats::QAudioStreamStats()
+{
+    reset();
+}
+
+void QAudioStreamStats::reset()
+{
+    m_underruns.store(0);
+    m_overruns.store(0);
+    m_bytes.store(0);
+    m_sinceLastFeed.invalidate();
+    m_feedTimer.invalidate();
+    m_feedInterval.reset();
+    m_bytesFree.reset();
+    m_feedDuration.reset();
+}
+
+void QAudioStreamStats::feedStarted(qint64 bytesFree)
+{
+    if (m_sinceLastFeed.isValid())
+        m_feedInterval.add(m_sinceLastFeed.nsecsElapsed() / 1000);
+    m_sinceLastFeed.start();
+    m_feedTimer.start();
+    m_bytesFree.add(bytesFree);
+}
+
+void QAudioStreamStats::feedFinished(qint64 bytes)
+{
+    if (!m_feedTimer.isValid())
+        return;
+
+    m_feedDuration.add(m_feedTimer.nsecsElapsed() / 1000);
+    m_feedTimer.invalidate();
+    m_bytes.store(m_bytes.load() + qMax<qint64>(0, bytes));
+}
+
+QVariantMap QAudioStreamStats::toVariantMap() const
+{
+    QVariantMap map;
+    map.insert(QStringLiteral("underruns"), m_underruns.load());
+    map.insert(QStringLiteral("overruns"), m_overruns.load());
+    map.insert(QStringLiteral("bytes"), m_bytes.load());
+    map.insert(QStringLiteral("feedIntervalUs"), m_feedInterval.toVariantMap());
+    map.insert(QStringLiteral("bytesFreeAtFeed"), m_bytesFree.toVariantMap());
+    map.insert(QStringLiteral("feedDurationUs"), m_feedDuration.toVariantMap());
+    return map;
+}
+
+void QAudioStreamStats::dump(const char *stream, const QByteArray &device) const
+{
+    if (!qLcAudioStats().isDebugEnabled())
+        return;
+
+    qCDebug(qLcAudioStats) << stream << device
+                           << "underruns" << m_underruns.load()
+                           << "overruns" << m_overruns.load()
+                           << "bytes" << m_bytes.load();
+    qCDebug(qLcAudioStats) << "  feed interval (us)" << m_feedInterval.toVariantMap();
+    qCDebug(qLcAudioStats) << "  bytes free at feed" << m_bytesFree.toVariantMap();
+    qCDebug(qLcAudioStats) << "  feed duration (us)" << m_feedDuration.toVariantMap();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,117 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QAUDIOSTREAMSTATS_P_H
+#define QAUDIOSTREAMSTATS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qtmultimediaglobal.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qvariant.h>
+
+QT_BEGIN_NAMESPACE
+
+// Per-stream glitch instrumentation shared by the audio backends.
+// Underruns and overruns may be recorded from any thread, the feed timings
+// from the one thread that feeds the device, and reset() only while no
+// stream is running. Every counter is atomic, so toVariantMap() and dump()
+// are safe from any thread at any time. A snapshot taken while the device
+// is fed may mix values from two consecutive feeds.
+class Q_MULTIMEDIA_EXPORT QAudioStreamStats
+{
+public:
+    QAudioStreamStats();
+
+    void reset();
+
+    void recordUnderrun() { m_underruns.ref(); }
+    void recordOverrun() { m_overruns.ref(); }
+
+    // Bracket one transfer between the application and the device. bytesFree
+    // is the space (output) or data (input) available when the transfer began.
+    void feedStarted(qint64 bytesFree);
+    void feedFinished(qint64 bytes);
+
+    QVariantMap toVariantMap() const;
+    void dump(const char *stream, const QByteArray &device) const;
+
+private:
+    // Power-of-two buckets: bucket 0 holds values below 2, bucket n values
+    // in [2^n, 2^(n+1)), the last one everything larger.
+    struct Histogram
+    {
+        enum { BucketCount = 32 };
+
+        void reset();
+        void add(qint64 value);
+        QVariantMap toVariantMap() const;
+
+        // A single thread writes, so plain loads and stores of the atomics
+        // are enough and the feeding thread never executes locked operations
+        QAtomicInteger<quint32> buckets[BucketCount];
+        QAtomicInteger<qint64> count;
+        QAtomicInteger<qint64> sum;
+        QAtomicInteger<qint64> min;
+        QAtomicInteger<qint64> max;
+    };
+
+    QAtomicInt m_underruns;
+    QAtomicInt m_overruns;
+    QAtomicInteger<qint64> m_bytes;
+    QElapsedTimer m_sinceLastFeed;
+    QElapsedTimer m_feedTimer;
+    Histogram m_feedInterval;
+    Histogram m_bytesFree;
+    Histogram m_feedDuration;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIOSTREAMSTATS_P_H
@@ -38,9 +38,167 @@
 ****************************************************************************/
 
 #include "qaudiosystem.h"
+#include "qaudiosystemext_p.h"
+
+#include <QtCore/qiodevice.h>
 
 QT_BEGIN_NAMESPACE
 
+QAudioOutputExtension::~QAudioOutputExtension()
+{
+}
+
+QAudioInputExtension::~QAudioInputExtension()
+{
+}
+
+// Adapters for backends without a native callback mode. They run the
+// callback from the pull mode of the backend, one period at a time, on
+// the thread of the audio object.
+
+static QString callbackDeviceName()
+{
+    return QStringLiteral("qt_audio_callback_device");
+}
+
+static int callbackPeriodBytes(const QAudioFormat &format, int periodSize)
+{
+    const int frameBytes = format.bytesPerFrame();
+    if (frameBytes <= 0)
+        return 0;
+
+    int bytes = periodSize > 0 ? periodSize : format.bytesForDuration(10000);
+    bytes -= bytes % frameBytes;
+    return qMax(bytes, frameBytes);
+}
+
+class QAudioRenderCallbackDevice : public QIODevice
+{
+public:
+    QAudioRenderCallbackDevice(QAbstractAudioOutput *output, QAudio::RenderCallback callback, void *userData)
+        : QIODevice(output)
+        , m_output(output)
+        , m_callback(callback)
+        , m_userData(userData)
+        , m_offset(0)
+    {
+        setObjectName(callbackDeviceName());
+    }
+
+    bool isSequential() const override { return true; }
+
+    qint64 bytesAvailable() const override
+    {
+        // There is always another period to render
+        return QIODevice::bytesAvailable() + qMax(m_period.size() - m_offset, m_output->periodSize());
+    }
+
+protected:
+    qint64 readData(char *data, qint64 len) override
+    {
+        qint64 read = 0;
+        while (read < len) {
+            if (m_offset == m_period.size()) {
+                const int bytes = callbackPeriodBytes(m_output->format(), m_output->periodSize());
+                if (bytes <= 0)
+                    break;
+                // Only reallocates if the period grew
+                m_period.resize(bytes);
+                m_callback(m_period.data(), bytes, m_userData);
+                m_offset = 0;
+            }
+
+            const int chunk = int(qMin<qint64>(len - read, m_period.size() - m_offset));
+            memcpy(data + read, m_period.constData() + m_offset, chunk);
+            m_offset += chunk;
+            read += chunk;
+        }
+        return read;
+    }
+
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    QAbstractAudioOutput *m_output;
+    QAudio::RenderCallback m_callback;
+    void *m_userData;
+    QByteArray m_period;
+    int m_offset;
+};
+
+class QAudioCaptureCallbackDevice : public QIODevice
+{
+public:
+    QAudioCaptureCallbackDevice(QAbstractAudioInput *input, QAudio::CaptureCallback callback, void *userData)
+        : QIODevice(input)
+        , m_input(input)
+        , m_callback(callback)
+        , m_userData(userData)
+        , m_fill(0)
+    {
+        setObjectName(callbackDeviceName());
+    }
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *, qint64) override { return -1; }
+
+    qint64 writeData(const char *data, qint64 len) override
+    {
+        qint64 written = 0;
+        while (written < len) {
+            if (m_fill == 0) {
+                const int bytes = callbackPeriodBytes(m_input->format(), m_input->periodSize());
+                if (bytes <= 0)
+                    return -1;
+                m_period.resize(bytes);
+            }
+
+            const int chunk = int(qMin<qint64>(len - written, m_period.size() - m_fill));
+            memcpy(m_period.data() + m_fill, data + written, chunk);
+            m_fill += chunk;
+            written += chunk;
+
+            if (m_fill == m_period.size()) {
+                m_callback(m_period.constData(), m_fill, m_userData);
+                m_fill = 0;
+            }
+        }
+        return written;
+    }
+
+private:
+    QAbstractAudioInput *m_input;
+    QAudio::CaptureCallback m_callback;
+    void *m_userData;
+    QByteArray m_period;
+    int m_fill;
+};
+
+void qt_startAudioCallback(QAbstractAudioOutput *output, QAudio::RenderCallback callback, void *userData)
+{
+    QIODevice *previous = output->findChild<QIODevice *>(callbackDeviceName(), Qt::FindDirectChildrenOnly);
+
+    QIODevice *device = new QAudioRenderCallbackDevice(output, callback, userData);
+    device->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    output->start(device);
+
+    // The backend let go of the previous device when it restarted
+    delete previous;
+}
+
+void qt_startAudioCallback(QAbstractAudioInput *input, QAudio::CaptureCallback callback, void *userData)
+{
+    QIODevice *previous = input->findChild<QIODevice *>(callbackDeviceName(), Qt::FindDirectChildrenOnly);
+
+    QIODevice *device = new QAudioCaptureCallbackDevice(input, callback, userData);
+    device->open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+    input->start(device);
+
+    delete previous;
+}
+
 /*!
     \class QAbstractAudioDeviceInfo
     \brief The QAbstractAudioDeviceInfo class is a base class for audio backends.
@@ -0,0 +1,108 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+
+#ifndef QAUDIOSYSTEMEXT_P_H
+#define QAUDIOSYSTEMEXT_P_H
+
+#include <QtMultimedia/qtmultimediaglobal.h>
+#include <QtMultimedia/qaudio.h>
+#include <QtMultimedia/qaudiobuffer.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qvariant.h>
+
+QT_BEGIN_NAMESPACE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+class QAbstractAudioOutput;
+class QAbstractAudioInput;
+class QAudioLoudnessMeter;
+
+// Implemented next to QAbstractAudioOutput by backends that support more
+// than the base class, found with qobject_cast so that plugins built
+// against an older QAbstractAudioOutput keep working.
+struct Q_MULTIMEDIA_EXPORT QAudioOutputExtension
+{
+    virtual ~QAudioOutputExtension();
+
+    virtual void setTargetLatency(qint64) {}
+    virtual qint64 targetLatency() const { return 0; }
+    virtual qint64 latency() const { return -1; }
+    // -1 lets QAudioOutput derive it from processedUSecs() and latency()
+    virtual qint64 presentedUSecs() const { return -1; }
+    virtual QVariantMap statistics() const { return QVariantMap(); }
+    virtual QAudioLoudnessMeter *loudnessMeter() { return Q_NULLPTR; }
+    // false if the backend has no callback mode of its own
+    virtual bool startCallback(QAudio::RenderCallback, void *) { return false; }
+};
+
+struct Q_MULTIMEDIA_EXPORT QAudioInputExtension
+{
+    virtual ~QAudioInputExtension();
+
+    virtual QAudioBuffer readBuffer() { return QAudioBuffer(); }
+    virtual void setTargetLatency(qint64) {}
+    virtual qint64 targetLatency() const { return 0; }
+    virtual qint64 latency() const { return -1; }
+    virtual QVariantMap statistics() const { return QVariantMap(); }
+    virtual QAudioLoudnessMeter *loudnessMeter() { return Q_NULLPTR; }
+    virtual bool startCallback(QAudio::CaptureCallback, void *) { return false; }
+};
+
+#define QAudioOutputExtension_iid "org.qt-project.qt.audiooutputextension"
+Q_DECLARE_INTERFACE(QAudioOutputExtension, QAudioOutputExtension_iid)
+
+#define QAudioInputExtension_iid "org.qt-project.qt.audioinputextension"
+Q_DECLARE_INTERFACE(QAudioInputExtension, QAudioInputExtension_iid)
+
+// Run the callback from the pull mode of the backend, on the thread of the audio object
+void qt_startAudioCallback(QAbstractAudioOutput *output, QAudio::RenderCallback callback, void *userData);
+void qt_startAudioCallback(QAbstractAudioInput *input, QAudio::CaptureCallback callback, void *userData);
+
+QT_END_NAMESPACE
+
+#endif // QAUDIOSYSTEMEXT_P_H
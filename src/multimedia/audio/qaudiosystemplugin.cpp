@@ -129,6 +129,19 @@ QAudioSystemPlugin::~QAudioSystemPlugin()
 
 */
 
+/*!
+    \fn void QAudioSystemPlugin::availableDevicesChanged(QAudio::Mode mode)
+    \since 5.11
+
+    Signals that the list returned by availableDevices() for \a mode may have
+    changed, for example because a device was plugged in or removed.
+
+    Plugins that cache their device list emit this signal after invalidating the
+    cache. The signal must be emitted from the thread the plugin lives in.
+
+    \sa QAudioDeviceWatcher
+*/
+
 
 QT_END_NAMESPACE
 
@@ -85,6 +85,9 @@ public:
     QAbstractAudioInput* createInput(const QByteArray& device) override = 0;
     QAbstractAudioOutput* createOutput(const QByteArray& device) override = 0;
     QAbstractAudioDeviceInfo* createDeviceInfo(const QByteArray& device, QAudio::Mode mode) override = 0;
+
+Q_SIGNALS:
+    void availableDevicesChanged(QAudio::Mode mode);
 };
 
 QT_END_NAMESPACE
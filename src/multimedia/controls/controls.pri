@@ -41,7 +41,9 @@ PUBLIC_HEADERS += \
 
 PRIVATE_HEADERS += \
     controls/qmediaplaylistcontrol_p.h \
-    controls/qmediaplaylistsourcecontrol_p.h
+    controls/qmediaplaylistsourcecontrol_p.h \
+    controls/qmediaaudioprobecontrol_p.h \
+    controls/qmediavideoprobecontrol_p.h
 
 SOURCES += \
     controls/qcameracapturebufferformatcontrol.cpp \
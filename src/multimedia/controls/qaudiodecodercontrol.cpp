@@ -261,6 +261,62 @@ QAudioDecoderControl::QAudioDecoderControl(QObject *parent):
     or -1 if not available.
 */
 
+/*!
+    Returns the position (in milliseconds) decoding starts at.
+
+    The default implementation returns 0.
+
+    \since 5.11
+    \sa setStartPosition()
+*/
+qint64 QAudioDecoderControl::startPosition() const
+{
+    return 0;
+}
+
+/*!
+    Sets the \a position (in milliseconds) decoding starts at. Backends that
+    support time ranges seek to \a position before decoding and trim the
+    samples before it from the first buffer.
+
+    The default implementation does nothing.
+
+    \since 5.11
+*/
+void QAudioDecoderControl::setStartPosition(qint64 position)
+{
+    Q_UNUSED(position);
+}
+
+/*!
+    Returns the position (in milliseconds) decoding stops at, or -1 if
+    decoding continues to the end of the stream.
+
+    The default implementation returns -1.
+
+    \since 5.11
+    \sa setEndPosition()
+*/
+qint64 QAudioDecoderControl::endPosition() const
+{
+    return -1;
+}
+
+/*!
+    Sets the \a position (in milliseconds) decoding stops at. Backends that
+    support time ranges finish decoding at \a position and trim the samples
+    after it from the last buffer. A \a position of -1 decodes to the end
+    of the stream.
+
+    The default implementation does nothing.
+
+    \since 5.11
+*/
+void QAudioDecoderControl::setEndPosition(qint64 position)
+{
+    Q_UNUSED(position);
+}
+
 #include "moc_qaudiodecodercontrol.cpp"
 QT_END_NAMESPACE
 
@@ -77,6 +77,12 @@ public:
     virtual qint64 position() const = 0;
     virtual qint64 duration() const = 0;
 
+    virtual qint64 startPosition() const;
+    virtual void setStartPosition(qint64 position);
+
+    virtual qint64 endPosition() const;
+    virtual void setEndPosition(qint64 position);
+
 Q_SIGNALS:
     void stateChanged(QAudioDecoder::State newState);
     void formatChanged(const QAudioFormat &format);
@@ -38,7 +38,7 @@
 ****************************************************************************/
 
 #include "qmediaaudioprobecontrol.h"
-#include "qmediacontrol_p.h"
+#include "qmediaaudioprobecontrol_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -74,7 +74,7 @@ QT_BEGIN_NAMESPACE
   Create a new media audio probe control object with the given \a parent.
 */
 QMediaAudioProbeControl::QMediaAudioProbeControl(QObject *parent)
-    : QMediaControl(*new QMediaControlPrivate, parent)
+    : QMediaControl(*new QMediaAudioProbeControlPrivate, parent)
 {
 }
 
@@ -97,6 +97,40 @@ QMediaAudioProbeControl::~QMediaAudioProbeControl()
     This signal should be emitted when it is required to release all frames.
 */
 
+QAudioProbeListener::~QAudioProbeListener()
+{
+}
+
+void QMediaAudioProbeControlPrivate::addListener(QAudioProbeListener *listener)
+{
+    QMutexLocker locker(&mutex);
+    if (!listeners.contains(listener)) {
+        listeners.append(listener);
+        listenerCount.ref();
+    }
+}
+
+void QMediaAudioProbeControlPrivate::removeListener(QAudioProbeListener *listener)
+{
+    QMutexLocker locker(&mutex);
+    if (listeners.removeOne(listener))
+        listenerCount.deref();
+}
+
+/*
+    Called by backends for every probed \a buffer, on the thread the buffer
+    has been produced on.
+*/
+void QMediaAudioProbeControlPrivate::probeBuffer(const QAudioBuffer &buffer)
+{
+    if (!hasListeners())
+        return;
+
+    QMutexLocker locker(&mutex);
+    for (QAudioProbeListener *listener : qAsConst(listeners))
+        listener->audioBufferProbed(buffer);
+}
+
 #include "moc_qmediaaudioprobecontrol.cpp"
 
 QT_END_NAMESPACE
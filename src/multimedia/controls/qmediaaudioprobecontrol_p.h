@@ -0,0 +1,116 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QMEDIAAUDIOPROBECONTROL_P_H
+#define QMEDIAAUDIOPROBECONTROL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <qmediaaudioprobecontrol.h>
+#include <private/qmediacontrol_p.h>
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+class QAudioBuffer;
+
+class Q_MULTIMEDIA_EXPORT QAudioProbeListener
+{
+public:
+    virtual ~QAudioProbeListener();
+
+    // Called on the thread the backend produces buffers on. The buffer may
+    // be kept, but zero-copy backends then can't reuse or modify the memory
+    // behind it in place, so listeners keeping buffers beyond the call
+    // should copy them.
+    virtual void audioBufferProbed(const QAudioBuffer &buffer) = 0;
+};
+
+class Q_MULTIMEDIA_EXPORT QMediaAudioProbeControlPrivate : public QMediaControlPrivate
+{
+public:
+    QMediaAudioProbeControlPrivate() : supportsListeners(false) {}
+
+    static QMediaAudioProbeControlPrivate *get(QMediaAudioProbeControl *control)
+    {
+        return control->d_func();
+    }
+
+    void addListener(QAudioProbeListener *listener);
+    void removeListener(QAudioProbeListener *listener);
+
+    bool hasListeners() const { return listenerCount.load() > 0; }
+
+    // Set by backends that hand their buffers to probeBuffer(). Listeners
+    // registered with other backends never receive anything.
+    void setListenersSupported(bool supported) { supportsListeners = supported; }
+    bool listenersSupported() const { return supportsListeners; }
+
+    void probeBuffer(const QAudioBuffer &buffer);
+
+    // Counts buffers a backend replaced before audioBufferProbed() could
+    // deliver them.
+    void bufferDropped() { droppedBuffers.fetchAndAddRelaxed(1); }
+    quint64 droppedBufferCount() const { return droppedBuffers.load(); }
+
+private:
+    // Held while listeners run, so a listener is never called after
+    // removeListener() has returned.
+    QMutex mutex;
+    QVector<QAudioProbeListener *> listeners;
+    QAtomicInt listenerCount;
+    QAtomicInteger<quint64> droppedBuffers;
+    bool supportsListeners;
+};
+
+QT_END_NAMESPACE
+
+#endif // QMEDIAAUDIOPROBECONTROL_P_H
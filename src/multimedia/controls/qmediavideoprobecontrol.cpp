@@ -38,7 +38,7 @@
 ****************************************************************************/
 
 #include "qmediavideoprobecontrol.h"
-#include "qmediacontrol_p.h"
+#include "qmediavideoprobecontrol_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -74,7 +74,7 @@ QT_BEGIN_NAMESPACE
   Create a new media video probe control object with the given \a parent.
 */
 QMediaVideoProbeControl::QMediaVideoProbeControl(QObject *parent)
-    : QMediaControl(*new QMediaControlPrivate, parent)
+    : QMediaControl(*new QMediaVideoProbeControlPrivate, parent)
 {
 }
 
@@ -96,6 +96,54 @@ QMediaVideoProbeControl::~QMediaVideoProbeControl()
     This signal should be emitted when it is required to release all frames.
 */
 
+QVideoProbeListener::~QVideoProbeListener()
+{
+}
+
+void QVideoProbeListener::flush()
+{
+}
+
+void QMediaVideoProbeControlPrivate::addListener(QVideoProbeListener *listener)
+{
+    QMutexLocker locker(&mutex);
+    if (!listeners.contains(listener)) {
+        listeners.append(listener);
+        listenerCount.ref();
+    }
+}
+
+void QMediaVideoProbeControlPrivate::removeListener(QVideoProbeListener *listener)
+{
+    QMutexLocker locker(&mutex);
+    if (listeners.removeOne(listener))
+        listenerCount.deref();
+}
+
+/*
+    Called by backends for every probed \a frame, on the thread the frame
+    has been produced on.
+*/
+void QMediaVideoProbeControlPrivate::probeFrame(const QVideoFrame &frame)
+{
+    if (!hasListeners())
+        return;
+
+    QMutexLocker locker(&mutex);
+    for (QVideoProbeListener *listener : qAsConst(listeners))
+        listener->videoFrameProbed(frame);
+}
+
+void QMediaVideoProbeControlPrivate::flush()
+{
+    if (!hasListeners())
+        return;
+
+    QMutexLocker locker(&mutex);
+    for (QVideoProbeListener *listener : qAsConst(listeners))
+        listener->flush();
+}
+
 #include "moc_qmediavideoprobecontrol.cpp"
 
 QT_END_NAMESPACE
@@ -47,6 +47,7 @@
 QT_BEGIN_NAMESPACE
 
 class QVideoFrame;
+class QMediaVideoProbeControlPrivate;
 class Q_MULTIMEDIA_EXPORT QMediaVideoProbeControl : public QMediaControl
 {
     Q_OBJECT
@@ -59,6 +60,9 @@ Q_SIGNALS:
 
 protected:
     explicit QMediaVideoProbeControl(QObject *parent = Q_NULLPTR);
+
+private:
+    Q_DECLARE_PRIVATE(QMediaVideoProbeControl)
 };
 
 #define QMediaVideoProbeControl_iid "org.qt-project.qt.mediavideoprobecontrol/5.0"
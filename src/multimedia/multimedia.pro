@@ -26,6 +26,7 @@ PRIVATE_HEADERS += \
     qmediaresourceset_p.h \
     qmediastoragelocation_p.h \
     qmediaopenglhelper_p.h \
+    qmediaprobequeue_p.h \
     qmultimediautils_p.h
 
 PUBLIC_HEADERS += \
@@ -49,6 +49,9 @@
 #include <qmediaplaylistsourcecontrol_p.h>
 #include <qmedianetworkaccesscontrol.h>
 #include <qaudiorolecontrol.h>
+#include <qmediaaudioprobecontrol.h>
+#include <private/qmediaaudioprobecontrol_p.h>
+#include <private/qaudioloudnessmeter_p.h>
 
 #include <QtCore/qcoreevent.h>
 #include <QtCore/qmetaobject.h>
@@ -111,6 +114,8 @@ public:
         : provider(0)
         , control(0)
         , audioRoleControl(0)
+        , loudnessProbe(0)
+        , loudnessMeter(0)
         , playlist(0)
         , networkAccessControl(0)
         , state(QMediaPlayer::StoppedState)
@@ -124,6 +129,8 @@ public:
     QMediaServiceProvider *provider;
     QMediaPlayerControl* control;
     QAudioRoleControl *audioRoleControl;
+    QMediaAudioProbeControl *loudnessProbe;
+    QAudioLoudnessMeter *loudnessMeter;
     QString errorString;
 
     QPointer<QObject> videoOutput;
@@ -145,6 +152,8 @@ public:
     QMediaPlaylist *parentPlaylist(QMediaPlaylist *pls);
     bool isInChain(const QUrl &url);
 
+    QAudioLoudnessMeter *meter();
+    void stopLoudnessMetering();
     void setMedia(const QMediaContent &media, QIODevice *stream = 0);
 
     void setPlaylist(QMediaPlaylist *playlist);
@@ -330,6 +339,30 @@ void QMediaPlayerPrivate::_q_playlistDestroyed()
     setMedia(QMediaContent(), 0);
 }
 
+QAudioLoudnessMeter *QMediaPlayerPrivate::meter()
+{
+    Q_Q(QMediaPlayer);
+
+    if (!loudnessMeter) {
+        loudnessMeter = new QAudioLoudnessMeter(q);
+        // Emitted on the streaming thread, queued to the player's
+        QObject::connect(loudnessMeter, &QAudioLoudnessMeter::loudnessChanged,
+                         q, &QMediaPlayer::loudnessChanged, Qt::QueuedConnection);
+    }
+    return loudnessMeter;
+}
+
+void QMediaPlayerPrivate::stopLoudnessMetering()
+{
+    if (!loudnessProbe)
+        return;
+
+    loudnessMeter->setEnabled(false);
+    QMediaAudioProbeControlPrivate::get(loudnessProbe)->removeListener(loudnessMeter);
+    service->releaseControl(loudnessProbe);
+    loudnessProbe = 0;
+}
+
 void QMediaPlayerPrivate::setMedia(const QMediaContent &media, QIODevice *stream)
 {
     Q_Q(QMediaPlayer);
@@ -337,6 +370,10 @@ void QMediaPlayerPrivate::setMedia(const QMediaContent &media, QIODevice *stream
     if (!control)
         return;
 
+    // Every item is measured on its own
+    if (loudnessMeter)
+        loudnessMeter->reset();
+
     QScopedPointer<QFile> file;
 
     // Backends can't play qrc files directly.
@@ -641,6 +678,7 @@ QMediaPlayer::~QMediaPlayer()
             d->service->releaseControl(d->control);
         if (d->audioRoleControl)
             d->service->releaseControl(d->audioRoleControl);
+        d->stopLoudnessMetering();
 
         d->provider->releaseService(d->service);
     }
@@ -1182,6 +1220,109 @@ QList<QAudio::Role> QMediaPlayer::supportedAudioRoles() const
     return QList<QAudio::Role>();
 }
 
+/*!
+    \since 5.11
+
+    Enables loudness metering of the played audio if \a enabled is true.
+
+    The meter measures momentary, short-term and integrated loudness and the
+    true peak as described by ITU-R BS.1770-4 and EBU R 128, before the
+    player's volume is applied. It runs on the media backend's streaming
+    thread. The measurement restarts for every new media and playlist item
+    and with resetLoudness().
+
+    Metering needs a backend that supports \l QAudioProbe, such as the
+    GStreamer backend, which measures the audio entering its audio sink.
+    Otherwise isLoudnessMeteringEnabled() stays false.
+
+    \sa loudness(), loudnessChanged()
+*/
+void QMediaPlayer::setLoudnessMeteringEnabled(bool enabled)
+{
+    Q_D(QMediaPlayer);
+
+    if (!enabled) {
+        d->stopLoudnessMetering();
+        return;
+    }
+
+    if (d->loudnessProbe || !d->service)
+        return;
+
+    d->loudnessProbe = d->service->requestControl<QMediaAudioProbeControl *>();
+    if (!d->loudnessProbe)
+        return;
+
+    d->meter()->setEnabled(true);
+    QMediaAudioProbeControlPrivate::get(d->loudnessProbe)->addListener(d->loudnessMeter);
+}
+
+/*!
+    \since 5.11
+
+    Returns true if the loudness of the played audio is measured.
+*/
+bool QMediaPlayer::isLoudnessMeteringEnabled() const
+{
+    Q_D(const QMediaPlayer);
+
+    return d->loudnessProbe != 0;
+}
+
+/*!
+    \since 5.11
+
+    Sets the interval of played audio after which loudnessChanged() is
+    emitted to \a milliSeconds. The default is 100 milliseconds, 0 disables
+    the signal.
+*/
+void QMediaPlayer::setLoudnessNotifyInterval(int milliSeconds)
+{
+    Q_D(QMediaPlayer);
+
+    d->meter()->setNotifyInterval(milliSeconds);
+}
+
+/*!
+    \since 5.11
+
+    Returns the interval of played audio after which loudnessChanged() is
+    emitted, in milliseconds.
+*/
+int QMediaPlayer::loudnessNotifyInterval() const
+{
+    Q_D(const QMediaPlayer);
+
+    return d->loudnessMeter ? d->loudnessMeter->notifyInterval() : 100;
+}
+
+/*!
+    \since 5.11
+
+    Returns the latest loudness measurement, or an invalid one if metering
+    isn't enabled or nothing has been measured yet.
+*/
+QAudioLoudness QMediaPlayer::loudness() const
+{
+    Q_D(const QMediaPlayer);
+
+    return d->loudnessMeter ? d->loudnessMeter->loudness() : QAudioLoudness();
+}
+
+/*!
+    \since 5.11
+
+    Restarts the loudness measurement, discarding the integrated loudness
+    and the true peak measured so far.
+*/
+void QMediaPlayer::resetLoudness()
+{
+    Q_D(QMediaPlayer);
+
+    if (d->loudnessMeter)
+        d->loudnessMeter->reset();
+}
+
 // Enums
 /*!
     \enum QMediaPlayer::State
@@ -1281,6 +1422,17 @@ QList<QAudio::Role> QMediaPlayer::supportedAudioRoles() const
     Signals the \a seekable status of the player object has changed.
 */
 
+/*!
+    \fn void QMediaPlayer::loudnessChanged(const QAudioLoudness &loudness)
+    \since 5.11
+
+    This signal is emitted with the current \a loudness every
+    loudnessNotifyInterval() of played audio while loudness metering is
+    enabled.
+
+    \sa setLoudnessMeteringEnabled()
+*/
+
 /*!
     \fn void QMediaPlayer::audioRoleChanged(QAudio::Role role)
 
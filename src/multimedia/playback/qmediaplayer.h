@@ -44,6 +44,7 @@
 #include <QtMultimedia/qmediacontent.h>
 #include <QtMultimedia/qmediaenumdebug.h>
 #include <QtMultimedia/qaudio.h>
+#include <QtMultimedia/qaudioloudness.h>
 
 #include <QtNetwork/qnetworkconfiguration.h>
 
@@ -163,6 +164,13 @@ public:
     void setAudioRole(QAudio::Role audioRole);
     QList<QAudio::Role> supportedAudioRoles() const;
 
+    void setLoudnessMeteringEnabled(bool enabled);
+    bool isLoudnessMeteringEnabled() const;
+    void setLoudnessNotifyInterval(int milliSeconds);
+    int loudnessNotifyInterval() const;
+    QAudioLoudness loudness() const;
+    void resetLoudness();
+
 public Q_SLOTS:
     void play();
     void pause();
@@ -200,6 +208,7 @@ Q_SIGNALS:
     void playbackRateChanged(qreal rate);
 
     void audioRoleChanged(QAudio::Role role);
+    void loudnessChanged(const QAudioLoudness &loudness);
 
     void error(QMediaPlayer::Error error);
 
@@ -0,0 +1,180 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QMEDIAPROBEQUEUE_P_H
+#define QMEDIAPROBEQUEUE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <qtmultimediaglobal.h>
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qqueue.h>
+#include <QtCore/qwaitcondition.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    Bounded queue between the thread a media backend probes buffers on and the
+    thread of the probe consuming them. When full, the producer either drops
+    the oldest item or waits for the consumer, but never longer than
+    BlockTimeout so that a consumer stopping the pipeline can't deadlock it.
+    Every dropped item is counted.
+*/
+template <typename T>
+class QMediaProbeQueue
+{
+public:
+    enum { BlockTimeout = 500 };
+
+    QMediaProbeQueue()
+        : m_limit(8)
+        , m_block(false)
+        , m_closed(false)
+        , m_notifyPending(false)
+        , m_dropped(0)
+    {}
+
+    int limit() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_limit;
+    }
+
+    void setLimit(int limit)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_limit = qMax(1, limit);
+        m_notFull.wakeAll();
+    }
+
+    void setBlocking(bool block)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_block = block;
+        m_notFull.wakeAll();
+    }
+
+    // Returns true if the consumer has to be notified about new items
+    bool enqueue(const T &item)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (m_block && !m_closed && m_queue.size() >= m_limit) {
+            QElapsedTimer timer;
+            timer.start();
+            while (!m_closed && m_queue.size() >= m_limit) {
+                const qint64 remaining = BlockTimeout - timer.elapsed();
+                if (remaining <= 0 || !m_notFull.wait(&m_mutex, ulong(remaining)))
+                    break;
+            }
+        }
+
+        if (m_closed)
+            return false;
+
+        while (m_queue.size() >= m_limit) {
+            m_queue.dequeue();
+            ++m_dropped;
+        }
+        m_queue.enqueue(item);
+
+        if (m_notifyPending)
+            return false;
+        m_notifyPending = true;
+        return true;
+    }
+
+    QQueue<T> takeAll()
+    {
+        QMutexLocker locker(&m_mutex);
+        QQueue<T> items;
+        items.swap(m_queue);
+        m_notifyPending = false;
+        m_notFull.wakeAll();
+        return items;
+    }
+
+    void clear()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_queue.clear();
+        m_notFull.wakeAll();
+    }
+
+    // A closed queue rejects items and releases a waiting producer
+    void setClosed(bool closed)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed = closed;
+        if (closed)
+            m_queue.clear();
+        m_notFull.wakeAll();
+    }
+
+    quint64 dropped() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_dropped;
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QWaitCondition m_notFull;
+    QQueue<T> m_queue;
+    int m_limit;
+    bool m_block;
+    bool m_closed;
+    bool m_notifyPending;
+    quint64 m_dropped;
+};
+
+QT_END_NAMESPACE
+
+#endif // QMEDIAPROBEQUEUE_P_H
@@ -39,6 +39,7 @@
 
 #include <QtCore/qdebug.h>
 #include <QtCore/qmap.h>
+#include <QtCore/qmutex.h>
 
 #include "qmediaservice.h"
 #include "qmediaserviceprovider_p.h"
@@ -313,10 +314,13 @@ class QPluginServiceProvider : public QMediaServiceProvider
     };
 
     QMap<const QMediaService*, MediaServiceData> mediaServiceData;
+    // Services may be requested from worker threads, see QAudioBatchDecoder
+    mutable QMutex mutex;
 
 public:
     QMediaService* requestService(const QByteArray &type, const QMediaServiceProviderHint &hint) override
     {
+        QMutexLocker locker(&mutex);
         QString key(QLatin1String(type.constData()));
 
         QList<QMediaServiceProviderPlugin *>plugins;
@@ -443,6 +447,7 @@ public:
     void releaseService(QMediaService *service) override
     {
         if (service != 0) {
+            QMutexLocker locker(&mutex);
             MediaServiceData d = mediaServiceData.take(service);
 
             if (d.plugin != 0)
@@ -453,6 +458,7 @@ public:
     QMediaServiceProviderHint::Features supportedFeatures(const QMediaService *service) const override
     {
         if (service) {
+            QMutexLocker locker(&mutex);
             MediaServiceData d = mediaServiceData.value(service);
 
             if (d.plugin) {
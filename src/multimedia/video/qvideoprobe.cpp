@@ -68,6 +68,8 @@
 
 #include "qvideoprobe.h"
 #include "qmediavideoprobecontrol.h"
+#include "qmediavideoprobecontrol_p.h"
+#include "qvideoprobedispatcher_p.h"
 #include "qmediaservice.h"
 #include "qmediarecorder.h"
 #include "qsharedpointer.h"
@@ -77,10 +79,64 @@ QT_BEGIN_NAMESPACE
 
 class QVideoProbePrivate {
 public:
+    QVideoProbePrivate(QVideoProbe *q)
+        : q(q)
+        , deliveryMode(QVideoProbe::LatestDelivery)
+        , queueLimit(8)
+        , overflowPolicy(QVideoProbe::DropOldest)
+        , callback(Q_NULLPTR)
+        , userData(Q_NULLPTR)
+        , dispatcher(0)
+        , droppedBase(0)
+    {}
+
+    void connectControl();
+    void disconnectControl();
+
+    QVideoProbe *q;
     QPointer<QMediaObject> source;
     QPointer<QMediaVideoProbeControl> probee;
+
+    QVideoProbe::DeliveryMode deliveryMode;
+    int queueLimit;
+    QVideoProbe::OverflowPolicy overflowPolicy;
+    QVideoProbe::FrameCallback callback;
+    void *userData;
+    QVideoProbeDispatcher *dispatcher;
+    quint64 droppedBase;
 };
 
+void QVideoProbePrivate::connectControl()
+{
+    if (deliveryMode == QVideoProbe::LatestDelivery) {
+        droppedBase = QMediaVideoProbeControlPrivate::get(probee.data())->droppedFrameCount();
+        QObject::connect(probee.data(), SIGNAL(videoFrameProbed(QVideoFrame)), q, SIGNAL(videoFrameProbed(QVideoFrame)));
+    } else {
+        if (!dispatcher) {
+            dispatcher = new QVideoProbeDispatcher(q);
+            QObject::connect(dispatcher, SIGNAL(frameReady(QVideoFrame)),
+                             q, SIGNAL(videoFrameProbed(QVideoFrame)));
+        }
+        dispatcher->setDirect(deliveryMode == QVideoProbe::DirectDelivery, callback, userData);
+        dispatcher->queue().setLimit(queueLimit);
+        dispatcher->queue().setBlocking(overflowPolicy == QVideoProbe::Block);
+        dispatcher->queue().setClosed(false);
+        QMediaVideoProbeControlPrivate::get(probee.data())->addListener(dispatcher);
+    }
+    QObject::connect(probee.data(), SIGNAL(flush()), q, SIGNAL(flush()));
+}
+
+void QVideoProbePrivate::disconnectControl()
+{
+    QObject::disconnect(probee.data(), SIGNAL(videoFrameProbed(QVideoFrame)), q, SIGNAL(videoFrameProbed(QVideoFrame)));
+    QObject::disconnect(probee.data(), SIGNAL(flush()), q, SIGNAL(flush()));
+    if (dispatcher) {
+        // Release a streaming thread waiting for room in the queue first
+        dispatcher->queue().setClosed(true);
+        QMediaVideoProbeControlPrivate::get(probee.data())->removeListener(dispatcher);
+    }
+}
+
 /*!
     Creates a new QVideoProbe class with \a parent. After setting the
     source to monitor with \l setSource(), the \l videoFrameProbed()
@@ -89,7 +145,7 @@ public:
  */
 QVideoProbe::QVideoProbe(QObject *parent)
     : QObject(parent)
-    , d(new QVideoProbePrivate)
+    , d(new QVideoProbePrivate(this))
 {
 
 }
@@ -102,10 +158,8 @@ QVideoProbe::~QVideoProbe()
 {
     if (d->source) {
         // Disconnect
-        if (d->probee) {
-            disconnect(d->probee.data(), SIGNAL(videoFrameProbed(QVideoFrame)), this, SIGNAL(videoFrameProbed(QVideoFrame)));
-            disconnect(d->probee.data(), SIGNAL(flush()), this, SIGNAL(flush()));
-        }
+        if (d->probee)
+            d->disconnectControl();
         d->source.data()->service()->releaseControl(d->probee.data());
     }
 }
@@ -132,16 +186,14 @@ bool QVideoProbe::setSource(QMediaObject *source)
 
     // in case source was destroyed but probe control is still valid
     if (!d->source && d->probee) {
-        disconnect(d->probee.data(), SIGNAL(videoFrameProbed(QVideoFrame)), this, SIGNAL(videoFrameProbed(QVideoFrame)));
-        disconnect(d->probee.data(), SIGNAL(flush()), this, SIGNAL(flush()));
+        d->disconnectControl();
         d->probee.clear();
     }
 
     if (source != d->source.data()) {
         if (d->source) {
             Q_ASSERT(d->probee);
-            disconnect(d->probee.data(), SIGNAL(videoFrameProbed(QVideoFrame)), this, SIGNAL(videoFrameProbed(QVideoFrame)));
-            disconnect(d->probee.data(), SIGNAL(flush()), this, SIGNAL(flush()));
+            d->disconnectControl();
             d->source.data()->service()->releaseControl(d->probee.data());
             d->source.clear();
             d->probee.clear();
@@ -154,8 +206,7 @@ bool QVideoProbe::setSource(QMediaObject *source)
             }
 
             if (d->probee) {
-                connect(d->probee.data(), SIGNAL(videoFrameProbed(QVideoFrame)), this, SIGNAL(videoFrameProbed(QVideoFrame)));
-                connect(d->probee.data(), SIGNAL(flush()), this, SIGNAL(flush()));
+                d->connectControl();
                 d->source = source;
             }
         }
@@ -201,6 +252,166 @@ bool QVideoProbe::isActive() const
     return d->probee != 0;
 }
 
+/*!
+    \enum QVideoProbe::DeliveryMode
+    \since 5.11
+
+    Selects how video frames are handed to the application.
+
+    \value LatestDelivery  Frames are delivered with \l videoFrameProbed() on the
+                           probe's thread. If that thread is busy, only the most
+                           recent frame is delivered once it gets to it.
+    \value QueuedDelivery  Frames are queued up to \l queueLimit() and all of them
+                           are delivered with \l videoFrameProbed() on the probe's
+                           thread. When the queue is full the \l overflowPolicy()
+                           applies and dropped frames are counted.
+    \value DirectDelivery  The callback set with \l setFrameCallback() is invoked
+                           for every frame on the thread the media backend
+                           produces it on, without involving the probe's thread.
+
+    \sa setDeliveryMode()
+*/
+
+/*!
+    \enum QVideoProbe::OverflowPolicy
+    \since 5.11
+
+    Selects what happens when the queue of a probe in \l QueuedDelivery mode
+    is full.
+
+    \value DropOldest The oldest queued frame is dropped.
+    \value Block      The media backend waits for the probe's thread to catch
+                      up, but never longer than half a second per frame.
+*/
+
+/*!
+    \typedef QVideoProbe::FrameCallback
+    \since 5.11
+
+    The callback invoked for every frame in \l DirectDelivery mode, a
+    pointer to a function of the form
+    \c{void callback(const QVideoFrame &frame, void *userData)}.
+*/
+
+/*!
+    \since 5.11
+
+    Returns how video frames are handed to the application. The default is
+    \l LatestDelivery.
+*/
+QVideoProbe::DeliveryMode QVideoProbe::deliveryMode() const
+{
+    return d->deliveryMode;
+}
+
+/*!
+    \since 5.11
+
+    Sets how video frames are handed to the application to \a mode.
+
+    \l QueuedDelivery and \l DirectDelivery need support from the media
+    backend, which is currently provided by the GStreamer backend. Queued
+    frames are discarded when \l flush() is emitted.
+*/
+void QVideoProbe::setDeliveryMode(DeliveryMode mode)
+{
+    if (d->deliveryMode == mode)
+        return;
+
+    if (d->probee)
+        d->disconnectControl();
+    d->deliveryMode = mode;
+    if (d->probee)
+        d->connectControl();
+}
+
+/*!
+    \since 5.11
+
+    Returns the maximum number of frames queued in \l QueuedDelivery mode.
+    The default is 8.
+*/
+int QVideoProbe::queueLimit() const
+{
+    return d->queueLimit;
+}
+
+/*!
+    \since 5.11
+
+    Sets the maximum number of frames queued in \l QueuedDelivery mode to
+    \a frames. Queued frames can keep the backend's video buffers alive,
+    so keep this small.
+*/
+void QVideoProbe::setQueueLimit(int frames)
+{
+    d->queueLimit = qMax(1, frames);
+    if (d->dispatcher)
+        d->dispatcher->queue().setLimit(d->queueLimit);
+}
+
+/*!
+    \since 5.11
+
+    Returns what happens when the queue is full in \l QueuedDelivery mode.
+    The default is \l DropOldest.
+*/
+QVideoProbe::OverflowPolicy QVideoProbe::overflowPolicy() const
+{
+    return d->overflowPolicy;
+}
+
+/*!
+    \since 5.11
+
+    Sets what happens when the queue is full in \l QueuedDelivery mode to
+    \a policy.
+*/
+void QVideoProbe::setOverflowPolicy(OverflowPolicy policy)
+{
+    d->overflowPolicy = policy;
+    if (d->dispatcher)
+        d->dispatcher->queue().setBlocking(policy == Block);
+}
+
+/*!
+    \since 5.11
+
+    Sets the \a callback invoked for every frame in \l DirectDelivery mode,
+    which is passed \a userData along with the frame.
+
+    The callback runs on the media backend's streaming thread and must be
+    thread-safe. It must return quickly, since the backend can't process
+    more media until it does, and must not keep the frame after returning.
+*/
+void QVideoProbe::setFrameCallback(FrameCallback callback, void *userData)
+{
+    if (d->probee)
+        d->disconnectControl();
+    d->callback = callback;
+    d->userData = userData;
+    if (d->probee)
+        d->connectControl();
+}
+
+/*!
+    \since 5.11
+
+    Returns the number of frames dropped because the queue was full in
+    \l QueuedDelivery mode. In \l LatestDelivery mode it is the number of
+    frames replaced by a newer one before they could be delivered since the
+    probe was connected, as far as the media backend reports them.
+*/
+quint64 QVideoProbe::droppedFrameCount() const
+{
+    if (d->deliveryMode == LatestDelivery) {
+        return d->probee
+                ? QMediaVideoProbeControlPrivate::get(d->probee.data())->droppedFrameCount() - d->droppedBase
+                : 0;
+    }
+    return d->dispatcher ? d->dispatcher->queue().dropped() : 0;
+}
+
 /*!
     \fn QVideoProbe::videoFrameProbed(const QVideoFrame &frame)
 
@@ -53,6 +53,23 @@ class Q_MULTIMEDIA_EXPORT QVideoProbe : public QObject
 {
     Q_OBJECT
 public:
+    enum DeliveryMode
+    {
+        LatestDelivery,
+        QueuedDelivery,
+        DirectDelivery
+    };
+    Q_ENUM(DeliveryMode)
+
+    enum OverflowPolicy
+    {
+        DropOldest,
+        Block
+    };
+    Q_ENUM(OverflowPolicy)
+
+    typedef void (*FrameCallback)(const QVideoFrame &frame, void *userData);
+
     explicit QVideoProbe(QObject *parent = Q_NULLPTR);
     ~QVideoProbe();
 
@@ -61,6 +78,19 @@ public:
 
     bool isActive() const;
 
+    DeliveryMode deliveryMode() const;
+    void setDeliveryMode(DeliveryMode mode);
+
+    int queueLimit() const;
+    void setQueueLimit(int frames);
+
+    OverflowPolicy overflowPolicy() const;
+    void setOverflowPolicy(OverflowPolicy policy);
+
+    void setFrameCallback(FrameCallback callback, void *userData);
+
+    quint64 droppedFrameCount() const;
+
 Q_SIGNALS:
     void videoFrameProbed(const QVideoFrame &videoFrame);
     void flush();
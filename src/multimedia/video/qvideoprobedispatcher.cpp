@@ -0,0 +1,93 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qvideoprobedispatcher_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*
+    Video counterpart of QAudioProbeDispatcher. Queued frames may reference
+    buffers owned by the backend, so they are dropped on flush().
+*/
+QVideoProbeDispatcher::QVideoProbeDispatcher(QObject *parent)
+    : QObject(parent)
+    , m_direct(false)
+    , m_callback(Q_NULLPTR)
+    , m_userData(Q_NULLPTR)
+{
+}
+
+QVideoProbeDispatcher::~QVideoProbeDispatcher()
+{
+}
+
+void QVideoProbeDispatcher::setDirect(bool direct, QVideoProbe::FrameCallback callback, void *userData)
+{
+    m_direct = direct;
+    m_callback = callback;
+    m_userData = userData;
+}
+
+void QVideoProbeDispatcher::videoFrameProbed(const QVideoFrame &frame)
+{
+    if (m_direct) {
+        if (m_callback)
+            m_callback(frame, m_userData);
+        return;
+    }
+
+    if (m_queue.enqueue(frame))
+        QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+}
+
+void QVideoProbeDispatcher::flush()
+{
+    m_queue.clear();
+}
+
+void QVideoProbeDispatcher::deliver()
+{
+    const QQueue<QVideoFrame> frames = m_queue.takeAll();
+    for (const QVideoFrame &frame : frames)
+        emit frameReady(frame);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qvideoprobedispatcher_p.cpp"
@@ -16,7 +16,8 @@ PRIVATE_HEADERS += \
     video/qvideooutputorientationhandler_p.h \
     video/qvideosurfaceoutput_p.h \
     video/qvideoframe_p.h \
-    video/qvideoframeconversionhelper_p.h
+    video/qvideoframeconversionhelper_p.h \
+    video/qvideoprobedispatcher_p.h
 
 SOURCES += \
     video/qabstractvideobuffer.cpp \
@@ -28,6 +29,7 @@ SOURCES += \
     video/qvideosurfaceformat.cpp \
     video/qvideosurfaceoutput.cpp \
     video/qvideoprobe.cpp \
+    video/qvideoprobedispatcher.cpp \
     video/qabstractvideofilter.cpp \
     video/qvideoframeconversionhelper.cpp
 
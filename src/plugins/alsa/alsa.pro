@@ -6,12 +6,14 @@ LIBS += -lasound
 HEADERS += \
     qalsaplugin.h \
     qalsaaudiodeviceinfo.h \
+    qalsacapabilitycache.h \
     qalsaaudioinput.h \
     qalsaaudiooutput.h
 
 SOURCES += \
     qalsaplugin.cpp \
     qalsaaudiodeviceinfo.cpp \
+    qalsacapabilitycache.cpp \
     qalsaaudioinput.cpp \
     qalsaaudiooutput.cpp
 
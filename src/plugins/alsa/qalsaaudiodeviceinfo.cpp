@@ -52,12 +52,14 @@
 
 #include <alsa/version.h>
 
+#include <QtCore/qmutex.h>
+
+#include "qalsacapabilitycache.h"
+
 QT_BEGIN_NAMESPACE
 
 QAlsaAudioDeviceInfo::QAlsaAudioDeviceInfo(QByteArray dev, QAudio::Mode mode)
 {
-    handle = 0;
-
     device = QLatin1String(dev);
     this->mode = mode;
 
@@ -66,7 +68,6 @@ QAlsaAudioDeviceInfo::QAlsaAudioDeviceInfo(QByteArray dev, QAudio::Mode mode)
 
 QAlsaAudioDeviceInfo::~QAlsaAudioDeviceInfo()
 {
-    close();
 }
 
 bool QAlsaAudioDeviceInfo::isFormatSupported(const QAudioFormat& format) const
@@ -149,61 +150,46 @@ QByteArray QAlsaAudioDeviceInfo::defaultDevice(QAudio::Mode mode)
     return devices.first();
 }
 
-bool QAlsaAudioDeviceInfo::open()
+static QString pcmName(const QString &device)
 {
-    int err = 0;
-    QString dev;
-
-    if (!availableDevices(mode).contains(device.toLocal8Bit()))
-        return false;
-
 #if SND_LIB_VERSION < 0x1000e  // 1.0.14
     if (device.compare(QLatin1String("default")) != 0)
-        dev = deviceFromCardName(device);
-    else
+        return QAlsaAudioDeviceInfo::deviceFromCardName(device);
 #endif
-        dev = device;
-
-    if(mode == QAudio::AudioOutput) {
-        err=snd_pcm_open( &handle,dev.toLocal8Bit().constData(),SND_PCM_STREAM_PLAYBACK,0);
-    } else {
-        err=snd_pcm_open( &handle,dev.toLocal8Bit().constData(),SND_PCM_STREAM_CAPTURE,0);
-    }
-    if(err < 0) {
-        handle = 0;
-        return false;
-    }
-    return true;
+    return device;
 }
 
-void QAlsaAudioDeviceInfo::close()
+int QAlsaAudioDeviceInfo::probeOpen(const QString &device, QAudio::Mode mode)
 {
-    if(handle)
-        snd_pcm_close(handle);
-    handle = 0;
+    if (!availableDevices(mode).contains(device.toLocal8Bit()))
+        return -ENODEV;
+
+    snd_pcm_t *pcmHandle;
+    snd_pcm_stream_t stream = mode == QAudio::AudioOutput
+                            ? SND_PCM_STREAM_PLAYBACK : SND_PCM_STREAM_CAPTURE;
+
+    // Don't wait for a device another process is holding open
+    int err = snd_pcm_open(&pcmHandle, pcmName(device).toLocal8Bit().constData(), stream, SND_PCM_NONBLOCK);
+    if (err < 0)
+        return err;
+
+    snd_pcm_close(pcmHandle);
+    return 0;
 }
 
-bool QAlsaAudioDeviceInfo::testSettings(const QAudioFormat& format) const
+int QAlsaAudioDeviceInfo::probeFormat(const QString &device, QAudio::Mode mode, const QAudioFormat &format)
 {
     // Set nearest to closest settings that do work.
     // See if what is in settings will work (return value).
-    int err = -1;
     snd_pcm_t* pcmHandle;
     snd_pcm_hw_params_t *params;
-    QString dev;
-
-#if SND_LIB_VERSION < 0x1000e  // 1.0.14
-    if (device.compare(QLatin1String("default")) != 0)
-        dev = deviceFromCardName(device);
-    else
-#endif
-        dev = device;
 
     snd_pcm_stream_t stream = mode == QAudio::AudioOutput
                             ? SND_PCM_STREAM_PLAYBACK : SND_PCM_STREAM_CAPTURE;
 
-    if (snd_pcm_open(&pcmHandle, dev.toLocal8Bit().constData(), stream, 0) < 0)
-        return false;
+    int err = snd_pcm_open(&pcmHandle, pcmName(device).toLocal8Bit().constData(), stream, SND_PCM_NONBLOCK);
+    if (err < 0)
+        return err;
 
     snd_pcm_nonblock(pcmHandle, 0);
     snd_pcm_hw_params_alloca(&params);
@@ -243,6 +229,7 @@ bool QAlsaAudioDeviceInfo::testSettings(const QAudioFormat& format) const
         }
     }
 
+    err = -1;
     if (pcmFormat != SND_PCM_FORMAT_UNKNOWN)
         err = snd_pcm_hw_params_set_format(pcmHandle, params, pcmFormat);
 
@@ -270,7 +257,14 @@ bool QAlsaAudioDeviceInfo::testSettings(const QAudioFormat& format) const
 
     snd_pcm_close(pcmHandle);
 
-    return (err == 0);
+    return err > 0 ? -EINVAL : err;
+}
+
+bool QAlsaAudioDeviceInfo::testSettings(const QAudioFormat& format) const
+{
+    // Opening the PCM and negotiating hw params is slow, so the answer comes
+    // from the capability cache whenever this device was probed before.
+    return QAlsaCapabilityCache::instance()->isFormatSupported(device, mode, format);
 }
 
 void QAlsaAudioDeviceInfo::updateLists()
@@ -283,10 +277,7 @@ void QAlsaAudioDeviceInfo::updateLists()
     typez.clear();
     codecz.clear();
 
-    if(!handle)
-        open();
-
-    if(!handle)
+    if (!QAlsaCapabilityCache::instance()->canOpen(device, mode))
         return;
 
     for(int i=0; i<(int)MAX_SAMPLE_RATES; i++) {
@@ -307,68 +298,125 @@ void QAlsaAudioDeviceInfo::updateLists()
     typez.append(QAudioFormat::UnSignedInt);
     typez.append(QAudioFormat::Float);
     codecz.append(QLatin1String("audio/pcm"));
-    close();
 }
 
-QList<QByteArray> QAlsaAudioDeviceInfo::availableDevices(QAudio::Mode mode)
+// snd_device_name_hint() parses the whole ALSA configuration, so the results are
+// cached until the plugin sees /dev/snd change and calls invalidateDeviceCache().
+struct QAlsaDeviceCache
+{
+    QMutex mutex;
+    bool valid = false;
+    QList<QByteArray> inputs;
+    QList<QByteArray> outputs;
+    QList<QByteArray> cardNames;
+    bool surround40 = false;
+    bool surround51 = false;
+    bool surround71 = false;
+};
+
+Q_GLOBAL_STATIC(QAlsaDeviceCache, deviceCache)
+
+static void scanDevices(QAlsaDeviceCache *cache)
 {
-    QList<QByteArray> devices;
-    bool hasDefault = false;
+    cache->inputs.clear();
+    cache->outputs.clear();
+    cache->cardNames.clear();
+    cache->surround40 = false;
+    cache->surround51 = false;
+    cache->surround71 = false;
 
-#if SND_LIB_VERSION >= 0x1000e  // 1.0.14
-    QByteArray filter;
+    bool hasDefaultInput = false;
+    bool hasDefaultOutput = false;
 
-    // Create a list of all current audio devices that support mode
+    int idx = 0;
+    char *cardName;
+    while (snd_card_get_name(idx, &cardName) == 0) {
+        cache->cardNames.append(cardName);
+        free(cardName);
+        idx++;
+    }
+
+#if SND_LIB_VERSION >= 0x1000e  // 1.0.14
+    // Create a list of all current audio devices, split by the mode they support
     void **hints, **n;
     char *name, *descr, *io;
 
-    if(snd_device_name_hint(-1, "pcm", &hints) < 0) {
+    if (snd_device_name_hint(-1, "pcm", &hints) < 0) {
         qWarning() << "no alsa devices available";
-        return devices;
-    }
-    n = hints;
-
-    if(mode == QAudio::AudioInput) {
-        filter = "Input";
-    } else {
-        filter = "Output";
+        cache->valid = true;
+        return;
     }
 
-    while (*n != NULL) {
+    for (n = hints; *n != NULL; ++n) {
         name = snd_device_name_get_hint(*n, "NAME");
-        if (name != 0 && qstrcmp(name, "null") != 0) {
-            descr = snd_device_name_get_hint(*n, "DESC");
-            io = snd_device_name_get_hint(*n, "IOID");
-
-            if ((descr != NULL) && ((io == NULL) || (io == filter))) {
-                devices.append(name);
-                if (strcmp(name, "default") == 0)
-                    hasDefault = true;
-            }
+        descr = snd_device_name_get_hint(*n, "DESC");
+        io = snd_device_name_get_hint(*n, "IOID");
 
-            free(descr);
-            free(io);
+        if (name != NULL && descr != NULL) {
+            const QByteArray deviceName(name);
+            if (deviceName.contains("surround40"))
+                cache->surround40 = true;
+            if (deviceName.contains("surround51"))
+                cache->surround51 = true;
+            if (deviceName.contains("surround71"))
+                cache->surround71 = true;
+
+            if (qstrcmp(name, "null") != 0) {
+                const bool isDefault = strcmp(name, "default") == 0;
+                if (io == NULL || qstrcmp(io, "Input") == 0) {
+                    cache->inputs.append(name);
+                    hasDefaultInput |= isDefault;
+                }
+                if (io == NULL || qstrcmp(io, "Output") == 0) {
+                    cache->outputs.append(name);
+                    hasDefaultOutput |= isDefault;
+                }
+            }
         }
+
         free(name);
-        ++n;
+        free(descr);
+        free(io);
     }
     snd_device_name_free_hint(hints);
 #else
-    int idx = 0;
-    char* name;
-
-    while(snd_card_get_name(idx,&name) == 0) {
-        devices.append(name);
-        if (strcmp(name, "default") == 0)
-            hasDefault = true;
-        idx++;
+    for (const QByteArray &name : qAsConst(cache->cardNames)) {
+        cache->inputs.append(name);
+        cache->outputs.append(name);
+        if (name == "default")
+            hasDefaultInput = hasDefaultOutput = true;
     }
 #endif
 
-    if (!hasDefault && devices.size() > 0)
-        devices.prepend("default");
+    if (!hasDefaultInput && cache->inputs.size() > 0)
+        cache->inputs.prepend("default");
+    if (!hasDefaultOutput && cache->outputs.size() > 0)
+        cache->outputs.prepend("default");
 
-    return devices;
+    cache->valid = true;
+}
+
+static QAlsaDeviceCache *cachedDevices()
+{
+    QAlsaDeviceCache *cache = deviceCache();
+    if (!cache->valid)
+        scanDevices(cache);
+    return cache;
+}
+
+QList<QByteArray> QAlsaAudioDeviceInfo::availableDevices(QAudio::Mode mode)
+{
+    QAlsaDeviceCache *cache = deviceCache();
+    QMutexLocker locker(&cache->mutex);
+    cachedDevices();
+    return mode == QAudio::AudioInput ? cache->inputs : cache->outputs;
+}
+
+void QAlsaAudioDeviceInfo::invalidateDeviceCache()
+{
+    QAlsaDeviceCache *cache = deviceCache();
+    QMutexLocker locker(&cache->mutex);
+    cache->valid = false;
 }
 
 void QAlsaAudioDeviceInfo::checkSurround()
@@ -377,51 +425,29 @@ void QAlsaAudioDeviceInfo::checkSurround()
     surround51 = false;
     surround71 = false;
 
-    void **hints, **n;
-    char *name, *descr, *io;
-
-    if(snd_device_name_hint(-1, "pcm", &hints) < 0)
+    if (mode != QAudio::AudioOutput)
         return;
 
-    n = hints;
-
-    while (*n != NULL) {
-        name = snd_device_name_get_hint(*n, "NAME");
-        descr = snd_device_name_get_hint(*n, "DESC");
-        io = snd_device_name_get_hint(*n, "IOID");
-        if((name != NULL) && (descr != NULL)) {
-            QString deviceName = QLatin1String(name);
-            if (mode == QAudio::AudioOutput) {
-                if(deviceName.contains(QLatin1String("surround40")))
-                    surround40 = true;
-                if(deviceName.contains(QLatin1String("surround51")))
-                    surround51 = true;
-                if(deviceName.contains(QLatin1String("surround71")))
-                    surround71 = true;
-            }
-        }
-        if(name != NULL)
-            free(name);
-        if(descr != NULL)
-            free(descr);
-        if(io != NULL)
-            free(io);
-        ++n;
-    }
-    snd_device_name_free_hint(hints);
+    QAlsaDeviceCache *cache = deviceCache();
+    QMutexLocker locker(&cache->mutex);
+    cachedDevices();
+    surround40 = cache->surround40;
+    surround51 = cache->surround51;
+    surround71 = cache->surround71;
 }
 
 QString QAlsaAudioDeviceInfo::deviceFromCardName(const QString &card)
 {
-    int idx = 0;
-    char *name;
-
     QStringRef shortName = card.midRef(card.indexOf(QLatin1String("="), 0) + 1);
 
-    while (snd_card_get_name(idx, &name) == 0) {
-        if (shortName.compare(QLatin1String(name)) == 0)
+    QAlsaDeviceCache *cache = deviceCache();
+    QMutexLocker locker(&cache->mutex);
+    cachedDevices();
+
+    int idx = 0;
+    for (; idx < cache->cardNames.size(); ++idx) {
+        if (shortName.compare(QLatin1String(cache->cardNames.at(idx))) == 0)
             break;
-        idx++;
     }
 
     return QString(QLatin1String("hw:%1,0")).arg(idx);
@@ -91,11 +91,12 @@ public:
     static QByteArray defaultDevice(QAudio::Mode mode);
     static QList<QByteArray> availableDevices(QAudio::Mode);
     static QString deviceFromCardName(const QString &card);
+    static void invalidateDeviceCache();
 
-private:
-    bool open();
-    void close();
+    static int probeOpen(const QString &device, QAudio::Mode mode);
+    static int probeFormat(const QString &device, QAudio::Mode mode, const QAudioFormat &format);
 
+private:
     void checkSurround();
     bool surround40;
     bool surround51;
@@ -110,8 +111,6 @@ private:
     QList<QAudioFormat::Endian> byteOrderz;
     QStringList codecz;
     QList<QAudioFormat::SampleType> typez;
-    snd_pcm_t* handle;
-    snd_pcm_hw_params_t *params;
 };
 
 QT_END_NAMESPACE
@@ -49,11 +49,12 @@
 //
 
 #include <QtCore/qcoreapplication.h>
-#include <QtCore/qvarlengtharray.h>
 #include <QtMultimedia/private/qaudiohelpers_p.h>
 #include "qalsaaudioinput.h"
 #include "qalsaaudiodeviceinfo.h"
 
+#include <time.h>
+
 QT_BEGIN_NAMESPACE
 
 //#define DEBUG_AUDIO 1
@@ -68,6 +69,8 @@ QAlsaAudioInput::QAlsaAudioInput(const QByteArray &device)
     period_size = 0;
     buffer_time = 100000;
     period_time = 20000;
+    m_targetLatency = 0;
+    m_latency = -1;
     totalTimeValue = 0;
     intervalTime = 1000;
     errorState = QAudio::NoError;
@@ -75,31 +78,29 @@ QAlsaAudioInput::QAlsaAudioInput(const QByteArray &device)
     audioSource = 0;
     pullMode = true;
     resuming = false;
-
-    m_volume = 1.0f;
+    htstampMonotonic = false;
 
     m_device = device;
 
-    timer = new QTimer(this);
-    connect(timer,SIGNAL(timeout()),SLOT(userFeed()));
+    captureCallback = 0;
+    captureUserData = 0;
+    captureThread = new AlsaCaptureThread(this);
 }
 
 QAlsaAudioInput::~QAlsaAudioInput()
 {
     close();
-    disconnect(timer, SIGNAL(timeout()));
-    QCoreApplication::processEvents();
-    delete timer;
+    delete captureThread;
 }
 
 void QAlsaAudioInput::setVolume(qreal vol)
 {
-    m_volume = vol;
+    m_volume.store(vol);
 }
 
 qreal QAlsaAudioInput::volume() const
 {
-    return m_volume;
+    return m_volume.load();
 }
 
 QAudio::Error QAlsaAudioInput::error() const
@@ -238,6 +239,7 @@ void QAlsaAudioInput::start(QIODevice* device)
 
     pullMode = true;
     audioSource = device;
+    captureCallback = 0;
 
     deviceState = QAudio::ActiveState;
 
@@ -247,6 +249,31 @@ void QAlsaAudioInput::start(QIODevice* device)
     emit stateChanged(deviceState);
 }
 
+bool QAlsaAudioInput::startCallback(QAudio::CaptureCallback callback, void *userData)
+{
+    if(deviceState != QAudio::StoppedState)
+        close();
+
+    if(!pullMode && audioSource)
+        delete audioSource;
+
+    // The capture thread hands every period to the callback, nothing is
+    // buffered for a QIODevice
+    pullMode = true;
+    audioSource = 0;
+    captureCallback = callback;
+    captureUserData = userData;
+
+    deviceState = QAudio::ActiveState;
+
+    if( !open() )
+        return true;
+
+    emit stateChanged(deviceState);
+
+    return true;
+}
+
 QIODevice* QAlsaAudioInput::start()
 {
     if(deviceState != QAudio::StoppedState)
@@ -256,6 +283,7 @@ QIODevice* QAlsaAudioInput::start()
         delete audioSource;
 
     pullMode = false;
+    captureCallback = 0;
     audioSource = new AlsaInputPrivate(this);
     audioSource->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
 
@@ -335,7 +363,8 @@ bool QAlsaAudioInput::open()
         emit stateChanged(deviceState);
         return false;
     }
-    snd_pcm_nonblock( handle, 0 );
+    // The capture thread waits on the PCM itself, reads must never block
+    snd_pcm_nonblock( handle, 1 );
 
     // Step 2: Set the desired HW parameters.
     snd_pcm_hw_params_alloca( &hwparams );
@@ -344,6 +373,14 @@ bool QAlsaAudioInput::open()
     QString errMessage;
     unsigned int chunks = 8;
 
+    if (m_targetLatency > 0) {
+        // Captured data is handed out a period at a time, so the period is
+        // the capture latency. Keep a few of them to ride out scheduling.
+        period_time = m_targetLatency;
+        buffer_time = period_time * 4;
+        chunks = 4;
+    }
+
     err = snd_pcm_hw_params_any( handle, hwparams );
     if ( err < 0 ) {
         fatal = true;
@@ -425,6 +462,7 @@ bool QAlsaAudioInput::open()
     period_size = snd_pcm_frames_to_bytes(handle,period_frames);
     snd_pcm_hw_params_get_buffer_time(hwparams,&buffer_time, &dir);
     snd_pcm_hw_params_get_period_time(hwparams,&period_time, &dir);
+    m_latency = period_time;
 
     // Step 3: Set the desired SW parameters.
     snd_pcm_sw_params_t *swparams;
@@ -433,209 +471,214 @@ bool QAlsaAudioInput::open()
     snd_pcm_sw_params_set_start_threshold(handle,swparams,period_frames);
     snd_pcm_sw_params_set_stop_threshold(handle,swparams,buffer_frames);
     snd_pcm_sw_params_set_avail_min(handle, swparams,period_frames);
+    snd_pcm_sw_params_set_tstamp_mode(handle, swparams, SND_PCM_TSTAMP_ENABLE);
+    htstampMonotonic = false;
+#if SND_LIB_VERSION >= 0x1001d // 1.0.29
+    htstampMonotonic = snd_pcm_sw_params_set_tstamp_type(handle, swparams, SND_PCM_TSTAMP_TYPE_MONOTONIC) == 0;
+#endif
     snd_pcm_sw_params(handle, swparams);
 
     // Step 4: Prepare audio
-    ringBuffer.resize(buffer_size);
+    // Keep at least a second of periods (and never less than twice the
+    // hardware buffer) so the owner thread can stall without data loss.
+    chunks = buffer_frames/period_frames;
+    int ringPeriods = qMax<int>(2 * chunks, 1000000 / qMax(period_time, 1u));
+    ringBuffer.resize(ringPeriods, period_size, settings);
+    pullPending.clear();
     snd_pcm_prepare( handle );
     snd_pcm_start(handle);
 
-    // Step 5: Setup timer
+    // Step 5: Setup feeding
     bytesAvailable = checkBytesReady();
 
-    if(pullMode)
+    if(pullMode && audioSource)
         connect(audioSource,SIGNAL(readyRead()),this,SLOT(userFeed()));
 
     // Step 6: Start audio processing
-    chunks = buffer_size/period_size;
-    timer->start(period_time*chunks/2000);
-
     errorState  = QAudio::NoError;
 
     totalTimeValue = 0;
+    deliveredBytes.store(0);
+    m_stats.reset();
+    m_loudnessMeter.reset();
+    m_loudnessMeter.prepareDeferred(settings);
+
+    captureThread->startCapture();
 
     return true;
 }
 
 void QAlsaAudioInput::close()
 {
-    timer->stop();
+    captureThread->stopCapture();
 
     if ( handle ) {
         snd_pcm_drop( handle );
         snd_pcm_close( handle );
         handle = 0;
     }
+    ringBuffer.clear();
+    pullPending.clear();
+    m_stats.dump("QAlsaAudioInput", m_device);
 }
 
 int QAlsaAudioInput::checkBytesReady()
 {
-    if(resuming)
-        bytesAvailable = period_size;
-    else if(deviceState != QAudio::ActiveState
-            && deviceState != QAudio::IdleState)
-        bytesAvailable = 0;
-    else {
-        int frames = snd_pcm_avail_update(handle);
-        if (frames < 0) {
-            bytesAvailable = frames;
-        } else {
-            if((int)frames > (int)buffer_frames)
-                frames = buffer_frames;
-            bytesAvailable = snd_pcm_frames_to_bytes(handle, frames);
-        }
-    }
+    bytesAvailable = bytesReady();
     return bytesAvailable;
 }
 
 int QAlsaAudioInput::bytesReady() const
 {
-    return qMax(bytesAvailable, 0);
+    if(deviceState != QAudio::ActiveState && deviceState != QAudio::IdleState)
+        return 0;
+
+    return ringBuffer.bytesOfDataInBuffer() + pullPending.size();
 }
 
 qint64 QAlsaAudioInput::read(char* data, qint64 len)
 {
-    // Read in some audio data and write it to QIODevice, pull mode
+    // Hands captured audio data to the user, from the ring filled by the capture thread
     if ( !handle )
         return 0;
 
-    int bytesRead = 0;
-    int bytesInRingbufferBeforeRead = ringBuffer.bytesOfDataInBuffer();
-
-    if (ringBuffer.bytesOfDataInBuffer() < len) {
-
-        // bytesAvaiable is saved as a side effect of checkBytesReady().
-        int bytesToRead = checkBytesReady();
-
-        if (bytesToRead < 0) {
-            // bytesAvailable as negative is error code, try to recover from it.
-            xrun_recovery(bytesToRead);
-            bytesToRead = checkBytesReady();
-            if (bytesToRead < 0) {
-                // recovery failed must stop and set error.
-                close();
-                errorState = QAudio::IOError;
-                deviceState = QAudio::StoppedState;
-                emit stateChanged(deviceState);
-                return 0;
-            }
+    if (deviceState != QAudio::ActiveState && deviceState != QAudio::IdleState)
+        return 0;
+
+    m_stats.feedStarted(bytesReady());
+
+    if (!pullMode) {
+        int bytesRead = ringBuffer.read(data, int(qMin<qint64>(len, ringBuffer.bytesOfDataInBuffer())));
+        if (bytesRead > 0) {
+            applyVolume(data, bytesRead);
+            m_loudnessMeter.process(settings, data, bytesRead);
+            dataRead(bytesRead);
         }
+        m_stats.feedFinished(bytesRead);
+        return bytesRead;
+    }
 
-        bytesToRead = qMin<qint64>(len, bytesToRead);
-        bytesToRead = qMin<qint64>(ringBuffer.freeBytes(), bytesToRead);
-        bytesToRead -= bytesToRead % period_size;
+    // Pull mode, write everything captured so far to the QIODevice and keep
+    // what it does not accept for the next round.
+    bool hadData = !pullPending.isEmpty();
+    qint64 l = 0;
+    qint64 bytesWritten = 0;
+    forever {
+        if (pullPending.isEmpty()) {
+            qint64 startTime;
+            pullPending = ringBuffer.takePeriod(&startTime);
+            if (pullPending.isEmpty())
+                break;
+            hadData = true;
+            applyVolume(pullPending.data(), pullPending.size());
+            m_loudnessMeter.process(settings, pullPending.constData(), pullPending.size());
+        }
+        l = audioSource->write(pullPending.constData(), pullPending.size());
+        if (l <= 0)
+            break;
+        pullPending.remove(0, l);
+        bytesWritten += l;
+    }
 
-        int count=0;
-        int err = 0;
-        QVarLengthArray<char, 4096> buffer(bytesToRead);
-        while(count < 5 && bytesToRead > 0) {
-            int chunks = bytesToRead / period_size;
-            int frames = chunks * period_frames;
-            if (frames > (int)buffer_frames)
-                frames = buffer_frames;
-
-            int readFrames = snd_pcm_readi(handle, buffer.data(), frames);
-            bytesRead = snd_pcm_frames_to_bytes(handle, readFrames);
-            if (m_volume < 1.0f)
-                QAudioHelperInternal::qMultiplySamples(m_volume, settings,
-                                                       buffer.constData(),
-                                                       buffer.data(), bytesRead);
-
-            if (readFrames >= 0) {
-                ringBuffer.write(buffer.data(), bytesRead);
 #ifdef DEBUG_AUDIO
-                qDebug() << QString::fromLatin1("read in bytes = %1 (frames=%2)").arg(bytesRead).arg(readFrames).toLatin1().constData();
+    qDebug() << "frames written to QIODevice = " <<
+        snd_pcm_bytes_to_frames( handle, (int)bytesWritten ) << " (" << bytesWritten << ") bytes";
 #endif
-                break;
-            } else if((readFrames == -EAGAIN) || (readFrames == -EINTR)) {
-                errorState = QAudio::IOError;
-                err = 0;
-                break;
-            } else {
-                if(readFrames == -EPIPE) {
-                    errorState = QAudio::UnderrunError;
-                    err = snd_pcm_prepare(handle);
-#ifdef ESTRPIPE
-                } else if(readFrames == -ESTRPIPE) {
-                    err = snd_pcm_prepare(handle);
-#endif
-                }
-                if(err != 0) break;
-            }
-            count++;
-        }
 
+    if (l < 0) {
+        close();
+        errorState = QAudio::IOError;
+        deviceState = QAudio::StoppedState;
+        emit stateChanged(deviceState);
+    } else if (bytesWritten == 0) {
+        if (hadData && deviceState != QAudio::IdleState) {
+            errorState = QAudio::NoError;
+            deviceState = QAudio::IdleState;
+            emit stateChanged(deviceState);
+        }
+    } else {
+        dataRead(bytesWritten);
     }
 
-    bytesRead += bytesInRingbufferBeforeRead;
+    m_stats.feedFinished(bytesWritten);
+    return bytesWritten;
+}
 
-    if (bytesRead > 0) {
-        // got some send it onward
-#ifdef DEBUG_AUDIO
-        qDebug() << "frames to write to QIODevice = " <<
-            snd_pcm_bytes_to_frames( handle, (int)bytesRead ) << " (" << bytesRead << ") bytes";
-#endif
-        if (deviceState != QAudio::ActiveState && deviceState != QAudio::IdleState)
-            return 0;
-
-        if (pullMode) {
-            qint64 l = 0;
-            qint64 bytesWritten = 0;
-            while (ringBuffer.bytesOfDataInBuffer() > 0) {
-                l = audioSource->write(ringBuffer.availableData(), ringBuffer.availableDataBlockSize());
-                if (l > 0) {
-                    ringBuffer.readBytes(l);
-                    bytesWritten += l;
-                } else {
-                    break;
-                }
-            }
+QAudioBuffer QAlsaAudioInput::readBuffer()
+{
+    if ( !handle || pullMode )
+        return QAudioBuffer();
 
-            if (l < 0) {
-                close();
-                errorState = QAudio::IOError;
-                deviceState = QAudio::StoppedState;
-                emit stateChanged(deviceState);
-            } else if (l == 0 && bytesWritten == 0) {
-                if (deviceState != QAudio::IdleState) {
-                    errorState = QAudio::NoError;
-                    deviceState = QAudio::IdleState;
-                    emit stateChanged(deviceState);
-                }
-            } else {
-                bytesAvailable -= bytesWritten;
-                totalTimeValue += bytesWritten;
-                resuming = false;
-                if (deviceState != QAudio::ActiveState) {
-                    errorState = QAudio::NoError;
-                    deviceState = QAudio::ActiveState;
-                    emit stateChanged(deviceState);
-                }
-            }
+    if (deviceState != QAudio::ActiveState && deviceState != QAudio::IdleState)
+        return QAudioBuffer();
 
-            return bytesWritten;
-        } else {
-            while (ringBuffer.bytesOfDataInBuffer() > 0) {
-                int size = ringBuffer.availableDataBlockSize();
-                memcpy(data, ringBuffer.availableData(), size);
-                data += size;
-                ringBuffer.readBytes(size);
-            }
+    m_stats.feedStarted(bytesReady());
 
-            bytesAvailable -= bytesRead;
-            totalTimeValue += bytesRead;
-            resuming = false;
-            if (deviceState != QAudio::ActiveState) {
-                errorState = QAudio::NoError;
-                deviceState = QAudio::ActiveState;
-                emit stateChanged(deviceState);
-            }
+    qint64 startTime = -1;
+    QByteArray data = ringBuffer.takePeriod(&startTime);
+    if (data.isEmpty())
+        return QAudioBuffer();
 
-            return bytesRead;
-        }
+    applyVolume(data.data(), data.size());
+    m_loudnessMeter.process(settings, data.constData(), data.size());
+    dataRead(data.size());
+    m_stats.feedFinished(data.size());
+
+    return QAudioBuffer(data, settings, startTime);
+}
+
+void QAlsaAudioInput::applyVolume(char *data, int len) const
+{
+    // Also called from the capture thread
+    const qreal volume = m_volume.load();
+    if (volume < 1.0f)
+        QAudioHelperInternal::qMultiplySamples(volume, settings, data, data, len);
+}
+
+void QAlsaAudioInput::dataRead(qint64 bytes)
+{
+    bytesAvailable = bytesReady();
+    totalTimeValue += bytes;
+    resuming = false;
+    if (deviceState != QAudio::ActiveState) {
+        errorState = QAudio::NoError;
+        deviceState = QAudio::ActiveState;
+        emit stateChanged(deviceState);
     }
+}
 
-    return 0;
+void QAlsaAudioInput::periodCaptured()
+{
+    // Called from the capture thread. Only keep one request in flight, the
+    // owner thread drains everything accumulated in the ring when it runs.
+    if (feedPending.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
+}
+
+void QAlsaAudioInput::periodDelivered(int bytes)
+{
+    // Called from the capture thread in callback mode, the owner thread
+    // only updates the clock and the state
+    deliveredBytes.fetchAndAddOrdered(bytes);
+    periodCaptured();
+}
+
+void QAlsaAudioInput::captureError(bool fatal)
+{
+    if (deviceState == QAudio::StoppedState)
+        return;
+
+    if (!fatal) {
+        // The capture thread recovered, but audio data was lost
+        errorState = QAudio::UnderrunError;
+        return;
+    }
+
+    // recovery failed must stop and set error.
+    close();
+    errorState = QAudio::IOError;
+    deviceState = QAudio::StoppedState;
+    emit stateChanged(deviceState);
 }
 
 void QAlsaAudioInput::resume()
@@ -652,16 +695,42 @@ void QAlsaAudioInput::resume()
             if(err < 0)
                 xrun_recovery(err);
 
-            bytesAvailable = buffer_size;
+            captureThread->startCapture();
         }
         resuming = true;
         deviceState = QAudio::ActiveState;
-        int chunks = buffer_size/period_size;
-        timer->start(period_time*chunks/2000);
+        bytesAvailable = checkBytesReady();
         emit stateChanged(deviceState);
     }
 }
 
+void QAlsaAudioInput::setTargetLatency(qint64 microseconds)
+{
+    if (m_targetLatency == microseconds)
+        return;
+
+    m_targetLatency = microseconds;
+    if (m_targetLatency == 0) {
+        buffer_time = 100000;
+        period_time = 20000;
+    }
+}
+
+qint64 QAlsaAudioInput::targetLatency() const
+{
+    return m_targetLatency;
+}
+
+QVariantMap QAlsaAudioInput::statistics() const
+{
+    return m_stats.toVariantMap();
+}
+
+qint64 QAlsaAudioInput::latency() const
+{
+    return m_latency;
+}
+
 void QAlsaAudioInput::setBufferSize(int value)
 {
     buffer_size = value;
@@ -699,8 +768,8 @@ qint64 QAlsaAudioInput::processedUSecs() const
 void QAlsaAudioInput::suspend()
 {
     if(deviceState == QAudio::ActiveState||resuming) {
+        captureThread->stopCapture();
         snd_pcm_drain(handle);
-        timer->stop();
         deviceState = QAudio::SuspendedState;
         emit stateChanged(deviceState);
     }
@@ -708,6 +777,8 @@ void QAlsaAudioInput::suspend()
 
 void QAlsaAudioInput::userFeed()
 {
+    feedPending.store(0);
+
     if(deviceState == QAudio::StoppedState || deviceState == QAudio::SuspendedState)
         return;
 #ifdef DEBUG_AUDIO
@@ -719,8 +790,13 @@ void QAlsaAudioInput::userFeed()
 
 bool QAlsaAudioInput::deviceReady()
 {
-    if(pullMode) {
-        // reads some audio data and writes it to QIODevice
+    if(captureCallback) {
+        const int bytes = deliveredBytes.fetchAndStoreOrdered(0);
+        m_loudnessMeter.processPending();
+        if (bytes > 0)
+            dataRead(bytes);
+    } else if(pullMode) {
+        // writes the captured audio data to QIODevice
         read(0, buffer_size);
     } else {
         // emits readyRead() so user will call read() on QIODevice to get some audio data
@@ -732,20 +808,6 @@ bool QAlsaAudioInput::deviceReady()
     if(deviceState != QAudio::ActiveState)
         return true;
 
-    if (bytesAvailable < 0) {
-        // bytesAvailable as negative is error code, try to recover from it.
-        xrun_recovery(bytesAvailable);
-        bytesAvailable = checkBytesReady();
-        if (bytesAvailable < 0) {
-            // recovery failed must stop and set error.
-            close();
-            errorState = QAudio::IOError;
-            deviceState = QAudio::StoppedState;
-            emit stateChanged(deviceState);
-            return 0;
-        }
-    }
-
     if(intervalTime && (timeStamp.elapsed() + elapsedTimeOffset) > intervalTime) {
         emit notify();
         elapsedTimeOffset = timeStamp.elapsed() + elapsedTimeOffset - intervalTime;
@@ -764,6 +826,7 @@ qint64 QAlsaAudioInput::elapsedUSecs() const
 
 void QAlsaAudioInput::reset()
 {
+    captureThread->stopCapture();
     if(handle)
         snd_pcm_reset(handle);
     stop();
@@ -802,68 +865,222 @@ void AlsaInputPrivate::trigger()
     emit readyRead();
 }
 
-RingBuffer::RingBuffer() :
+AlsaCaptureThread::AlsaCaptureThread(QAlsaAudioInput *audio)
+    : audioDevice(audio)
+    , running(0)
+{
+}
+
+void AlsaCaptureThread::startCapture()
+{
+    if (isRunning())
+        return;
+
+    running.store(1);
+    start(QThread::TimeCriticalPriority);
+}
+
+void AlsaCaptureThread::stopCapture()
+{
+    running.store(0);
+    wait();
+}
+
+void AlsaCaptureThread::run()
+{
+    snd_pcm_t *handle = audioDevice->handle;
+    const snd_pcm_uframes_t periodFrames = audioDevice->period_frames;
+    const int timeout = qMax(1, int(2 * audioDevice->period_time / 1000));
+
+    QByteArray period(audioDevice->period_size, 0);
+    snd_pcm_status_t *status;
+    snd_pcm_status_alloca(&status);
+
+    // Callback mode collects whole periods before handing them out
+    const QAudio::CaptureCallback callback = audioDevice->captureCallback;
+    snd_pcm_uframes_t filled = 0;
+
+    while (running.load()) {
+        int err = snd_pcm_wait(handle, timeout);
+        if (err == 0)
+            continue;
+
+        char *dest = period.data() + snd_pcm_frames_to_bytes(handle, filled);
+        snd_pcm_sframes_t frames = err < 0 ? err : snd_pcm_readi(handle, dest, periodFrames - filled);
+        if (frames == 0 || frames == -EAGAIN)
+            continue;
+
+        if (frames < 0) {
+            // Overrun or suspend, let alsa-lib recover and restart the
+            // capture. Anything it can't handle is fatal for the stream.
+            if (frames == -EPIPE)
+                audioDevice->m_stats.recordOverrun();
+            filled = 0;
+            err = snd_pcm_recover(handle, frames, 1);
+            if (err == 0)
+                err = snd_pcm_start(handle);
+            QMetaObject::invokeMethod(audioDevice, "captureError", Qt::QueuedConnection,
+                                      Q_ARG(bool, err < 0));
+            if (err < 0)
+                break;
+            continue;
+        }
+
+#ifdef DEBUG_AUDIO
+        qDebug() << QString::fromLatin1("captured frames = %1").arg(frames).toLatin1().constData();
+#endif
+        if (callback) {
+            filled += frames;
+            if (filled < periodFrames)
+                continue;
+
+            audioDevice->m_stats.feedStarted(period.size());
+            audioDevice->applyVolume(period.data(), period.size());
+            audioDevice->m_loudnessMeter.processDeferred(period.constData(), period.size());
+            callback(period.constData(), period.size(), audioDevice->captureUserData);
+            audioDevice->m_stats.feedFinished(period.size());
+            audioDevice->periodDelivered(period.size());
+            filled = 0;
+            continue;
+        }
+
+        const qint64 startTime = captureTime(status, frames);
+        if (!audioDevice->ringBuffer.write(period.constData(), snd_pcm_frames_to_bytes(handle, frames), startTime)) {
+            // The application didn't keep up, the oldest period was dropped
+            audioDevice->m_stats.recordOverrun();
+            QMetaObject::invokeMethod(audioDevice, "captureError", Qt::QueuedConnection,
+                                      Q_ARG(bool, false));
+        }
+        audioDevice->periodCaptured();
+    }
+}
+
+qint64 AlsaCaptureThread::captureTime(snd_pcm_status_t *status, snd_pcm_sframes_t frames) const
+{
+    // The timestamp marks the last hardware pointer update. At that point
+    // 'avail' frames were waiting in the buffer, all captured after the
+    // frames just read, so the first frame is that much older.
+    snd_pcm_t *handle = audioDevice->handle;
+    snd_pcm_sframes_t delay = frames;
+    qint64 now = -1;
+
+    if (audioDevice->htstampMonotonic && snd_pcm_status(handle, status) == 0) {
+        snd_htimestamp_t ts;
+        snd_pcm_status_get_htstamp(status, &ts);
+        if (ts.tv_sec != 0 || ts.tv_nsec != 0) {
+            now = qint64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+            delay += snd_pcm_status_get_avail(status);
+        }
+    }
+
+    if (now < 0) {
+        // No usable hardware timestamp, fall back to the time of the read
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        now = qint64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+        snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+        if (avail > 0)
+            delay += avail;
+    }
+
+    return now - qint64(delay) * 1000000 / audioDevice->settings.sampleRate();
+}
+
+PeriodRingBuffer::PeriodRingBuffer() :
+        m_periodBytes(0),
         m_head(0),
-        m_tail(0)
+        m_count(0),
+        m_headOffset(0),
+        m_bytes(0)
 {
 }
 
-void RingBuffer::resize(int size)
+void PeriodRingBuffer::resize(int periods, int periodBytes, const QAudioFormat &format)
 {
-    m_data.resize(size);
+    QMutexLocker locker(&m_mutex);
+    m_data.resize(periods * periodBytes);
+    m_periods.resize(periods);
+    m_format = format;
+    m_periodBytes = periodBytes;
+    m_head = m_count = m_headOffset = m_bytes = 0;
 }
 
-int RingBuffer::bytesOfDataInBuffer() const
+void PeriodRingBuffer::clear()
 {
-    if (m_head < m_tail)
-        return m_tail - m_head;
-    else if (m_tail < m_head)
-        return m_data.size() + m_tail - m_head;
-    else
-        return 0;
+    QMutexLocker locker(&m_mutex);
+    m_head = m_count = m_headOffset = m_bytes = 0;
 }
 
-int RingBuffer::freeBytes() const
+int PeriodRingBuffer::bytesOfDataInBuffer() const
 {
-    if (m_head > m_tail)
-        return m_head - m_tail - 1;
-    else if (m_tail > m_head)
-        return m_data.size() - m_tail + m_head - 1;
-    else
-        return m_data.size() - 1;
+    QMutexLocker locker(&m_mutex);
+    return m_bytes;
 }
 
-const char *RingBuffer::availableData() const
+bool PeriodRingBuffer::write(const char *data, int len, qint64 startTime)
 {
-    return (m_data.constData() + m_head);
+    QMutexLocker locker(&m_mutex);
+    if (m_periods.isEmpty())
+        return false;
+
+    bool overrun = false;
+    if (m_count == m_periods.size()) {
+        // The consumer fell behind by the whole ring, drop the oldest period
+        consume(m_periods.at(m_head).bytes - m_headOffset);
+        overrun = true;
+    }
+
+    len = qMin(len, m_periodBytes);
+    const int tail = (m_head + m_count) % m_periods.size();
+    memcpy(m_data.data() + tail * m_periodBytes, data, len);
+    Period &period = m_periods[tail];
+    period.bytes = len;
+    period.startTime = startTime;
+    ++m_count;
+    m_bytes += len;
+
+    return !overrun;
 }
 
-int RingBuffer::availableDataBlockSize() const
+int PeriodRingBuffer::read(char *data, int len)
 {
-    if (m_head > m_tail)
-        return m_data.size() - m_head;
-    else if (m_tail > m_head)
-        return m_tail - m_head;
-    else
-        return 0;
+    QMutexLocker locker(&m_mutex);
+    int bytesRead = 0;
+    while (m_count > 0 && bytesRead < len) {
+        const int size = qMin(m_periods.at(m_head).bytes - m_headOffset, len - bytesRead);
+        memcpy(data + bytesRead, m_data.constData() + m_head * m_periodBytes + m_headOffset, size);
+        bytesRead += size;
+        consume(size);
+    }
+    return bytesRead;
 }
 
-void RingBuffer::readBytes(int bytes)
+QByteArray PeriodRingBuffer::takePeriod(qint64 *startTime)
 {
-    m_head = (m_head + bytes) % m_data.size();
+    QMutexLocker locker(&m_mutex);
+    if (m_count == 0)
+        return QByteArray();
+
+    const Period &period = m_periods.at(m_head);
+    // A partially read period starts later than its first frame
+    *startTime = period.startTime;
+    if (period.startTime >= 0)
+        *startTime += m_format.durationForBytes(m_headOffset);
+
+    QByteArray data(m_data.constData() + m_head * m_periodBytes + m_headOffset,
+                    period.bytes - m_headOffset);
+    consume(data.size());
+    return data;
 }
 
-void RingBuffer::write(char *data, int len)
+void PeriodRingBuffer::consume(int bytes)
 {
-    if (m_tail + len < m_data.size()) {
-        memcpy(m_data.data() + m_tail, data, len);
-        m_tail += len;
-    } else {
-        int bytesUntilEnd = m_data.size() - m_tail;
-        memcpy(m_data.data() + m_tail, data, bytesUntilEnd);
-        if (len - bytesUntilEnd > 0)
-            memcpy(m_data.data(), data + bytesUntilEnd, len - bytesUntilEnd);
-        m_tail = len - bytesUntilEnd;
+    m_headOffset += bytes;
+    m_bytes -= bytes;
+    if (m_headOffset >= m_periods.at(m_head).bytes) {
+        m_head = (m_head + 1) % m_periods.size();
+        m_headOffset = 0;
+        --m_count;
     }
 }
 
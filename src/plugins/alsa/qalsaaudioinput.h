@@ -56,55 +56,99 @@
 
 #include <QtCore/qfile.h>
 #include <QtCore/qdebug.h>
-#include <QtCore/qtimer.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qstringlist.h>
 #include <QtCore/qdatetime.h>
 #include <QtCore/qiodevice.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qvector.h>
+#include <QtCore/qatomic.h>
 
 #include <QtMultimedia/qaudio.h>
+#include <QtMultimedia/qaudiobuffer.h>
 #include <QtMultimedia/qaudiodeviceinfo.h>
 #include <QtMultimedia/qaudiosystem.h>
+#include <QtMultimedia/private/qaudiohelpers_p.h>
+#include <QtMultimedia/private/qaudiostreamstats_p.h>
+#include <QtMultimedia/private/qaudioloudnessmeter_p.h>
+#include <QtMultimedia/private/qaudiosystemext_p.h>
 
 QT_BEGIN_NAMESPACE
 
 
 class AlsaInputPrivate;
+class QAlsaAudioInput;
 
-class RingBuffer
+// Ring of fixed size periods shared between the capture thread (producer)
+// and the thread owning the QAlsaAudioInput (consumer). Every period keeps
+// the capture time of its first frame.
+class PeriodRingBuffer
 {
 public:
-    RingBuffer();
+    PeriodRingBuffer();
 
-    void resize(int size);
+    void resize(int periods, int periodBytes, const QAudioFormat &format);
+    void clear();
 
     int bytesOfDataInBuffer() const;
-    int freeBytes() const;
 
-    const char *availableData() const;
-    int availableDataBlockSize() const;
-    void readBytes(int bytes);
-
-    void write(char *data, int len);
+    bool write(const char *data, int len, qint64 startTime);
+    int read(char *data, int len);
+    QByteArray takePeriod(qint64 *startTime);
 
 private:
-    int m_head;
-    int m_tail;
+    void consume(int bytes);
 
+    struct Period
+    {
+        int bytes;
+        qint64 startTime;
+    };
+
+    mutable QMutex m_mutex;
     QByteArray m_data;
+    QVector<Period> m_periods;
+    QAudioFormat m_format;
+    int m_periodBytes;
+    int m_head;
+    int m_count;
+    int m_headOffset;
+    int m_bytes;
 };
 
-class QAlsaAudioInput : public QAbstractAudioInput
+class AlsaCaptureThread : public QThread
+{
+public:
+    AlsaCaptureThread(QAlsaAudioInput *audio);
+
+    void startCapture();
+    void stopCapture();
+
+protected:
+    void run() override;
+
+private:
+    qint64 captureTime(snd_pcm_status_t *status, snd_pcm_sframes_t frames) const;
+
+    QAlsaAudioInput *audioDevice;
+    QAtomicInt running;
+};
+
+class QAlsaAudioInput : public QAbstractAudioInput, public QAudioInputExtension
 {
     Q_OBJECT
+    Q_INTERFACES(QAudioInputExtension)
 public:
     QAlsaAudioInput(const QByteArray &device);
     ~QAlsaAudioInput();
 
     qint64 read(char* data, qint64 len);
+    QAudioBuffer readBuffer() override;
 
     void start(QIODevice* device);
     QIODevice* start();
+    bool startCallback(QAudio::CaptureCallback callback, void *userData) override;
     void stop();
     void reset();
     void suspend();
@@ -123,6 +167,11 @@ public:
     QAudioFormat format() const;
     void setVolume(qreal);
     qreal volume() const;
+    void setTargetLatency(qint64 microseconds) override;
+    qint64 targetLatency() const override;
+    qint64 latency() const override;
+    QVariantMap statistics() const override;
+    QAudioLoudnessMeter *loudnessMeter() override { return &m_loudnessMeter; }
     bool resuming;
     snd_pcm_t* handle;
     qint64 totalTimeValue;
@@ -134,8 +183,15 @@ public:
 private slots:
     void userFeed();
     bool deviceReady();
+    void captureError(bool fatal);
 
 private:
+    friend class AlsaCaptureThread;
+
+    void applyVolume(char *data, int len) const;
+    void dataRead(qint64 bytes);
+    void periodCaptured();
+    void periodDelivered(int bytes);
     int checkBytesReady();
     int xrun_recovery(int err);
     int setFormat();
@@ -143,12 +199,19 @@ private:
     void close();
     void drain();
 
-    QTimer* timer;
+    AlsaCaptureThread *captureThread;
+    QAtomicInt feedPending;
+    QAudio::CaptureCallback captureCallback;
+    void *captureUserData;
+    QAtomicInt deliveredBytes;
+    QAudioStreamStats m_stats;
+    QAudioLoudnessMeter m_loudnessMeter;
     QTime timeStamp;
     QTime clockStamp;
     qint64 elapsedTimeOffset;
     int intervalTime;
-    RingBuffer ringBuffer;
+    PeriodRingBuffer ringBuffer;
+    QByteArray pullPending;
     int bytesAvailable;
     QByteArray m_device;
     bool pullMode;
@@ -158,10 +221,13 @@ private:
     unsigned int period_time;
     snd_pcm_uframes_t buffer_frames;
     snd_pcm_uframes_t period_frames;
+    qint64 m_targetLatency;
+    qint64 m_latency;
     snd_pcm_access_t access;
     snd_pcm_format_t pcmformat;
     snd_pcm_hw_params_t *hwparams;
-    qreal m_volume;
+    bool htstampMonotonic;
+    QAudioHelperInternal::AtomicVolume m_volume;
 };
 
 class AlsaInputPrivate : public QIODevice
@@ -70,6 +70,11 @@ QAlsaAudioOutput::QAlsaAudioOutput(const QByteArray &device)
     period_size = 0;
     buffer_time = 100000;
     period_time = 20000;
+    m_targetLatency = 0;
+    m_latency = -1;
+    m_presentedUSecs = 0;
+    m_clockAnchorUSecs = -1;
+    m_clockAnchorTime = 0;
     totalTimeValue = 0;
     intervalTime = 1000;
     audioBuffer = 0;
@@ -80,12 +85,17 @@ QAlsaAudioOutput::QAlsaAudioOutput(const QByteArray &device)
     resuming = false;
     opened = false;
 
-    m_volume = 1.0f;
-
     m_device = device;
 
+    renderCallback = 0;
+    renderUserData = 0;
+
     timer = new QTimer(this);
+    // Low target latencies give periods of a few milliseconds, a coarse
+    // timer would miss them
+    timer->setTimerType(Qt::PreciseTimer);
     connect(timer,SIGNAL(timeout()),SLOT(userFeed()));
+    renderThread = new AlsaRenderThread(this);
 }
 
 QAlsaAudioOutput::~QAlsaAudioOutput()
@@ -94,16 +104,17 @@ QAlsaAudioOutput::~QAlsaAudioOutput()
     disconnect(timer, SIGNAL(timeout()));
     QCoreApplication::processEvents();
     delete timer;
+    delete renderThread;
 }
 
 void QAlsaAudioOutput::setVolume(qreal vol)
 {
-    m_volume = vol;
+    m_volume.store(vol);
 }
 
 qreal QAlsaAudioOutput::volume() const
 {
-    return m_volume;
+    return m_volume.load();
 }
 
 QAudio::Error QAlsaAudioOutput::error() const
@@ -128,6 +139,7 @@ int QAlsaAudioOutput::xrun_recovery(int err)
 #endif
 
     if(err == -EPIPE) {
+        m_stats.recordUnderrun();
         errorState = QAudio::UnderrunError;
         emit errorChanged(errorState);
         err = snd_pcm_prepare(handle);
@@ -237,6 +249,7 @@ void QAlsaAudioOutput::start(QIODevice* device)
 
     pullMode = true;
     audioSource = device;
+    renderCallback = 0;
 
     deviceState = QAudio::ActiveState;
 
@@ -263,6 +276,7 @@ QIODevice* QAlsaAudioOutput::start()
     audioSource = new AlsaOutputPrivate(this);
     audioSource->open(QIODevice::WriteOnly|QIODevice::Unbuffered);
     pullMode = false;
+    renderCallback = 0;
 
     deviceState = QAudio::IdleState;
 
@@ -273,6 +287,36 @@ QIODevice* QAlsaAudioOutput::start()
     return audioSource;
 }
 
+bool QAlsaAudioOutput::startCallback(QAudio::RenderCallback callback, void *userData)
+{
+    if(deviceState != QAudio::StoppedState)
+        deviceState = QAudio::StoppedState;
+
+    errorState = QAudio::NoError;
+
+    // Handle change of mode
+    if(audioSource && !pullMode) {
+        delete audioSource;
+        audioSource = 0;
+    }
+
+    close();
+
+    // The render thread feeds the device, there is no source to pull from
+    pullMode = true;
+    audioSource = 0;
+    renderCallback = callback;
+    renderUserData = userData;
+
+    deviceState = QAudio::ActiveState;
+
+    open();
+
+    emit stateChanged(deviceState);
+
+    return true;
+}
+
 void QAlsaAudioOutput::stop()
 {
     if(deviceState == QAudio::StoppedState)
@@ -345,6 +389,14 @@ bool QAlsaAudioOutput::open()
     QString errMessage;
     unsigned int chunks = 8;
 
+    if (m_targetLatency > 0) {
+        // The whole buffer is the output latency, split it in four periods.
+        // If that is out of range, the device minimum is used below.
+        buffer_time = m_targetLatency;
+        period_time = qMax<unsigned int>(1, buffer_time / 4);
+        chunks = 4;
+    }
+
     err = snd_pcm_hw_params_any( handle, hwparams );
     if ( err < 0 ) {
         fatal = true;
@@ -468,6 +520,7 @@ bool QAlsaAudioOutput::open()
     period_size = snd_pcm_frames_to_bytes(handle,period_frames);
     snd_pcm_hw_params_get_buffer_time(hwparams,&buffer_time, &dir);
     snd_pcm_hw_params_get_period_time(hwparams,&period_time, &dir);
+    m_latency = buffer_time;
 
     // Step 3: Set the desired SW parameters.
     snd_pcm_sw_params_t *swparams;
@@ -482,27 +535,43 @@ bool QAlsaAudioOutput::open()
     if(audioBuffer == 0)
         audioBuffer = new char[snd_pcm_frames_to_bytes(handle,buffer_frames)];
     snd_pcm_prepare( handle );
-    snd_pcm_start(handle);
+    // In callback mode the start threshold starts the device once the
+    // render thread wrote the first period
+    if (!renderCallback)
+        snd_pcm_start(handle);
 
     // Step 5: Setup timer
     bytesAvailable = bytesFree();
 
-    // Step 6: Start audio processing
-    timer->start(period_time/1000);
-
     clockStamp.restart();
     timeStamp.restart();
     elapsedTimeOffset = 0;
     errorState  = QAudio::NoError;
     totalTimeValue = 0;
+    m_presentedUSecs = 0;
+    m_clockAnchorUSecs = -1;
+    m_presentationTimer.start();
+    m_stats.reset();
+    m_loudnessMeter.reset();
+    m_loudnessMeter.prepareDeferred(settings);
+    renderedFrames.store(0);
+    renderPending.store(0);
+    renderThread->resetPresentation();
     opened = true;
 
+    // Step 6: Start audio processing
+    if (renderCallback)
+        renderThread->startRendering();
+    else
+        timer->start(qMax(1u, period_time/1000));
+
     return true;
 }
 
 void QAlsaAudioOutput::close()
 {
     timer->stop();
+    renderThread->stopRendering();
 
     if ( handle ) {
         snd_pcm_drain( handle );
@@ -510,6 +579,7 @@ void QAlsaAudioOutput::close()
         handle = 0;
         delete [] audioBuffer;
         audioBuffer=0;
+        m_stats.dump("QAlsaAudioOutput", m_device);
     }
     if(!pullMode && audioSource) {
         delete audioSource;
@@ -559,20 +629,26 @@ qint64 QAlsaAudioOutput::write( const char *data, qint64 len )
     if (!space)
         return 0;
 
+    m_stats.feedStarted(space);
+
     if (len < space)
         space = len;
 
     frames = snd_pcm_bytes_to_frames(handle, space);
 
-    if (m_volume < 1.0f) {
+    const qreal volume = m_volume.load();
+    if (volume < 1.0f) {
         QVarLengthArray<char, 4096> out(space);
-        QAudioHelperInternal::qMultiplySamples(m_volume, settings, data, out.data(), space);
+        QAudioHelperInternal::qMultiplySamples(volume, settings, data, out.data(), space);
         err = snd_pcm_writei(handle, out.constData(), frames);
     } else {
         err = snd_pcm_writei(handle, data, frames);
     }
 
+    m_stats.feedFinished(err > 0 ? snd_pcm_frames_to_bytes(handle, err) : 0);
+
     if(err > 0) {
+        m_loudnessMeter.process(settings, data, snd_pcm_frames_to_bytes(handle, err));
         totalTimeValue += err;
         resuming = false;
         errorState = QAudio::NoError;
@@ -599,6 +675,28 @@ int QAlsaAudioOutput::periodSize() const
     return period_size;
 }
 
+void QAlsaAudioOutput::setTargetLatency(qint64 microseconds)
+{
+    if (m_targetLatency == microseconds)
+        return;
+
+    m_targetLatency = microseconds;
+    if (m_targetLatency == 0) {
+        buffer_time = 100000;
+        period_time = 20000;
+    }
+}
+
+qint64 QAlsaAudioOutput::targetLatency() const
+{
+    return m_targetLatency;
+}
+
+qint64 QAlsaAudioOutput::latency() const
+{
+    return m_latency;
+}
+
 void QAlsaAudioOutput::setBufferSize(int value)
 {
     if(deviceState == QAudio::StoppedState)
@@ -625,6 +723,57 @@ qint64 QAlsaAudioOutput::processedUSecs() const
     return qint64(1000000) * totalTimeValue / settings.sampleRate();
 }
 
+QVariantMap QAlsaAudioOutput::statistics() const
+{
+    return m_stats.toVariantMap();
+}
+
+qint64 QAlsaAudioOutput::presentedUSecs() const
+{
+    if (!opened || !handle)
+        return m_presentedUSecs;
+
+    const qint64 now = m_presentationTimer.nsecsElapsed() / 1000;
+    qint64 position;
+    qint64 limit;
+
+    if (renderCallback) {
+        // The render thread owns the PCM, use what it measured last
+        qint64 frames;
+        qint64 time;
+        if (!renderThread->presentation(&frames, &time))
+            return m_presentedUSecs;
+
+        position = qint64(1000000) * frames / settings.sampleRate();
+        limit = position + period_time;
+        if (position != m_clockAnchorUSecs) {
+            m_clockAnchorUSecs = position;
+            m_clockAnchorTime = time;
+        }
+    } else {
+        snd_pcm_sframes_t delay = 0;
+        if (snd_pcm_delay(handle, &delay) < 0)
+            return m_presentedUSecs;
+
+        position = qint64(1000000) * qMax<qint64>(0, totalTimeValue - delay) / settings.sampleRate();
+        limit = processedUSecs();
+        if (position != m_clockAnchorUSecs) {
+            // The hardware pointer moved, interpolate from here on
+            m_clockAnchorUSecs = position;
+            m_clockAnchorTime = now;
+        }
+    }
+
+    // Many devices only update their pointer once per period. Advance with
+    // the monotonic clock in between, but never more than a period ahead.
+    qint64 presented = position;
+    if (deviceState == QAudio::ActiveState)
+        presented += qMin<qint64>(now - m_clockAnchorTime, period_time);
+
+    m_presentedUSecs = qMax(m_presentedUSecs, qMin(presented, limit));
+    return m_presentedUSecs;
+}
+
 void QAlsaAudioOutput::resume()
 {
     if(deviceState == QAudio::SuspendedState) {
@@ -635,9 +784,11 @@ void QAlsaAudioOutput::resume()
             if(err < 0)
                 xrun_recovery(err);
 
-            err = snd_pcm_start(handle);
-            if(err < 0)
-                xrun_recovery(err);
+            if (!renderCallback) {
+                err = snd_pcm_start(handle);
+                if(err < 0)
+                    xrun_recovery(err);
+            }
 
             bytesAvailable = (int)snd_pcm_frames_to_bytes(handle, buffer_frames);
         }
@@ -646,7 +797,10 @@ void QAlsaAudioOutput::resume()
         deviceState = pullMode ? QAudio::ActiveState : QAudio::IdleState;
 
         errorState = QAudio::NoError;
-        timer->start(period_time/1000);
+        if (renderCallback)
+            renderThread->startRendering();
+        else
+            timer->start(qMax(1u, period_time/1000));
         emit stateChanged(deviceState);
     }
 }
@@ -665,6 +819,7 @@ QAudioFormat QAlsaAudioOutput::format() const
 void QAlsaAudioOutput::suspend()
 {
     if(deviceState == QAudio::ActiveState || deviceState == QAudio::IdleState || resuming) {
+        renderThread->stopRendering();
         snd_pcm_drain(handle);
         timer->stop();
         deviceState = QAudio::SuspendedState;
@@ -762,6 +917,51 @@ bool QAlsaAudioOutput::deviceReady()
     return true;
 }
 
+void QAlsaAudioOutput::periodRendered(snd_pcm_sframes_t frames)
+{
+    // Called from the render thread. The owner thread picks up everything
+    // rendered so far, so only keep one request in flight.
+    renderedFrames.fetchAndAddOrdered(int(frames));
+    if (renderPending.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "renderProgress", Qt::QueuedConnection);
+}
+
+void QAlsaAudioOutput::renderProgress()
+{
+    renderPending.store(0);
+    totalTimeValue += renderedFrames.fetchAndStoreOrdered(0);
+    m_loudnessMeter.processPending();
+    resuming = false;
+
+    if(deviceState != QAudio::ActiveState)
+        return;
+
+    if(intervalTime && (timeStamp.elapsed() + elapsedTimeOffset) > intervalTime) {
+        emit notify();
+        elapsedTimeOffset = timeStamp.elapsed() + elapsedTimeOffset - intervalTime;
+        timeStamp.restart();
+    }
+}
+
+void QAlsaAudioOutput::renderError(bool fatal)
+{
+    if (deviceState == QAudio::StoppedState)
+        return;
+
+    if (!fatal) {
+        // The render thread recovered, but the device ran dry meanwhile
+        errorState = QAudio::UnderrunError;
+        emit errorChanged(errorState);
+        return;
+    }
+
+    close();
+    errorState = QAudio::FatalError;
+    emit errorChanged(errorState);
+    deviceState = QAudio::StoppedState;
+    emit stateChanged(deviceState);
+}
+
 qint64 QAlsaAudioOutput::elapsedUSecs() const
 {
     if (deviceState == QAudio::StoppedState)
@@ -812,6 +1012,137 @@ qint64 AlsaOutputPrivate::writeData(const char* data, qint64 len)
 
 }
 
+AlsaRenderThread::AlsaRenderThread(QAlsaAudioOutput *audio)
+    : audioDevice(audio)
+    , running(0)
+    , renderedTotal(0)
+    , presentSequence(0)
+    , presentFrames(0)
+    , presentTime(-1)
+{
+}
+
+void AlsaRenderThread::resetPresentation()
+{
+    // Only called while the thread is not running
+    renderedTotal = 0;
+    presentFrames.store(0);
+    presentTime.store(-1);
+}
+
+void AlsaRenderThread::publishPresentation(qint64 frames, qint64 time)
+{
+    const int sequence = presentSequence.fetchAndAddOrdered(1);
+    presentFrames.store(frames);
+    presentTime.store(time);
+    presentSequence.storeRelease(sequence + 2);
+}
+
+bool AlsaRenderThread::presentation(qint64 *frames, qint64 *time) const
+{
+    forever {
+        const int sequence = presentSequence.loadAcquire();
+        if (sequence & 1)
+            continue;
+        *frames = presentFrames.loadAcquire();
+        *time = presentTime.loadAcquire();
+        if (presentSequence.load() == sequence)
+            return *time >= 0;
+    }
+}
+
+void AlsaRenderThread::startRendering()
+{
+    if (isRunning())
+        return;
+
+    running.store(1);
+    start(QThread::TimeCriticalPriority);
+}
+
+void AlsaRenderThread::stopRendering()
+{
+    running.store(0);
+    wait();
+}
+
+bool AlsaRenderThread::recover(snd_pcm_sframes_t err)
+{
+    // Underrun or suspend, let alsa-lib prepare the device again. The start
+    // threshold restarts it with the next period written.
+    if (err == -EPIPE)
+        audioDevice->m_stats.recordUnderrun();
+    const int result = snd_pcm_recover(audioDevice->handle, err, 1);
+    QMetaObject::invokeMethod(audioDevice, "renderError", Qt::QueuedConnection,
+                              Q_ARG(bool, result < 0));
+    return result == 0;
+}
+
+void AlsaRenderThread::run()
+{
+    snd_pcm_t *handle = audioDevice->handle;
+    const QAudioFormat format = audioDevice->settings;
+    const snd_pcm_uframes_t periodFrames = audioDevice->period_frames;
+    const int periodBytes = audioDevice->period_size;
+    const int timeout = qMax(1, int(2 * audioDevice->period_time / 1000));
+
+    // Everything the loop needs is allocated up front
+    QByteArray period(periodBytes, 0);
+    char *data = period.data();
+
+    while (running.load()) {
+        // Render as late as possible, once a whole period fits
+        snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+        if (avail >= 0 && snd_pcm_uframes_t(avail) < periodFrames) {
+            const int err = snd_pcm_wait(handle, timeout);
+            if (err >= 0)
+                continue;
+            avail = err;
+        }
+
+        if (avail < 0) {
+            if (!recover(avail))
+                break;
+            continue;
+        }
+
+        audioDevice->m_stats.feedStarted(snd_pcm_frames_to_bytes(handle, avail));
+
+        audioDevice->renderCallback(data, periodBytes, audioDevice->renderUserData);
+
+        // Metered before the volume is applied, on the owner thread
+        audioDevice->m_loudnessMeter.processDeferred(data, periodBytes);
+        const qreal volume = audioDevice->m_volume.load();
+        if (volume < 1.0f)
+            QAudioHelperInternal::qMultiplySamples(volume, format, data, data, periodBytes);
+
+        snd_pcm_uframes_t written = 0;
+        while (written < periodFrames && running.load()) {
+            const snd_pcm_sframes_t frames = snd_pcm_writei(handle, data + snd_pcm_frames_to_bytes(handle, written),
+                                                            periodFrames - written);
+            if (frames < 0) {
+                if (!recover(frames)) {
+                    running.store(0);
+                    break;
+                }
+                continue;
+            }
+            written += frames;
+        }
+
+        audioDevice->m_stats.feedFinished(snd_pcm_frames_to_bytes(handle, written));
+        if (written > 0) {
+            renderedTotal += written;
+            snd_pcm_sframes_t delay = 0;
+            if (snd_pcm_delay(handle, &delay) == 0) {
+                publishPresentation(qMax<qint64>(0, renderedTotal - delay),
+                                    audioDevice->m_presentationTimer.nsecsElapsed() / 1000);
+            }
+            audioDevice->periodRendered(written);
+        }
+    }
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qalsaaudiooutput.cpp"
@@ -59,18 +59,61 @@
 #include <QtCore/qstring.h>
 #include <QtCore/qstringlist.h>
 #include <QtCore/qdatetime.h>
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qiodevice.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qatomic.h>
 
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudiodeviceinfo.h>
 #include <QtMultimedia/qaudiosystem.h>
+#include <QtMultimedia/private/qaudiohelpers_p.h>
+#include <QtMultimedia/private/qaudiostreamstats_p.h>
+#include <QtMultimedia/private/qaudioloudnessmeter_p.h>
+#include <QtMultimedia/private/qaudiosystemext_p.h>
 
 QT_BEGIN_NAMESPACE
 
-class QAlsaAudioOutput : public QAbstractAudioOutput
+class QAlsaAudioOutput;
+
+// Calls the render callback of a QAlsaAudioOutput one period at a time, as
+// soon as the device has room for it.
+class AlsaRenderThread : public QThread
+{
+public:
+    AlsaRenderThread(QAlsaAudioOutput *audio);
+
+    void startRendering();
+    void stopRendering();
+
+    // The frames played and when that was measured, in microseconds of the
+    // output's presentation timer. Only the render thread touches the PCM
+    // while it runs, so it publishes this after every period.
+    void resetPresentation();
+    bool presentation(qint64 *frames, qint64 *time) const;
+
+protected:
+    void run() override;
+
+private:
+    bool recover(snd_pcm_sframes_t err);
+    void publishPresentation(qint64 frames, qint64 time);
+
+    QAlsaAudioOutput *audioDevice;
+    QAtomicInt running;
+    qint64 renderedTotal;
+    // Sequence lock, odd while the render thread updates the values
+    QAtomicInt presentSequence;
+    QAtomicInteger<qint64> presentFrames;
+    QAtomicInteger<qint64> presentTime;
+};
+
+class QAlsaAudioOutput : public QAbstractAudioOutput, public QAudioOutputExtension
 {
     friend class AlsaOutputPrivate;
+    friend class AlsaRenderThread;
     Q_OBJECT
+    Q_INTERFACES(QAudioOutputExtension)
 public:
     QAlsaAudioOutput(const QByteArray &device);
     ~QAlsaAudioOutput();
@@ -79,6 +122,7 @@ public:
 
     void start(QIODevice* device);
     QIODevice* start();
+    bool startCallback(QAudio::RenderCallback callback, void *userData) override;
     void stop();
     void reset();
     void suspend();
@@ -97,6 +141,12 @@ public:
     QAudioFormat format() const;
     void setVolume(qreal);
     qreal volume() const;
+    void setTargetLatency(qint64 microseconds) override;
+    qint64 targetLatency() const override;
+    qint64 latency() const override;
+    qint64 presentedUSecs() const override;
+    QVariantMap statistics() const override;
+    QAudioLoudnessMeter *loudnessMeter() override { return &m_loudnessMeter; }
 
 
     QIODevice* audioSource;
@@ -107,6 +157,8 @@ public:
 private slots:
     void userFeed();
     bool deviceReady();
+    void renderProgress();
+    void renderError(bool fatal);
 
 signals:
     void processMore();
@@ -123,13 +175,27 @@ private:
     unsigned int period_time;
     snd_pcm_uframes_t buffer_frames;
     snd_pcm_uframes_t period_frames;
+    qint64 m_targetLatency;
+    qint64 m_latency;
+    QElapsedTimer m_presentationTimer;
+    mutable qint64 m_presentedUSecs;
+    mutable qint64 m_clockAnchorUSecs;
+    mutable qint64 m_clockAnchorTime;
+    QAudioStreamStats m_stats;
+    QAudioLoudnessMeter m_loudnessMeter;
     int xrun_recovery(int err);
+    void periodRendered(snd_pcm_sframes_t frames);
 
     int setFormat();
     bool open();
     void close();
 
     QTimer* timer;
+    AlsaRenderThread *renderThread;
+    QAudio::RenderCallback renderCallback;
+    void *renderUserData;
+    QAtomicInt renderedFrames;
+    QAtomicInt renderPending;
     QByteArray m_device;
     int bytesAvailable;
     QTime timeStamp;
@@ -140,7 +206,7 @@ private:
     snd_pcm_access_t access;
     snd_pcm_format_t pcmformat;
     snd_pcm_hw_params_t *hwparams;
-    qreal m_volume;
+    QAudioHelperInternal::AtomicVolume m_volume;
 };
 
 class AlsaOutputPrivate : public QIODevice
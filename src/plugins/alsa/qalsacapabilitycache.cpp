@@ -0,0 +1,404 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// INTERNAL USE ONLY: Do NOT use for any other purpose.
+//
+
+#include "qalsacapabilitycache.h"
+#include "qalsaaudiodeviceinfo.h"
+
+#include <QtCore/qdir.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qsettings.h>
+#include <QtCore/qstandardpaths.h>
+#include <QtCore/qsysinfo.h>
+
+#include <alsa/asoundlib.h>
+
+QT_BEGIN_NAMESPACE
+
+// Bump when the meaning of stored probes changes.
+static const int cacheFormatVersion = 2;
+
+// Probes come in bursts while a stream negotiates its format. The file is
+// written once the burst is over, or right away when the cache goes away.
+static const int saveDelayMs = 500;
+
+Q_GLOBAL_STATIC(QAlsaCapabilityCache, capabilityCache)
+
+class QAlsaCapabilityRefresh : public QRunnable
+{
+public:
+    QAlsaCapabilityRefresh(QAlsaCapabilityCache *cache) : m_cache(cache) {}
+    void run() override { m_cache->refresh(); }
+
+private:
+    QAlsaCapabilityCache *m_cache;
+};
+
+class QAlsaCapabilitySave : public QRunnable
+{
+public:
+    QAlsaCapabilitySave(QAlsaCapabilityCache *cache) : m_cache(cache) {}
+    void run() override { m_cache->writeFile(); }
+
+private:
+    QAlsaCapabilityCache *m_cache;
+};
+
+// What a card supports may change with its driver. Out of tree modules
+// carry a version, in tree drivers change with the kernel.
+static QString driverVersion(int card)
+{
+    const QString module = QString(QLatin1String("/sys/class/sound/card%1/device/driver/module/")).arg(card);
+    for (const char *name : { "version", "srcversion" }) {
+        QFile file(module + QLatin1String(name));
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+        const QByteArray version = file.readLine().trimmed();
+        if (!version.isEmpty())
+            return QString::fromLatin1(version);
+    }
+    return QSysInfo::kernelVersion();
+}
+
+QAlsaCapabilityCache::QAlsaCapabilityCache()
+{
+    // Refreshes and saves never run concurrently
+    m_worker.setMaxThreadCount(1);
+}
+
+QAlsaCapabilityCache::~QAlsaCapabilityCache()
+{
+    shutdown();
+}
+
+void QAlsaCapabilityCache::shutdown()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_shuttingDown = true;
+        m_saveWakeup.wakeAll();
+    }
+    m_worker.waitForDone();
+}
+
+QAlsaCapabilityCache *QAlsaCapabilityCache::instance()
+{
+    return capabilityCache();
+}
+
+bool QAlsaCapabilityCache::canOpen(const QString &device, QAudio::Mode mode)
+{
+    return lookup(device, mode, QStringLiteral("open"));
+}
+
+bool QAlsaCapabilityCache::isFormatSupported(const QString &device, QAudio::Mode mode,
+                                             const QAudioFormat &format)
+{
+    // Only PCM is handled, so there is nothing worth remembering about other codecs
+    if (!format.codec().startsWith(QLatin1String("audio/pcm")))
+        return false;
+
+    return lookup(device, mode, formatProbe(format));
+}
+
+void QAlsaCapabilityCache::reloadCards()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_cards.clear();
+    QStringList all;
+
+    int card = -1;
+    while (snd_card_next(&card) == 0 && card >= 0) {
+        snd_ctl_t *ctl;
+        if (snd_ctl_open(&ctl, QByteArray("hw:" + QByteArray::number(card)).constData(), 0) < 0)
+            continue;
+
+        snd_ctl_card_info_t *info;
+        snd_ctl_card_info_alloca(&info);
+        if (snd_ctl_card_info(ctl, info) == 0) {
+            const QString id = QString::fromLocal8Bit(snd_ctl_card_info_get_id(info));
+            const QString key = id + QLatin1Char(':')
+                              + QString::fromLocal8Bit(snd_ctl_card_info_get_driver(info))
+                              + QLatin1Char('@') + driverVersion(card);
+            m_cards.insert(id, key);
+            m_cards.insert(QString::number(card), key);
+            all.append(key);
+        }
+        snd_ctl_close(ctl);
+    }
+
+    all.sort();
+    m_allCards = all.join(QLatin1Char(','));
+}
+
+bool QAlsaCapabilityCache::lookup(const QString &device, QAudio::Mode mode, const QString &probe)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_loaded) {
+        locker.unlock();
+        reloadCards();
+        locker.relock();
+        if (!m_loaded)
+            load();
+    }
+
+    const QString key = entryKey(device, mode, probe);
+    auto it = m_entries.constFind(key);
+    if (it != m_entries.constEnd()) {
+        if (!it->verified && !m_refreshStarted) {
+            m_refreshStarted = true;
+            m_worker.start(new QAlsaCapabilityRefresh(this));
+        }
+        return it->supported;
+    }
+
+    locker.unlock();
+    const int err = runProbe(device, mode, probe);
+    // A busy device says nothing about what it supports; ask again next time.
+    if (err == -EBUSY || err == -EAGAIN)
+        return false;
+
+    locker.relock();
+    m_entries.insert(key, Entry{ device, mode, probe, err == 0, true });
+    scheduleSave();
+    return err == 0;
+}
+
+QString QAlsaCapabilityCache::entryKey(const QString &device, QAudio::Mode mode,
+                                       const QString &probe) const
+{
+    return QString(QLatin1String("%1|%2|%3|%4"))
+            .arg(mode == QAudio::AudioInput ? QLatin1Char('i') : QLatin1Char('o'))
+            .arg(cardKey(device), device, probe);
+}
+
+QString QAlsaCapabilityCache::cardKey(const QString &device) const
+{
+    // "hw:CARD=PCH,DEV=0", "front:CARD=PCH,DEV=0" or "plughw:1,0" all name a card;
+    // anything else ("default", "dmix", ...) may route to any of them.
+    QString card;
+    const int cardPos = device.indexOf(QLatin1String("CARD="));
+    if (cardPos >= 0) {
+        card = device.mid(cardPos + 5);
+    } else if (device.startsWith(QLatin1String("hw:")) || device.startsWith(QLatin1String("plughw:"))) {
+        card = device.mid(device.indexOf(QLatin1Char(':')) + 1);
+    }
+    const int comma = card.indexOf(QLatin1Char(','));
+    if (comma >= 0)
+        card.truncate(comma);
+
+    return m_cards.value(card, m_allCards);
+}
+
+void QAlsaCapabilityCache::load()
+{
+    m_loaded = true;
+
+    QString version;
+    QFile procVersion(QStringLiteral("/proc/asound/version"));
+    if (procVersion.open(QIODevice::ReadOnly))
+        version = QString::fromLocal8Bit(procVersion.readLine().trimmed());
+    m_fingerprint = QString(QLatin1String("%1 %2 alsa-lib %3"))
+            .arg(cacheFormatVersion).arg(version, QLatin1String(snd_asoundlib_version()));
+
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (cacheDir.isEmpty())
+        return;
+    m_fileName = cacheDir + QLatin1String("/qtmultimedia/alsa-capabilities.ini");
+
+    QSettings settings(m_fileName, QSettings::IniFormat);
+    if (settings.value(QStringLiteral("fingerprint")).toString() != m_fingerprint)
+        return;
+
+    settings.beginGroup(QStringLiteral("probes"));
+    const QStringList keys = settings.childKeys();
+    for (const QString &encoded : keys) {
+        const QString key = QString::fromUtf8(QByteArray::fromPercentEncoding(encoded.toLatin1()));
+        const QStringList parts = key.split(QLatin1Char('|'));
+        if (parts.size() != 4)
+            continue;
+        Entry entry{ parts.at(2),
+                     parts.at(0) == QLatin1String("i") ? QAudio::AudioInput : QAudio::AudioOutput,
+                     parts.at(3),
+                     settings.value(encoded).toBool(),
+                     false };
+        m_entries.insert(key, entry);
+    }
+}
+
+// Called with m_mutex held
+void QAlsaCapabilityCache::scheduleSave()
+{
+    m_dirty = true;
+    if (m_fileName.isEmpty() || m_saveScheduled)
+        return;
+
+    m_saveScheduled = true;
+    m_worker.start(new QAlsaCapabilitySave(this));
+}
+
+void QAlsaCapabilityCache::writeFile()
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Lookups go on while this waits, shutdown() cuts the wait short
+    QElapsedTimer timer;
+    timer.start();
+    qint64 remaining = saveDelayMs;
+    while (!m_shuttingDown && remaining > 0) {
+        m_saveWakeup.wait(&m_mutex, remaining);
+        remaining = saveDelayMs - timer.elapsed();
+    }
+
+    m_saveScheduled = false;
+    if (!m_dirty)
+        return;
+    m_dirty = false;
+
+    const QString fileName = m_fileName;
+    const QString fingerprint = m_fingerprint;
+    QHash<QString, bool> probes;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+        probes.insert(it.key(), it->supported);
+    locker.unlock();
+
+    QDir().mkpath(fileName.left(fileName.lastIndexOf(QLatin1Char('/'))));
+
+    QSettings settings(fileName, QSettings::IniFormat);
+    settings.clear();
+    settings.setValue(QStringLiteral("fingerprint"), fingerprint);
+    settings.beginGroup(QStringLiteral("probes"));
+    for (auto it = probes.cbegin(); it != probes.cend(); ++it)
+        settings.setValue(QString::fromLatin1(it.key().toUtf8().toPercentEncoding()), it.value());
+    settings.endGroup();
+}
+
+void QAlsaCapabilityCache::refresh()
+{
+    QHash<QString, Entry> pending;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+            if (!it->verified)
+                pending.insert(it.key(), it.value());
+        }
+    }
+
+    // Enumerating the devices opens them, don't hold up lookups meanwhile
+    const QList<QByteArray> inputs = availableDevices(QAudio::AudioInput);
+    const QList<QByteArray> outputs = availableDevices(QAudio::AudioOutput);
+
+    bool changed = false;
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it) {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_shuttingDown)
+                break;
+        }
+
+        const Entry &entry = it.value();
+        const QList<QByteArray> &devices = entry.mode == QAudio::AudioInput ? inputs : outputs;
+        if (!devices.contains(entry.device.toLocal8Bit())) {
+            // Belongs to a card that is not plugged in; keep it for next time.
+            continue;
+        }
+
+        const int err = runProbe(entry.device, entry.mode, entry.probe);
+
+        QMutexLocker locker(&m_mutex);
+        if (err == -EBUSY || err == -EAGAIN || !m_entries.contains(it.key()))
+            continue;
+        Entry &stored = m_entries[it.key()];
+        stored.supported = err == 0;
+        stored.verified = true;
+        changed = true;
+    }
+
+    if (changed) {
+        QMutexLocker locker(&m_mutex);
+        scheduleSave();
+    }
+}
+
+QList<QByteArray> QAlsaCapabilityCache::availableDevices(QAudio::Mode mode)
+{
+    return QAlsaAudioDeviceInfo::availableDevices(mode);
+}
+
+int QAlsaCapabilityCache::runProbe(const QString &device, QAudio::Mode mode, const QString &probe)
+{
+    if (probe == QLatin1String("open"))
+        return QAlsaAudioDeviceInfo::probeOpen(device, mode);
+
+    // rate/channels/size/type/byteorder
+    const QStringList fields = probe.split(QLatin1Char('/'));
+    if (fields.size() != 5)
+        return -EINVAL;
+
+    QAudioFormat format;
+    format.setCodec(QStringLiteral("audio/pcm"));
+    format.setSampleRate(fields.at(0).toInt());
+    format.setChannelCount(fields.at(1).toInt());
+    format.setSampleSize(fields.at(2).toInt());
+    format.setSampleType(QAudioFormat::SampleType(fields.at(3).toInt()));
+    format.setByteOrder(QAudioFormat::Endian(fields.at(4).toInt()));
+    return QAlsaAudioDeviceInfo::probeFormat(device, mode, format);
+}
+
+QString QAlsaCapabilityCache::formatProbe(const QAudioFormat &format)
+{
+    return QString(QLatin1String("%1/%2/%3/%4/%5"))
+            .arg(format.sampleRate()).arg(format.channelCount()).arg(format.sampleSize())
+            .arg(int(format.sampleType())).arg(int(format.byteOrder()));
+}
+
+QT_END_NAMESPACE
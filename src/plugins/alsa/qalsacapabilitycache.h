@@ -0,0 +1,136 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#ifndef QALSACAPABILITYCACHE_H
+#define QALSACAPABILITYCACHE_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qwaitcondition.h>
+
+#include <QtMultimedia/qaudio.h>
+#include <QtMultimedia/qaudioformat.h>
+
+QT_BEGIN_NAMESPACE
+
+// Remembers the outcome of opening a PCM and testing hw params against it.
+// Results are kept in memory and in a file below the generic cache location,
+// keyed by the card ID, driver and driver version of the card the device
+// belongs to. Results read from disk are answered immediately and
+// re-verified on a worker thread, which also writes the file.
+class QAlsaCapabilityCache
+{
+public:
+    QAlsaCapabilityCache();
+    virtual ~QAlsaCapabilityCache();
+
+    static QAlsaCapabilityCache *instance();
+
+    bool canOpen(const QString &device, QAudio::Mode mode);
+    bool isFormatSupported(const QString &device, QAudio::Mode mode, const QAudioFormat &format);
+
+    // Called when the set of sound cards may have changed.
+    void reloadCards();
+
+protected:
+    // Overridden by the unit test, which has no sound cards to probe
+    virtual int runProbe(const QString &device, QAudio::Mode mode, const QString &probe);
+    virtual QList<QByteArray> availableDevices(QAudio::Mode mode);
+
+    // Wakes a pending save, which then writes at once, and waits for the worker.
+    // Subclasses call it from their destructor, before their overrides go away.
+    void shutdown();
+
+private:
+    struct Entry
+    {
+        QString device;
+        QAudio::Mode mode;
+        QString probe;
+        bool supported;
+        bool verified;
+    };
+
+    bool lookup(const QString &device, QAudio::Mode mode, const QString &probe);
+    QString entryKey(const QString &device, QAudio::Mode mode, const QString &probe) const;
+    QString cardKey(const QString &device) const;
+
+    void load();
+    void scheduleSave();
+    void writeFile();
+    void refresh();
+
+    static QString formatProbe(const QAudioFormat &format);
+
+    QMutex m_mutex;
+    bool m_loaded = false;
+    bool m_refreshStarted = false;
+    bool m_dirty = false;
+    bool m_saveScheduled = false;
+    bool m_shuttingDown = false;
+    QWaitCondition m_saveWakeup;
+    QString m_fingerprint;
+    QString m_fileName;
+    QHash<QString, QString> m_cards;  // card id and index -> "id:driver@version"
+    QString m_allCards;
+    QHash<QString, Entry> m_entries;
+    QThreadPool m_worker;
+
+    friend class QAlsaCapabilityRefresh;
+    friend class QAlsaCapabilitySave;
+};
+
+QT_END_NAMESPACE
+
+#endif // QALSACAPABILITYCACHE_H
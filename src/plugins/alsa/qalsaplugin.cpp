@@ -39,14 +39,42 @@
 
 #include "qalsaplugin.h"
 #include "qalsaaudiodeviceinfo.h"
+#include "qalsacapabilitycache.h"
 #include "qalsaaudioinput.h"
 #include "qalsaaudiooutput.h"
 
+#include <QtCore/qfilesystemwatcher.h>
+
 QT_BEGIN_NAMESPACE
 
 QAlsaPlugin::QAlsaPlugin(QObject *parent)
     : QAudioSystemPlugin(parent)
 {
+    // A hotplugged card creates or removes several nodes in /dev/snd in quick
+    // succession; wait for the burst to settle before rescanning.
+    m_rescanTimer.setSingleShot(true);
+    m_rescanTimer.setInterval(250);
+    connect(&m_rescanTimer, &QTimer::timeout, this, &QAlsaPlugin::rescanDevices);
+
+    QFileSystemWatcher *watcher = new QFileSystemWatcher(this);
+    if (watcher->addPath(QStringLiteral("/dev/snd"))) {
+        connect(watcher, &QFileSystemWatcher::directoryChanged,
+                &m_rescanTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    }
+}
+
+void QAlsaPlugin::rescanDevices()
+{
+    const QList<QByteArray> inputs = QAlsaAudioDeviceInfo::availableDevices(QAudio::AudioInput);
+    const QList<QByteArray> outputs = QAlsaAudioDeviceInfo::availableDevices(QAudio::AudioOutput);
+
+    QAlsaAudioDeviceInfo::invalidateDeviceCache();
+    QAlsaCapabilityCache::instance()->reloadCards();
+
+    if (QAlsaAudioDeviceInfo::availableDevices(QAudio::AudioInput) != inputs)
+        emit availableDevicesChanged(QAudio::AudioInput);
+    if (QAlsaAudioDeviceInfo::availableDevices(QAudio::AudioOutput) != outputs)
+        emit availableDevicesChanged(QAudio::AudioOutput);
 }
 
 QByteArray QAlsaPlugin::defaultDevice(QAudio::Mode mode) const
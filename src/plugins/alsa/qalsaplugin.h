@@ -43,6 +43,8 @@
 #include <QtMultimedia/qaudiosystemplugin.h>
 #include <QtMultimedia/private/qaudiosystempluginext_p.h>
 
+#include <QtCore/qtimer.h>
+
 QT_BEGIN_NAMESPACE
 
 class QAlsaPlugin : public QAudioSystemPlugin, public QAudioSystemPluginExtension
@@ -61,6 +63,12 @@ public:
     QAbstractAudioInput *createInput(const QByteArray &device) Q_DECL_OVERRIDE;
     QAbstractAudioOutput *createOutput(const QByteArray &device) Q_DECL_OVERRIDE;
     QAbstractAudioDeviceInfo *createDeviceInfo(const QByteArray &device, QAudio::Mode mode) Q_DECL_OVERRIDE;
+
+private Q_SLOTS:
+    void rescanDevices();
+
+private:
+    QTimer m_rescanTimer;
 };
 
 QT_END_NAMESPACE
@@ -38,12 +38,16 @@
 ****************************************************************************/
 
 #include "audiocaptureprobecontrol.h"
+#include <private/qmediaaudioprobecontrol_p.h>
+
+#include <QtCore/qmetaobject.h>
 
 QT_BEGIN_NAMESPACE
 
 AudioCaptureProbeControl::AudioCaptureProbeControl(QObject *parent):
     QMediaAudioProbeControl(parent)
 {
+    QMediaAudioProbeControlPrivate::get(this)->setListenersSupported(true);
 }
 
 AudioCaptureProbeControl::~AudioCaptureProbeControl()
@@ -55,8 +59,19 @@ void AudioCaptureProbeControl::bufferProbed(const char *data, quint32 size, cons
     if (!format.isValid())
         return;
 
-    QAudioBuffer audioBuffer = QAudioBuffer(QByteArray::fromRawData(data, size), format);
-    QMetaObject::invokeMethod(this, "audioBufferProbed", Qt::QueuedConnection, Q_ARG(QAudioBuffer, audioBuffer));
+    QMediaAudioProbeControlPrivate *d = QMediaAudioProbeControlPrivate::get(this);
+    static const QMetaMethod probedSignal = QMetaMethod::fromSignal(&QMediaAudioProbeControl::audioBufferProbed);
+    const bool deliverBuffers = isSignalConnected(probedSignal);
+    if (!deliverBuffers && !d->hasListeners())
+        return;
+
+    // Queued listeners and the queued signal keep the buffer beyond this
+    // call, so both share one copy of the data
+    QAudioBuffer audioBuffer = QAudioBuffer(QByteArray(data, size), format);
+    d->probeBuffer(audioBuffer);
+
+    if (deliverBuffers)
+        QMetaObject::invokeMethod(this, "audioBufferProbed", Qt::QueuedConnection, Q_ARG(QAudioBuffer, audioBuffer));
 }
 
 QT_END_NAMESPACE
@@ -49,6 +49,16 @@
 
 QT_BEGIN_NAMESPACE
 
+FileProbeProxy::FileProbeProxy()
+    : m_writer(0)
+{
+}
+
+void FileProbeProxy::setWriter(AudioFileWriter *writer)
+{
+    m_writer = writer;
+}
+
 void FileProbeProxy::startProbes(const QAudioFormat &format)
 {
     m_format = format;
@@ -84,7 +94,14 @@ qint64 FileProbeProxy::writeData(const char *data, qint64 len)
             probe->bufferProbed(data, len, m_format);
     }
 
-    return QFile::writeData(data, len);
+    return m_writer ? m_writer->write(data, len) : len;
+}
+
+qint64 FileProbeProxy::readData(char *data, qint64 len)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+    return -1;
 }
 
 AudioCaptureSession::AudioCaptureSession(QObject *parent)
@@ -93,11 +110,14 @@ AudioCaptureSession::AudioCaptureSession(QObject *parent)
     , m_status(QMediaRecorder::UnloadedStatus)
     , m_audioInput(0)
     , m_deviceInfo(QAudioDeviceInfo::defaultInputDevice())
-    , m_wavFile(true)
+    , m_container(AudioFileWriter::WavContainer)
+    , m_flacCodec(false)
     , m_volume(1.0)
     , m_muted(false)
 {
     m_format = m_deviceInfo.preferredFormat();
+    file.setWriter(&m_writer);
+    connect(&m_writer, SIGNAL(error(QString)), this, SLOT(writerError(QString)));
 }
 
 AudioCaptureSession::~AudioCaptureSession()
@@ -107,24 +127,47 @@ AudioCaptureSession::~AudioCaptureSession()
 
 QAudioFormat AudioCaptureSession::format() const
 {
-    return m_format;
+    if (!m_flacCodec)
+        return m_format;
+
+    QAudioFormat format = m_format;
+    format.setCodec(QStringLiteral("audio/x-flac"));
+    return format;
 }
 
 void AudioCaptureSession::setFormat(const QAudioFormat &format)
 {
+    // FLAC is encoded from the PCM the device captures
     m_format = format;
+    m_flacCodec = format.codec() == QLatin1String("audio/x-flac");
+    if (m_flacCodec)
+        m_format.setCodec(QStringLiteral("audio/pcm"));
 }
 
 void AudioCaptureSession::setContainerFormat(const QString &formatMimeType)
 {
-    m_wavFile = (formatMimeType.isEmpty()
-                 || QString::compare(formatMimeType, QLatin1String("audio/x-wav")) == 0);
+    if (formatMimeType.isEmpty()
+            || QString::compare(formatMimeType, QLatin1String("audio/x-wav")) == 0) {
+        m_container = AudioFileWriter::WavContainer;
+#if QT_CONFIG(flac)
+    } else if (QString::compare(formatMimeType, QLatin1String("audio/x-flac")) == 0) {
+        m_container = AudioFileWriter::FlacContainer;
+#endif
+    } else {
+        m_container = AudioFileWriter::RawContainer;
+    }
 }
 
 QString AudioCaptureSession::containerFormat() const
 {
-    if (m_wavFile)
+    switch (m_container) {
+    case AudioFileWriter::WavContainer:
         return QStringLiteral("audio/x-wav");
+    case AudioFileWriter::FlacContainer:
+        return QStringLiteral("audio/x-flac");
+    case AudioFileWriter::RawContainer:
+        break;
+    }
 
     return QStringLiteral("audio/x-raw");
 }
@@ -275,7 +318,30 @@ void AudioCaptureSession::record()
 
         setStatus(QMediaRecorder::LoadingStatus);
 
+        // The FLAC codec implies the FLAC container
+        AudioFileWriter::Container container = m_container;
+#if QT_CONFIG(flac)
+        if (m_flacCodec)
+            container = AudioFileWriter::FlacContainer;
+        if (container == AudioFileWriter::FlacContainer
+                && !AudioFlacEncoder::isFormatSupported(m_format)) {
+            m_format.setSampleType(QAudioFormat::SignedInt);
+            m_format.setSampleSize(16);
+        }
+#endif
+
         m_format = m_deviceInfo.nearestFormat(m_format);
+#if QT_CONFIG(flac)
+        if (container == AudioFileWriter::FlacContainer
+                && !AudioFlacEncoder::isFormatSupported(m_format)) {
+            emit error(QMediaRecorder::FormatError,
+                       QStringLiteral("The input device has no format FLAC can encode."));
+            m_state = QMediaRecorder::StoppedState;
+            emit stateChanged(m_state);
+            setStatus(QMediaRecorder::UnloadedStatus);
+            return;
+        }
+#endif
         m_audioInput = new QAudioInput(m_deviceInfo, m_format);
         connect(m_audioInput, SIGNAL(stateChanged(QAudio::State)),
                 this, SLOT(audioInputStateChanged(QAudio::State)));
@@ -286,41 +352,23 @@ void AudioCaptureSession::record()
         QString filePath = generateFileName(
                     m_requestedOutputLocation.isLocalFile() ? m_requestedOutputLocation.toLocalFile()
                                                    : m_requestedOutputLocation.toString(),
-                    m_wavFile ? QLatin1String("wav")
-                              : QLatin1String("raw"));
+                    container == AudioFileWriter::WavContainer ? QLatin1String("wav")
+                    : container == AudioFileWriter::FlacContainer ? QLatin1String("flac")
+                    : QLatin1String("raw"));
 
         m_actualOutputLocation = QUrl::fromLocalFile(filePath);
         if (m_actualOutputLocation != m_requestedOutputLocation)
             emit actualLocationChanged(m_actualOutputLocation);
 
-        file.setFileName(filePath);
-
         setStatus(QMediaRecorder::LoadedStatus);
         setStatus(QMediaRecorder::StartingStatus);
 
-        if (file.open(QIODevice::WriteOnly)) {
-            if (m_wavFile) {
-                memset(&header,0,sizeof(CombinedHeader));
-                memcpy(header.riff.descriptor.id,"RIFF",4);
-                header.riff.descriptor.size = 0xFFFFFFFF; // This should be updated on stop(), filesize-8
-                memcpy(header.riff.type,"WAVE",4);
-                memcpy(header.wave.descriptor.id,"fmt ",4);
-                header.wave.descriptor.size = 16;
-                header.wave.audioFormat = 1; // for PCM data
-                header.wave.numChannels = m_format.channelCount();
-                header.wave.sampleRate = m_format.sampleRate();
-                header.wave.byteRate = m_format.sampleRate()*m_format.channelCount()*m_format.sampleSize()/8;
-                header.wave.blockAlign = m_format.channelCount()*m_format.sampleSize()/8;
-                header.wave.bitsPerSample = m_format.sampleSize();
-                memcpy(header.data.descriptor.id,"data",4);
-                header.data.descriptor.size = 0xFFFFFFFF; // This should be updated on stop(),samples*channels*sampleSize/8
-                file.write((char*)&header,sizeof(CombinedHeader));
-            }
-
+        if (m_writer.open(filePath, m_format, container)) {
             setVolumeHelper(m_muted ? 0 : m_volume);
 
             file.startProbes(m_format);
-            m_audioInput->start(qobject_cast<QIODevice*>(&file));
+            file.open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+            m_audioInput->start(&file);
         } else {
             delete m_audioInput;
             m_audioInput = 0;
@@ -344,17 +392,8 @@ void AudioCaptureSession::stop()
         m_audioInput->stop();
         file.stopProbes();
         file.close();
-        if (m_wavFile) {
-            qint32 fileSize = file.size();
-            file.open(QIODevice::ReadWrite | QIODevice::Unbuffered);
-            file.read((char*)&header,sizeof(CombinedHeader));
-            header.riff.descriptor.size = fileSize - 8; // The RIFF chunk size is the file size minus
-                                                        // the first two RIFF fields (8 bytes)
-            header.data.descriptor.size = fileSize - 44; // dataSize = fileSize - headerSize (44 bytes)
-            file.seek(0);
-            file.write((char*)&header,sizeof(CombinedHeader));
-            file.close();
-        }
+        // Writes what is still queued and finalizes the header
+        m_writer.close();
         delete m_audioInput;
         m_audioInput = 0;
         setStatus(QMediaRecorder::UnloadedStatus);
@@ -393,6 +432,12 @@ void AudioCaptureSession::notify()
     emit positionChanged(position());
 }
 
+void AudioCaptureSession::writerError(const QString &errorString)
+{
+    emit error(QMediaRecorder::ResourceError, errorString);
+    setState(QMediaRecorder::StoppedState);
+}
+
 void AudioCaptureSession::setCaptureDevice(const QString &deviceName)
 {
     m_captureDevice = deviceName;
@@ -46,6 +46,7 @@
 #include <QMutex>
 
 #include "audioencodercontrol.h"
+#include "audiofilewriter.h"
 #include "audioinputselector.h"
 #include "audiomediarecordercontrol.h"
 
@@ -57,17 +58,22 @@ QT_BEGIN_NAMESPACE
 
 class AudioCaptureProbeControl;
 
-class FileProbeProxy: public QFile {
+class FileProbeProxy: public QIODevice {
 public:
+    FileProbeProxy();
+
+    void setWriter(AudioFileWriter *writer);
     void startProbes(const QAudioFormat& format);
     void stopProbes();
     void addProbe(AudioCaptureProbeControl *probe);
     void removeProbe(AudioCaptureProbeControl *probe);
 
 protected:
+    virtual qint64 readData(char *data, qint64 len);
     virtual qint64 writeData(const char *data, qint64 len);
 
 private:
+    AudioFileWriter *m_writer;
     QAudioFormat m_format;
     QList<AudioCaptureProbeControl*> m_probes;
     QMutex m_probeMutex;
@@ -120,6 +126,7 @@ signals:
 private slots:
     void audioInputStateChanged(QAudio::State state);
     void notify();
+    void writerError(const QString &errorString);
 
 private:
     void record();
@@ -136,6 +143,7 @@ private:
     QString generateFileName(const QDir &dir, const QString &extension) const;
 
     FileProbeProxy file;
+    AudioFileWriter m_writer;
     QString m_captureDevice;
     QUrl m_requestedOutputLocation;
     QUrl m_actualOutputLocation;
@@ -144,49 +152,10 @@ private:
     QAudioInput *m_audioInput;
     QAudioDeviceInfo m_deviceInfo;
     QAudioFormat m_format;
-    bool m_wavFile;
+    AudioFileWriter::Container m_container;
+    bool m_flacCodec;
     qreal m_volume;
     bool m_muted;
-
-    // WAV header stuff
-
-    struct chunk
-    {
-        char        id[4];
-        quint32     size;
-    };
-
-    struct RIFFHeader
-    {
-        chunk       descriptor;
-        char        type[4];
-    };
-
-    struct WAVEHeader
-    {
-        chunk       descriptor;
-        quint16     audioFormat;        // PCM = 1
-        quint16     numChannels;
-        quint32     sampleRate;
-        quint32     byteRate;
-        quint16     blockAlign;
-        quint16     bitsPerSample;
-    };
-
-    struct DATAHeader
-    {
-        chunk       descriptor;
-//        quint8      data[];
-    };
-
-    struct CombinedHeader
-    {
-        RIFFHeader  riff;
-        WAVEHeader  wave;
-        DATAHeader  data;
-    };
-
-    CombinedHeader      header;
 };
 
 QT_END_NAMESPACE
@@ -40,6 +40,8 @@
 #include "audiocontainercontrol.h"
 #include "audiocapturesession.h"
 
+#include <QtMultimedia/private/qtmultimediaglobal_p.h>
+
 QT_BEGIN_NAMESPACE
 
 AudioContainerControl::AudioContainerControl(QObject *parent)
@@ -54,8 +56,13 @@ AudioContainerControl::~AudioContainerControl()
 
 QStringList AudioContainerControl::supportedContainers() const
 {
-    return QStringList() << QStringLiteral("audio/x-wav")
-                         << QStringLiteral("audio/x-raw");
+    QStringList containers;
+    containers << QStringLiteral("audio/x-wav")
+               << QStringLiteral("audio/x-raw");
+#if QT_CONFIG(flac)
+    containers << QStringLiteral("audio/x-flac");
+#endif
+    return containers;
 }
 
 QString AudioContainerControl::containerFormat() const
@@ -75,6 +82,8 @@ QString AudioContainerControl::containerDescription(const QString &formatMimeTyp
         return tr("RAW (headerless) file format");
     if (QString::compare(formatMimeType, QLatin1String("audio/x-wav")) == 0)
         return tr("WAV file format");
+    if (QString::compare(formatMimeType, QLatin1String("audio/x-flac")) == 0)
+        return tr("FLAC file format");
 
     return QString();
 }
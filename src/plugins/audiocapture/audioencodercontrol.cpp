@@ -43,6 +43,7 @@
 #include <qaudioformat.h>
 
 #include <QtCore/qdebug.h>
+#include <QtMultimedia/private/qtmultimediaglobal_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -89,13 +90,20 @@ AudioEncoderControl::~AudioEncoderControl()
 
 QStringList AudioEncoderControl::supportedAudioCodecs() const
 {
-    return QStringList() << QStringLiteral("audio/pcm");
+    QStringList codecs;
+    codecs << QStringLiteral("audio/pcm");
+#if QT_CONFIG(flac)
+    codecs << QStringLiteral("audio/x-flac");
+#endif
+    return codecs;
 }
 
 QString AudioEncoderControl::codecDescription(const QString &codecName) const
 {
     if (QString::compare(codecName, QLatin1String("audio/pcm")) == 0)
         return tr("Linear PCM audio data");
+    if (QString::compare(codecName, QLatin1String("audio/x-flac")) == 0)
+        return tr("FLAC lossless compressed audio");
 
     return QString();
 }
@@ -105,7 +113,7 @@ QList<int> AudioEncoderControl::supportedSampleRates(const QAudioEncoderSettings
     if (continuous)
         *continuous = false;
 
-    if (settings.codec().isEmpty() || settings.codec() == QLatin1String("audio/pcm"))
+    if (settings.codec().isEmpty() || supportedAudioCodecs().contains(settings.codec()))
         return m_sampleRates;
 
     return QList<int>();
@@ -121,7 +129,9 @@ void AudioEncoderControl::setAudioSettings(const QAudioEncoderSettings &settings
     QAudioFormat fmt = audioSettingsToAudioFormat(settings);
 
     if (settings.encodingMode() == QMultimedia::ConstantQualityEncoding) {
-        fmt.setCodec("audio/pcm");
+        // FLAC is lossless, the quality only selects the PCM it encodes
+        if (settings.codec() != QLatin1String("audio/x-flac"))
+            fmt.setCodec("audio/pcm");
         switch (settings.quality()) {
         case QMultimedia::VeryLowQuality:
             fmt.setSampleSize(8);
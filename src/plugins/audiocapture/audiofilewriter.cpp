@@ -0,0 +1,401 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "audiofilewriter.h"
+
+#include <QtCore/qdebug.h>
+#include <QtCore/qendian.h>
+
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+// Captured audio is handed to the writer thread in blocks of this size
+static const int BlockSize = 1024 * 1024;
+// Recycled blocks kept around so that the feeding thread rarely allocates
+static const int FreeBlocks = 4;
+// Audio queued beyond this is dropped instead of growing without bounds
+static const qint64 QueueLimit = 128 * 1024 * 1024;
+// Disk space is reserved ahead of the data in steps of this size
+static const qint64 PreallocationSize = 64 * 1024 * 1024;
+// The header is brought up to date and the data synced this often
+static const int CheckpointInterval = 2000;
+
+// RIFF, a JUNK chunk that turns into ds64 for RF64, fmt and data headers
+static const int WavHeaderSize = 80;
+// Float data needs the 18 byte fmt chunk with cbSize and a fact chunk
+static const int FloatWavHeaderSize = 94;
+// RIFF sizes are 32 bit, larger files are written as RF64
+static const quint64 RiffSizeLimit = 0xFFFFFFFFu;
+
+static int wavHeaderSize(const QAudioFormat &format)
+{
+    return format.sampleType() == QAudioFormat::Float ? FloatWavHeaderSize : WavHeaderSize;
+}
+
+/*
+    Writes the captured audio on a thread of its own, so a slow disk
+    doesn't stall capture. The feeding thread only appends to the current
+    block; full blocks are written in one go. Every checkpoint the WAV
+    header is rewritten with the sizes written so far and the data is
+    synced, so the file stays playable if the process dies. WAV files
+    switch to RF64 once they no longer fit 32 bit sizes. FLAC is encoded
+    on the writer thread as well.
+*/
+AudioFileWriter::AudioFileWriter(QObject *parent)
+    : QThread(parent)
+    , m_container(RawContainer)
+    , m_checkpointInterval(CheckpointInterval)
+    , m_sizeLimit(RiffSizeLimit)
+    , m_queuedBytes(0)
+    , m_droppedBytes(0)
+    , m_closing(false)
+    , m_failed(false)
+    , m_dataBytes(0)
+    , m_preallocated(0)
+    , m_preallocationSupported(true)
+{
+}
+
+AudioFileWriter::~AudioFileWriter()
+{
+    close();
+}
+
+bool AudioFileWriter::open(const QString &fileName, const QAudioFormat &format, Container container)
+{
+    Q_ASSERT(!isRunning());
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+
+    m_format = format;
+    m_container = container;
+    m_current = QByteArray();
+    m_current.reserve(BlockSize);
+    m_blocks.clear();
+    m_queuedBytes = 0;
+    m_droppedBytes = 0;
+    m_closing = false;
+    m_failed = false;
+    m_errorString.clear();
+    m_dataBytes = 0;
+    m_preallocated = 0;
+    m_preallocationSupported = true;
+
+    if (m_container == WavContainer && !writeHeader()) {
+        m_errorString = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    if (m_container == FlacContainer) {
+#if QT_CONFIG(flac)
+        const bool started = m_flacEncoder.start(&m_file, format);
+#else
+        const bool started = false;
+#endif
+        if (!started) {
+            m_errorString = tr("Can't encode this audio format to FLAC");
+            m_file.close();
+            return false;
+        }
+    }
+
+    start();
+    return true;
+}
+
+void AudioFileWriter::close()
+{
+    if (!isRunning())
+        return;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closing = true;
+        m_wake.wakeOne();
+    }
+    wait();
+}
+
+qint64 AudioFileWriter::write(const char *data, qint64 len)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // After a failure the error is reported by the session, the audio goes nowhere
+    if (m_failed || m_closing)
+        return len;
+
+    if (m_queuedBytes + m_current.size() + len > QueueLimit) {
+        if (m_droppedBytes == 0)
+            qWarning() << "AudioFileWriter: the disk can't keep up, dropping audio";
+        m_droppedBytes += len;
+        return len;
+    }
+
+    m_current.append(data, int(len));
+    if (m_current.size() >= BlockSize) {
+        m_queuedBytes += m_current.size();
+        m_blocks.enqueue(m_current);
+        m_current = m_free.isEmpty() ? QByteArray() : m_free.takeLast();
+        m_current.reserve(BlockSize);
+        m_wake.wakeOne();
+    }
+
+    return len;
+}
+
+QString AudioFileWriter::errorString() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_errorString;
+}
+
+void AudioFileWriter::setCheckpointInterval(int msecs)
+{
+    Q_ASSERT(!isRunning());
+    m_checkpointInterval = msecs;
+}
+
+void AudioFileWriter::setSizeLimit(quint64 bytes)
+{
+    Q_ASSERT(!isRunning());
+    m_sizeLimit = bytes;
+}
+
+void AudioFileWriter::run()
+{
+    m_checkpointTimer.start();
+
+    bool failed = false;
+    forever {
+        QQueue<QByteArray> blocks;
+        bool closing;
+        {
+            QMutexLocker locker(&m_mutex);
+            const qint64 remaining = m_checkpointInterval - m_checkpointTimer.elapsed();
+            if (m_blocks.isEmpty() && !m_closing && remaining > 0)
+                m_wake.wait(&m_mutex, remaining);
+
+            closing = m_closing;
+            // Checkpoints write the partial block as well, so the file on
+            // disk is never more than one interval behind
+            if (!m_current.isEmpty()
+                    && (closing || m_checkpointTimer.elapsed() >= m_checkpointInterval)) {
+                m_queuedBytes += m_current.size();
+                m_blocks.enqueue(m_current);
+                m_current = m_free.isEmpty() ? QByteArray() : m_free.takeLast();
+                m_current.reserve(BlockSize);
+            }
+            blocks.swap(m_blocks);
+        }
+
+        while (!blocks.isEmpty()) {
+            QByteArray block = blocks.dequeue();
+            if (!writeBlock(block)) {
+                failed = true;
+                break;
+            }
+
+            QMutexLocker locker(&m_mutex);
+            m_queuedBytes -= block.size();
+            if (m_free.size() < FreeBlocks) {
+                // Keeps the reserved capacity
+                block.resize(0);
+                m_free.append(block);
+            }
+        }
+
+        if (failed || closing)
+            break;
+
+        if (m_checkpointTimer.elapsed() >= m_checkpointInterval) {
+            checkpoint();
+            m_checkpointTimer.restart();
+        }
+    }
+
+    if (failed) {
+        fail(m_file.error() != QFile::NoError ? m_file.errorString() : tr("Encoding failed"));
+    } else if (m_container == FlacContainer) {
+#if QT_CONFIG(flac)
+        if (!m_flacEncoder.finish())
+            fail(tr("Encoding failed"));
+#endif
+    } else if (m_container == WavContainer) {
+        // RIFF chunks are padded to an even size
+        if (m_dataBytes % 2)
+            m_file.write("", 1);
+        if (!writeHeader())
+            fail(m_file.errorString());
+    }
+
+    // Truncating releases the space preallocated past the end
+    m_file.resize(m_file.pos());
+    m_file.close();
+
+    if (m_droppedBytes > 0)
+        qWarning() << "AudioFileWriter: dropped" << m_droppedBytes << "bytes of audio";
+}
+
+bool AudioFileWriter::writeBlock(const QByteArray &block)
+{
+    // Compressed data is smaller, the excess is released on close
+    preallocate(m_file.pos() + block.size());
+
+    if (m_container == FlacContainer) {
+#if QT_CONFIG(flac)
+        if (!m_flacEncoder.encode(block.constData(), block.size()))
+            return false;
+#endif
+    } else if (m_file.write(block) != block.size()) {
+        return false;
+    }
+
+    m_dataBytes += block.size();
+    return true;
+}
+
+bool AudioFileWriter::writeHeader()
+{
+    const bool isFloat = m_format.sampleType() == QAudioFormat::Float;
+    const int headerSize = wavHeaderSize(m_format);
+    const qint64 end = m_file.pos();
+    const quint64 riffSize = qMax<qint64>(end, headerSize) - 8;
+    const bool rf64 = riffSize > m_sizeLimit || quint64(m_dataBytes) > m_sizeLimit;
+    const int bytesPerFrame = m_format.bytesPerFrame();
+    const quint64 frames = bytesPerFrame > 0 ? m_dataBytes / bytesPerFrame : 0;
+
+    char header[FloatWavHeaderSize];
+    memset(header, 0, headerSize);
+
+    memcpy(header, rf64 ? "RF64" : "RIFF", 4);
+    qToLittleEndian<quint32>(rf64 ? 0xFFFFFFFFu : quint32(riffSize), header + 4);
+    memcpy(header + 8, "WAVE", 4);
+
+    // The JUNK chunk keeps room for the ds64 chunk RF64 needs, so
+    // switching doesn't move the data
+    memcpy(header + 12, rf64 ? "ds64" : "JUNK", 4);
+    qToLittleEndian<quint32>(28, header + 16);
+    if (rf64) {
+        qToLittleEndian<quint64>(riffSize, header + 20);
+        qToLittleEndian<quint64>(m_dataBytes, header + 28);
+        qToLittleEndian<quint64>(frames, header + 36);
+    }
+
+    memcpy(header + 48, "fmt ", 4);
+    qToLittleEndian<quint32>(isFloat ? 18 : 16, header + 52);
+    // PCM = 1, IEEE float = 3
+    qToLittleEndian<quint16>(isFloat ? 3 : 1, header + 56);
+    qToLittleEndian<quint16>(m_format.channelCount(), header + 58);
+    qToLittleEndian<quint32>(m_format.sampleRate(), header + 60);
+    qToLittleEndian<quint32>(m_format.sampleRate() * bytesPerFrame, header + 64);
+    qToLittleEndian<quint16>(bytesPerFrame, header + 68);
+    qToLittleEndian<quint16>(m_format.sampleSize(), header + 70);
+
+    if (isFloat) {
+        // cbSize at 72 stays 0. Formats other than PCM need a fact chunk,
+        // with RF64 the frame count is in ds64.
+        memcpy(header + 74, "fact", 4);
+        qToLittleEndian<quint32>(4, header + 78);
+        qToLittleEndian<quint32>(rf64 ? 0xFFFFFFFFu : quint32(frames), header + 82);
+    }
+
+    memcpy(header + headerSize - 8, "data", 4);
+    qToLittleEndian<quint32>(rf64 ? 0xFFFFFFFFu : quint32(m_dataBytes), header + headerSize - 4);
+
+    if (end != 0 && !m_file.seek(0))
+        return false;
+    if (m_file.write(header, headerSize) != headerSize)
+        return false;
+    return end == 0 || m_file.seek(end);
+}
+
+void AudioFileWriter::preallocate(qint64 end)
+{
+#if defined(Q_OS_LINUX)
+    if (!m_preallocationSupported || end <= m_preallocated)
+        return;
+
+    // Reserving space ahead keeps long recordings from fragmenting. The
+    // file size stays put, so a crash leaves no unwritten space behind the
+    // data. Filesystems without support, or a full disk, end the attempts.
+    const qint64 length = qMax(PreallocationSize, end - m_preallocated);
+    if (::fallocate(m_file.handle(), FALLOC_FL_KEEP_SIZE, m_preallocated, length) == 0)
+        m_preallocated += length;
+    else
+        m_preallocationSupported = false;
+#else
+    Q_UNUSED(end);
+#endif
+}
+
+void AudioFileWriter::checkpoint()
+{
+    if (m_container == WavContainer && !writeHeader())
+        return;
+
+#if defined(Q_OS_LINUX)
+    ::fdatasync(m_file.handle());
+#endif
+}
+
+void AudioFileWriter::fail(const QString &errorString)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_failed = true;
+        m_errorString = errorString;
+        m_blocks.clear();
+        m_current.clear();
+        m_queuedBytes = 0;
+    }
+    emit error(errorString);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,132 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef AUDIOFILEWRITER_H
+#define AUDIOFILEWRITER_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qqueue.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qvector.h>
+#include <QtCore/qwaitcondition.h>
+
+#include <qaudioformat.h>
+
+#include <QtMultimedia/private/qtmultimediaglobal_p.h>
+
+#if QT_CONFIG(flac)
+#include "audioflacencoder.h"
+#endif
+
+QT_BEGIN_NAMESPACE
+
+class AudioFileWriter : public QThread
+{
+    Q_OBJECT
+public:
+    enum Container
+    {
+        RawContainer,
+        WavContainer,
+        FlacContainer
+    };
+
+    AudioFileWriter(QObject *parent = 0);
+    ~AudioFileWriter();
+
+    bool open(const QString &fileName, const QAudioFormat &format, Container container);
+    void close();
+
+    // Called on the thread feeding the recorder, never waits for the disk
+    qint64 write(const char *data, qint64 len);
+
+    QString errorString() const;
+
+    // Let tests reach checkpoints and RF64 without waiting or writing 4 GiB.
+    // Set before open().
+    void setCheckpointInterval(int msecs);
+    void setSizeLimit(quint64 bytes);
+
+signals:
+    void error(const QString &errorString);
+
+protected:
+    void run() override;
+
+private:
+    bool writeBlock(const QByteArray &block);
+    bool writeHeader();
+    void preallocate(qint64 end);
+    void checkpoint();
+    void fail(const QString &errorString);
+
+    QFile m_file;
+    QAudioFormat m_format;
+    Container m_container;
+    int m_checkpointInterval;
+    quint64 m_sizeLimit;
+
+    // Shared with the feeding thread, guarded by m_mutex
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    QByteArray m_current;
+    QQueue<QByteArray> m_blocks;
+    QVector<QByteArray> m_free;
+    qint64 m_queuedBytes;
+    qint64 m_droppedBytes;
+    bool m_closing;
+    bool m_failed;
+    QString m_errorString;
+
+    // Only used on the writer thread
+    qint64 m_dataBytes;
+    qint64 m_preallocated;
+    bool m_preallocationSupported;
+    QElapsedTimer m_checkpointTimer;
+#if QT_CONFIG(flac)
+    AudioFlacEncoder m_flacEncoder;
+#endif
+};
+
+QT_END_NAMESPACE
+
+#endif // AUDIOFILEWRITER_H
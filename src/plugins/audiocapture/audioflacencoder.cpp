@@ -0,0 +1,220 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "audioflacencoder.h"
+
+#include <QtCore/qendian.h>
+#include <QtCore/qfile.h>
+
+QT_BEGIN_NAMESPACE
+
+// Samples are converted for the encoder in chunks of this many frames
+static const int ChunkFrames = 4096;
+
+/*
+    Encodes interleaved integer PCM to a native FLAC stream with libFLAC.
+    Runs on the recorder's writer thread, so the capture side never waits
+    for the encoder. Until finish() the stream header carries no length,
+    which decoders accept, so an interrupted recording stays playable.
+*/
+AudioFlacEncoder::AudioFlacEncoder()
+    : m_encoder(0)
+    , m_file(0)
+{
+}
+
+AudioFlacEncoder::~AudioFlacEncoder()
+{
+    if (m_encoder)
+        FLAC__stream_encoder_delete(m_encoder);
+}
+
+bool AudioFlacEncoder::isFormatSupported(const QAudioFormat &format)
+{
+    if (format.channelCount() < 1 || format.channelCount() > 8
+            || format.sampleRate() <= 0 || format.sampleRate() > 655350) {
+        return false;
+    }
+
+    switch (format.sampleSize()) {
+    case 8:
+    case 16:
+        return format.sampleType() == QAudioFormat::SignedInt
+                || format.sampleType() == QAudioFormat::UnSignedInt;
+    case 24:
+        return format.sampleType() == QAudioFormat::SignedInt;
+    default:
+        return false;
+    }
+}
+
+bool AudioFlacEncoder::start(QFile *file, const QAudioFormat &format)
+{
+    if (!isFormatSupported(format))
+        return false;
+
+    if (m_encoder)
+        FLAC__stream_encoder_delete(m_encoder);
+    m_encoder = FLAC__stream_encoder_new();
+    if (!m_encoder)
+        return false;
+
+    m_file = file;
+    m_format = format;
+    m_partialFrame.clear();
+    m_samples.resize(ChunkFrames * format.channelCount());
+
+    FLAC__stream_encoder_set_channels(m_encoder, format.channelCount());
+    FLAC__stream_encoder_set_bits_per_sample(m_encoder, format.sampleSize());
+    FLAC__stream_encoder_set_sample_rate(m_encoder, format.sampleRate());
+    FLAC__stream_encoder_set_compression_level(m_encoder, 5);
+
+    return FLAC__stream_encoder_init_stream(m_encoder, writeCallback, seekCallback, tellCallback,
+                                            0, this) == FLAC__STREAM_ENCODER_INIT_STATUS_OK;
+}
+
+bool AudioFlacEncoder::encode(const char *data, int len)
+{
+    Q_ASSERT(m_encoder);
+    const int bytesPerFrame = m_format.bytesPerFrame();
+
+    // Writes don't have to end on a frame boundary
+    if (!m_partialFrame.isEmpty()) {
+        const int missing = qMin(bytesPerFrame - m_partialFrame.size(), len);
+        m_partialFrame.append(data, missing);
+        data += missing;
+        len -= missing;
+        if (m_partialFrame.size() < bytesPerFrame)
+            return true;
+        if (!encodeFrames(m_partialFrame.constData(), 1))
+            return false;
+        m_partialFrame.clear();
+    }
+
+    const int frames = len / bytesPerFrame;
+    if (!encodeFrames(data, frames))
+        return false;
+    m_partialFrame = QByteArray(data + frames * bytesPerFrame, len - frames * bytesPerFrame);
+    return true;
+}
+
+bool AudioFlacEncoder::finish()
+{
+    Q_ASSERT(m_encoder);
+    // Also seeks back to complete the STREAMINFO block
+    const bool ok = FLAC__stream_encoder_finish(m_encoder);
+    m_file->seek(m_file->size());
+    return ok;
+}
+
+bool AudioFlacEncoder::encodeFrames(const char *data, int frames)
+{
+    const int channels = m_format.channelCount();
+    const int sampleBytes = m_format.sampleSize() / 8;
+    const bool littleEndian = m_format.byteOrder() == QAudioFormat::LittleEndian;
+    const bool isUnsigned = m_format.sampleType() == QAudioFormat::UnSignedInt;
+    const uchar *src = reinterpret_cast<const uchar *>(data);
+
+    while (frames > 0) {
+        const int chunk = qMin(frames, ChunkFrames);
+        const int samples = chunk * channels;
+        FLAC__int32 *out = m_samples.data();
+
+        switch (sampleBytes) {
+        case 1:
+            for (int i = 0; i < samples; ++i)
+                out[i] = isUnsigned ? FLAC__int32(src[i]) - 128 : FLAC__int32(qint8(src[i]));
+            break;
+        case 2:
+            for (int i = 0; i < samples; ++i) {
+                const quint16 value = littleEndian ? qFromLittleEndian<quint16>(src + 2 * i)
+                                                   : qFromBigEndian<quint16>(src + 2 * i);
+                out[i] = isUnsigned ? FLAC__int32(value) - 32768 : FLAC__int32(qint16(value));
+            }
+            break;
+        case 3:
+            for (int i = 0; i < samples; ++i) {
+                const uchar *s = src + 3 * i;
+                const quint32 value = littleEndian ? (s[0] | (s[1] << 8) | (s[2] << 16))
+                                                   : (s[2] | (s[1] << 8) | (s[0] << 16));
+                // Sign extend from 24 bits
+                out[i] = FLAC__int32(value << 8) >> 8;
+            }
+            break;
+        }
+
+        if (!FLAC__stream_encoder_process_interleaved(m_encoder, out, chunk))
+            return false;
+
+        src += samples * sampleBytes;
+        frames -= chunk;
+    }
+
+    return true;
+}
+
+FLAC__StreamEncoderWriteStatus AudioFlacEncoder::writeCallback(const FLAC__StreamEncoder *,
+                                                               const FLAC__byte buffer[], size_t bytes,
+                                                               unsigned, unsigned, void *clientData)
+{
+    AudioFlacEncoder *self = static_cast<AudioFlacEncoder *>(clientData);
+    if (self->m_file->write(reinterpret_cast<const char *>(buffer), qint64(bytes)) != qint64(bytes))
+        return FLAC__STREAM_ENCODER_WRITE_STATUS_FATAL_ERROR;
+    return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+}
+
+FLAC__StreamEncoderSeekStatus AudioFlacEncoder::seekCallback(const FLAC__StreamEncoder *,
+                                                             FLAC__uint64 absoluteByteOffset,
+                                                             void *clientData)
+{
+    AudioFlacEncoder *self = static_cast<AudioFlacEncoder *>(clientData);
+    return self->m_file->seek(qint64(absoluteByteOffset)) ? FLAC__STREAM_ENCODER_SEEK_STATUS_OK
+                                                          : FLAC__STREAM_ENCODER_SEEK_STATUS_ERROR;
+}
+
+FLAC__StreamEncoderTellStatus AudioFlacEncoder::tellCallback(const FLAC__StreamEncoder *,
+                                                             FLAC__uint64 *absoluteByteOffset,
+                                                             void *clientData)
+{
+    AudioFlacEncoder *self = static_cast<AudioFlacEncoder *>(clientData);
+    *absoluteByteOffset = FLAC__uint64(self->m_file->pos());
+    return FLAC__STREAM_ENCODER_TELL_STATUS_OK;
+}
+
+QT_END_NAMESPACE
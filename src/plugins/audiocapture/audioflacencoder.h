@@ -0,0 +1,91 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef AUDIOFLACENCODER_H
+#define AUDIOFLACENCODER_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qvector.h>
+
+#include <qaudioformat.h>
+
+#include <FLAC/stream_encoder.h>
+
+QT_BEGIN_NAMESPACE
+
+class QFile;
+
+class AudioFlacEncoder
+{
+public:
+    AudioFlacEncoder();
+    ~AudioFlacEncoder();
+
+    static bool isFormatSupported(const QAudioFormat &format);
+
+    // Writes the stream header to the current position of file
+    bool start(QFile *file, const QAudioFormat &format);
+    bool encode(const char *data, int len);
+    // Encodes what is left and fills in the length and checksum in the header
+    bool finish();
+
+private:
+    static FLAC__StreamEncoderWriteStatus writeCallback(const FLAC__StreamEncoder *encoder,
+                                                        const FLAC__byte buffer[], size_t bytes,
+                                                        unsigned samples, unsigned currentFrame,
+                                                        void *clientData);
+    static FLAC__StreamEncoderSeekStatus seekCallback(const FLAC__StreamEncoder *encoder,
+                                                      FLAC__uint64 absoluteByteOffset,
+                                                      void *clientData);
+    static FLAC__StreamEncoderTellStatus tellCallback(const FLAC__StreamEncoder *encoder,
+                                                      FLAC__uint64 *absoluteByteOffset,
+                                                      void *clientData);
+
+    bool encodeFrames(const char *data, int frames);
+
+    FLAC__StreamEncoder *m_encoder;
+    QFile *m_file;
+    QAudioFormat m_format;
+    QVector<FLAC__int32> m_samples;
+    QByteArray m_partialFrame;
+};
+
+QT_END_NAMESPACE
+
+#endif // AUDIOFLACENCODER_H
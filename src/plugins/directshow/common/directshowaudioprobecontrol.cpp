@@ -39,13 +39,16 @@
 
 #include "directshowaudioprobecontrol.h"
 #include "directshowglobal.h"
+#include <private/qmediaaudioprobecontrol_p.h>
+
+#include <QtCore/qmetaobject.h>
 
 QT_BEGIN_NAMESPACE
 
 DirectShowAudioProbeControl::DirectShowAudioProbeControl(QObject *p)
     : QMediaAudioProbeControl(p)
 {
-
+    QMediaAudioProbeControlPrivate::get(this)->setListenersSupported(true);
 }
 
 DirectShowAudioProbeControl::~DirectShowAudioProbeControl()
@@ -54,4 +57,19 @@ DirectShowAudioProbeControl::~DirectShowAudioProbeControl()
         qCWarning(qtDirectShowPlugin, "QAudioProbe control destroyed while it's still being referenced!!!");
 }
 
+bool DirectShowAudioProbeControl::wantsBuffers()
+{
+    static const QMetaMethod probedSignal = QMetaMethod::fromSignal(&QMediaAudioProbeControl::audioBufferProbed);
+    return isSignalConnected(probedSignal) || QMediaAudioProbeControlPrivate::get(this)->hasListeners();
+}
+
+void DirectShowAudioProbeControl::bufferProbed(const QAudioBuffer &buffer)
+{
+    QMediaAudioProbeControlPrivate::get(this)->probeBuffer(buffer);
+
+    static const QMetaMethod probedSignal = QMetaMethod::fromSignal(&QMediaAudioProbeControl::audioBufferProbed);
+    if (isSignalConnected(probedSignal))
+        Q_EMIT audioBufferProbed(buffer);
+}
+
 QT_END_NAMESPACE
@@ -55,6 +55,9 @@ public:
 
     bool ref() { return m_ref.ref(); }
     bool deref() { return m_ref.deref(); }
+
+    bool wantsBuffers();
+    void bufferProbed(const QAudioBuffer &buffer);
 private:
     QAtomicInt m_ref;
 };
@@ -1455,7 +1455,7 @@ QT_WARNING_DISABLE_GCC("-Wmissing-field-initializers")
 void DirectShowPlayerService::onAudioBufferAvailable(double time, const QByteArray &data)
 {
     QMutexLocker locker(&m_mutex);
-    if (!m_audioProbeControl || !m_audioSampleGrabber)
+    if (!m_audioProbeControl || !m_audioSampleGrabber || !m_audioProbeControl->wantsBuffers())
         return;
 
     DirectShowMediaType mt(AM_MEDIA_TYPE { GUID_NULL });
@@ -1500,7 +1500,7 @@ void DirectShowPlayerService::onAudioBufferAvailable(double time, const QByteArr
                              format,
                              startTime);
 
-    Q_EMIT m_audioProbeControl->audioBufferProbed(audioBuffer);
+    m_audioProbeControl->bufferProbed(audioBuffer);
 }
 
 void DirectShowPlayerService::onVideoBufferAvailable(double time, const QByteArray &data)
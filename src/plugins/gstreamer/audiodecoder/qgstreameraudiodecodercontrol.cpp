@@ -137,4 +137,24 @@ qint64 QGstreamerAudioDecoderControl::duration() const
     return m_session->duration();
 }
 
+qint64 QGstreamerAudioDecoderControl::startPosition() const
+{
+    return m_session->startPosition();
+}
+
+void QGstreamerAudioDecoderControl::setStartPosition(qint64 position)
+{
+    m_session->setStartPosition(position);
+}
+
+qint64 QGstreamerAudioDecoderControl::endPosition() const
+{
+    return m_session->endPosition();
+}
+
+void QGstreamerAudioDecoderControl::setEndPosition(qint64 position)
+{
+    m_session->setEndPosition(position);
+}
+
 QT_END_NAMESPACE
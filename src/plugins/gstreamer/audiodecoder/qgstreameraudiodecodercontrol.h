@@ -84,6 +84,12 @@ public:
     qint64 position() const override;
     qint64 duration() const override;
 
+    qint64 startPosition() const override;
+    void setStartPosition(qint64 position) override;
+
+    qint64 endPosition() const override;
+    void setEndPosition(qint64 position) override;
+
 private:
     // Stuff goes here
 
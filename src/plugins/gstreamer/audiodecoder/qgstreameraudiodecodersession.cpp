@@ -42,6 +42,7 @@
 #include <private/qgstreamerbushelper_p.h>
 
 #include <private/qgstutils_p.h>
+#include <private/qgstaudiobuffer_p.h>
 
 #include <gst/gstvalue.h>
 #include <gst/base/gstbasesrc.h>
@@ -88,7 +89,10 @@ QGstreamerAudioDecoderSession::QGstreamerAudioDecoderSession(QObject *parent)
      m_buffersAvailable(0),
      m_position(-1),
      m_duration(-1),
-     m_durationQueries(0)
+     m_durationQueries(0),
+     m_startPosition(0),
+     m_endPosition(-1),
+     m_rangeSeekPending(false)
 {
     // Create pipeline here
     m_playbin = gst_element_factory_make(QT_GSTREAMER_PLAYBIN_ELEMENT_NAME, NULL);
@@ -205,6 +209,12 @@ bool QGstreamerAudioDecoderSession::processBusMessage(const QGstreamerMessage &m
                         //the duration is queried up to 5 times with increasing delay
                         m_durationQueries = 5;
                         updateDuration();
+
+                        // The pipeline has prerolled, the decoding range can be applied now
+                        if (m_rangeSeekPending) {
+                            m_rangeSeekPending = false;
+                            seekToRange();
+                        }
                         break;
                     }
 
@@ -378,8 +388,14 @@ void QGstreamerAudioDecoderSession::start()
     }
 
     m_pendingState = QAudioDecoder::DecodingState;
-    if (gst_element_set_state(m_playbin, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+
+    // Seeking needs a prerolled pipeline, so when decoding a time range pause
+    // first and switch to playing once the seek has been issued.
+    m_rangeSeekPending = m_startPosition > 0 || m_endPosition >= 0;
+    const GstState targetState = m_rangeSeekPending ? GST_STATE_PAUSED : GST_STATE_PLAYING;
+    if (gst_element_set_state(m_playbin, targetState) == GST_STATE_CHANGE_FAILURE) {
         qWarning() << "GStreamer; Unable to start decoding process";
+        m_rangeSeekPending = false;
         m_pendingState = m_state = QAudioDecoder::StoppedState;
 
         emit stateChanged(m_state);
@@ -391,6 +407,7 @@ void QGstreamerAudioDecoderSession::stop()
     if (m_playbin) {
         gst_element_set_state(m_playbin, GST_STATE_NULL);
         removeAppSink();
+        m_rangeSeekPending = false;
 
         QAudioDecoder::State oldState = m_state;
         m_pendingState = m_state = QAudioDecoder::StoppedState;
@@ -448,37 +465,32 @@ QAudioBuffer QGstreamerAudioDecoderSession::read()
         if (buffersAvailable == 1)
             emit bufferAvailableChanged(false);
 
-        const char* bufferData = 0;
-        int bufferSize = 0;
-
 #if GST_CHECK_VERSION(1,0,0)
         GstSample *sample = gst_app_sink_pull_sample(m_appSink);
         GstBuffer *buffer = gst_sample_get_buffer(sample);
-        GstMapInfo mapInfo;
-        gst_buffer_map(buffer, &mapInfo, GST_MAP_READ);
-        bufferData = (const char*)mapInfo.data;
-        bufferSize = mapInfo.size;
         QAudioFormat format = QGstUtils::audioFormatForSample(sample);
 #else
         GstBuffer *buffer = gst_app_sink_pull_buffer(m_appSink);
-        bufferData = (const char*)buffer->data;
-        bufferSize = buffer->size;
         QAudioFormat format = QGstUtils::audioFormatForBuffer(buffer);
 #endif
 
         if (format.isValid()) {
-            // XXX At the moment we have to copy data from GstBuffer into QAudioBuffer.
-            // We could improve performance by implementing QAbstractAudioBuffer for GstBuffer.
+            // The QAudioBuffer keeps its own reference to the GstBuffer and
+            // reads the decoded samples straight from its memory.
             qint64 position = getPositionFromBuffer(buffer);
-            audioBuffer = QAudioBuffer(QByteArray((const char*)bufferData, bufferSize), format, position);
-            position /= 1000; // convert to milliseconds
-            if (position != m_position) {
-                m_position = position;
-                emit positionChanged(m_position);
+            audioBuffer = QGstAudioBuffer::create(buffer, format, position);
+            if (position >= 0 && (m_startPosition > 0 || m_endPosition >= 0))
+                audioBuffer = trimToRange(audioBuffer);
+
+            if (audioBuffer.isValid()) {
+                position = audioBuffer.startTime() / 1000; // convert to milliseconds
+                if (position != m_position) {
+                    m_position = position;
+                    emit positionChanged(m_position);
+                }
             }
         }
 #if GST_CHECK_VERSION(1,0,0)
-        gst_buffer_unmap(buffer, &mapInfo);
         gst_sample_unref(sample);
 #else
         gst_buffer_unref(buffer);
@@ -488,6 +500,39 @@ QAudioBuffer QGstreamerAudioDecoderSession::read()
     return audioBuffer;
 }
 
+QAudioBuffer QGstreamerAudioDecoderSession::trimToRange(const QAudioBuffer &buffer) const
+{
+    const QAudioFormat format = buffer.format();
+    const qint64 sampleRate = format.sampleRate();
+    const qint64 startTime = buffer.startTime();
+    const int frameCount = buffer.frameCount();
+
+    // Offsets of the range boundaries in frames from the start of the buffer,
+    // rounded to the nearest frame
+    int first = 0;
+    int last = frameCount;
+    if (m_startPosition * 1000 > startTime) {
+        const qint64 frames = ((m_startPosition * 1000 - startTime) * sampleRate + 500000) / 1000000;
+        first = int(qMin(frames, qint64(frameCount)));
+    }
+    if (m_endPosition >= 0) {
+        const qint64 frames = ((m_endPosition * 1000 - startTime) * sampleRate + 500000) / 1000000;
+        last = int(qBound(qint64(0), frames, qint64(frameCount)));
+    }
+
+    // Entirely outside of the range, e.g. decoded ahead of an inaccurate seek
+    if (first >= last)
+        return QAudioBuffer();
+
+    if (first == 0 && last == frameCount)
+        return buffer;
+
+    const int bytesPerFrame = format.bytesPerFrame();
+    const QByteArray data(static_cast<const char *>(buffer.constData()) + first * bytesPerFrame,
+                          (last - first) * bytesPerFrame);
+    return QAudioBuffer(data, format, startTime + format.durationForFrames(first));
+}
+
 bool QGstreamerAudioDecoderSession::bufferAvailable() const
 {
     QMutexLocker locker(&m_buffersMutex);
@@ -504,6 +549,44 @@ qint64 QGstreamerAudioDecoderSession::duration() const
      return m_duration;
 }
 
+qint64 QGstreamerAudioDecoderSession::startPosition() const
+{
+    return m_startPosition;
+}
+
+void QGstreamerAudioDecoderSession::setStartPosition(qint64 position)
+{
+    m_startPosition = position;
+}
+
+qint64 QGstreamerAudioDecoderSession::endPosition() const
+{
+    return m_endPosition;
+}
+
+void QGstreamerAudioDecoderSession::setEndPosition(qint64 position)
+{
+    m_endPosition = position;
+}
+
+void QGstreamerAudioDecoderSession::seekToRange()
+{
+    // An accurate seek lets the decoders start at the requested sample instead
+    // of the preceding key frame; the stop position makes the pipeline emit EOS
+    // at the end of the range.
+    const GstSeekType stopType = m_endPosition >= 0 ? GST_SEEK_TYPE_SET : GST_SEEK_TYPE_NONE;
+    const gint64 stop = m_endPosition >= 0 ? m_endPosition * GST_MSECOND : gint64(-1);
+    if (!gst_element_seek(m_playbin, 1.0, GST_FORMAT_TIME,
+                          GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE),
+                          GST_SEEK_TYPE_SET, m_startPosition * GST_MSECOND,
+                          stopType, stop)) {
+        qWarning() << "GStreamer; Unable to seek to the decoding range";
+    }
+
+    if (gst_element_set_state(m_playbin, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+        processInvalidMedia(QAudioDecoder::ResourceError, QStringLiteral("Unable to start decoding process"));
+}
+
 void QGstreamerAudioDecoderSession::processInvalidMedia(QAudioDecoder::Error errorCode, const QString& errorString)
 {
     stop();
@@ -99,6 +99,12 @@ public:
     qint64 position() const;
     qint64 duration() const;
 
+    qint64 startPosition() const;
+    void setStartPosition(qint64 position);
+
+    qint64 endPosition() const;
+    void setEndPosition(qint64 position);
+
     static GstFlowReturn new_sample(GstAppSink *sink, gpointer user_data);
 
 signals:
@@ -125,6 +131,8 @@ private:
 
     void processInvalidMedia(QAudioDecoder::Error errorCode, const QString& errorString);
     static qint64 getPositionFromBuffer(GstBuffer* buffer);
+    void seekToRange();
+    QAudioBuffer trimToRange(const QAudioBuffer &buffer) const;
 
     QAudioDecoder::State m_state;
     QAudioDecoder::State m_pendingState;
@@ -150,6 +158,10 @@ private:
     qint64 m_duration;
 
     int m_durationQueries;
+
+    qint64 m_startPosition;
+    qint64 m_endPosition;
+    bool m_rangeSeekPending;
 };
 
 QT_END_NAMESPACE
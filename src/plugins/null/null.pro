@@ -0,0 +1,23 @@
+TARGET = qtaudio_null
+QT += multimedia-private
+
+HEADERS += \
+    qnullaudioplugin.h \
+    qnullaudiohelpers.h \
+    qnullaudiodeviceinfo.h \
+    qnullaudioinput.h \
+    qnullaudiooutput.h
+
+SOURCES += \
+    qnullaudioplugin.cpp \
+    qnullaudiohelpers.cpp \
+    qnullaudiodeviceinfo.cpp \
+    qnullaudioinput.cpp \
+    qnullaudiooutput.cpp
+
+OTHER_FILES += \
+    null.json
+
+PLUGIN_TYPE = audio
+PLUGIN_CLASS_NAME = QNullAudioPlugin
+load(qt_plugin)
@@ -0,0 +1,133 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qnullaudiodeviceinfo.h"
+#include "qnullaudiohelpers.h"
+
+QT_BEGIN_NAMESPACE
+
+QNullAudioDeviceInfo::QNullAudioDeviceInfo(const QByteArray &device, QAudio::Mode mode)
+    : m_device(device)
+    , m_mode(mode)
+{
+}
+
+QList<QByteArray> QNullAudioDeviceInfo::availableDevices(QAudio::Mode mode)
+{
+    QList<QByteArray> devices;
+    if (!QNullAudioInternal::devicesEnabled())
+        return devices;
+    devices << QByteArrayLiteral("virtual");
+    if (mode == QAudio::AudioOutput)
+        devices << QByteArrayLiteral("offline");
+    return devices;
+}
+
+QAudioFormat QNullAudioDeviceInfo::preferredFormat() const
+{
+    QAudioFormat format;
+    format.setSampleRate(44100);
+    format.setChannelCount(m_mode == QAudio::AudioOutput ? 2 : 1);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec(QStringLiteral("audio/pcm"));
+    return format;
+}
+
+bool QNullAudioDeviceInfo::isFormatSupported(const QAudioFormat &format) const
+{
+    if (format.codec() != QLatin1String("audio/pcm"))
+        return false;
+    if (format.sampleRate() < 8000 || format.sampleRate() > 192000)
+        return false;
+    if (format.channelCount() < 1 || format.channelCount() > 8)
+        return false;
+
+    switch (format.sampleSize()) {
+    case 8:
+    case 16:
+        return format.sampleType() == QAudioFormat::SignedInt
+                || format.sampleType() == QAudioFormat::UnSignedInt;
+    case 32:
+        return format.sampleType() != QAudioFormat::Unknown;
+    default:
+        return false;
+    }
+}
+
+QString QNullAudioDeviceInfo::deviceName() const
+{
+    return QString::fromLatin1(m_device);
+}
+
+QStringList QNullAudioDeviceInfo::supportedCodecs()
+{
+    return QStringList() << QStringLiteral("audio/pcm");
+}
+
+QList<int> QNullAudioDeviceInfo::supportedSampleRates()
+{
+    return QList<int>() << 8000 << 11025 << 16000 << 22050 << 32000
+                        << 44100 << 48000 << 88200 << 96000 << 192000;
+}
+
+QList<int> QNullAudioDeviceInfo::supportedChannelCounts()
+{
+    return QList<int>() << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8;
+}
+
+QList<int> QNullAudioDeviceInfo::supportedSampleSizes()
+{
+    return QList<int>() << 8 << 16 << 32;
+}
+
+QList<QAudioFormat::Endian> QNullAudioDeviceInfo::supportedByteOrders()
+{
+    return QList<QAudioFormat::Endian>() << QAudioFormat::LittleEndian << QAudioFormat::BigEndian;
+}
+
+QList<QAudioFormat::SampleType> QNullAudioDeviceInfo::supportedSampleTypes()
+{
+    return QList<QAudioFormat::SampleType>() << QAudioFormat::SignedInt
+                                             << QAudioFormat::UnSignedInt
+                                             << QAudioFormat::Float;
+}
+
+QT_END_NAMESPACE
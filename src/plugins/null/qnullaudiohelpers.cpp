@@ -0,0 +1,380 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qnullaudiohelpers.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qmath.h>
+#include <QtCore/qrandom.h>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QNullAudioInternal
+{
+static int environmentValue(const char *name, int defaultValue)
+{
+    bool ok = false;
+    const int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value >= 0 ? value : defaultValue;
+}
+
+DeviceSettings DeviceSettings::fromEnvironment()
+{
+    DeviceSettings settings;
+    settings.periodMs = qMax(1, environmentValue("QT_NULL_AUDIO_PERIOD_MS", 10));
+    // A device buffer needs room for at least two periods
+    settings.latencyMs = qMax(2 * settings.periodMs,
+                              environmentValue("QT_NULL_AUDIO_LATENCY_MS", 4 * settings.periodMs));
+    settings.jitterMs = environmentValue("QT_NULL_AUDIO_JITTER_MS", 0);
+    settings.xrunIntervalMs = environmentValue("QT_NULL_AUDIO_XRUN_INTERVAL_MS", 0);
+    settings.captureDirectory = qEnvironmentVariable("QT_NULL_AUDIO_CAPTURE_DIR");
+    settings.inputFile = qEnvironmentVariable("QT_NULL_AUDIO_INPUT_FILE");
+    settings.offlineFile = qEnvironmentVariable("QT_NULL_AUDIO_OFFLINE_FILE");
+    return settings;
+}
+
+bool devicesEnabled()
+{
+    static const char *const variables[] = {
+        "QT_NULL_AUDIO_PERIOD_MS",
+        "QT_NULL_AUDIO_LATENCY_MS",
+        "QT_NULL_AUDIO_JITTER_MS",
+        "QT_NULL_AUDIO_XRUN_INTERVAL_MS",
+        "QT_NULL_AUDIO_CAPTURE_DIR",
+        "QT_NULL_AUDIO_INPUT_FILE",
+        "QT_NULL_AUDIO_OFFLINE_FILE"
+    };
+
+    if (qEnvironmentVariable("QT_AUDIO_DEFAULT_REALM") == QLatin1String("null"))
+        return true;
+    for (const char *variable : variables) {
+        if (qEnvironmentVariableIsSet(variable))
+            return true;
+    }
+    return false;
+}
+
+int nextWakeup(const DeviceSettings &settings)
+{
+    if (settings.jitterMs <= 0)
+        return settings.periodMs;
+    return settings.periodMs + int(QRandomGenerator::global()->bounded(settings.jitterMs + 1));
+}
+
+QString nextCaptureFileName(const QString &directory)
+{
+    static QBasicAtomicInt counter = Q_BASIC_ATOMIC_INITIALIZER(0);
+    return QDir(directory).filePath(QStringLiteral("qtaudio_null-%1-%2.wav")
+                                    .arg(QCoreApplication::applicationPid())
+                                    .arg(counter.fetchAndAddRelaxed(1)));
+}
+
+DeviceClock::DeviceClock()
+    : m_accumulatedNSecs(0)
+    , m_sampleRate(0)
+{
+}
+
+void DeviceClock::start(int sampleRate)
+{
+    m_sampleRate = sampleRate;
+    m_accumulatedNSecs = 0;
+    m_timer.start();
+}
+
+void DeviceClock::stop()
+{
+    m_accumulatedNSecs = 0;
+    m_timer.invalidate();
+}
+
+void DeviceClock::suspend()
+{
+    if (!m_timer.isValid())
+        return;
+    m_accumulatedNSecs += m_timer.nsecsElapsed();
+    m_timer.invalidate();
+}
+
+void DeviceClock::resume()
+{
+    if (!m_timer.isValid())
+        m_timer.start();
+}
+
+qint64 DeviceClock::elapsedUSecs() const
+{
+    qint64 nsecs = m_accumulatedNSecs;
+    if (m_timer.isValid())
+        nsecs += m_timer.nsecsElapsed();
+    return nsecs / 1000;
+}
+
+qint64 DeviceClock::frames() const
+{
+    return elapsedUSecs() * m_sampleRate / 1000000;
+}
+
+WaveFileWriter::WaveFileWriter()
+    : m_dataBytes(0)
+    , m_wave(true)
+{
+}
+
+WaveFileWriter::~WaveFileWriter()
+{
+    close();
+}
+
+bool WaveFileWriter::open(const QString &fileName, const QAudioFormat &format)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("QNullAudio: cannot record to %s: %s", qPrintable(fileName),
+                 qPrintable(m_file.errorString()));
+        return false;
+    }
+
+    m_format = format;
+    m_dataBytes = 0;
+    m_wave = fileName.endsWith(QLatin1String(".wav"), Qt::CaseInsensitive);
+    if (m_wave)
+        writeHeader();
+    return true;
+}
+
+void WaveFileWriter::write(const char *data, qint64 len)
+{
+    if (!m_file.isOpen() || len <= 0)
+        return;
+    m_dataBytes += qMax<qint64>(0, m_file.write(data, len));
+}
+
+void WaveFileWriter::close()
+{
+    if (!m_file.isOpen())
+        return;
+
+    if (m_wave) {
+        m_file.seek(0);
+        writeHeader();
+    }
+    m_file.close();
+}
+
+void WaveFileWriter::writeHeader()
+{
+    // The samples are recorded as they are, big endian streams use RIFX
+    const bool bigEndian = m_format.byteOrder() == QAudioFormat::BigEndian;
+    const quint32 dataBytes = quint32(qMin<qint64>(m_dataBytes, 0xffffffffLL - 36));
+
+    QDataStream out(&m_file);
+    out.setByteOrder(bigEndian ? QDataStream::BigEndian : QDataStream::LittleEndian);
+    out.writeRawData(bigEndian ? "RIFX" : "RIFF", 4);
+    out << quint32(36 + dataBytes);
+    out.writeRawData("WAVEfmt ", 8);
+    out << quint32(16)
+        << quint16(m_format.sampleType() == QAudioFormat::Float ? 3 : 1)
+        << quint16(m_format.channelCount())
+        << quint32(m_format.sampleRate())
+        << quint32(m_format.bytesForDuration(1000000))
+        << quint16(m_format.bytesPerFrame())
+        << quint16(m_format.sampleSize());
+    out.writeRawData("data", 4);
+    out << dataBytes;
+}
+
+static void encodeSample(const QAudioFormat &format, double value, char *dest)
+{
+    const bool bigEndian = format.byteOrder() == QAudioFormat::BigEndian;
+    const bool isUnsigned = format.sampleType() == QAudioFormat::UnSignedInt;
+
+    switch (format.sampleSize()) {
+    case 8:
+        *reinterpret_cast<quint8 *>(dest) = isUnsigned ? quint8(128 + qRound(value * 127))
+                                                       : quint8(qint8(qRound(value * 127)));
+        break;
+    case 16: {
+        const quint16 sample = isUnsigned ? quint16(32768 + qRound(value * 32767))
+                                          : quint16(qint16(qRound(value * 32767)));
+        if (bigEndian)
+            qToBigEndian(sample, dest);
+        else
+            qToLittleEndian(sample, dest);
+        break;
+    }
+    case 32: {
+        quint32 sample;
+        if (format.sampleType() == QAudioFormat::Float) {
+            const float f = float(value);
+            memcpy(&sample, &f, sizeof(sample));
+        } else if (isUnsigned) {
+            sample = quint32(Q_INT64_C(2147483648) + qRound64(value * 2147483647.0));
+        } else {
+            sample = quint32(qint32(qRound64(value * 2147483647.0)));
+        }
+        if (bigEndian)
+            qToBigEndian(sample, dest);
+        else
+            qToLittleEndian(sample, dest);
+        break;
+    }
+    default:
+        memset(dest, 0, format.sampleSize() / 8);
+        break;
+    }
+}
+
+void generateSilence(const QAudioFormat &format, char *data, qint64 frames)
+{
+    const qint64 samples = frames * format.channelCount();
+    if (format.sampleType() != QAudioFormat::UnSignedInt) {
+        memset(data, 0, size_t(samples * format.sampleSize() / 8));
+        return;
+    }
+
+    const int sampleBytes = format.sampleSize() / 8;
+    for (qint64 i = 0; i < samples; ++i)
+        encodeSample(format, 0.0, data + i * sampleBytes);
+}
+
+SignalGenerator::SignalGenerator()
+    : m_position(0)
+    , m_frame(0)
+{
+}
+
+void SignalGenerator::setFormat(const QAudioFormat &format)
+{
+    m_format = format;
+    m_data.clear();
+    m_position = 0;
+    m_frame = 0;
+}
+
+bool SignalGenerator::loadFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning("QNullAudio: cannot read %s: %s", qPrintable(fileName),
+                 qPrintable(file.errorString()));
+        return false;
+    }
+
+    QByteArray data = file.readAll();
+
+    // Skip to the samples of a WAV file, anything else is taken as raw PCM
+    // in the stream format
+    if (data.size() >= 12 && (data.startsWith("RIFF") || data.startsWith("RIFX"))
+            && data.mid(8, 4) == "WAVE") {
+        const bool bigEndian = data.startsWith("RIFX");
+        int offset = 12;
+        QByteArray samples;
+        while (offset + 8 <= data.size()) {
+            const uchar *sizeField = reinterpret_cast<const uchar *>(data.constData() + offset + 4);
+            const quint32 size = bigEndian ? qFromBigEndian<quint32>(sizeField)
+                                           : qFromLittleEndian<quint32>(sizeField);
+            if (data.mid(offset, 4) == "data") {
+                samples = data.mid(offset + 8, int(qMin<quint32>(size, data.size() - offset - 8)));
+                break;
+            }
+            offset += 8 + int(size) + (size & 1);
+        }
+        data = samples;
+    }
+
+    const int frameBytes = m_format.bytesPerFrame();
+    if (frameBytes > 0)
+        data.truncate(data.size() - data.size() % frameBytes);
+    if (data.isEmpty())
+        return false;
+
+    m_data = data;
+    m_position = 0;
+    return true;
+}
+
+void SignalGenerator::generate(char *data, qint64 frames)
+{
+    const int frameBytes = m_format.bytesPerFrame();
+
+    if (!m_data.isEmpty()) {
+        qint64 len = frames * frameBytes;
+        while (len > 0) {
+            const qint64 chunk = qMin<qint64>(len, m_data.size() - m_position);
+            memcpy(data, m_data.constData() + m_position, size_t(chunk));
+            data += chunk;
+            len -= chunk;
+            m_position = (m_position + chunk) % m_data.size();
+        }
+        return;
+    }
+
+    // 440 Hz completes a whole number of cycles every second, wrapping the
+    // phase there keeps it exact over long runs
+    const int sampleRate = m_format.sampleRate();
+    const int sampleBytes = m_format.sampleSize() / 8;
+    const double step = 2 * M_PI * 440 / sampleRate;
+    for (qint64 i = 0; i < frames; ++i) {
+        encodeSample(m_format, 0.25 * qSin(step * m_frame), data);
+        for (int channel = 1; channel < m_format.channelCount(); ++channel)
+            memcpy(data + channel * sampleBytes, data, sampleBytes);
+        data += frameBytes;
+        m_frame = (m_frame + 1) % sampleRate;
+    }
+}
+
+void SignalGenerator::skip(qint64 frames)
+{
+    if (!m_data.isEmpty())
+        m_position = (m_position + frames * m_format.bytesPerFrame()) % m_data.size();
+    else if (m_format.sampleRate() > 0)
+        m_frame = (m_frame + frames) % m_format.sampleRate();
+}
+}
+
+QT_END_NAMESPACE
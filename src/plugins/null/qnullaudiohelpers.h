@@ -0,0 +1,165 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QNULLAUDIOHELPERS_H
+#define QNULLAUDIOHELPERS_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qstring.h>
+
+#include <QtMultimedia/qaudioformat.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QNullAudioInternal
+{
+// Behavior of the virtual devices. It is read from the environment each
+// time a stream opens, so a test can change it between streams.
+struct DeviceSettings
+{
+    DeviceSettings() : periodMs(10), latencyMs(40), jitterMs(0), xrunIntervalMs(0) {}
+
+    static DeviceSettings fromEnvironment();
+
+    int periodMs;               // QT_NULL_AUDIO_PERIOD_MS, default 10
+    int latencyMs;              // QT_NULL_AUDIO_LATENCY_MS, device buffer, default 40
+    int jitterMs;               // QT_NULL_AUDIO_JITTER_MS, maximum late wakeup, default 0
+    int xrunIntervalMs;         // QT_NULL_AUDIO_XRUN_INTERVAL_MS, 0 never injects xruns
+    QString captureDirectory;   // QT_NULL_AUDIO_CAPTURE_DIR, where output is recorded
+    QString inputFile;          // QT_NULL_AUDIO_INPUT_FILE, looped as the input signal
+    QString offlineFile;        // QT_NULL_AUDIO_OFFLINE_FILE, rendered to by the offline device,
+                                // the default output if QT_AUDIO_DEFAULT_REALM is "null"
+};
+
+// The virtual devices are only listed when QT_AUDIO_DEFAULT_REALM selects
+// this plugin or one of the QT_NULL_AUDIO_ variables above is set, so they
+// never show up next to the real hardware of an ordinary application
+bool devicesEnabled();
+
+// Milliseconds until the next period, late by up to the configured jitter
+int nextWakeup(const DeviceSettings &settings);
+
+// The virtual hardware pointer. It follows the monotonic clock while the
+// device runs and stands still while it is suspended.
+class DeviceClock
+{
+public:
+    DeviceClock();
+
+    void start(int sampleRate);
+    void stop();
+    void suspend();
+    void resume();
+
+    bool isRunning() const { return m_timer.isValid(); }
+    qint64 elapsedUSecs() const;
+    qint64 frames() const;
+
+private:
+    QElapsedTimer m_timer;
+    qint64 m_accumulatedNSecs;
+    int m_sampleRate;
+};
+
+// Records a stream to a file, as WAV when the name ends in .wav and raw
+// samples otherwise. The sizes in the WAV header are patched on close.
+class WaveFileWriter
+{
+public:
+    WaveFileWriter();
+    ~WaveFileWriter();
+
+    bool open(const QString &fileName, const QAudioFormat &format);
+    void write(const char *data, qint64 len);
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    QString fileName() const { return m_file.fileName(); }
+
+private:
+    void writeHeader();
+
+    QFile m_file;
+    QAudioFormat m_format;
+    qint64 m_dataBytes;
+    bool m_wave;
+};
+
+// Signal produced by a virtual input: the contents of a file, looped, or
+// a 440 Hz sine at -12 dBFS in every channel.
+class SignalGenerator
+{
+public:
+    SignalGenerator();
+
+    void setFormat(const QAudioFormat &format);
+    bool loadFile(const QString &fileName);
+    void generate(char *data, qint64 frames);
+    void skip(qint64 frames);
+
+private:
+    QAudioFormat m_format;
+    QByteArray m_data;
+    qint64 m_position;
+    qint64 m_frame;
+};
+
+// Fills frames with the zero level of format
+void generateSilence(const QAudioFormat &format, char *data, qint64 frames);
+
+// The unique name of the next capture file in directory
+QString nextCaptureFileName(const QString &directory);
+}
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,482 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qnullaudioinput.h"
+#include "qnullaudiodeviceinfo.h"
+
+#include <QtMultimedia/private/qaudiohelpers_p.h>
+
+QT_BEGIN_NAMESPACE
+
+using namespace QNullAudioInternal;
+
+QNullAudioInput::QNullAudioInput(const QByteArray &device)
+    : m_device(device)
+    , m_state(QAudio::StoppedState)
+    , m_error(QAudio::NoError)
+    , m_periodTimer(new QTimer(this))
+    , m_audioSource(0)
+    , m_pullMode(true)
+    , m_bufferSize(0)
+    , m_periodSize(0)
+    , m_bufferFrames(0)
+    , m_periodFrames(0)
+    , m_readPosition(0)
+    , m_totalBytes(0)
+    , m_nextXrunUSecs(0)
+    , m_lastNotifyUSecs(0)
+    , m_notifyInterval(1000)
+    , m_targetLatency(0)
+    , m_latency(-1)
+    , m_volume(1.0)
+{
+    m_periodTimer->setSingleShot(true);
+    m_periodTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_periodTimer, &QTimer::timeout, this, &QNullAudioInput::periodElapsed);
+}
+
+QNullAudioInput::~QNullAudioInput()
+{
+    close();
+}
+
+void QNullAudioInput::start(QIODevice *device)
+{
+    m_state = QAudio::StoppedState;
+    m_error = QAudio::NoError;
+    close();
+
+    m_pullMode = true;
+    m_audioSource = device;
+
+    if (open())
+        m_state = QAudio::ActiveState;
+    emit stateChanged(m_state);
+}
+
+QIODevice *QNullAudioInput::start()
+{
+    m_state = QAudio::StoppedState;
+    m_error = QAudio::NoError;
+    close();
+
+    m_pullMode = false;
+    m_audioSource = new QNullInputPrivate(this);
+    m_audioSource->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+    if (open())
+        m_state = QAudio::IdleState;
+    emit stateChanged(m_state);
+
+    return m_audioSource;
+}
+
+void QNullAudioInput::stop()
+{
+    if (m_state == QAudio::StoppedState)
+        return;
+
+    m_error = QAudio::NoError;
+    close();
+    setState(QAudio::StoppedState);
+}
+
+void QNullAudioInput::reset()
+{
+    stop();
+}
+
+void QNullAudioInput::suspend()
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return;
+
+    m_periodTimer->stop();
+    m_clock.suspend();
+    setState(QAudio::SuspendedState);
+}
+
+void QNullAudioInput::resume()
+{
+    if (m_state != QAudio::SuspendedState)
+        return;
+
+    m_clock.resume();
+    m_periodTimer->start(nextWakeup(m_settings));
+    setState(QAudio::ActiveState);
+}
+
+bool QNullAudioInput::open()
+{
+    if (!QNullAudioDeviceInfo(m_device, QAudio::AudioInput).isFormatSupported(m_format)) {
+        qWarning("QNullAudioInput: unsupported format");
+        setError(QAudio::OpenError);
+        return false;
+    }
+
+    m_settings = DeviceSettings::fromEnvironment();
+
+    const int sampleRate = m_format.sampleRate();
+    const int frameBytes = m_format.bytesPerFrame();
+    const qint64 bufferUSecs = m_targetLatency > 0 ? m_targetLatency
+                                                   : qint64(m_settings.latencyMs) * 1000;
+
+    m_periodFrames = qMax<qint64>(1, qint64(sampleRate) * m_settings.periodMs / 1000);
+    m_bufferFrames = m_bufferSize > 0 ? m_bufferSize / frameBytes
+                                      : sampleRate * bufferUSecs / 1000000;
+    m_bufferFrames = qMax(m_bufferFrames, 2 * m_periodFrames);
+    m_periodSize = int(m_periodFrames * frameBytes);
+    m_latency = m_bufferFrames * 1000000 / sampleRate;
+
+    m_generator.setFormat(m_format);
+    if (!m_settings.inputFile.isEmpty())
+        m_generator.loadFile(m_settings.inputFile);
+
+    m_pullPending.clear();
+    m_readPosition = 0;
+    m_totalBytes = 0;
+    m_nextXrunUSecs = qint64(m_settings.xrunIntervalMs) * 1000;
+    m_lastNotifyUSecs = 0;
+    m_stats.reset();
+    m_loudnessMeter.reset();
+
+    m_startTime.start();
+    m_clock.start(sampleRate);
+    m_periodTimer->start(nextWakeup(m_settings));
+    return true;
+}
+
+void QNullAudioInput::close()
+{
+    m_periodTimer->stop();
+
+    if (m_startTime.isValid()) {
+        m_stats.dump("QNullAudioInput", m_device);
+        m_startTime.invalidate();
+    }
+    m_clock.stop();
+
+    if (!m_pullMode && m_audioSource)
+        delete m_audioSource;
+    m_audioSource = 0;
+}
+
+void QNullAudioInput::updateDevice()
+{
+    const qint64 captured = m_clock.frames();
+
+    const qint64 xrunInterval = qint64(m_settings.xrunIntervalMs) * 1000;
+    if (xrunInterval > 0 && m_clock.elapsedUSecs() >= m_nextXrunUSecs) {
+        while (m_nextXrunUSecs <= m_clock.elapsedUSecs())
+            m_nextXrunUSecs += xrunInterval;
+
+        // Injected overrun, everything captured so far is lost
+        m_generator.skip(captured - m_readPosition);
+        m_readPosition = captured;
+        m_stats.recordOverrun();
+        m_error = QAudio::UnderrunError;
+        return;
+    }
+
+    if (captured - m_readPosition > m_bufferFrames) {
+        // The application didn't keep up, the oldest frames were overwritten
+        const qint64 lost = captured - m_readPosition - m_bufferFrames;
+        m_generator.skip(lost);
+        m_readPosition += lost;
+        m_stats.recordOverrun();
+        m_error = QAudio::UnderrunError;
+    }
+}
+
+qint64 QNullAudioInput::availableFrames() const
+{
+    if (!m_startTime.isValid())
+        return 0;
+    return qBound<qint64>(0, m_clock.frames() - m_readPosition, m_bufferFrames);
+}
+
+qint64 QNullAudioInput::capture(char *data, qint64 frames)
+{
+    const qint64 bytes = frames * m_format.bytesPerFrame();
+
+    m_generator.generate(data, frames);
+    if (m_volume < 1.0)
+        QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, data, int(bytes));
+    m_loudnessMeter.process(m_format, data, bytes);
+
+    m_readPosition += frames;
+    return bytes;
+}
+
+qint64 QNullAudioInput::read(char *data, qint64 len)
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return 0;
+
+    updateDevice();
+
+    const qint64 available = availableFrames();
+    const int frameBytes = m_format.bytesPerFrame();
+    m_stats.feedStarted(available * frameBytes);
+
+    const qint64 frames = qMin(len / frameBytes, available);
+    const qint64 bytes = frames > 0 ? capture(data, frames) : 0;
+    if (bytes > 0)
+        dataRead(bytes);
+
+    m_stats.feedFinished(bytes);
+    return bytes;
+}
+
+void QNullAudioInput::dataRead(qint64 bytes)
+{
+    m_totalBytes += bytes;
+    if (m_state != QAudio::ActiveState) {
+        m_error = QAudio::NoError;
+        setState(QAudio::ActiveState);
+    }
+}
+
+void QNullAudioInput::periodElapsed()
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return;
+
+    updateDevice();
+
+    if (m_pullMode) {
+        // Write everything captured so far to the QIODevice and keep what
+        // it does not accept for the next round
+        bool hadData = !m_pullPending.isEmpty();
+        if (m_pullPending.isEmpty()) {
+            const qint64 frames = availableFrames();
+            if (frames > 0) {
+                m_pullPending.resize(int(frames * m_format.bytesPerFrame()));
+                capture(m_pullPending.data(), frames);
+                hadData = true;
+            }
+        }
+
+        m_stats.feedStarted(m_pullPending.size());
+
+        qint64 l = 0;
+        qint64 bytesWritten = 0;
+        while (!m_pullPending.isEmpty()) {
+            l = m_audioSource->write(m_pullPending.constData(), m_pullPending.size());
+            if (l <= 0)
+                break;
+            m_pullPending.remove(0, int(l));
+            bytesWritten += l;
+        }
+
+        m_stats.feedFinished(bytesWritten);
+
+        if (l < 0) {
+            close();
+            setError(QAudio::IOError);
+            setState(QAudio::StoppedState);
+            return;
+        }
+
+        if (bytesWritten > 0) {
+            dataRead(bytesWritten);
+        } else if (hadData && m_state != QAudio::IdleState) {
+            m_error = QAudio::NoError;
+            setState(QAudio::IdleState);
+        }
+    } else if (availableFrames() > 0) {
+        // Let the application read() what is available
+        static_cast<QNullInputPrivate *>(m_audioSource)->trigger();
+    }
+
+    if (m_state == QAudio::ActiveState && m_notifyInterval > 0) {
+        const qint64 interval = qint64(m_notifyInterval) * 1000;
+        const qint64 now = m_clock.elapsedUSecs();
+        if (now - m_lastNotifyUSecs >= interval) {
+            m_lastNotifyUSecs += interval;
+            if (now - m_lastNotifyUSecs >= interval)
+                m_lastNotifyUSecs = now;
+            emit notify();
+        }
+    }
+
+    if (m_state == QAudio::ActiveState || m_state == QAudio::IdleState)
+        m_periodTimer->start(nextWakeup(m_settings));
+}
+
+void QNullAudioInput::setState(QAudio::State state)
+{
+    if (m_state == state)
+        return;
+    m_state = state;
+    emit stateChanged(state);
+}
+
+void QNullAudioInput::setError(QAudio::Error error)
+{
+    m_error = error;
+    emit errorChanged(error);
+}
+
+int QNullAudioInput::bytesReady() const
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return 0;
+    return int(availableFrames() * m_format.bytesPerFrame());
+}
+
+int QNullAudioInput::periodSize() const
+{
+    return m_periodSize;
+}
+
+void QNullAudioInput::setBufferSize(int value)
+{
+    if (m_state == QAudio::StoppedState)
+        m_bufferSize = value;
+}
+
+int QNullAudioInput::bufferSize() const
+{
+    if (m_startTime.isValid())
+        return int(m_bufferFrames * m_format.bytesPerFrame());
+    return m_bufferSize;
+}
+
+void QNullAudioInput::setNotifyInterval(int milliSeconds)
+{
+    m_notifyInterval = qMax(0, milliSeconds);
+}
+
+int QNullAudioInput::notifyInterval() const
+{
+    return m_notifyInterval;
+}
+
+qint64 QNullAudioInput::processedUSecs() const
+{
+    const int frameBytes = m_format.bytesPerFrame();
+    if (frameBytes <= 0 || m_format.sampleRate() <= 0)
+        return 0;
+    return m_totalBytes / frameBytes * 1000000 / m_format.sampleRate();
+}
+
+qint64 QNullAudioInput::elapsedUSecs() const
+{
+    if (m_state == QAudio::StoppedState || !m_startTime.isValid())
+        return 0;
+    return m_startTime.nsecsElapsed() / 1000;
+}
+
+QAudio::Error QNullAudioInput::error() const
+{
+    return m_error;
+}
+
+QAudio::State QNullAudioInput::state() const
+{
+    return m_state;
+}
+
+void QNullAudioInput::setFormat(const QAudioFormat &format)
+{
+    if (m_state == QAudio::StoppedState)
+        m_format = format;
+}
+
+QAudioFormat QNullAudioInput::format() const
+{
+    return m_format;
+}
+
+void QNullAudioInput::setVolume(qreal volume)
+{
+    m_volume = qBound(qreal(0.0), volume, qreal(1.0));
+}
+
+qreal QNullAudioInput::volume() const
+{
+    return m_volume;
+}
+
+void QNullAudioInput::setTargetLatency(qint64 microseconds)
+{
+    m_targetLatency = qMax<qint64>(0, microseconds);
+}
+
+qint64 QNullAudioInput::targetLatency() const
+{
+    return m_targetLatency;
+}
+
+qint64 QNullAudioInput::latency() const
+{
+    return m_latency;
+}
+
+QVariantMap QNullAudioInput::statistics() const
+{
+    return m_stats.toVariantMap();
+}
+
+QNullInputPrivate::QNullInputPrivate(QNullAudioInput *audio)
+    : m_audioDevice(audio)
+{
+}
+
+void QNullInputPrivate::trigger()
+{
+    emit readyRead();
+}
+
+qint64 QNullInputPrivate::readData(char *data, qint64 len)
+{
+    return m_audioDevice->read(data, len);
+}
+
+qint64 QNullInputPrivate::writeData(const char *data, qint64 len)
+{
+    Q_UNUSED(data)
+    Q_UNUSED(len)
+    return 0;
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qnullaudioinput.cpp"
@@ -0,0 +1,170 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QNULLAUDIOINPUT_H
+#define QNULLAUDIOINPUT_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qtimer.h>
+
+#include <QtMultimedia/qaudio.h>
+#include <QtMultimedia/qaudioformat.h>
+#include <QtMultimedia/qaudiosystem.h>
+#include <QtMultimedia/private/qaudiostreamstats_p.h>
+#include <QtMultimedia/private/qaudioloudnessmeter_p.h>
+#include <QtMultimedia/private/qaudiosystemext_p.h>
+
+#include "qnullaudiohelpers.h"
+
+QT_BEGIN_NAMESPACE
+
+// Captures from a virtual device that produces one frame per sample period
+// of the monotonic clock, either from a file or a test tone.
+class QNullAudioInput : public QAbstractAudioInput, public QAudioInputExtension
+{
+    friend class QNullInputPrivate;
+    Q_OBJECT
+    Q_INTERFACES(QAudioInputExtension)
+
+public:
+    QNullAudioInput(const QByteArray &device);
+    ~QNullAudioInput();
+
+    void start(QIODevice *device) Q_DECL_OVERRIDE;
+    QIODevice *start() Q_DECL_OVERRIDE;
+    void stop() Q_DECL_OVERRIDE;
+    void reset() Q_DECL_OVERRIDE;
+    void suspend() Q_DECL_OVERRIDE;
+    void resume() Q_DECL_OVERRIDE;
+    int bytesReady() const Q_DECL_OVERRIDE;
+    int periodSize() const Q_DECL_OVERRIDE;
+    void setBufferSize(int value) Q_DECL_OVERRIDE;
+    int bufferSize() const Q_DECL_OVERRIDE;
+    void setNotifyInterval(int milliSeconds) Q_DECL_OVERRIDE;
+    int notifyInterval() const Q_DECL_OVERRIDE;
+    qint64 processedUSecs() const Q_DECL_OVERRIDE;
+    qint64 elapsedUSecs() const Q_DECL_OVERRIDE;
+    QAudio::Error error() const Q_DECL_OVERRIDE;
+    QAudio::State state() const Q_DECL_OVERRIDE;
+    void setFormat(const QAudioFormat &format) Q_DECL_OVERRIDE;
+    QAudioFormat format() const Q_DECL_OVERRIDE;
+    void setVolume(qreal volume) Q_DECL_OVERRIDE;
+    qreal volume() const Q_DECL_OVERRIDE;
+    void setTargetLatency(qint64 microseconds) Q_DECL_OVERRIDE;
+    qint64 targetLatency() const Q_DECL_OVERRIDE;
+    qint64 latency() const Q_DECL_OVERRIDE;
+    QVariantMap statistics() const Q_DECL_OVERRIDE;
+    QAudioLoudnessMeter *loudnessMeter() Q_DECL_OVERRIDE { return &m_loudnessMeter; }
+
+    qint64 read(char *data, qint64 len);
+
+private Q_SLOTS:
+    void periodElapsed();
+
+private:
+    bool open();
+    void close();
+    void updateDevice();
+    qint64 availableFrames() const;
+    qint64 capture(char *data, qint64 frames);
+    void dataRead(qint64 bytes);
+    void setState(QAudio::State state);
+    void setError(QAudio::Error error);
+
+    QByteArray m_device;
+    QAudioFormat m_format;
+    QAudio::State m_state;
+    QAudio::Error m_error;
+    QNullAudioInternal::DeviceSettings m_settings;
+    QNullAudioInternal::DeviceClock m_clock;
+    QNullAudioInternal::SignalGenerator m_generator;
+    QTimer *m_periodTimer;
+    QElapsedTimer m_startTime;
+    QIODevice *m_audioSource;
+    bool m_pullMode;
+    QByteArray m_pullPending;
+    int m_bufferSize;
+    int m_periodSize;
+    qint64 m_bufferFrames;
+    qint64 m_periodFrames;
+    qint64 m_readPosition;
+    qint64 m_totalBytes;
+    qint64 m_nextXrunUSecs;
+    qint64 m_lastNotifyUSecs;
+    int m_notifyInterval;
+    qint64 m_targetLatency;
+    qint64 m_latency;
+    qreal m_volume;
+    QAudioStreamStats m_stats;
+    QAudioLoudnessMeter m_loudnessMeter;
+};
+
+class QNullInputPrivate : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    QNullInputPrivate(QNullAudioInput *audio);
+
+    void trigger();
+
+protected:
+    qint64 readData(char *data, qint64 len) Q_DECL_OVERRIDE;
+    qint64 writeData(const char *data, qint64 len) Q_DECL_OVERRIDE;
+
+private:
+    QNullAudioInput *m_audioDevice;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,590 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qnullaudiooutput.h"
+#include "qnullaudiodeviceinfo.h"
+
+#include <QtCore/qdir.h>
+#include <QtCore/qvarlengtharray.h>
+#include <QtMultimedia/private/qaudiohelpers_p.h>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+using namespace QNullAudioInternal;
+
+QNullAudioOutput::QNullAudioOutput(const QByteArray &device)
+    : m_device(device)
+    , m_offline(device == "offline")
+    , m_state(QAudio::StoppedState)
+    , m_error(QAudio::NoError)
+    , m_periodTimer(new QTimer(this))
+    , m_audioSource(0)
+    , m_pullMode(true)
+    , m_playing(false)
+    , m_bufferSize(0)
+    , m_periodSize(0)
+    , m_bufferFrames(0)
+    , m_periodFrames(0)
+    , m_writePosition(0)
+    , m_recordedPosition(0)
+    , m_totalFrames(0)
+    , m_nextXrunUSecs(0)
+    , m_lastNotifyUSecs(0)
+    , m_notifyInterval(1000)
+    , m_targetLatency(0)
+    , m_latency(-1)
+    , m_volume(1.0)
+{
+    m_periodTimer->setSingleShot(true);
+    m_periodTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_periodTimer, &QTimer::timeout, this, &QNullAudioOutput::periodElapsed);
+}
+
+QNullAudioOutput::~QNullAudioOutput()
+{
+    close();
+}
+
+void QNullAudioOutput::start(QIODevice *device)
+{
+    m_state = QAudio::StoppedState;
+    m_error = QAudio::NoError;
+    close();
+
+    m_pullMode = true;
+    m_audioSource = device;
+
+    if (open())
+        m_state = QAudio::ActiveState;
+    emit stateChanged(m_state);
+}
+
+QIODevice *QNullAudioOutput::start()
+{
+    m_state = QAudio::StoppedState;
+    m_error = QAudio::NoError;
+    close();
+
+    m_pullMode = false;
+    m_audioSource = new QNullOutputPrivate(this);
+    m_audioSource->open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+
+    if (open())
+        m_state = QAudio::IdleState;
+    emit stateChanged(m_state);
+
+    return m_audioSource;
+}
+
+void QNullAudioOutput::stop()
+{
+    if (m_state == QAudio::StoppedState)
+        return;
+
+    m_error = QAudio::NoError;
+    close();
+    setState(QAudio::StoppedState);
+}
+
+void QNullAudioOutput::reset()
+{
+    // Drop whatever is still queued in the virtual device
+    recordPlayed(m_clock.frames());
+    m_writePosition = m_clock.frames();
+    m_playing = false;
+    stop();
+}
+
+void QNullAudioOutput::suspend()
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return;
+
+    m_periodTimer->stop();
+    m_clock.suspend();
+    m_error = QAudio::NoError;
+    setState(QAudio::SuspendedState);
+}
+
+void QNullAudioOutput::resume()
+{
+    if (m_state != QAudio::SuspendedState)
+        return;
+
+    m_clock.resume();
+    m_error = QAudio::NoError;
+    setState(m_pullMode || queuedFrames() > 0 ? QAudio::ActiveState : QAudio::IdleState);
+    scheduleNextPeriod();
+}
+
+bool QNullAudioOutput::open()
+{
+    if (!QNullAudioDeviceInfo(m_device, QAudio::AudioOutput).isFormatSupported(m_format)) {
+        qWarning("QNullAudioOutput: unsupported format");
+        setError(QAudio::OpenError);
+        return false;
+    }
+
+    m_settings = DeviceSettings::fromEnvironment();
+
+    const int sampleRate = m_format.sampleRate();
+    const int frameBytes = m_format.bytesPerFrame();
+    const qint64 bufferUSecs = m_targetLatency > 0 ? m_targetLatency
+                                                   : qint64(m_settings.latencyMs) * 1000;
+
+    m_periodFrames = qMax<qint64>(1, qint64(sampleRate) * m_settings.periodMs / 1000);
+    m_bufferFrames = m_bufferSize > 0 ? m_bufferSize / frameBytes
+                                      : sampleRate * bufferUSecs / 1000000;
+    m_bufferFrames = qMax(m_bufferFrames, 2 * m_periodFrames);
+    m_periodSize = int(m_periodFrames * frameBytes);
+    m_latency = m_offline ? 0 : m_bufferFrames * 1000000 / sampleRate;
+    m_pullBuffer.resize(int(m_bufferFrames * frameBytes));
+
+    m_writePosition = 0;
+    m_recordedPosition = 0;
+    m_totalFrames = 0;
+    m_playing = false;
+    m_nextXrunUSecs = qint64(m_settings.xrunIntervalMs) * 1000;
+    m_lastNotifyUSecs = 0;
+    m_stats.reset();
+    m_loudnessMeter.reset();
+
+    QString fileName;
+    if (m_offline && !m_settings.offlineFile.isEmpty())
+        fileName = m_settings.offlineFile;
+    else if (!m_settings.captureDirectory.isEmpty())
+        fileName = nextCaptureFileName(m_settings.captureDirectory);
+    else if (m_offline)
+        fileName = nextCaptureFileName(QDir::tempPath());
+
+    m_recordingFileName.clear();
+    if (!fileName.isEmpty() && m_recorder.open(fileName, m_format))
+        m_recordingFileName = fileName;
+
+    if (m_offline && m_recordingFileName.isEmpty()) {
+        setError(QAudio::OpenError);
+        return false;
+    }
+
+    // The offline device records straight from write()
+    if (m_recorder.isOpen() && !m_offline) {
+        m_deviceBuffer.resize(int(m_bufferFrames * frameBytes));
+        m_silence.resize(m_periodSize);
+        generateSilence(m_format, m_silence.data(), m_periodFrames);
+    } else {
+        m_deviceBuffer.clear();
+        m_silence.clear();
+    }
+
+    m_startTime.start();
+    m_clock.start(sampleRate);
+    scheduleNextPeriod();
+    return true;
+}
+
+void QNullAudioOutput::close()
+{
+    m_periodTimer->stop();
+
+    if (m_startTime.isValid()) {
+        // The device stops here, whatever is still queued is never played
+        recordPlayed(m_clock.frames());
+        m_stats.dump("QNullAudioOutput", m_device);
+        m_startTime.invalidate();
+    }
+    m_clock.stop();
+    m_recorder.close();
+
+    if (!m_pullMode && m_audioSource)
+        delete m_audioSource;
+    m_audioSource = 0;
+}
+
+void QNullAudioOutput::updateDevice()
+{
+    if (m_offline)
+        return;
+
+    const qint64 played = m_clock.frames();
+    recordPlayed(played);
+
+    const qint64 xrunInterval = qint64(m_settings.xrunIntervalMs) * 1000;
+    if (xrunInterval > 0 && m_clock.elapsedUSecs() >= m_nextXrunUSecs) {
+        while (m_nextXrunUSecs <= m_clock.elapsedUSecs())
+            m_nextXrunUSecs += xrunInterval;
+
+        // Injected stall, the hardware skips ahead and loses what was queued
+        m_writePosition = played;
+        m_playing = false;
+        m_stats.recordUnderrun();
+        setError(QAudio::UnderrunError);
+        return;
+    }
+
+    if (m_writePosition < played) {
+        // The device ran dry and played silence meanwhile
+        if (m_playing)
+            m_stats.recordUnderrun();
+        m_playing = false;
+        m_writePosition = played;
+    }
+}
+
+void QNullAudioOutput::recordPlayed(qint64 played)
+{
+    // Appends what the device played since the last call, the queued frames
+    // where there were any and silence where it ran dry
+    if (m_deviceBuffer.isEmpty()) {
+        m_recordedPosition = played;
+        return;
+    }
+
+    const int frameBytes = m_format.bytesPerFrame();
+    while (m_recordedPosition < played) {
+        qint64 frames;
+        if (m_recordedPosition < m_writePosition) {
+            const qint64 index = m_recordedPosition % m_bufferFrames;
+            frames = qMin(qMin(played, m_writePosition) - m_recordedPosition, m_bufferFrames - index);
+            m_recorder.write(m_deviceBuffer.constData() + index * frameBytes, frames * frameBytes);
+        } else {
+            frames = qMin(played - m_recordedPosition, m_periodFrames);
+            m_recorder.write(m_silence.constData(), frames * frameBytes);
+        }
+        m_recordedPosition += frames;
+    }
+}
+
+void QNullAudioOutput::scheduleNextPeriod()
+{
+    if (!m_offline) {
+        m_periodTimer->start(nextWakeup(m_settings));
+    } else if (m_pullMode) {
+        // Render as fast as the source delivers, poll once per period while
+        // it has nothing. Writes drive the offline device in push mode.
+        m_periodTimer->start(m_state == QAudio::ActiveState ? 0 : m_settings.periodMs);
+    }
+}
+
+void QNullAudioOutput::checkNotify()
+{
+    if (m_state != QAudio::ActiveState || m_notifyInterval <= 0)
+        return;
+
+    const qint64 interval = qint64(m_notifyInterval) * 1000;
+    const qint64 now = deviceUSecs();
+    if (now - m_lastNotifyUSecs >= interval) {
+        m_lastNotifyUSecs += interval;
+        if (now - m_lastNotifyUSecs >= interval)
+            m_lastNotifyUSecs = now;
+        emit notify();
+    }
+}
+
+qint64 QNullAudioOutput::queuedFrames() const
+{
+    // The offline device consumes everything the moment it is written
+    if (!m_startTime.isValid() || m_offline)
+        return 0;
+    return qMax<qint64>(0, m_writePosition - m_clock.frames());
+}
+
+qint64 QNullAudioOutput::deviceUSecs() const
+{
+    return m_offline ? processedUSecs() : m_clock.elapsedUSecs();
+}
+
+qint64 QNullAudioOutput::write(const char *data, qint64 len)
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return 0;
+
+    updateDevice();
+
+    const int space = bytesFree();
+    if (!space)
+        return 0;
+
+    m_stats.feedStarted(space);
+
+    // The offline device never runs out of room. The clock may have moved
+    // on since updateDevice(), frames not recorded yet must not be overwritten.
+    const int frameBytes = m_format.bytesPerFrame();
+    const qint64 room = m_offline ? len
+                                  : qMin<qint64>(space, (m_recordedPosition + m_bufferFrames - m_writePosition) * frameBytes);
+    const qint64 frames = qMin(len, room) / frameBytes;
+    const qint64 bytes = frames * frameBytes;
+
+    if (frames > 0) {
+        m_loudnessMeter.process(m_format, data, bytes);
+
+        if (m_offline) {
+            if (m_volume < 1.0) {
+                QVarLengthArray<char, 4096> out(int(bytes));
+                QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, out.data(), int(bytes));
+                m_recorder.write(out.constData(), bytes);
+            } else {
+                m_recorder.write(data, bytes);
+            }
+        } else if (!m_deviceBuffer.isEmpty()) {
+            // Recorded by updateDevice() once the clock has played it
+            const char *src = data;
+            qint64 position = m_writePosition;
+            qint64 remaining = frames;
+            while (remaining > 0) {
+                const qint64 index = position % m_bufferFrames;
+                const qint64 chunk = qMin(remaining, m_bufferFrames - index);
+                char *dest = m_deviceBuffer.data() + index * frameBytes;
+                if (m_volume < 1.0)
+                    QAudioHelperInternal::qMultiplySamples(m_volume, m_format, src, dest, int(chunk * frameBytes));
+                else
+                    memcpy(dest, src, size_t(chunk * frameBytes));
+                src += chunk * frameBytes;
+                position += chunk;
+                remaining -= chunk;
+            }
+        }
+
+        m_writePosition += frames;
+        m_totalFrames += frames;
+        m_playing = true;
+    }
+
+    m_stats.feedFinished(bytes);
+
+    if (frames > 0) {
+        m_error = QAudio::NoError;
+        setState(QAudio::ActiveState);
+        if (m_offline && !m_pullMode)
+            checkNotify();
+    }
+    return bytes;
+}
+
+void QNullAudioOutput::periodElapsed()
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return;
+
+    updateDevice();
+
+    bool fed = false;
+    if (m_pullMode) {
+        const int chunks = bytesFree() / m_periodSize;
+        if (chunks > 0) {
+            const qint64 l = m_audioSource->read(m_pullBuffer.data(), chunks * m_periodSize);
+
+            // reading can take a while and stream may have been stopped
+            if (m_state == QAudio::StoppedState)
+                return;
+
+            if (l > 0) {
+                const qint64 written = write(m_pullBuffer.constData(), l);
+                if (written != l && !m_audioSource->isSequential())
+                    m_audioSource->seek(m_audioSource->pos() - (l - written));
+                fed = written > 0;
+            } else if (l < 0) {
+                close();
+                setError(QAudio::IOError);
+                setState(QAudio::StoppedState);
+                return;
+            }
+        }
+    }
+
+    if (!fed && m_state != QAudio::IdleState && queuedFrames() < m_periodFrames) {
+        // Underrun
+        setError(QAudio::UnderrunError);
+        setState(QAudio::IdleState);
+    }
+
+    checkNotify();
+
+    if (m_state == QAudio::ActiveState || m_state == QAudio::IdleState)
+        scheduleNextPeriod();
+}
+
+void QNullAudioOutput::setState(QAudio::State state)
+{
+    if (m_state == state)
+        return;
+    m_state = state;
+    emit stateChanged(state);
+}
+
+void QNullAudioOutput::setError(QAudio::Error error)
+{
+    m_error = error;
+    emit errorChanged(error);
+}
+
+int QNullAudioOutput::bytesFree() const
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return 0;
+
+    return int(qMax<qint64>(0, m_bufferFrames - queuedFrames()) * m_format.bytesPerFrame());
+}
+
+int QNullAudioOutput::periodSize() const
+{
+    return m_periodSize;
+}
+
+void QNullAudioOutput::setBufferSize(int value)
+{
+    if (m_state == QAudio::StoppedState)
+        m_bufferSize = value;
+}
+
+int QNullAudioOutput::bufferSize() const
+{
+    if (m_startTime.isValid())
+        return int(m_bufferFrames * m_format.bytesPerFrame());
+    return m_bufferSize;
+}
+
+void QNullAudioOutput::setNotifyInterval(int milliSeconds)
+{
+    m_notifyInterval = qMax(0, milliSeconds);
+}
+
+int QNullAudioOutput::notifyInterval() const
+{
+    return m_notifyInterval;
+}
+
+qint64 QNullAudioOutput::processedUSecs() const
+{
+    if (m_format.sampleRate() <= 0)
+        return 0;
+    return m_totalFrames * 1000000 / m_format.sampleRate();
+}
+
+qint64 QNullAudioOutput::elapsedUSecs() const
+{
+    if (m_state == QAudio::StoppedState || !m_startTime.isValid())
+        return 0;
+    if (m_offline)
+        return processedUSecs();
+    return m_startTime.nsecsElapsed() / 1000;
+}
+
+qint64 QNullAudioOutput::presentedUSecs() const
+{
+    if (m_format.sampleRate() <= 0)
+        return 0;
+    return (m_totalFrames - queuedFrames()) * 1000000 / m_format.sampleRate();
+}
+
+QAudio::Error QNullAudioOutput::error() const
+{
+    return m_error;
+}
+
+QAudio::State QNullAudioOutput::state() const
+{
+    return m_state;
+}
+
+void QNullAudioOutput::setFormat(const QAudioFormat &format)
+{
+    if (m_state == QAudio::StoppedState)
+        m_format = format;
+}
+
+QAudioFormat QNullAudioOutput::format() const
+{
+    return m_format;
+}
+
+void QNullAudioOutput::setVolume(qreal volume)
+{
+    m_volume = qBound(qreal(0.0), volume, qreal(1.0));
+}
+
+qreal QNullAudioOutput::volume() const
+{
+    return m_volume;
+}
+
+void QNullAudioOutput::setTargetLatency(qint64 microseconds)
+{
+    m_targetLatency = qMax<qint64>(0, microseconds);
+}
+
+qint64 QNullAudioOutput::targetLatency() const
+{
+    return m_targetLatency;
+}
+
+qint64 QNullAudioOutput::latency() const
+{
+    return m_latency;
+}
+
+QVariantMap QNullAudioOutput::statistics() const
+{
+    QVariantMap statistics = m_stats.toVariantMap();
+    if (!m_recordingFileName.isEmpty())
+        statistics.insert(QStringLiteral("recordingFile"), m_recordingFileName);
+    return statistics;
+}
+
+QNullOutputPrivate::QNullOutputPrivate(QNullAudioOutput *audio)
+    : m_audioDevice(audio)
+{
+}
+
+qint64 QNullOutputPrivate::readData(char *data, qint64 len)
+{
+    Q_UNUSED(data)
+    Q_UNUSED(len)
+    return 0;
+}
+
+qint64 QNullOutputPrivate::writeData(const char *data, qint64 len)
+{
+    return m_audioDevice->write(data, len);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qnullaudiooutput.cpp"
@@ -0,0 +1,86 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qnullaudioplugin.h"
+#include "qnullaudiodeviceinfo.h"
+#include "qnullaudiohelpers.h"
+#include "qnullaudioinput.h"
+#include "qnullaudiooutput.h"
+
+QT_BEGIN_NAMESPACE
+
+QNullAudioPlugin::QNullAudioPlugin(QObject *parent)
+    : QAudioSystemPlugin(parent)
+{
+}
+
+QByteArray QNullAudioPlugin::defaultDevice(QAudio::Mode mode) const
+{
+    // Real hardware wins, the virtual devices only become the default when
+    // QT_AUDIO_DEFAULT_REALM selects this plugin. The plugin registered as
+    // "default" is asked first, so QT_NULL_AUDIO_OFFLINE_FILE only redirects
+    // the default output together with QT_AUDIO_DEFAULT_REALM=null.
+    if (mode == QAudio::AudioOutput
+            && !QNullAudioInternal::DeviceSettings::fromEnvironment().offlineFile.isEmpty()) {
+        return QByteArrayLiteral("offline");
+    }
+    return QByteArray();
+}
+
+QList<QByteArray> QNullAudioPlugin::availableDevices(QAudio::Mode mode) const
+{
+    return QNullAudioDeviceInfo::availableDevices(mode);
+}
+
+QAbstractAudioInput *QNullAudioPlugin::createInput(const QByteArray &device)
+{
+    return new QNullAudioInput(device);
+}
+
+QAbstractAudioOutput *QNullAudioPlugin::createOutput(const QByteArray &device)
+{
+    return new QNullAudioOutput(device);
+}
+
+QAbstractAudioDeviceInfo *QNullAudioPlugin::createDeviceInfo(const QByteArray &device, QAudio::Mode mode)
+{
+    return new QNullAudioDeviceInfo(device, mode);
+}
+
+QT_END_NAMESPACE
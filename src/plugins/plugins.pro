@@ -7,7 +7,7 @@
 TEMPLATE = subdirs
 QT_FOR_CONFIG += multimedia-private
 
-SUBDIRS += m3u
+SUBDIRS += m3u null
 
 qtHaveModule(quick) {
    SUBDIRS += videonode
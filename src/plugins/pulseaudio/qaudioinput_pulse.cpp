@@ -41,6 +41,7 @@
 #include <QtCore/qdebug.h>
 #include <QtCore/qmath.h>
 #include <private/qaudiohelpers_p.h>
+#include <private/qaudiobuffer_p.h>
 
 #include "qaudioinput_pulse.h"
 #include "qaudiodeviceinfo_pulse.h"
@@ -53,13 +54,67 @@ QT_BEGIN_NAMESPACE
 
 const int PeriodTimeMs = 50;
 
+// A fragment peeked from a record stream, handed out without copying.
+// The stream can't deliver anything else until the fragment is dropped,
+// which happens once the last QAudioBuffer referencing it goes away.
+class QPulseAudioPeekedBuffer : public QAbstractAudioBuffer
+{
+public:
+    QPulseAudioPeekedBuffer(pa_stream *stream, const QSharedPointer<QAtomicInt> &borrowed,
+                            const void *data, int frameCount, const QAudioFormat &format, qint64 startTime)
+        : m_stream(pa_stream_ref(stream))
+        , m_borrowed(borrowed)
+        , m_data(data)
+        , m_frameCount(frameCount)
+        , m_format(format)
+        , m_startTime(startTime)
+    {
+    }
+
+    void release() override
+    {
+        // The last reference may be dropped from a callback running on the
+        // mainloop thread, which already holds the lock
+        QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+        const bool locked = !pa_threaded_mainloop_in_thread(pulseEngine->mainloop());
+        if (locked)
+            pulseEngine->lock();
+        if (pa_stream_get_state(m_stream) == PA_STREAM_READY)
+            pa_stream_drop(m_stream);
+        pa_stream_unref(m_stream);
+        if (locked)
+            pulseEngine->unlock();
+
+        m_borrowed->store(0);
+        delete this;
+    }
+
+    QAudioFormat format() const override { return m_format; }
+    qint64 startTime() const override { return m_startTime; }
+    int frameCount() const override { return m_frameCount; }
+
+    void *constData() const override { return const_cast<void *>(m_data); }
+
+    // The memory belongs to PulseAudio, QAudioBuffer makes a copy for writing
+    void *writableData() override { return 0; }
+    QAbstractAudioBuffer *clone() const override { return 0; }
+
+private:
+    pa_stream *m_stream;
+    QSharedPointer<QAtomicInt> m_borrowed;
+    const void *m_data;
+    int m_frameCount;
+    QAudioFormat m_format;
+    qint64 m_startTime;
+};
+
 static void inputStreamReadCallback(pa_stream *stream, size_t length, void *userdata)
 {
-    Q_UNUSED(userdata);
     Q_UNUSED(length);
     Q_UNUSED(stream);
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
     pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
+    static_cast<QPulseAudioInput*>(userdata)->streamReadCallback();
 }
 
 static void inputStreamStateCallback(pa_stream *stream, void *userdata)
@@ -100,15 +155,15 @@ static void inputStreamStateCallback(pa_stream *stream, void *userdata)
 
 static void inputStreamUnderflowCallback(pa_stream *stream, void *userdata)
 {
-    Q_UNUSED(userdata)
     Q_UNUSED(stream)
+    static_cast<QPulseAudioInput *>(userdata)->m_stats.recordUnderrun();
     qWarning() << "Got a buffer underflow!";
 }
 
 static void inputStreamOverflowCallback(pa_stream *stream, void *userdata)
 {
     Q_UNUSED(stream)
-    Q_UNUSED(userdata)
+    static_cast<QPulseAudioInput *>(userdata)->m_stats.recordOverrun();
     qWarning() << "Got a buffer overflow!";
 }
 
@@ -138,19 +193,18 @@ QPulseAudioInput::QPulseAudioInput(const QByteArray &device)
     , m_periodSize(0)
     , m_intervalTime(1000)
     , m_periodTime(PeriodTimeMs)
+    , m_targetLatency(0)
+    , m_latency(-1)
     , m_stream(0)
     , m_device(device)
+    , m_borrowed(QSharedPointer<QAtomicInt>::create(0))
+    , m_tempBufferStartTime(-1)
 {
-    m_timer = new QTimer(this);
-    connect(m_timer, SIGNAL(timeout()), SLOT(userFeed()));
 }
 
 QPulseAudioInput::~QPulseAudioInput()
 {
     close();
-    disconnect(m_timer, SIGNAL(timeout()));
-    QCoreApplication::processEvents();
-    delete m_timer;
 }
 
 void QPulseAudioInput::setError(QAudio::Error error)
@@ -287,6 +341,11 @@ bool QPulseAudioInput::open()
 #endif
 
     pulseEngine->lock();
+
+    // Fragments still held by the previous stream release on their own
+    m_borrowed = QSharedPointer<QAtomicInt>::create(0);
+    m_feedPending.store(0);
+
     pa_channel_map channel_map;
 
     pa_channel_map_init_extend(&channel_map, spec.channels, PA_CHANNEL_MAP_DEFAULT);
@@ -311,8 +370,13 @@ bool QPulseAudioInput::open()
     buffer_attr.tlength = (uint32_t) -1;
     buffer_attr.minreq = (uint32_t) -1;
     flags |= PA_STREAM_ADJUST_LATENCY;
+    // Keep the timing info current so fragments can be stamped cheaply
+    flags |= PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE;
 
-    if (m_bufferSize > 0)
+    // With PA_STREAM_ADJUST_LATENCY the fragment size is the capture latency
+    if (m_targetLatency > 0)
+        buffer_attr.fragsize = (uint32_t) pa_usec_to_bytes(m_targetLatency, &spec);
+    else if (m_bufferSize > 0)
         buffer_attr.fragsize = (uint32_t) m_bufferSize;
     else
         buffer_attr.fragsize = (uint32_t) m_periodSize;
@@ -336,17 +400,29 @@ bool QPulseAudioInput::open()
     if (actualBufferAttr->tlength != (uint32_t)-1)
         m_bufferSize = actualBufferAttr->tlength;
 
+    // The fragment plus whatever the source was configured with
+    m_latency = pa_bytes_to_usec(m_periodSize, &spec);
+    pa_operation *timingOperation = pa_stream_update_timing_info(m_stream, inputStreamSuccessCallback, 0);
+    if (timingOperation) {
+        pulseEngine->wait(timingOperation);
+        pa_operation_unref(timingOperation);
+        const pa_timing_info *timing = pa_stream_get_timing_info(m_stream);
+        if (timing)
+            m_latency += timing->configured_source_usec;
+    }
+
     pulseEngine->unlock();
 
     connect(pulseEngine, &QPulseAudioEngine::contextFailed, this, &QPulseAudioInput::onPulseContextFailed);
 
     m_opened = true;
-    m_timer->start(m_periodTime);
 
     m_clockStamp.restart();
     m_timeStamp.restart();
     m_elapsedTimeOffset = 0;
     m_totalTimeValue = 0;
+    m_stats.reset();
+    m_loudnessMeter.reset();
 
     return true;
 }
@@ -356,8 +432,6 @@ void QPulseAudioInput::close()
     if (!m_opened)
         return;
 
-    m_timer->stop();
-
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
 
     if (m_stream) {
@@ -375,12 +449,15 @@ void QPulseAudioInput::close()
         pulseEngine->unlock();
     }
 
+    m_stats.dump("QPulseAudioInput", m_device);
+
     disconnect(pulseEngine, &QPulseAudioEngine::contextFailed, this, &QPulseAudioInput::onPulseContextFailed);
 
     if (!m_pullMode && m_audioSource) {
         delete m_audioSource;
         m_audioSource = 0;
     }
+    m_tempBuffer.clear();
     m_opened = false;
 }
 
@@ -403,6 +480,7 @@ int QPulseAudioInput::bytesReady() const
 qint64 QPulseAudioInput::read(char *data, qint64 len)
 {
     m_bytesAvailable = checkBytesReady();
+    m_stats.feedStarted(m_bytesAvailable + m_tempBuffer.size());
 
     setError(QAudio::NoError);
     setState(QAudio::ActiveState);
@@ -416,13 +494,17 @@ qint64 QPulseAudioInput::read(char *data, qint64 len)
 
         if (readBytes < m_tempBuffer.size()) {
             m_tempBuffer.remove(0, readBytes);
+            if (m_tempBufferStartTime >= 0)
+                m_tempBufferStartTime += m_format.durationForBytes(readBytes);
+            m_stats.feedFinished(readBytes);
             return readBytes;
         }
 
         m_tempBuffer.clear();
     }
 
-    while (pa_stream_readable_size(m_stream) > 0) {
+    // A fragment handed out by readBuffer() blocks the stream until released
+    while (!m_borrowed->load() && pa_stream_readable_size(m_stream) > 0) {
         size_t readLength = 0;
 
 #ifdef DEBUG_PULSE
@@ -440,14 +522,30 @@ qint64 QPulseAudioInput::read(char *data, qint64 len)
         if (pa_stream_peek(m_stream, &audioBuffer, &readLength) < 0) {
             qWarning() << QString("pa_stream_peek() failed: %1").arg(pa_strerror(pa_context_errno(pa_stream_get_context(m_stream))));
             pulseEngine->unlock();
+            m_stats.feedFinished(readBytes);
             return 0;
         }
 
+        if (!audioBuffer) {
+            // A hole in the stream, nothing to deliver
+            pa_stream_drop(m_stream);
+            pulseEngine->unlock();
+            continue;
+        }
+
         qint64 actualLength = 0;
         if (m_pullMode) {
-            QByteArray adjusted(readLength, Qt::Uninitialized);
-            applyVolume(audioBuffer, adjusted.data(), readLength);
-            actualLength = m_audioSource->write(adjusted);
+            if (m_volume < 1.f) {
+                QByteArray adjusted(readLength, Qt::Uninitialized);
+                applyVolume(audioBuffer, adjusted.data(), readLength);
+                actualLength = m_audioSource->write(adjusted);
+                if (actualLength > 0)
+                    m_loudnessMeter.process(m_format, adjusted.constData(), actualLength);
+            } else {
+                actualLength = m_audioSource->write(static_cast<const char *>(audioBuffer), readLength);
+                if (actualLength > 0)
+                    m_loudnessMeter.process(m_format, audioBuffer, actualLength);
+            }
 
             if (actualLength < qint64(readLength)) {
                 pulseEngine->unlock();
@@ -455,11 +553,13 @@ qint64 QPulseAudioInput::read(char *data, qint64 len)
                 setError(QAudio::UnderrunError);
                 setState(QAudio::IdleState);
 
+                m_stats.feedFinished(readBytes + actualLength);
                 return actualLength;
             }
         } else {
             actualLength = qMin(static_cast<int>(len - readBytes), static_cast<int>(readLength));
             applyVolume(audioBuffer, data + readBytes, actualLength);
+            m_loudnessMeter.process(m_format, data + readBytes, actualLength);
         }
 
 #ifdef DEBUG_PULSE
@@ -472,8 +572,14 @@ qint64 QPulseAudioInput::read(char *data, qint64 len)
 #endif
             int diff = readLength - actualLength;
             int oldSize = m_tempBuffer.size();
+            if (oldSize == 0) {
+                const qint64 startTime = fragmentStartTime();
+                m_tempBufferStartTime = startTime >= 0 ? startTime + m_format.durationForBytes(actualLength) : -1;
+            }
             m_tempBuffer.resize(m_tempBuffer.size() + diff);
             applyVolume(static_cast<const char *>(audioBuffer) + actualLength, m_tempBuffer.data() + oldSize, diff);
+            // Metered now, the application gets it with the next read
+            m_loudnessMeter.process(m_format, m_tempBuffer.constData() + oldSize, diff);
             QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
         }
 
@@ -497,9 +603,111 @@ qint64 QPulseAudioInput::read(char *data, qint64 len)
     qDebug() << "QPulseAudioInput::read -- returning after reading " << readBytes << " bytes";
 #endif
 
+    m_stats.feedFinished(readBytes);
     return readBytes;
 }
 
+QAudioBuffer QPulseAudioInput::readBuffer()
+{
+    if (m_pullMode || !m_opened)
+        return QAudioBuffer();
+
+    if (m_deviceState != QAudio::ActiveState && m_deviceState != QAudio::IdleState)
+        return QAudioBuffer();
+
+    if (!m_tempBuffer.isEmpty()) {
+        // Left over from a partial read()
+        QAudioBuffer buffer(m_tempBuffer, m_format, m_tempBufferStartTime);
+        m_totalTimeValue += m_tempBuffer.size();
+        m_tempBuffer.clear();
+
+        setError(QAudio::NoError);
+        setState(QAudio::ActiveState);
+        return buffer;
+    }
+
+    // The previous fragment is still borrowed, nothing else can be peeked
+    if (m_borrowed->load())
+        return QAudioBuffer();
+
+    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    pulseEngine->lock();
+
+    m_stats.feedStarted(pa_stream_readable_size(m_stream));
+
+    const void *audioBuffer = 0;
+    size_t readLength = 0;
+    if (pa_stream_peek(m_stream, &audioBuffer, &readLength) < 0) {
+        qWarning() << QString("pa_stream_peek() failed: %1").arg(pa_strerror(pa_context_errno(pa_stream_get_context(m_stream))));
+        pulseEngine->unlock();
+        return QAudioBuffer();
+    }
+
+    if (readLength == 0) {
+        pulseEngine->unlock();
+        return QAudioBuffer();
+    }
+
+    if (!audioBuffer) {
+        // A hole in the stream, nothing to deliver
+        pa_stream_drop(m_stream);
+        pulseEngine->unlock();
+        return QAudioBuffer();
+    }
+
+    const qint64 startTime = fragmentStartTime();
+
+    QAudioBuffer buffer;
+    if (m_volume < 1.f) {
+        QByteArray adjusted(readLength, Qt::Uninitialized);
+        applyVolume(audioBuffer, adjusted.data(), readLength);
+        pa_stream_drop(m_stream);
+        buffer = QAudioBuffer(adjusted, m_format, startTime);
+    } else {
+        m_borrowed->store(1);
+        buffer = QAudioBuffer(new QPulseAudioPeekedBuffer(m_stream, m_borrowed, audioBuffer,
+                                                          readLength / pa_frame_size(&m_spec),
+                                                          m_format, startTime));
+    }
+
+    pulseEngine->unlock();
+
+    m_stats.feedFinished(readLength);
+    m_loudnessMeter.process(m_format, buffer.constData(), buffer.byteCount());
+    m_totalTimeValue += readLength;
+
+    setError(QAudio::NoError);
+    setState(QAudio::ActiveState);
+
+    return buffer;
+}
+
+QVariantMap QPulseAudioInput::statistics() const
+{
+    return m_stats.toVariantMap();
+}
+
+qint64 QPulseAudioInput::fragmentStartTime() const
+{
+    // Called with the mainloop locked. For record streams the latency is the
+    // age of the data at the read index, i.e. of the fragment at the head.
+    pa_usec_t latency = 0;
+    int negative = 0;
+    if (pa_stream_get_latency(m_stream, &latency, &negative) < 0)
+        return -1;
+
+    const qint64 now = pa_rtclock_now();
+    return negative ? now + qint64(latency) : now - qint64(latency);
+}
+
+void QPulseAudioInput::streamReadCallback()
+{
+    // Called from the PulseAudio mainloop thread when a new fragment arrived.
+    // Only keep one feed request in flight.
+    if (m_feedPending.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
+}
+
 void QPulseAudioInput::applyVolume(const void *src, void *dest, int len)
 {
     if (m_volume < 1.f)
@@ -522,7 +730,8 @@ void QPulseAudioInput::resume()
 
         pulseEngine->unlock();
 
-        m_timer->start(m_periodTime);
+        // Deliver whatever arrived before the stream was corked
+        QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
 
         setState(QAudio::ActiveState);
         setError(QAudio::NoError);
@@ -542,6 +751,21 @@ qreal QPulseAudioInput::volume() const
     return m_volume;
 }
 
+void QPulseAudioInput::setTargetLatency(qint64 microseconds)
+{
+    m_targetLatency = microseconds;
+}
+
+qint64 QPulseAudioInput::targetLatency() const
+{
+    return m_targetLatency;
+}
+
+qint64 QPulseAudioInput::latency() const
+{
+    return m_latency;
+}
+
 void QPulseAudioInput::setBufferSize(int value)
 {
     m_bufferSize = value;
@@ -581,8 +805,6 @@ void QPulseAudioInput::suspend()
         setError(QAudio::NoError);
         setState(QAudio::SuspendedState);
 
-        m_timer->stop();
-
         QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
         pa_operation *operation;
 
@@ -598,6 +820,8 @@ void QPulseAudioInput::suspend()
 
 void QPulseAudioInput::userFeed()
 {
+    m_feedPending.store(0);
+
     if (m_deviceState == QAudio::StoppedState || m_deviceState == QAudio::SuspendedState)
         return;
 #ifdef DEBUG_PULSE
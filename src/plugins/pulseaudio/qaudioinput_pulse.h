@@ -52,15 +52,19 @@
 #define QAUDIOINPUTPULSE_H
 
 #include <QtCore/qfile.h>
-#include <QtCore/qtimer.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qstringlist.h>
 #include <QtCore/qdatetime.h>
 #include <QtCore/qiodevice.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qsharedpointer.h>
 
 #include "qaudio.h"
 #include "qaudiodeviceinfo.h"
 #include "qaudiosystem.h"
+#include <private/qaudiostreamstats_p.h>
+#include <private/qaudioloudnessmeter_p.h>
+#include <private/qaudiosystemext_p.h>
 
 #include <pulse/pulseaudio.h>
 
@@ -68,15 +72,17 @@ QT_BEGIN_NAMESPACE
 
 class PulseInputPrivate;
 
-class QPulseAudioInput : public QAbstractAudioInput
+class QPulseAudioInput : public QAbstractAudioInput, public QAudioInputExtension
 {
     Q_OBJECT
+    Q_INTERFACES(QAudioInputExtension)
 
 public:
     QPulseAudioInput(const QByteArray &device);
     ~QPulseAudioInput();
 
     qint64 read(char *data, qint64 len);
+    QAudioBuffer readBuffer() override;
 
     void start(QIODevice *device);
     QIODevice *start();
@@ -100,6 +106,12 @@ public:
     void setVolume(qreal volume);
     qreal volume() const;
 
+    void setTargetLatency(qint64 microseconds) override;
+    qint64 targetLatency() const override;
+    qint64 latency() const override;
+    QVariantMap statistics() const override;
+    QAudioLoudnessMeter *loudnessMeter() override { return &m_loudnessMeter; }
+
     qint64 m_totalTimeValue;
     QIODevice *m_audioSource;
     QAudioFormat m_format;
@@ -107,6 +119,11 @@ public:
     QAudio::State m_deviceState;
     qreal m_volume;
 
+    void streamReadCallback();
+
+    QAudioStreamStats m_stats;
+    QAudioLoudnessMeter m_loudnessMeter;
+
 private slots:
     void userFeed();
     bool deviceReady();
@@ -118,6 +135,8 @@ private:
 
     void applyVolume(const void *src, void *dest, int len);
 
+    qint64 fragmentStartTime() const;
+
     int checkBytesReady();
     bool open();
     void close();
@@ -129,7 +148,10 @@ private:
     int m_periodSize;
     int m_intervalTime;
     unsigned int m_periodTime;
-    QTimer *m_timer;
+    qint64 m_targetLatency;
+    qint64 m_latency;
+    QAtomicInt m_feedPending;
+    QSharedPointer<QAtomicInt> m_borrowed;
     qint64 m_elapsedTimeOffset;
     pa_stream *m_stream;
     QTime m_timeStamp;
@@ -137,6 +159,7 @@ private:
     QByteArray m_streamName;
     QByteArray m_device;
     QByteArray m_tempBuffer;
+    qint64 m_tempBufferStartTime;
     pa_sample_spec m_spec;
 };
 
@@ -61,9 +61,9 @@ static void  outputStreamWriteCallback(pa_stream *stream, size_t length, void *u
 {
     Q_UNUSED(stream);
     Q_UNUSED(length);
-    Q_UNUSED(userdata);
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
     pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
+    ((QPulseAudioOutput*)userdata)->streamWriteCallback();
 }
 
 static void outputStreamStateCallback(pa_stream *stream, void *userdata)
@@ -97,8 +97,7 @@ static void outputStreamUnderflowCallback(pa_stream *stream, void *userdata)
 static void outputStreamOverflowCallback(pa_stream *stream, void *userdata)
 {
     Q_UNUSED(stream)
-    Q_UNUSED(userdata)
-    qWarning() << "Got a buffer overflow!";
+    ((QPulseAudioOutput*)userdata)->streamOverflowCallback();
 }
 
 static void outputStreamLatencyCallback(pa_stream *stream, void *userdata)
@@ -164,12 +163,17 @@ QPulseAudioOutput::QPulseAudioOutput(const QByteArray &device)
     , m_periodSize(0)
     , m_bufferSize(0)
     , m_maxBufferSize(0)
+    , m_targetLatency(0)
+    , m_latency(-1)
     , m_totalTimeValue(0)
+    , m_presentedUSecs(0)
     , m_tickTimer(new QTimer(this))
-    , m_audioBuffer(0)
+    , m_renderCallback(0)
+    , m_renderUserData(0)
     , m_resuming(false)
     , m_volume(1.0)
 {
+    m_tickTimer->setSingleShot(true);
     connect(m_tickTimer, SIGNAL(timeout()), SLOT(userFeed()));
 }
 
@@ -208,14 +212,36 @@ QAudio::State QPulseAudioOutput::state() const
     return m_deviceState;
 }
 
+void QPulseAudioOutput::streamWriteCallback()
+{
+    // In callback mode the audio is rendered right here, userFeed() only
+    // updates the clock and the state.
+    if (m_renderCallback)
+        renderPeriods();
+
+    // Called from the PulseAudio mainloop thread whenever the server asks
+    // for data. Only keep one feed request in flight, userFeed() fills all
+    // the writable space at once.
+    if (m_feedPending.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
+}
+
 void QPulseAudioOutput::streamUnderflowCallback()
 {
+    m_stats.recordUnderrun();
+
     if (m_deviceState != QAudio::IdleState && !m_resuming) {
         setError(QAudio::UnderrunError);
         setState(QAudio::IdleState);
     }
 }
 
+void QPulseAudioOutput::streamOverflowCallback()
+{
+    m_stats.recordOverrun();
+    qWarning() << "Got a buffer overflow!";
+}
+
 void QPulseAudioOutput::start(QIODevice *device)
 {
     setState(QAudio::StoppedState);
@@ -231,6 +257,7 @@ void QPulseAudioOutput::start(QIODevice *device)
 
     m_pullMode = true;
     m_audioSource = device;
+    m_renderCallback = 0;
 
     if (!open()) {
         m_audioSource = 0;
@@ -254,6 +281,7 @@ QIODevice *QPulseAudioOutput::start()
     close();
 
     m_pullMode = false;
+    m_renderCallback = 0;
 
     if (!open())
         return Q_NULLPTR;
@@ -266,6 +294,73 @@ QIODevice *QPulseAudioOutput::start()
     return m_audioSource;
 }
 
+bool QPulseAudioOutput::startCallback(QAudio::RenderCallback callback, void *userData)
+{
+    setState(QAudio::StoppedState);
+    setError(QAudio::NoError);
+
+    // Handle change of mode
+    if (m_audioSource && !m_pullMode) {
+        delete m_audioSource;
+    }
+    m_audioSource = 0;
+
+    close();
+
+    // Rendered from the write callback, there is no source to pull from
+    m_pullMode = true;
+    m_renderCallback = callback;
+    m_renderUserData = userData;
+
+    if (!open()) {
+        m_renderCallback = 0;
+        return true;
+    }
+
+    setState(QAudio::ActiveState);
+
+    return true;
+}
+
+void QPulseAudioOutput::renderPeriods()
+{
+    // Runs with the mainloop lock held, either on the mainloop thread or
+    // from open() and resume(). m_periodSize is zero until the stream is connected.
+    if (!m_stream || m_periodSize <= 0)
+        return;
+
+    while (pa_stream_writable_size(m_stream) != size_t(-1)
+           && pa_stream_writable_size(m_stream) >= size_t(m_periodSize)) {
+        m_stats.feedStarted(pa_stream_writable_size(m_stream));
+
+        // Render straight into PulseAudio's memory where it hands out a
+        // whole period, otherwise into the buffer allocated by open()
+        void *dest = NULL;
+        size_t nbytes = m_periodSize;
+        if (pa_stream_begin_write(m_stream, &dest, &nbytes) < 0 || nbytes < size_t(m_periodSize)) {
+            if (dest)
+                pa_stream_cancel_write(m_stream);
+            dest = m_renderBuffer.data();
+        }
+
+        m_renderCallback(static_cast<char *>(dest), m_periodSize, m_renderUserData);
+
+        // Metered before the volume is applied, on the owner thread
+        m_loudnessMeter.processDeferred(dest, m_periodSize);
+        const qreal volume = m_volume.load();
+        if (volume < 1.0f)
+            QAudioHelperInternal::qMultiplySamples(volume, m_format, dest, dest, m_periodSize);
+
+        if (pa_stream_write(m_stream, dest, m_periodSize, NULL, 0, PA_SEEK_RELATIVE) < 0) {
+            m_stats.feedFinished(0);
+            break;
+        }
+
+        m_stats.feedFinished(m_periodSize);
+        m_renderedBytes.fetchAndAddOrdered(m_periodSize);
+    }
+}
+
 bool QPulseAudioOutput::open()
 {
     if (m_opened)
@@ -288,7 +383,12 @@ bool QPulseAudioOutput::open()
     }
 
     m_spec = spec;
+    m_periodSize = 0;
     m_totalTimeValue = 0;
+    m_presentedUSecs = 0;
+    m_stats.reset();
+    m_loudnessMeter.reset();
+    m_loudnessMeter.prepareDeferred(m_format);
 
     if (m_streamName.isNull())
         m_streamName = QString(QLatin1String("QtmPulseStream-%1-%2")).arg(::getpid()).arg(quintptr(this)).toUtf8();
@@ -302,6 +402,8 @@ bool QPulseAudioOutput::open()
 
     pulseEngine->lock();
 
+    m_feedPending.store(0);
+
     qint64 bytesPerSecond = m_format.sampleRate() * m_format.channelCount() * m_format.sampleSize() / 8;
 
     pa_proplist *propList = pa_proplist_new();
@@ -329,7 +431,21 @@ bool QPulseAudioOutput::open()
     requestedBuffer.prebuf = (uint32_t)-1;
     requestedBuffer.tlength = m_bufferSize;
 
-    if (pa_stream_connect_playback(m_stream, m_device.data(), (m_bufferSize > 0) ? &requestedBuffer : NULL, (pa_stream_flags_t)0, NULL, NULL) < 0) {
+    // Let the client library extrapolate the playback position between
+    // timing updates, see presentedUSecs().
+    pa_stream_flags_t flags = pa_stream_flags_t(PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE);
+    if (m_targetLatency > 0) {
+        // tlength becomes the end-to-end latency, the server sizes the sink
+        // latency to fit. We're asked for data four times per tlength and
+        // playback starts as soon as the first request is served.
+        requestedBuffer.tlength = pa_usec_to_bytes(m_targetLatency, &m_spec);
+        requestedBuffer.minreq = pa_usec_to_bytes(m_targetLatency / 4, &m_spec);
+        requestedBuffer.prebuf = requestedBuffer.minreq;
+        flags = pa_stream_flags_t(flags | PA_STREAM_ADJUST_LATENCY);
+    }
+
+    const bool customBuffer = m_bufferSize > 0 || m_targetLatency > 0;
+    if (pa_stream_connect_playback(m_stream, m_device.data(), customBuffer ? &requestedBuffer : NULL, flags, NULL, NULL) < 0) {
         qWarning() << "pa_stream_connect_playback() failed!";
         pa_stream_unref(m_stream);
         m_stream = 0;
@@ -343,11 +459,29 @@ bool QPulseAudioOutput::open()
         pa_threaded_mainloop_wait(pulseEngine->mainloop());
 
     const pa_buffer_attr *buffer = pa_stream_get_buffer_attr(m_stream);
-    m_periodTime = (m_category == LOW_LATENCY_CATEGORY_NAME) ? LowLatencyPeriodTimeMs : PeriodTimeMs;
-    m_periodSize = pa_usec_to_bytes(m_periodTime*1000, &m_spec);
+    if (m_targetLatency > 0) {
+        m_periodSize = buffer->minreq;
+        m_periodTime = qMax<int>(1, pa_bytes_to_usec(m_periodSize, &m_spec) / 1000);
+    } else {
+        m_periodTime = (m_category == LOW_LATENCY_CATEGORY_NAME) ? LowLatencyPeriodTimeMs : PeriodTimeMs;
+        m_periodSize = pa_usec_to_bytes(m_periodTime*1000, &m_spec);
+    }
     m_bufferSize = buffer->tlength;
     m_maxBufferSize = buffer->maxlength;
-    m_audioBuffer = new char[m_maxBufferSize];
+    m_renderedBytes.store(0);
+    if (m_renderCallback)
+        m_renderBuffer.resize(m_periodSize);
+
+    // The stream buffer plus whatever the sink was configured with
+    m_latency = pa_bytes_to_usec(buffer->tlength, &m_spec);
+    pa_operation *timingOperation = pa_stream_update_timing_info(m_stream, outputStreamSuccessCallback, NULL);
+    if (timingOperation) {
+        pulseEngine->wait(timingOperation);
+        pa_operation_unref(timingOperation);
+        const pa_timing_info *timing = pa_stream_get_timing_info(m_stream);
+        if (timing)
+            m_latency += timing->configured_sink_usec;
+    }
 
     const qint64 streamSize = m_audioSource ? m_audioSource->size() : 0;
     if (m_pullMode && streamSize > 0 && static_cast<qint64>(buffer->prebuf) > streamSize) {
@@ -368,14 +502,16 @@ bool QPulseAudioOutput::open()
     qDebug() << "\tFragment size: " << buffer->fragsize;
 #endif
 
+    // Requests that came in while connecting were skipped, serve them
+    if (m_renderCallback)
+        renderPeriods();
+
     pulseEngine->unlock();
 
     connect(pulseEngine, &QPulseAudioEngine::contextFailed, this, &QPulseAudioOutput::onPulseContextFailed);
 
     m_opened = true;
 
-    m_tickTimer->start(m_periodTime);
-
     m_elapsedTimeOffset = 0;
     m_timeStamp.restart();
     m_clockStamp.restart();
@@ -412,6 +548,8 @@ void QPulseAudioOutput::close()
         pulseEngine->unlock();
     }
 
+    m_stats.dump("QPulseAudioOutput", m_device);
+
     disconnect(pulseEngine, &QPulseAudioEngine::contextFailed, this, &QPulseAudioOutput::onPulseContextFailed);
 
     if (!m_pullMode && m_audioSource) {
@@ -419,45 +557,111 @@ void QPulseAudioOutput::close()
         m_audioSource = 0;
     }
     m_opened = false;
-    if (m_audioBuffer) {
-        delete[] m_audioBuffer;
-        m_audioBuffer = 0;
-    }
 }
 
 void QPulseAudioOutput::userFeed()
 {
+    m_feedPending.store(0);
+
     if (m_deviceState == QAudio::StoppedState || m_deviceState == QAudio::SuspendedState)
         return;
 
     m_resuming = false;
 
-    if (m_pullMode) {
-        int writableSize = bytesFree();
-        int chunks = writableSize / m_periodSize;
-        if (chunks == 0)
-            return;
+    if (m_renderCallback) {
+        const int rendered = m_renderedBytes.fetchAndStoreOrdered(0);
+        m_loudnessMeter.processPending();
+        if (rendered > 0) {
+            m_totalTimeValue += rendered;
+            setState(QAudio::ActiveState);
+        }
+    } else if (m_pullMode) {
+        QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
 
-        int input = m_periodSize; // always request 1 chunk of data from user
-        if (input > m_maxBufferSize)
-            input = m_maxBufferSize;
+        forever {
+            // Read straight into memory of the stream, without holding the
+            // mainloop lock while user code runs. The reference keeps the
+            // stream and its write buffer alive if it is closed or fails
+            // meanwhile, in which case the write is cancelled instead.
+            pulseEngine->lock();
+
+            pa_stream *stream = m_stream;
+            const size_t writableSize = stream ? pa_stream_writable_size(stream) : 0;
+            if (writableSize == 0 || writableSize == size_t(-1)) {
+                pulseEngine->unlock();
+                break;
+            }
 
-        int audioBytesPulled = m_audioSource->read(m_audioBuffer, input);
-        Q_ASSERT(audioBytesPulled <= input);
-        if (audioBytesPulled > 0) {
-            if (audioBytesPulled > input) {
+            m_stats.feedStarted(writableSize);
+
+            void *dest = NULL;
+            size_t nbytes = writableSize;
+            if (pa_stream_begin_write(stream, &dest, &nbytes) < 0) {
+                qWarning("QAudioOutput(pulseaudio): pa_stream_begin_write, error = %s",
+                         pa_strerror(pa_context_errno(pulseEngine->context())));
+                pulseEngine->unlock();
+                m_stats.feedFinished(0);
+                setError(QAudio::IOError);
+                break;
+            }
+            pa_stream_ref(stream);
+            pulseEngine->unlock();
+
+            char *data = reinterpret_cast<char *>(dest);
+            qint64 audioBytesPulled = m_audioSource->read(data, nbytes);
+            if (audioBytesPulled > qint64(nbytes)) {
                 qWarning() << "QPulseAudioOutput::userFeed() - Invalid audio data size provided from user:"
-                           << audioBytesPulled << "should be less than" << input;
-                audioBytesPulled = input;
+                           << audioBytesPulled << "should be less than" << nbytes;
+                audioBytesPulled = nbytes;
+            }
+
+            if (audioBytesPulled > 0 && m_deviceState != QAudio::StoppedState) {
+                // Metered before the volume is applied
+                m_loudnessMeter.process(m_format, data, audioBytesPulled);
+
+                const qreal volume = m_volume.load();
+                if (volume < 1.0f) {
+                    // Don't use PulseAudio volume, as it might affect all other streams of the same category
+                    // or even affect the system volume if flat volumes are enabled
+                    QAudioHelperInternal::qMultiplySamples(volume, m_format, data, data, audioBytesPulled);
+                }
+            }
+
+            pulseEngine->lock();
+
+            if (stream != m_stream || pa_stream_get_state(stream) != PA_STREAM_READY
+                    || m_deviceState == QAudio::StoppedState || audioBytesPulled <= 0) {
+                pa_stream_cancel_write(stream);
+                pa_stream_unref(stream);
+                pulseEngine->unlock();
+                m_stats.feedFinished(0);
+                if (audioBytesPulled <= 0 && stream == m_stream && m_deviceState != QAudio::StoppedState) {
+                    // PulseAudio won't ask again once the stream ran dry,
+                    // poll the source until it has data.
+                    m_tickTimer->start(m_periodTime);
+                }
+                break;
             }
-            qint64 bytesWritten = write(m_audioBuffer, audioBytesPulled);
-            Q_ASSERT(bytesWritten == audioBytesPulled); //unfinished write should not happen since the data provided is less than writableSize
-            Q_UNUSED(bytesWritten);
 
-            if (chunks > 1) {
-                // PulseAudio needs more data. Ask for it immediately.
-                QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
+            const int result = pa_stream_write(stream, data, audioBytesPulled, NULL, 0, PA_SEEK_RELATIVE);
+            pa_stream_unref(stream);
+            if (result < 0) {
+                qWarning("QAudioOutput(pulseaudio): pa_stream_write, error = %s",
+                         pa_strerror(pa_context_errno(pulseEngine->context())));
+                pulseEngine->unlock();
+                setError(QAudio::IOError);
+                break;
             }
+
+            pulseEngine->unlock();
+
+            m_stats.feedFinished(audioBytesPulled);
+            m_totalTimeValue += audioBytesPulled;
+            setError(QAudio::NoError);
+            setState(QAudio::ActiveState);
+
+            if (audioBytesPulled < qint64(nbytes))
+                break;
         }
     }
 
@@ -474,12 +678,21 @@ void QPulseAudioOutput::userFeed()
 qint64 QPulseAudioOutput::write(const char *data, qint64 len)
 {
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    const char *source = data;
 
     pulseEngine->lock();
 
-    len = qMin(len, static_cast<qint64>(pa_stream_writable_size(m_stream)));
+    const qint64 writable = static_cast<qint64>(pa_stream_writable_size(m_stream));
+    len = qMin(len, writable);
+    if (len <= 0) {
+        pulseEngine->unlock();
+        return 0;
+    }
+
+    m_stats.feedStarted(writable);
 
-    if (m_volume < 1.0f) {
+    const qreal volume = m_volume.load();
+    if (volume < 1.0f) {
         // Don't use PulseAudio volume, as it might affect all other streams of the same category
         // or even affect the system volume if flat volumes are enabled
         void *dest = NULL;
@@ -487,23 +700,27 @@ qint64 QPulseAudioOutput::write(const char *data, qint64 len)
         if (pa_stream_begin_write(m_stream, &dest, &nbytes) < 0) {
             qWarning("QAudioOutput(pulseaudio): pa_stream_begin_write, error = %s",
                      pa_strerror(pa_context_errno(pulseEngine->context())));
+            pulseEngine->unlock();
             setError(QAudio::IOError);
             return 0;
         }
 
-        len = int(nbytes);
-        QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, dest, len);
+        len = qMin(len, qint64(nbytes));
+        QAudioHelperInternal::qMultiplySamples(volume, m_format, data, dest, len);
         data = reinterpret_cast<char *>(dest);
     }
 
     if (pa_stream_write(m_stream, data, len, NULL, 0, PA_SEEK_RELATIVE) < 0) {
         qWarning("QAudioOutput(pulseaudio): pa_stream_write, error = %s",
                  pa_strerror(pa_context_errno(pulseEngine->context())));
+        pulseEngine->unlock();
         setError(QAudio::IOError);
         return 0;
     }
 
     pulseEngine->unlock();
+    m_stats.feedFinished(len);
+    m_loudnessMeter.process(m_format, source, len);
     m_totalTimeValue += len;
 
     setError(QAudio::NoError);
@@ -586,9 +803,13 @@ void QPulseAudioOutput::resume()
         pulseEngine->wait(operation);
         pa_operation_unref(operation);
 
+        if (m_renderCallback)
+            renderPeriods();
+
         pulseEngine->unlock();
 
-        m_tickTimer->start(m_periodTime);
+        // Kick the feed, the write callback takes over from there
+        m_tickTimer->start(0);
 
         setState(m_pullMode ? QAudio::ActiveState : QAudio::IdleState);
         setError(QAudio::NoError);
@@ -674,15 +895,15 @@ qint64 PulseOutputPrivate::writeData(const char *data, qint64 len)
 
 void QPulseAudioOutput::setVolume(qreal vol)
 {
-    if (qFuzzyCompare(m_volume, vol))
+    if (qFuzzyCompare(m_volume.load(), vol))
         return;
 
-    m_volume = qBound(qreal(0), vol, qreal(1));
+    m_volume.store(qBound(qreal(0), vol, qreal(1)));
 }
 
 qreal QPulseAudioOutput::volume() const
 {
-    return m_volume;
+    return m_volume.load();
 }
 
 void QPulseAudioOutput::setCategory(const QString &category)
@@ -697,6 +918,45 @@ QString QPulseAudioOutput::category() const
     return m_category;
 }
 
+void QPulseAudioOutput::setTargetLatency(qint64 microseconds)
+{
+    m_targetLatency = microseconds;
+}
+
+qint64 QPulseAudioOutput::targetLatency() const
+{
+    return m_targetLatency;
+}
+
+qint64 QPulseAudioOutput::latency() const
+{
+    return m_latency;
+}
+
+QVariantMap QPulseAudioOutput::statistics() const
+{
+    return m_stats.toVariantMap();
+}
+
+qint64 QPulseAudioOutput::presentedUSecs() const
+{
+    if (!m_stream)
+        return m_presentedUSecs;
+
+    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    pa_usec_t usecs = 0;
+    pulseEngine->lock();
+    const bool valid = pa_stream_get_time(m_stream, &usecs) == 0;
+    pulseEngine->unlock();
+
+    // The interpolated time can run ahead of the data actually written
+    // when the stream underflows, and back when a timing update arrives.
+    if (valid)
+        m_presentedUSecs = qMax(m_presentedUSecs, qMin<qint64>(usecs, processedUSecs()));
+
+    return m_presentedUSecs;
+}
+
 void QPulseAudioOutput::onPulseContextFailed()
 {
     close();
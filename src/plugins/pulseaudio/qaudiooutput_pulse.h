@@ -57,19 +57,25 @@
 #include <QtCore/qstringlist.h>
 #include <QtCore/qdatetime.h>
 #include <QtCore/qiodevice.h>
+#include <QtCore/qatomic.h>
 
 #include "qaudio.h"
 #include "qaudiodeviceinfo.h"
 #include "qaudiosystem.h"
+#include <private/qaudiohelpers_p.h>
+#include <private/qaudiostreamstats_p.h>
+#include <private/qaudioloudnessmeter_p.h>
+#include <private/qaudiosystemext_p.h>
 
 #include <pulse/pulseaudio.h>
 
 QT_BEGIN_NAMESPACE
 
-class QPulseAudioOutput : public QAbstractAudioOutput
+class QPulseAudioOutput : public QAbstractAudioOutput, public QAudioOutputExtension
 {
     friend class PulseOutputPrivate;
     Q_OBJECT
+    Q_INTERFACES(QAudioOutputExtension)
 
 public:
     QPulseAudioOutput(const QByteArray &device);
@@ -77,6 +83,7 @@ public:
 
     void start(QIODevice *device);
     QIODevice *start();
+    bool startCallback(QAudio::RenderCallback callback, void *userData) override;
     void stop();
     void reset();
     void suspend();
@@ -100,8 +107,17 @@ public:
     void setCategory(const QString &category);
     QString category() const;
 
+    void setTargetLatency(qint64 microseconds) override;
+    qint64 targetLatency() const override;
+    qint64 latency() const override;
+    qint64 presentedUSecs() const override;
+    QVariantMap statistics() const override;
+    QAudioLoudnessMeter *loudnessMeter() override { return &m_loudnessMeter; }
+
 public:
+    void streamWriteCallback();
     void streamUnderflowCallback();
+    void streamOverflowCallback();
 
 private:
     void setState(QAudio::State state);
@@ -110,6 +126,7 @@ private:
     bool open();
     void close();
     qint64 write(const char *data, qint64 len);
+    void renderPeriods();
 
 private Q_SLOTS:
     void userFeed();
@@ -131,16 +148,25 @@ private:
     int m_periodSize;
     int m_bufferSize;
     int m_maxBufferSize;
+    qint64 m_targetLatency;
+    qint64 m_latency;
     QTime m_clockStamp;
     qint64 m_totalTimeValue;
+    mutable qint64 m_presentedUSecs;
     QTimer *m_tickTimer;
-    char *m_audioBuffer;
+    QAtomicInt m_feedPending;
+    QAudio::RenderCallback m_renderCallback;
+    void *m_renderUserData;
+    QByteArray m_renderBuffer;
+    QAtomicInt m_renderedBytes;
+    QAudioStreamStats m_stats;
+    QAudioLoudnessMeter m_loudnessMeter;
     QTime m_timeStamp;
     qint64 m_elapsedTimeOffset;
     bool m_resuming;
     QString m_category;
 
-    qreal m_volume;
+    QAudioHelperInternal::AtomicVolume m_volume;
     pa_sample_spec m_spec;
 };
 
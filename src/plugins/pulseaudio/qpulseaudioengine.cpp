@@ -125,8 +125,13 @@ static void sinkInfoCallback(pa_context *context, const pa_sink_info *info, int
     QAudioFormat format = QPulseAudioInternal::sampleSpecToAudioFormat(info->sample_spec);
 
     QWriteLocker locker(&pulseEngine->m_sinkLock);
+    const bool added = !pulseEngine->m_sinks.contains(info->index);
     pulseEngine->m_preferredFormats.insert(info->name, format);
     pulseEngine->m_sinks.insert(info->index, info->name);
+    locker.unlock();
+
+    if (added)
+        emit pulseEngine->availableDevicesChanged(QAudio::AudioOutput);
 }
 
 static void sourceInfoCallback(pa_context *context, const pa_source_info *info, int isLast, void *userdata)
@@ -161,8 +166,13 @@ static void sourceInfoCallback(pa_context *context, const pa_source_info *info,
     QAudioFormat format = QPulseAudioInternal::sampleSpecToAudioFormat(info->sample_spec);
 
     QWriteLocker locker(&pulseEngine->m_sourceLock);
+    const bool added = !pulseEngine->m_sources.contains(info->index);
     pulseEngine->m_preferredFormats.insert(info->name, format);
     pulseEngine->m_sources.insert(info->index, info->name);
+    locker.unlock();
+
+    if (added)
+        emit pulseEngine->availableDevicesChanged(QAudio::AudioInput);
 }
 
 static void event_cb(pa_context* context, pa_subscription_event_type_t t, uint32_t index, void* userdata)
@@ -211,12 +221,14 @@ static void event_cb(pa_context* context, pa_subscription_event_type_t t, uint32
             pulseEngine->m_preferredFormats.remove(pulseEngine->m_sinks.value(index));
             pulseEngine->m_sinks.remove(index);
             pulseEngine->m_sinkLock.unlock();
+            emit pulseEngine->availableDevicesChanged(QAudio::AudioOutput);
             break;
         case PA_SUBSCRIPTION_EVENT_SOURCE:
             pulseEngine->m_sourceLock.lockForWrite();
             pulseEngine->m_preferredFormats.remove(pulseEngine->m_sources.value(index));
             pulseEngine->m_sources.remove(index);
             pulseEngine->m_sourceLock.unlock();
+            emit pulseEngine->availableDevicesChanged(QAudio::AudioInput);
             break;
         default:
             break;
@@ -96,6 +96,8 @@ public:
 
 Q_SIGNALS:
     void contextFailed();
+    // Emitted from the mainloop thread when a sink or source appears or disappears
+    void availableDevicesChanged(QAudio::Mode mode);
 
 private Q_SLOTS:
     void prepare();
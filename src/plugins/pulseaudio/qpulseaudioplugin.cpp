@@ -51,6 +51,10 @@ QPulseAudioPlugin::QPulseAudioPlugin(QObject *parent)
     : QAudioSystemPlugin(parent)
     , m_pulseEngine(QPulseAudioEngine::instance())
 {
+    // The engine keeps its sink and source lists up to date from server
+    // subscription events; forward those to the thread the plugin lives in.
+    connect(m_pulseEngine, &QPulseAudioEngine::availableDevicesChanged,
+            this, &QAudioSystemPlugin::availableDevicesChanged, Qt::QueuedConnection);
 }
 
 QByteArray QPulseAudioPlugin::defaultDevice(QAudio::Mode mode) const
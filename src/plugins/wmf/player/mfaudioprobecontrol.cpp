@@ -38,10 +38,14 @@
 ****************************************************************************/
 
 #include "mfaudioprobecontrol.h"
+#include <private/qmediaaudioprobecontrol_p.h>
+
+#include <QtCore/qmetaobject.h>
 
 MFAudioProbeControl::MFAudioProbeControl(QObject *parent):
     QMediaAudioProbeControl(parent)
 {
+    QMediaAudioProbeControlPrivate::get(this)->setListenersSupported(true);
 }
 
 MFAudioProbeControl::~MFAudioProbeControl()
@@ -53,9 +57,16 @@ void MFAudioProbeControl::bufferProbed(const char *data, quint32 size, const QAu
     if (!format.isValid())
         return;
 
+    QMediaAudioProbeControlPrivate *d = QMediaAudioProbeControlPrivate::get(this);
+    static const QMetaMethod probedSignal = QMetaMethod::fromSignal(&QMediaAudioProbeControl::audioBufferProbed);
+    const bool deliverBuffers = isSignalConnected(probedSignal);
+    if (!deliverBuffers && !d->hasListeners())
+        return;
+
     QAudioBuffer audioBuffer = QAudioBuffer(QByteArray(data, size), format, startTime);
+    d->probeBuffer(audioBuffer);
 
-    {
+    if (deliverBuffers) {
         QMutexLocker locker(&m_bufferMutex);
         m_pendingBuffer = audioBuffer;
         QMetaObject::invokeMethod(this, "bufferProbed", Qt::QueuedConnection);
@@ -5,6 +5,7 @@ SUBDIRS += \
     qaudiodeviceinfo \
     qaudioinput \
     qaudiooutput \
+    qnullaudio \
     qmediaplayerbackend \
     qcamerabackend \
     qsoundeffect \
@@ -29,6 +29,7 @@
 #include <QtTest/QtTest>
 #include <QDebug>
 #include "qaudiodecoder.h"
+#include "qaudiobatchdecoder.h"
 
 #include "../shared/mediafileselector.h"
 
@@ -58,6 +59,8 @@ private slots:
     void unsupportedFileTest();
     void corruptedFileTest();
     void deviceTest();
+    void batchTest();
+    void rangeTest();
 
 private:
     bool isWavSupported();
@@ -566,6 +569,143 @@ void tst_QAudioDecoderBackend::deviceTest()
     QCOMPARE(d.duration(), qint64(-1));
 }
 
+void tst_QAudioDecoderBackend::batchTest()
+{
+    if (!isWavSupported())
+        QSKIP("Sound format is not supported");
+
+    QAudioDecoder decoder;
+    if (decoder.error() == QAudioDecoder::ServiceMissingError)
+        QSKIP("There is no audio decoding support on this platform.");
+
+    QFileInfo fileInfo(QFINDTESTDATA(TEST_FILE_NAME));
+    QBuffer output;
+    QVERIFY(output.open(QIODevice::WriteOnly));
+
+    QAudioBatchDecoder d;
+    d.setMaxThreadCount(2);
+    QCOMPARE(d.addSource(fileInfo.absoluteFilePath()), 0);
+    QCOMPARE(d.addSource(fileInfo.absoluteFilePath(), &output), 1);
+    QCOMPARE(d.addSource(QFINDTESTDATA(TEST_CORRUPTED_FILE_NAME)), 2);
+    QCOMPARE(d.sourceCount(), 3);
+
+    QSignalSpy progressSpy(&d, SIGNAL(progress(int,qint64,qint64)));
+    QSignalSpy sourceFinishedSpy(&d, SIGNAL(sourceFinished(int)));
+    QSignalSpy finishedSpy(&d, SIGNAL(finished()));
+
+    d.start();
+    QVERIFY(d.isRunning());
+    QVERIFY(d.waitForFinished(10000));
+    QVERIFY(!d.isRunning());
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(sourceFinishedSpy.count(), 3);
+    QVERIFY(!progressSpy.isEmpty());
+
+    // Test file is 44.1K 16bit mono with 44094 samples
+    QCOMPARE(d.error(0), QAudioDecoder::NoError);
+    QVERIFY(!d.isCancelled(0));
+    QCOMPARE(d.format(0).channelCount(), 1);
+    QCOMPARE(d.format(0).sampleRate(), 44100);
+    QCOMPARE(d.format(0).sampleSize(), 16);
+    QCOMPARE(d.data(0).size(), 44094 * 2);
+
+    QCOMPARE(d.error(1), QAudioDecoder::NoError);
+    QVERIFY(d.data(1).isEmpty());
+    QCOMPARE(output.data().size(), 44094 * 2);
+    QCOMPARE(output.data(), d.data(0));
+
+    QVERIFY(d.error(2) != QAudioDecoder::NoError);
+    QVERIFY(d.data(2).isEmpty());
+
+    // Decoding to a requested format
+    QAudioFormat format;
+    format.setChannelCount(2);
+    format.setSampleSize(8);
+    format.setSampleRate(8000);
+    format.setCodec("audio/pcm");
+    format.setSampleType(QAudioFormat::SignedInt);
+
+    d.clear();
+    d.setAudioFormat(format);
+    d.addSource(fileInfo.absoluteFilePath());
+    d.start();
+    QVERIFY(d.waitForFinished(10000));
+    QCOMPARE(d.error(0), QAudioDecoder::NoError);
+    QVERIFY(!d.isCancelled(0));
+    QVERIFY(d.format(0) == format);
+    QVERIFY(qAbs(d.data(0).size() - 16000) < 320);
+
+    // Cancelling from the first progress report, the later sources are skipped
+    d.clear();
+    d.setMaxThreadCount(1);
+    for (int i = 0; i < 3; ++i)
+        d.addSource(fileInfo.absoluteFilePath());
+    connect(&d, &QAudioBatchDecoder::progress, [&d]() { d.cancel(); });
+    sourceFinishedSpy.clear();
+    d.start();
+    QVERIFY(d.waitForFinished(10000));
+    QTRY_COMPARE(sourceFinishedSpy.count(), 3);
+    QVERIFY(d.isCancelled(0) || qAbs(d.data(0).size() - 16000) < 320);
+    for (int i = 1; i < 3; ++i) {
+        QVERIFY(d.isCancelled(i));
+        QCOMPARE(d.error(i), QAudioDecoder::NoError);
+        QVERIFY(d.data(i).isEmpty());
+    }
+}
+
+void tst_QAudioDecoderBackend::rangeTest()
+{
+    if (!isWavSupported())
+        QSKIP("Sound format is not supported");
+
+    QAudioDecoder d;
+    if (d.error() == QAudioDecoder::ServiceMissingError)
+        QSKIP("There is no audio decoding support on this platform.");
+
+    QCOMPARE(d.startPosition(), qint64(0));
+    QCOMPARE(d.endPosition(), qint64(-1));
+
+    d.setStartPosition(200);
+    d.setEndPosition(700);
+    if (d.startPosition() != 200 || d.endPosition() != 700)
+        QSKIP("The backend does not support decoding time ranges.");
+
+    QSignalSpy errorSpy(&d, SIGNAL(error(QAudioDecoder::Error)));
+    QSignalSpy finishedSpy(&d, SIGNAL(finished()));
+
+    QFileInfo fileInfo(QFINDTESTDATA(TEST_FILE_NAME));
+    d.setSourceFilename(fileInfo.absoluteFilePath());
+    d.start();
+
+    qint64 firstStartTime = -1;
+    int sampleCount = 0;
+    while (finishedSpy.isEmpty() || d.bufferAvailable()) {
+        QTRY_VERIFY(d.bufferAvailable() || !finishedSpy.isEmpty());
+        while (d.bufferAvailable()) {
+            const QAudioBuffer buffer = d.read();
+            if (!buffer.isValid())
+                continue;
+            if (firstStartTime < 0)
+                firstStartTime = buffer.startTime();
+            // Trimmed buffers never cross the range boundaries
+            QVERIFY(buffer.startTime() >= 200000 - 23);
+            QVERIFY(buffer.startTime() + buffer.duration() <= 700000 + 23);
+            sampleCount += buffer.sampleCount();
+        }
+    }
+
+    QVERIFY(errorSpy.isEmpty());
+    // Test file is 44.1K 16bit mono, so 500ms are 22050 samples
+    QVERIFY(qAbs(firstStartTime - 200000) < 23);
+    QVERIFY(qAbs(sampleCount - 22050) <= 1);
+
+    // Resetting the range decodes the whole file again
+    d.setStartPosition(0);
+    d.setEndPosition(-1);
+    QCOMPARE(d.startPosition(), qint64(0));
+    QCOMPARE(d.endPosition(), qint64(-1));
+}
+
 QTEST_MAIN(tst_QAudioDecoderBackend)
 
 #include "tst_qaudiodecoderbackend.moc"
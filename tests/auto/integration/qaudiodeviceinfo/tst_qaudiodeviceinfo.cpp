@@ -30,6 +30,7 @@
 #include <QtTest/QtTest>
 #include <QtCore/qlocale.h>
 #include <qaudiodeviceinfo.h>
+#include <qaudiodevicewatcher.h>
 
 #include <QStringList>
 #include <QList>
@@ -61,6 +62,8 @@ private slots:
     void deviceName();
     void defaultConstructor();
     void equalityOperator();
+    void cachedDeviceList();
+    void watcher();
 
 private:
     QAudioDeviceInfo* device;
@@ -242,6 +245,34 @@ void tst_QAudioDeviceInfo::equalityOperator()
     // XXX Perhaps each available device should not be equal to any other
 }
 
+void tst_QAudioDeviceInfo::cachedDeviceList()
+{
+    // Repeated enumeration is served from the backend cache and must be stable
+    const QList<QAudioDeviceInfo> outputs = QAudioDeviceInfo::availableDevices(QAudio::AudioOutput);
+    for (int i = 0; i < 10; ++i)
+        QCOMPARE(QAudioDeviceInfo::availableDevices(QAudio::AudioOutput), outputs);
+
+    const QList<QAudioDeviceInfo> inputs = QAudioDeviceInfo::availableDevices(QAudio::AudioInput);
+    QCOMPARE(QAudioDeviceInfo::availableDevices(QAudio::AudioInput), inputs);
+}
+
+void tst_QAudioDeviceInfo::watcher()
+{
+    QAudioDeviceWatcher watcher;
+    QSignalSpy addedSpy(&watcher, SIGNAL(deviceAdded(QAudioDeviceInfo)));
+    QSignalSpy removedSpy(&watcher, SIGNAL(deviceRemoved(QAudioDeviceInfo)));
+
+    QCOMPARE(watcher.availableDevices(QAudio::AudioOutput),
+             QAudioDeviceInfo::availableDevices(QAudio::AudioOutput));
+    QCOMPARE(watcher.availableDevices(QAudio::AudioInput),
+             QAudioDeviceInfo::availableDevices(QAudio::AudioInput));
+
+    // Nothing is plugged in or out while the test runs
+    QTest::qWait(500);
+    QCOMPARE(addedSpy.count(), 0);
+    QCOMPARE(removedSpy.count(), 0);
+}
+
 QTEST_MAIN(tst_QAudioDeviceInfo)
 
 #include "tst_qaudiodeviceinfo.moc"
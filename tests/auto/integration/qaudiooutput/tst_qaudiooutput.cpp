@@ -74,6 +74,8 @@ private slots:
     void bufferSize_data();
     void bufferSize();
 
+    void targetLatency();
+
     void notifyInterval_data();
     void notifyInterval();
 
@@ -86,6 +88,14 @@ private slots:
     void pull_data(){generate_audiofile_testrows();}
     void pull();
 
+    void presentedUSecs_data(){generate_audiofile_testrows();}
+    void presentedUSecs();
+
+    void statistics();
+    void pullStatistics();
+
+    void renderCallback();
+
     void pullSuspendResume_data(){generate_audiofile_testrows();}
     void pullSuspendResume();
 
@@ -366,6 +376,27 @@ void tst_QAudioOutput::bufferSize()
              QString("bufferSize: requested=%1, actual=%2").arg(bufferSize).arg(audioOutput.bufferSize()).toLocal8Bit().constData());
 }
 
+void tst_QAudioOutput::targetLatency()
+{
+    QAudioOutput audioOutput(audioDevice.preferredFormat(), this);
+
+    QCOMPARE(audioOutput.targetLatency(), qint64(0));
+
+    audioOutput.setTargetLatency(20000);
+    if (audioOutput.targetLatency() == 0)
+        QSKIP("Backend does not support requesting a latency");
+    QCOMPARE(audioOutput.targetLatency(), qint64(20000));
+
+    QIODevice *feed = audioOutput.start();
+    QVERIFY(feed);
+    QVERIFY2(audioOutput.latency() > 0,
+             QString("latency() after start() was %1").arg(audioOutput.latency()).toLocal8Bit().constData());
+    audioOutput.stop();
+
+    audioOutput.setTargetLatency(0);
+    QCOMPARE(audioOutput.targetLatency(), qint64(0));
+}
+
 void tst_QAudioOutput::notifyInterval_data()
 {
     QTest::addColumn<int>("interval");
@@ -547,6 +578,143 @@ void tst_QAudioOutput::pull()
     audioFile->close();
 }
 
+void tst_QAudioOutput::presentedUSecs()
+{
+    QFETCH(FilePtr, audioFile);
+    QFETCH(QAudioFormat, audioFormat);
+
+    QAudioOutput audioOutput(audioFormat, this);
+    audioOutput.setVolume(0.1f);
+
+    QCOMPARE(audioOutput.presentedUSecs(), qint64(0));
+
+    audioFile->close();
+    audioFile->open(QIODevice::ReadOnly);
+    audioFile->seek(WavHeader::headerLength());
+
+    audioOutput.start(audioFile.data());
+    QTRY_VERIFY(audioOutput.state() == QAudio::ActiveState);
+
+    // The clock must never go backwards and never run ahead of the data written
+    qint64 previous = 0;
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 500) {
+        const qint64 presented = audioOutput.presentedUSecs();
+        QVERIFY2(presented >= previous,
+                 QString("presentedUSecs() went back from %1 to %2").arg(previous).arg(presented).toLocal8Bit().constData());
+        QVERIFY(presented <= audioOutput.processedUSecs());
+        previous = presented;
+        QTest::qWait(16);
+    }
+    QVERIFY2(previous > 0, "presentedUSecs() did not advance during playback");
+
+    audioOutput.stop();
+    audioFile->close();
+}
+
+void tst_QAudioOutput::statistics()
+{
+    QAudioOutput audioOutput(audioDevice.preferredFormat(), this);
+    audioOutput.setVolume(0.1f);
+
+    QIODevice *feed = audioOutput.start();
+    QVERIFY(feed);
+
+    const QVariantMap initial = audioOutput.statistics();
+    if (initial.isEmpty())
+        QSKIP("Backend does not collect statistics");
+    QCOMPARE(initial.value(QStringLiteral("bytes")).toLongLong(), qint64(0));
+
+    QByteArray silence(audioOutput.periodSize(), 0);
+    for (int i = 0; i < 10; ++i) {
+        QTRY_VERIFY(audioOutput.bytesFree() >= silence.size());
+        QCOMPARE(feed->write(silence), qint64(silence.size()));
+    }
+
+    const QVariantMap stats = audioOutput.statistics();
+    QCOMPARE(stats.value(QStringLiteral("bytes")).toLongLong(), qint64(10 * silence.size()));
+    QVERIFY(stats.contains(QStringLiteral("underruns")));
+    QVERIFY(stats.contains(QStringLiteral("overruns")));
+
+    const QVariantMap duration = stats.value(QStringLiteral("feedDurationUs")).toMap();
+    QVERIFY(duration.value(QStringLiteral("count")).toLongLong() >= 10);
+    const QVariantMap interval = stats.value(QStringLiteral("feedIntervalUs")).toMap();
+    QCOMPARE(interval.value(QStringLiteral("count")).toLongLong(),
+             duration.value(QStringLiteral("count")).toLongLong() - 1);
+
+    audioOutput.stop();
+}
+
+void tst_QAudioOutput::pullStatistics()
+{
+    const QAudioFormat format = testFormats.first();
+    const qint64 length = format.bytesForFrames(format.framesForDuration(1000000));
+    createSineWaveData(format, length);
+
+    QAudioOutput audioOutput(format, this);
+    audioOutput.setVolume(0.1f);
+
+    // Everything pulled from the source has to reach the device
+    audioOutput.start(m_buffer.data());
+    QTRY_VERIFY2(m_buffer->atEnd(), "didn't play to EOF");
+    QTRY_COMPARE(audioOutput.state(), QAudio::IdleState);
+    QCOMPARE(audioOutput.processedUSecs(), qint64(format.durationForBytes(length)));
+
+    const QVariantMap stats = audioOutput.statistics();
+    if (!stats.isEmpty())
+        QCOMPARE(stats.value(QStringLiteral("bytes")).toLongLong(), length);
+
+    audioOutput.stop();
+    QCOMPARE(audioOutput.error(), QAudio::NoError);
+}
+
+struct RenderState
+{
+    QAtomicInt calls;
+    QAtomicInt wrongSize;
+    QAtomicInt periodSize;
+};
+
+static void renderSilence(char *data, int len, void *userData)
+{
+    RenderState *state = static_cast<RenderState *>(userData);
+    if (len != state->periodSize.load())
+        state->wrongSize.ref();
+    memset(data, 0, len);
+    state->calls.ref();
+}
+
+void tst_QAudioOutput::renderCallback()
+{
+    QAudioOutput audioOutput(audioDevice.preferredFormat(), this);
+
+    RenderState state;
+
+    // The period size is only known once the device is open
+    audioOutput.start(renderSilence, &state);
+    QCOMPARE(audioOutput.error(), QAudio::NoError);
+    QCOMPARE(audioOutput.state(), QAudio::ActiveState);
+    state.periodSize.store(audioOutput.periodSize());
+    state.wrongSize.store(0);
+
+    QTRY_VERIFY(state.calls.load() > 5);
+    QCOMPARE(state.wrongSize.load(), 0);
+    QTRY_VERIFY(audioOutput.processedUSecs() > 0);
+
+    audioOutput.suspend();
+    QCOMPARE(audioOutput.state(), QAudio::SuspendedState);
+    audioOutput.resume();
+    QCOMPARE(audioOutput.state(), QAudio::ActiveState);
+
+    // No more calls once stop() returned
+    audioOutput.stop();
+    QCOMPARE(audioOutput.state(), QAudio::StoppedState);
+    const int calls = state.calls.load();
+    QTest::qWait(100);
+    QCOMPARE(state.calls.load(), calls);
+}
+
 void tst_QAudioOutput::pullSuspendResume()
 {
 #ifdef Q_OS_LINUX
@@ -0,0 +1,138 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+import QtQuick 2.0
+import QtAudioEngine 1.1
+import QtTest 1.0
+
+Item {
+    id: top
+
+    AudioEngine {
+        id: engine
+
+        AudioSample {
+            name: "tone"
+            source: "../../../integration/qsoundeffect/test.wav"
+            preloaded: true
+        }
+
+        Sound {
+            name: "low"
+            PlayVariation {
+                sample: "tone"
+                looping: true
+            }
+        }
+
+        Sound {
+            name: "high"
+            priority: 1
+            PlayVariation {
+                sample: "tone"
+                looping: true
+            }
+        }
+    }
+
+    SoundInstance { id: first; engine: engine }
+    SoundInstance { id: second; engine: engine }
+    SoundInstance { id: third; engine: engine }
+
+    TestCase {
+        name: "AudioEngine"
+
+        function initTestCase() {
+            // No limit unless asked for one
+            compare(engine.maxVoices, 0)
+            tryCompare(engine, "loading", false)
+            engine.maxVoices = 2
+        }
+
+        function init() {
+            first.gain = 1
+            second.gain = 1
+            third.gain = 1
+        }
+
+        function cleanup() {
+            first.stop()
+            second.stop()
+            third.stop()
+        }
+
+        function start(instance, sound) {
+            instance.sound = sound
+            instance.play()
+        }
+
+        function test_stealsLowestPriority() {
+            // Priority wins over loudness
+            first.gain = 0.1
+            start(first, "high")
+            start(second, "low")
+            tryCompare(second, "state", SoundInstance.PlayingState)
+            start(third, "low")
+            tryCompare(third, "state", SoundInstance.PlayingState)
+            compare(second.state, SoundInstance.StoppedState)
+            compare(first.state, SoundInstance.PlayingState)
+        }
+
+        function test_stealsQuietest() {
+            start(first, "low")
+            second.gain = 0.2
+            start(second, "low")
+            tryCompare(second, "state", SoundInstance.PlayingState)
+            start(third, "low")
+            tryCompare(third, "state", SoundInstance.PlayingState)
+            compare(second.state, SoundInstance.StoppedState)
+            compare(first.state, SoundInstance.PlayingState)
+        }
+
+        function test_stealsOldest() {
+            start(first, "low")
+            start(second, "low")
+            tryCompare(second, "state", SoundInstance.PlayingState)
+            start(third, "low")
+            tryCompare(third, "state", SoundInstance.PlayingState)
+            compare(first.state, SoundInstance.StoppedState)
+            compare(second.state, SoundInstance.PlayingState)
+        }
+
+        function test_refusesLowerPriority() {
+            start(first, "high")
+            start(second, "high")
+            tryCompare(second, "state", SoundInstance.PlayingState)
+            start(third, "low")
+            wait(100)
+            compare(third.state, SoundInstance.StoppedState)
+            compare(first.state, SoundInstance.PlayingState)
+            compare(second.state, SoundInstance.PlayingState)
+        }
+    }
+}
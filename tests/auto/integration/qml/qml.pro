@@ -4,7 +4,7 @@ CONFIG += qmltestcase
 SOURCES += tst_qml.cpp
 
 
-importFiles.files = soundeffect
+importFiles.files = soundeffect audioengine
 
 importFiles.path = .
 DEPLOYMENT += importFiles
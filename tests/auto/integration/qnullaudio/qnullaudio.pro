@@ -0,0 +1,15 @@
+TARGET = tst_qnullaudio
+
+QT += core multimedia-private testlib
+
+# Runs against the null audio plugin, no audio hardware is needed
+CONFIG += testcase
+
+SOURCES += tst_qnullaudio.cpp
+
+unix:!mac {
+    qtConfig(pulseaudio) {
+        # QSoundEffect talks to PulseAudio directly there
+        DEFINES += QT_SOUNDEFFECT_PULSE
+    }
+}
@@ -0,0 +1,412 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/plugins/null
+
+#include <QtTest/QtTest>
+#include <QtCore/QBuffer>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/qendian.h>
+
+#include <qaudioinput.h>
+#include <qaudiooutput.h>
+#include <qaudiodeviceinfo.h>
+#include <qaudioformat.h>
+#include <qsoundeffect.h>
+
+// Plays and records through the virtual devices of the null plugin, which
+// record what they play and inject xruns as configured by the environment
+class tst_QNullAudio : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void devicesHidden();
+    void outputRecording();
+    void outputXruns();
+    void offlineRendering();
+    void inputSignal();
+    void inputXruns();
+    void soundEffect();
+
+private:
+    QStringList captureFiles() const;
+
+    static QAudioFormat audioFormat(int channels = 2);
+    static QByteArray constantSignal(const QAudioFormat &format, int milliSeconds);
+    static qint64 framesWithSignal(const QAudioFormat &format, const QByteArray &data);
+    static bool readWave(const QString &fileName, QAudioFormat *format, QByteArray *data);
+    static bool writeWave(const QString &fileName, const QAudioFormat &format, const QByteArray &data);
+
+    QScopedPointer<QTemporaryDir> m_captureDir;
+};
+
+void tst_QNullAudio::initTestCase()
+{
+    qputenv("QT_AUDIO_DEFAULT_REALM", "null");
+
+    if (QAudioDeviceInfo::defaultOutputDevice().deviceName() != QLatin1String("virtual"))
+        QSKIP("The null audio plugin is not available");
+}
+
+void tst_QNullAudio::init()
+{
+    m_captureDir.reset(new QTemporaryDir);
+    QVERIFY(m_captureDir->isValid());
+    qputenv("QT_NULL_AUDIO_CAPTURE_DIR", QFile::encodeName(m_captureDir->path()));
+}
+
+void tst_QNullAudio::cleanup()
+{
+    qunsetenv("QT_NULL_AUDIO_CAPTURE_DIR");
+    qunsetenv("QT_NULL_AUDIO_LATENCY_MS");
+    qunsetenv("QT_NULL_AUDIO_XRUN_INTERVAL_MS");
+    qunsetenv("QT_NULL_AUDIO_OFFLINE_FILE");
+    m_captureDir.reset();
+}
+
+QStringList tst_QNullAudio::captureFiles() const
+{
+    const QDir dir(m_captureDir->path());
+    QStringList files;
+    const QStringList names = dir.entryList(QStringList() << QStringLiteral("*.wav"), QDir::Files, QDir::Name);
+    for (const QString &name : names)
+        files << dir.filePath(name);
+    return files;
+}
+
+QAudioFormat tst_QNullAudio::audioFormat(int channels)
+{
+    QAudioFormat format;
+    format.setSampleRate(44100);
+    format.setChannelCount(channels);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec(QStringLiteral("audio/pcm"));
+    return format;
+}
+
+QByteArray tst_QNullAudio::constantSignal(const QAudioFormat &format, int milliSeconds)
+{
+    // A level that is never silence, so every frame that got lost is counted
+    const int samples = format.framesForDuration(qint64(milliSeconds) * 1000) * format.channelCount();
+    QByteArray data(samples * 2, Qt::Uninitialized);
+    for (int i = 0; i < samples; ++i)
+        qToLittleEndian<qint16>(4000, data.data() + 2 * i);
+    return data;
+}
+
+qint64 tst_QNullAudio::framesWithSignal(const QAudioFormat &format, const QByteArray &data)
+{
+    const int frameBytes = format.bytesPerFrame();
+    qint64 frames = 0;
+    for (int offset = 0; offset + frameBytes <= data.size(); offset += frameBytes) {
+        for (int i = 0; i < frameBytes; ++i) {
+            if (data.at(offset + i) != 0) {
+                ++frames;
+                break;
+            }
+        }
+    }
+    return frames;
+}
+
+bool tst_QNullAudio::readWave(const QString &fileName, QAudioFormat *format, QByteArray *data)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const QByteArray contents = file.readAll();
+    if (contents.size() < 12 || !contents.startsWith("RIFF") || contents.mid(8, 4) != "WAVE")
+        return false;
+
+    bool haveFormat = false;
+    int offset = 12;
+    while (offset + 8 <= contents.size()) {
+        const QByteArray id = contents.mid(offset, 4);
+        const quint32 size = qFromLittleEndian<quint32>(contents.constData() + offset + 4);
+        const char *chunk = contents.constData() + offset + 8;
+        if (id == "fmt " && size >= 16) {
+            *format = audioFormat(qFromLittleEndian<quint16>(chunk + 2));
+            format->setSampleRate(int(qFromLittleEndian<quint32>(chunk + 4)));
+            format->setSampleSize(qFromLittleEndian<quint16>(chunk + 14));
+            haveFormat = true;
+        } else if (id == "data") {
+            *data = contents.mid(offset + 8, int(size));
+            return haveFormat;
+        }
+        offset += 8 + int(size) + (size & 1);
+    }
+    return false;
+}
+
+bool tst_QNullAudio::writeWave(const QString &fileName, const QAudioFormat &format, const QByteArray &data)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.writeRawData("RIFF", 4);
+    out << quint32(36 + data.size());
+    out.writeRawData("WAVEfmt ", 8);
+    out << quint32(16) << quint16(1) << quint16(format.channelCount())
+        << quint32(format.sampleRate()) << quint32(format.bytesForDuration(1000000))
+        << quint16(format.bytesPerFrame()) << quint16(format.sampleSize());
+    out.writeRawData("data", 4);
+    out << quint32(data.size());
+    out.writeRawData(data.constData(), data.size());
+    return out.status() == QDataStream::Ok;
+}
+
+void tst_QNullAudio::devicesHidden()
+{
+    // Only the environment of a test run makes the virtual devices visible
+    const QByteArray realm = qgetenv("QT_AUDIO_DEFAULT_REALM");
+    const QByteArray captureDir = qgetenv("QT_NULL_AUDIO_CAPTURE_DIR");
+    qunsetenv("QT_AUDIO_DEFAULT_REALM");
+    qunsetenv("QT_NULL_AUDIO_CAPTURE_DIR");
+
+    const QList<QAudioDeviceInfo> hidden = QAudioDeviceInfo::availableDevices(QAudio::AudioOutput);
+
+    qputenv("QT_AUDIO_DEFAULT_REALM", realm);
+    qputenv("QT_NULL_AUDIO_CAPTURE_DIR", captureDir);
+
+    for (const QAudioDeviceInfo &device : hidden) {
+        QVERIFY(device.deviceName() != QLatin1String("virtual"));
+        QVERIFY(device.deviceName() != QLatin1String("offline"));
+    }
+
+    bool listed = false;
+    const QList<QAudioDeviceInfo> devices = QAudioDeviceInfo::availableDevices(QAudio::AudioOutput);
+    for (const QAudioDeviceInfo &device : devices)
+        listed |= device.deviceName() == QLatin1String("virtual");
+    QVERIFY(listed);
+}
+
+void tst_QNullAudio::outputRecording()
+{
+    // A device buffer longer than the signal takes it all with the first
+    // period, so a busy machine can't cause underruns
+    qputenv("QT_NULL_AUDIO_LATENCY_MS", "1000");
+
+    const QAudioFormat format = audioFormat();
+    QByteArray signal = constantSignal(format, 300);
+    QBuffer source(&signal);
+    QVERIFY(source.open(QIODevice::ReadOnly));
+
+    QAudioOutput output(format);
+    output.start(&source);
+    QCOMPARE(output.state(), QAudio::ActiveState);
+    QTRY_COMPARE_WITH_TIMEOUT(output.state(), QAudio::IdleState, 5000);
+    // Idle leaves less than a period to play
+    QTest::qWait(100);
+    output.stop();
+
+    const QStringList files = captureFiles();
+    QCOMPARE(files.size(), 1);
+
+    QAudioFormat recordedFormat;
+    QByteArray recorded;
+    QVERIFY(readWave(files.first(), &recordedFormat, &recorded));
+    QCOMPARE(recordedFormat, format);
+
+    // The device plays silence until the first period is written, then the
+    // whole signal without a gap
+    const int start = recorded.indexOf(signal);
+    QVERIFY(start >= 0);
+    QCOMPARE(start % format.bytesPerFrame(), 0);
+    QCOMPARE(framesWithSignal(format, recorded.left(start)), qint64(0));
+    QCOMPARE(framesWithSignal(format, recorded), qint64(signal.size() / format.bytesPerFrame()));
+}
+
+void tst_QNullAudio::outputXruns()
+{
+    qputenv("QT_NULL_AUDIO_XRUN_INTERVAL_MS", "100");
+
+    const QAudioFormat format = audioFormat();
+    QByteArray signal = constantSignal(format, 1000);
+    QBuffer source(&signal);
+    QVERIFY(source.open(QIODevice::ReadOnly));
+
+    QAudioOutput output(format);
+    output.start(&source);
+    QTRY_COMPARE_WITH_TIMEOUT(output.state(), QAudio::IdleState, 10000);
+    QTest::qWait(100);
+
+    // Every xrun is counted and loses the audio queued at that point
+    const int underruns = output.statistics().value(QStringLiteral("underruns")).toInt();
+    QVERIFY2(underruns >= 5, QByteArray::number(underruns));
+    output.stop();
+
+    const QStringList files = captureFiles();
+    QCOMPARE(files.size(), 1);
+
+    QAudioFormat recordedFormat;
+    QByteArray recorded;
+    QVERIFY(readWave(files.first(), &recordedFormat, &recorded));
+    const qint64 played = framesWithSignal(format, recorded);
+    QVERIFY(played > 0);
+    QVERIFY(played < signal.size() / format.bytesPerFrame());
+}
+
+void tst_QNullAudio::offlineRendering()
+{
+    const QString fileName = QDir(m_captureDir->path()).filePath(QStringLiteral("offline.wav"));
+    qputenv("QT_NULL_AUDIO_OFFLINE_FILE", QFile::encodeName(fileName));
+    QCOMPARE(QAudioDeviceInfo::defaultOutputDevice().deviceName(), QStringLiteral("offline"));
+
+    const QAudioFormat format = audioFormat();
+    const QByteArray signal = constantSignal(format, 5000);
+    QAudioOutput output(format);
+
+    // The offline device has no clock, five seconds render in a fraction of that
+    QBuffer source;
+    source.setData(signal);
+    QVERIFY(source.open(QIODevice::ReadOnly));
+    QElapsedTimer timer;
+    timer.start();
+    output.start(&source);
+    QTRY_VERIFY(source.atEnd());
+    QTRY_COMPARE(output.state(), QAudio::IdleState);
+    QVERIFY2(timer.elapsed() < 2500, QByteArray::number(timer.elapsed()));
+    QCOMPARE(output.processedUSecs(), qint64(5000000));
+    output.stop();
+
+    QAudioFormat recordedFormat;
+    QByteArray recorded;
+    QVERIFY(readWave(fileName, &recordedFormat, &recorded));
+    QCOMPARE(recordedFormat, format);
+    QCOMPARE(recorded.size(), signal.size());
+    QVERIFY(recorded == signal);
+    QCOMPARE(QFileInfo(fileName).size(), qint64(44 + signal.size()));
+
+    // In push mode the clock follows every write, the file starts over
+    const QByteArray tail = constantSignal(format, 1000);
+    QIODevice *feed = output.start();
+    QVERIFY(feed);
+    const int chunk = format.bytesForDuration(100000);
+    qint64 written = 0;
+    while (written < tail.size()) {
+        QCOMPARE(feed->write(tail.constData() + written, chunk), qint64(chunk));
+        written += chunk;
+        QCOMPARE(output.processedUSecs(), format.durationForBytes(int(written)));
+    }
+    output.stop();
+
+    QVERIFY(readWave(fileName, &recordedFormat, &recorded));
+    QVERIFY(recorded == tail);
+}
+
+void tst_QNullAudio::inputSignal()
+{
+    const QAudioFormat format = audioFormat(1);
+    QAudioInput input(format);
+    QIODevice *device = input.start();
+    QVERIFY(device);
+
+    QByteArray captured;
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 300) {
+        QTest::qWait(20);
+        captured += device->readAll();
+    }
+    input.stop();
+
+    // The default signal is a sine, hardly any sample is zero
+    QVERIFY(captured.size() >= format.bytesForDuration(100000));
+    QVERIFY(framesWithSignal(format, captured) > captured.size() / format.bytesPerFrame() / 2);
+}
+
+void tst_QNullAudio::inputXruns()
+{
+    qputenv("QT_NULL_AUDIO_XRUN_INTERVAL_MS", "100");
+
+    QAudioInput input(audioFormat(1));
+    QIODevice *device = input.start();
+    QVERIFY(device);
+
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 600) {
+        QTest::qWait(20);
+        device->readAll();
+    }
+
+    const int overruns = input.statistics().value(QStringLiteral("overruns")).toInt();
+    QVERIFY2(overruns >= 3, QByteArray::number(overruns));
+    input.stop();
+}
+
+void tst_QNullAudio::soundEffect()
+{
+#ifdef QT_SOUNDEFFECT_PULSE
+    QSKIP("QSoundEffect plays through PulseAudio directly on this platform");
+#endif
+    qputenv("QT_NULL_AUDIO_LATENCY_MS", "1000");
+
+    const QAudioFormat format = audioFormat();
+    const QByteArray signal = constantSignal(format, 200);
+    QTemporaryDir sourceDir;
+    QVERIFY(sourceDir.isValid());
+    const QString fileName = QDir(sourceDir.path()).filePath(QStringLiteral("signal.wav"));
+    QVERIFY(writeWave(fileName, format, signal));
+
+    {
+        QSoundEffect effect;
+        effect.setSource(QUrl::fromLocalFile(fileName));
+        QTRY_COMPARE(effect.status(), QSoundEffect::Ready);
+        effect.play();
+        QTRY_VERIFY(effect.isPlaying());
+        QTRY_VERIFY_WITH_TIMEOUT(!effect.isPlaying(), 5000);
+        QTest::qWait(100);
+    }
+
+    const QStringList files = captureFiles();
+    QCOMPARE(files.size(), 1);
+
+    QAudioFormat recordedFormat;
+    QByteArray recorded;
+    QVERIFY(readWave(files.first(), &recordedFormat, &recorded));
+    QVERIFY(recorded.indexOf(signal) >= 0);
+    QCOMPARE(framesWithSignal(format, recorded), qint64(signal.size() / format.bytesPerFrame()));
+}
+
+QTEST_MAIN(tst_QNullAudio)
+
+#include "tst_qnullaudio.moc"
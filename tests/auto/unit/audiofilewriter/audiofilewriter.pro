@@ -0,0 +1,19 @@
+CONFIG += testcase
+TARGET = tst_audiofilewriter
+
+QT += multimedia-private testlib
+
+HEADERS += \
+    ../../../../src/plugins/audiocapture/audiofilewriter.h
+
+SOURCES += \
+    tst_audiofilewriter.cpp \
+    ../../../../src/plugins/audiocapture/audiofilewriter.cpp
+
+qtConfig(flac) {
+    QMAKE_USE += flac
+    HEADERS += ../../../../src/plugins/audiocapture/audioflacencoder.h
+    SOURCES += ../../../../src/plugins/audiocapture/audioflacencoder.cpp
+}
+
+INCLUDEPATH += ../../../../src/plugins/audiocapture
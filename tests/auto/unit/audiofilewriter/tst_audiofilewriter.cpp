@@ -0,0 +1,261 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+//TESTED_COMPONENT=src/plugins/audiocapture
+
+#include <QtTest/QtTest>
+
+#include "audiofilewriter.h"
+
+QT_USE_NAMESPACE
+
+static QAudioFormat pcmFormat(int sampleSize, QAudioFormat::SampleType sampleType, int channels)
+{
+    QAudioFormat format;
+    format.setCodec(QStringLiteral("audio/pcm"));
+    format.setSampleRate(8000);
+    format.setChannelCount(channels);
+    format.setSampleSize(sampleSize);
+    format.setSampleType(sampleType);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    return format;
+}
+
+static QByteArray testData(int bytes)
+{
+    QByteArray data(bytes, Qt::Uninitialized);
+    for (int i = 0; i < bytes; ++i)
+        data[i] = char(i * 7 + 3);
+    return data;
+}
+
+static quint16 u16(const QByteArray &file, int offset)
+{
+    return qFromLittleEndian<quint16>(file.constData() + offset);
+}
+
+static quint32 u32(const QByteArray &file, int offset)
+{
+    return qFromLittleEndian<quint32>(file.constData() + offset);
+}
+
+static quint64 u64(const QByteArray &file, int offset)
+{
+    return qFromLittleEndian<quint64>(file.constData() + offset);
+}
+
+class tst_AudioFileWriter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void headerAtCheckpoint_data();
+    void headerAtCheckpoint();
+    void finalSizes_data();
+    void finalSizes();
+    void rf64Overflow_data();
+    void rf64Overflow();
+
+private:
+    void formatData();
+    QByteArray readFile() const;
+    void verifyFmt(const QByteArray &file, const QAudioFormat &format);
+
+    QTemporaryDir m_dir;
+    QString m_fileName;
+};
+
+void tst_AudioFileWriter::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    m_fileName = m_dir.filePath(QStringLiteral("recording.wav"));
+}
+
+void tst_AudioFileWriter::formatData()
+{
+    QTest::addColumn<QAudioFormat>("format");
+    QTest::addColumn<int>("headerSize");
+
+    QTest::newRow("pcm16") << pcmFormat(16, QAudioFormat::SignedInt, 2) << 80;
+    QTest::newRow("float32") << pcmFormat(32, QAudioFormat::Float, 2) << 94;
+}
+
+QByteArray tst_AudioFileWriter::readFile() const
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll();
+}
+
+void tst_AudioFileWriter::verifyFmt(const QByteArray &file, const QAudioFormat &format)
+{
+    const bool isFloat = format.sampleType() == QAudioFormat::Float;
+
+    QCOMPARE(file.mid(48, 4), QByteArray("fmt "));
+    QCOMPARE(u32(file, 52), quint32(isFloat ? 18 : 16));
+    QCOMPARE(u16(file, 56), quint16(isFloat ? 3 : 1));
+    QCOMPARE(u16(file, 58), quint16(format.channelCount()));
+    QCOMPARE(u32(file, 60), quint32(format.sampleRate()));
+    QCOMPARE(u32(file, 64), quint32(format.sampleRate() * format.bytesPerFrame()));
+    QCOMPARE(u16(file, 68), quint16(format.bytesPerFrame()));
+    QCOMPARE(u16(file, 70), quint16(format.sampleSize()));
+    if (isFloat) {
+        QCOMPARE(u16(file, 72), quint16(0));
+        QCOMPARE(file.mid(74, 4), QByteArray("fact"));
+        QCOMPARE(u32(file, 78), quint32(4));
+    }
+}
+
+void tst_AudioFileWriter::headerAtCheckpoint_data()
+{
+    formatData();
+}
+
+void tst_AudioFileWriter::headerAtCheckpoint()
+{
+    QFETCH(QAudioFormat, format);
+    QFETCH(int, headerSize);
+
+    AudioFileWriter writer;
+    writer.setCheckpointInterval(20);
+    QVERIFY(writer.open(m_fileName, format, AudioFileWriter::WavContainer));
+
+    // Far less than a block, only a checkpoint gets it to the disk
+    const QByteArray data = testData(format.bytesPerFrame() * 100);
+    QCOMPARE(writer.write(data.constData(), data.size()), qint64(data.size()));
+
+    QTRY_COMPARE(u32(readFile(), headerSize - 4), quint32(data.size()));
+
+    const QByteArray file = readFile();
+    QCOMPARE(file.size(), headerSize + data.size());
+    QCOMPARE(file.left(4), QByteArray("RIFF"));
+    QCOMPARE(u32(file, 4), quint32(file.size() - 8));
+    QCOMPARE(file.mid(8, 4), QByteArray("WAVE"));
+    QCOMPARE(file.mid(12, 4), QByteArray("JUNK"));
+    QCOMPARE(u32(file, 16), quint32(28));
+    verifyFmt(file, format);
+    if (format.sampleType() == QAudioFormat::Float)
+        QCOMPARE(u32(file, 82), quint32(100));
+    QCOMPARE(file.mid(headerSize - 8, 4), QByteArray("data"));
+    QCOMPARE(file.mid(headerSize), data);
+
+    writer.close();
+}
+
+void tst_AudioFileWriter::finalSizes_data()
+{
+    QTest::addColumn<QAudioFormat>("format");
+    QTest::addColumn<int>("headerSize");
+    QTest::addColumn<int>("bytes");
+
+    QTest::newRow("pcm16") << pcmFormat(16, QAudioFormat::SignedInt, 2) << 80 << 4 * 1000;
+    QTest::newRow("float32") << pcmFormat(32, QAudioFormat::Float, 2) << 94 << 8 * 1000;
+    // The data chunk is padded to an even size, its size field is not
+    QTest::newRow("pcm8-odd") << pcmFormat(8, QAudioFormat::UnSignedInt, 1) << 80 << 999;
+}
+
+void tst_AudioFileWriter::finalSizes()
+{
+    QFETCH(QAudioFormat, format);
+    QFETCH(int, headerSize);
+    QFETCH(int, bytes);
+
+    const QByteArray data = testData(bytes);
+    {
+        AudioFileWriter writer;
+        QVERIFY(writer.open(m_fileName, format, AudioFileWriter::WavContainer));
+        // Uneven writes, as a capture device delivers them
+        for (int offset = 0; offset < data.size(); offset += 333)
+            writer.write(data.constData() + offset, qMin(333, data.size() - offset));
+        writer.close();
+        QVERIFY(writer.errorString().isEmpty());
+    }
+
+    const QByteArray file = readFile();
+    QCOMPARE(file.size(), headerSize + bytes + bytes % 2);
+    QCOMPARE(file.left(4), QByteArray("RIFF"));
+    QCOMPARE(u32(file, 4), quint32(file.size() - 8));
+    verifyFmt(file, format);
+    if (format.sampleType() == QAudioFormat::Float)
+        QCOMPARE(u32(file, 82), quint32(bytes / format.bytesPerFrame()));
+    QCOMPARE(file.mid(headerSize - 8, 4), QByteArray("data"));
+    QCOMPARE(u32(file, headerSize - 4), quint32(bytes));
+    QCOMPARE(file.mid(headerSize, bytes), data);
+}
+
+void tst_AudioFileWriter::rf64Overflow_data()
+{
+    formatData();
+}
+
+void tst_AudioFileWriter::rf64Overflow()
+{
+    QFETCH(QAudioFormat, format);
+    QFETCH(int, headerSize);
+
+    const QByteArray data = testData(1600);
+
+    AudioFileWriter writer;
+    writer.setCheckpointInterval(20);
+    writer.setSizeLimit(1000);
+    QVERIFY(writer.open(m_fileName, format, AudioFileWriter::WavContainer));
+
+    // Below the limit it is a plain RIFF file
+    writer.write(data.constData(), 800);
+    QTRY_COMPARE(u32(readFile(), headerSize - 4), quint32(800));
+    QCOMPARE(readFile().left(4), QByteArray("RIFF"));
+
+    writer.write(data.constData() + 800, 800);
+    writer.close();
+
+    // The JUNK chunk turned into ds64, the data stayed in place
+    const QByteArray file = readFile();
+    const quint64 frames = data.size() / format.bytesPerFrame();
+    QCOMPARE(file.size(), headerSize + data.size());
+    QCOMPARE(file.left(4), QByteArray("RF64"));
+    QCOMPARE(u32(file, 4), 0xFFFFFFFFu);
+    QCOMPARE(file.mid(12, 4), QByteArray("ds64"));
+    QCOMPARE(u32(file, 16), quint32(28));
+    QCOMPARE(u64(file, 20), quint64(file.size() - 8));
+    QCOMPARE(u64(file, 28), quint64(data.size()));
+    QCOMPARE(u64(file, 36), frames);
+    verifyFmt(file, format);
+    if (format.sampleType() == QAudioFormat::Float)
+        QCOMPARE(u32(file, 82), 0xFFFFFFFFu);
+    QCOMPARE(file.mid(headerSize - 8, 4), QByteArray("data"));
+    QCOMPARE(u32(file, headerSize - 4), 0xFFFFFFFFu);
+    QCOMPARE(file.mid(headerSize), data);
+}
+
+QTEST_GUILESS_MAIN(tst_AudioFileWriter)
+
+#include "tst_audiofilewriter.moc"
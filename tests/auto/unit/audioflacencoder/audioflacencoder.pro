@@ -0,0 +1,13 @@
+CONFIG += testcase
+TARGET = tst_audioflacencoder
+
+QT += multimedia-private testlib
+
+SOURCES += tst_audioflacencoder.cpp
+
+qtConfig(flac) {
+    QMAKE_USE += flac
+    HEADERS += ../../../../src/plugins/audiocapture/audioflacencoder.h
+    SOURCES += ../../../../src/plugins/audiocapture/audioflacencoder.cpp
+    INCLUDEPATH += ../../../../src/plugins/audiocapture
+}
@@ -0,0 +1,230 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+//TESTED_COMPONENT=src/plugins/audiocapture
+
+#include <QtTest/QtTest>
+
+#include <QtMultimedia/private/qtmultimediaglobal_p.h>
+
+#if QT_CONFIG(flac)
+#include "audioflacencoder.h"
+
+#include <FLAC/stream_decoder.h>
+#endif
+
+QT_USE_NAMESPACE
+
+#if QT_CONFIG(flac)
+struct DecodedStream
+{
+    QVector<qint32> samples;
+    quint64 totalSamples = 0;
+    unsigned channels = 0;
+    unsigned bitsPerSample = 0;
+    bool failed = false;
+};
+
+static FLAC__StreamDecoderWriteStatus decodeWrite(const FLAC__StreamDecoder *, const FLAC__Frame *frame,
+                                                  const FLAC__int32 *const buffer[], void *clientData)
+{
+    DecodedStream *stream = static_cast<DecodedStream *>(clientData);
+    for (unsigned i = 0; i < frame->header.blocksize; ++i) {
+        for (unsigned c = 0; c < frame->header.channels; ++c)
+            stream->samples.append(buffer[c][i]);
+    }
+    return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+static void decodeMetadata(const FLAC__StreamDecoder *, const FLAC__StreamMetadata *metadata,
+                           void *clientData)
+{
+    DecodedStream *stream = static_cast<DecodedStream *>(clientData);
+    if (metadata->type == FLAC__METADATA_TYPE_STREAMINFO) {
+        stream->totalSamples = metadata->data.stream_info.total_samples;
+        stream->channels = metadata->data.stream_info.channels;
+        stream->bitsPerSample = metadata->data.stream_info.bits_per_sample;
+    }
+}
+
+static void decodeError(const FLAC__StreamDecoder *, FLAC__StreamDecoderErrorStatus, void *clientData)
+{
+    static_cast<DecodedStream *>(clientData)->failed = true;
+}
+
+// Decodes the whole file, false if it is broken or its MD5 doesn't match
+static bool decodeFile(const QString &fileName, DecodedStream *stream)
+{
+    FLAC__StreamDecoder *decoder = FLAC__stream_decoder_new();
+    if (!decoder)
+        return false;
+
+    FLAC__stream_decoder_set_md5_checking(decoder, true);
+    bool ok = FLAC__stream_decoder_init_file(decoder, QFile::encodeName(fileName).constData(),
+                                             decodeWrite, decodeMetadata, decodeError,
+                                             stream) == FLAC__STREAM_DECODER_INIT_STATUS_OK;
+    if (ok)
+        ok = FLAC__stream_decoder_process_until_end_of_stream(decoder);
+    if (!FLAC__stream_decoder_finish(decoder))
+        ok = false;
+    FLAC__stream_decoder_delete(decoder);
+    return ok && !stream->failed;
+}
+
+// Some of every value range, including both extremes
+static qint32 testSample(int index, int sampleSize)
+{
+    const qint32 limit = 1 << (sampleSize - 1);
+    switch (index % 5) {
+    case 0:
+        return -limit;
+    case 1:
+        return limit - 1;
+    default:
+        return qint32((quint32(index) * 2654435761u) % quint32(2 * limit)) - limit;
+    }
+}
+
+static QByteArray encodeSamples(const QVector<qint32> &samples, const QAudioFormat &format)
+{
+    const int sampleBytes = format.sampleSize() / 8;
+    const bool isUnsigned = format.sampleType() == QAudioFormat::UnSignedInt;
+    const bool littleEndian = format.byteOrder() == QAudioFormat::LittleEndian;
+
+    QByteArray data(samples.size() * sampleBytes, Qt::Uninitialized);
+    uchar *out = reinterpret_cast<uchar *>(data.data());
+    for (int i = 0; i < samples.size(); ++i) {
+        quint32 value = quint32(samples.at(i));
+        if (isUnsigned)
+            value += 1u << (format.sampleSize() - 1);
+        for (int b = 0; b < sampleBytes; ++b) {
+            const uchar byte = uchar(value >> (8 * b));
+            out[i * sampleBytes + (littleEndian ? b : sampleBytes - 1 - b)] = byte;
+        }
+    }
+    return data;
+}
+#endif
+
+class tst_AudioFlacEncoder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip_data();
+    void roundTrip();
+};
+
+void tst_AudioFlacEncoder::roundTrip_data()
+{
+    QTest::addColumn<int>("sampleSize");
+    QTest::addColumn<int>("sampleType");
+    QTest::addColumn<int>("byteOrder");
+    QTest::addColumn<int>("writeSize");
+
+    // Write sizes that are no multiple of the frame size split frames
+    // between writes
+    QTest::newRow("u8") << 8 << int(QAudioFormat::UnSignedInt) << int(QAudioFormat::LittleEndian) << 7;
+    QTest::newRow("s8") << 8 << int(QAudioFormat::SignedInt) << int(QAudioFormat::LittleEndian) << 4097;
+    QTest::newRow("s16le") << 16 << int(QAudioFormat::SignedInt) << int(QAudioFormat::LittleEndian) << 7;
+    QTest::newRow("s16be") << 16 << int(QAudioFormat::SignedInt) << int(QAudioFormat::BigEndian) << 1001;
+    QTest::newRow("u16le") << 16 << int(QAudioFormat::UnSignedInt) << int(QAudioFormat::LittleEndian) << 3;
+    QTest::newRow("s24le") << 24 << int(QAudioFormat::SignedInt) << int(QAudioFormat::LittleEndian) << 7;
+    QTest::newRow("s24be") << 24 << int(QAudioFormat::SignedInt) << int(QAudioFormat::BigEndian) << 65537;
+}
+
+void tst_AudioFlacEncoder::roundTrip()
+{
+#if QT_CONFIG(flac)
+    QFETCH(int, sampleSize);
+    QFETCH(int, sampleType);
+    QFETCH(int, byteOrder);
+    QFETCH(int, writeSize);
+
+    QAudioFormat format;
+    format.setCodec(QStringLiteral("audio/pcm"));
+    format.setSampleRate(44100);
+    format.setChannelCount(2);
+    format.setSampleSize(sampleSize);
+    format.setSampleType(QAudioFormat::SampleType(sampleType));
+    format.setByteOrder(QAudioFormat::Endian(byteOrder));
+    QVERIFY(AudioFlacEncoder::isFormatSupported(format));
+
+    // More than the encoder converts in one go
+    const int frames = 10000;
+    QVector<qint32> samples(frames * format.channelCount());
+    for (int i = 0; i < samples.size(); ++i)
+        samples[i] = testSample(i, sampleSize);
+    const QByteArray data = encodeSamples(samples, format);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("recording.flac"));
+
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+
+        AudioFlacEncoder encoder;
+        QVERIFY(encoder.start(&file, format));
+        for (int offset = 0; offset < data.size(); offset += writeSize)
+            QVERIFY(encoder.encode(data.constData() + offset, qMin(writeSize, data.size() - offset)));
+        QVERIFY(encoder.finish());
+        QCOMPARE(file.pos(), file.size());
+    }
+
+    // STREAMINFO follows the marker and its block header, the total
+    // sample count is in the low 36 bits of its third 64 bit field
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray header = file.read(42);
+    QCOMPARE(header.left(4), QByteArray("fLaC"));
+    QCOMPARE(header.at(4) & 0x7f, 0);
+    const quint64 info = qFromBigEndian<quint64>(header.constData() + 18);
+    QCOMPARE(info & Q_UINT64_C(0xFFFFFFFFF), quint64(frames));
+
+    DecodedStream stream;
+    QVERIFY(decodeFile(fileName, &stream));
+    QCOMPARE(stream.totalSamples, quint64(frames));
+    QCOMPARE(stream.channels, unsigned(format.channelCount()));
+    QCOMPARE(stream.bitsPerSample, unsigned(sampleSize));
+    QCOMPARE(stream.samples.size(), samples.size());
+    for (int i = 0; i < samples.size(); ++i) {
+        if (stream.samples.at(i) != samples.at(i))
+            QFAIL(qPrintable(QString::fromLatin1("Sample %1 is %2 instead of %3")
+                             .arg(i).arg(stream.samples.at(i)).arg(samples.at(i))));
+    }
+#else
+    QSKIP("Built without FLAC support");
+#endif
+}
+
+QTEST_GUILESS_MAIN(tst_AudioFlacEncoder)
+
+#include "tst_audioflacencoder.moc"
@@ -1,6 +1,8 @@
 
 TEMPLATE = subdirs
 SUBDIRS += \
+    audiofilewriter \
+    audioflacencoder \
     qabstractvideobuffer \
     qabstractvideosurface \
     qaudiorecorder \
@@ -31,7 +33,11 @@ SUBDIRS += \
     qvideosurfaceformat \
     qwavedecoder \
     qaudiobuffer \
+    qaudioloudness \
     qaudiodecoder \
     qaudioprobe \
+    qaudiospectrumprobe \
     qvideoprobe \
     qsamplecache
+
+qtConfig(alsa): SUBDIRS += qalsacapabilitycache
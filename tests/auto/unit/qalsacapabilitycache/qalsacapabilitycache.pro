@@ -0,0 +1,17 @@
+CONFIG += testcase
+TARGET = tst_qalsacapabilitycache
+
+QT += multimedia-private testlib
+
+LIBS += -lasound
+
+HEADERS += \
+    ../../../../src/plugins/alsa/qalsacapabilitycache.h \
+    ../../../../src/plugins/alsa/qalsaaudiodeviceinfo.h
+
+SOURCES += \
+    tst_qalsacapabilitycache.cpp \
+    ../../../../src/plugins/alsa/qalsacapabilitycache.cpp \
+    ../../../../src/plugins/alsa/qalsaaudiodeviceinfo.cpp
+
+INCLUDEPATH += ../../../../src/plugins/alsa
@@ -0,0 +1,215 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+//TESTED_COMPONENT=src/plugins/alsa
+
+#include <QtTest/QtTest>
+
+#include "qalsacapabilitycache.h"
+
+#include <errno.h>
+
+QT_USE_NAMESPACE
+
+// Answers every probe with the same result instead of opening a device
+class TestCapabilityCache : public QAlsaCapabilityCache
+{
+public:
+    ~TestCapabilityCache() { shutdown(); }
+
+    using QAlsaCapabilityCache::shutdown;
+
+    QAtomicInt result;
+    QAtomicInt probes;
+    QList<QByteArray> devices;
+
+protected:
+    int runProbe(const QString &, QAudio::Mode, const QString &) override
+    {
+        probes.ref();
+        return result.load();
+    }
+
+    QList<QByteArray> availableDevices(QAudio::Mode) override
+    {
+        return devices;
+    }
+};
+
+class tst_QAlsaCapabilityCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+
+    void lookupProbesOnce();
+    void busyDeviceNotRemembered();
+    void destroyWritesAtOnce();
+    void storedResultsRefreshed();
+    void absentDeviceNotRefreshed();
+    void staleFingerprintIgnored();
+
+private:
+    void writeCacheFile(bool supported);
+
+    QTemporaryDir m_cacheHome;
+    QString m_fileName;
+    QAudioFormat m_format;
+};
+
+void tst_QAlsaCapabilityCache::initTestCase()
+{
+    QVERIFY(m_cacheHome.isValid());
+    // GenericCacheLocation, where the cache keeps its file
+    qputenv("XDG_CACHE_HOME", QFile::encodeName(m_cacheHome.path()));
+    m_fileName = m_cacheHome.path() + QLatin1String("/qtmultimedia/alsa-capabilities.ini");
+
+    m_format.setCodec(QStringLiteral("audio/pcm"));
+    m_format.setSampleRate(48000);
+    m_format.setChannelCount(2);
+    m_format.setSampleSize(16);
+    m_format.setSampleType(QAudioFormat::SignedInt);
+    m_format.setByteOrder(QAudioFormat::LittleEndian);
+}
+
+void tst_QAlsaCapabilityCache::init()
+{
+    QFile::remove(m_fileName);
+}
+
+void tst_QAlsaCapabilityCache::writeCacheFile(bool supported)
+{
+    TestCapabilityCache cache;
+    cache.result = supported ? 0 : -EINVAL;
+    QCOMPARE(cache.canOpen(QStringLiteral("hw:0,0"), QAudio::AudioOutput), supported);
+}
+
+void tst_QAlsaCapabilityCache::lookupProbesOnce()
+{
+    TestCapabilityCache cache;
+
+    QVERIFY(cache.canOpen(QStringLiteral("hw:0,0"), QAudio::AudioOutput));
+    QVERIFY(cache.canOpen(QStringLiteral("hw:0,0"), QAudio::AudioOutput));
+    QCOMPARE(cache.probes.load(), 1);
+
+    cache.result = -EINVAL;
+    QVERIFY(!cache.isFormatSupported(QStringLiteral("hw:0,0"), QAudio::AudioOutput, m_format));
+    QVERIFY(!cache.isFormatSupported(QStringLiteral("hw:0,0"), QAudio::AudioOutput, m_format));
+    QCOMPARE(cache.probes.load(), 2);
+
+    // Input and output are probed separately
+    QVERIFY(!cache.canOpen(QStringLiteral("hw:0,0"), QAudio::AudioInput));
+    QCOMPARE(cache.probes.load(), 3);
+
+    QTRY_VERIFY(QFile::exists(m_fileName));
+    QSettings settings(m_fileName, QSettings::IniFormat);
+    QVERIFY(!settings.value(QStringLiteral("fingerprint")).toString().isEmpty());
+    settings.beginGroup(QStringLiteral("probes"));
+    QCOMPARE(settings.childKeys().size(), 3);
+}
+
+void tst_QAlsaCapabilityCache::busyDeviceNotRemembered()
+{
+    TestCapabilityCache cache;
+    cache.result = -EBUSY;
+
+    QVERIFY(!cache.canOpen(QStringLiteral("hw:0,0"), QAudio::AudioOutput));
+    QVERIFY(!cache.canOpen(QStringLiteral("hw:0,0"), QAudio::AudioOutput));
+    QCOMPARE(cache.probes.load(), 2);
+
+    cache.result = 0;
+    QVERIFY(cache.canOpen(QStringLiteral("hw:0,0"), QAudio::AudioOutput));
+    QCOMPARE(cache.probes.load(), 3);
+}
+
+void tst_QAlsaCapabilityCache::destroyWritesAtOnce()
+{
+    QScopedPointer<TestCapabilityCache> cache(new TestCapabilityCache);
+    QVERIFY(cache->canOpen(QStringLiteral("hw:0,0"), QAudio::AudioOutput));
+
+    // The pending save must not hold up the destruction for its delay
+    QElapsedTimer timer;
+    timer.start();
+    cache.reset();
+    QVERIFY(timer.elapsed() < 400);
+    QVERIFY(QFile::exists(m_fileName));
+}
+
+void tst_QAlsaCapabilityCache::storedResultsRefreshed()
+{
+    writeCacheFile(true);
+
+    TestCapabilityCache cache;
+    cache.result = -EINVAL;
+    cache.devices.append("hw:0,0");
+
+    // Answered from the file, then probed again in the background
+    QVERIFY(cache.canOpen(QStringLiteral("hw:0,0"), QAudio::AudioOutput));
+    QTRY_VERIFY(!cache.canOpen(QStringLiteral("hw:0,0"), QAudio::AudioOutput));
+    QCOMPARE(cache.probes.load(), 1);
+
+    cache.shutdown();
+    QSettings settings(m_fileName, QSettings::IniFormat);
+    settings.beginGroup(QStringLiteral("probes"));
+    const QStringList keys = settings.childKeys();
+    QCOMPARE(keys.size(), 1);
+    QCOMPARE(settings.value(keys.first()).toBool(), false);
+}
+
+void tst_QAlsaCapabilityCache::absentDeviceNotRefreshed()
+{
+    writeCacheFile(false);
+
+    TestCapabilityCache cache;
+    QVERIFY(!cache.canOpen(QStringLiteral("hw:0,0"), QAudio::AudioOutput));
+
+    // The card is not plugged in, the stored result stays
+    cache.shutdown();
+    QCOMPARE(cache.probes.load(), 0);
+    QVERIFY(!cache.canOpen(QStringLiteral("hw:0,0"), QAudio::AudioOutput));
+}
+
+void tst_QAlsaCapabilityCache::staleFingerprintIgnored()
+{
+    writeCacheFile(false);
+    {
+        QSettings settings(m_fileName, QSettings::IniFormat);
+        settings.setValue(QStringLiteral("fingerprint"), QStringLiteral("0 stale"));
+    }
+
+    TestCapabilityCache cache;
+    QVERIFY(cache.canOpen(QStringLiteral("hw:0,0"), QAudio::AudioOutput));
+    QCOMPARE(cache.probes.load(), 1);
+}
+
+QTEST_MAIN(tst_QAlsaCapabilityCache)
+
+#include "tst_qalsacapabilitycache.moc"
@@ -48,6 +48,11 @@ private Q_SLOTS:
     void durations();
     void durations_data();
     void stereoSample();
+    void planar();
+    void planarConversion();
+    void planarConversion_data();
+    void convertToFloat();
+    void pool();
 
 private:
     QAudioFormat mFormat;
@@ -391,6 +396,194 @@ void tst_QAudioBuffer::stereoSample()
     QCOMPARE(s32f.average(), 0.0f);
 }
 
+void tst_QAudioBuffer::planar()
+{
+    QAudioBuffer planar(500, mFormat, QAudioBuffer::Planar, 1000);
+    QVERIFY(planar.isValid());
+    QCOMPARE(planar.layout(), QAudioBuffer::Planar);
+    QCOMPARE(planar.frameCount(), 500);
+    QCOMPARE(planar.sampleCount(), 1000);
+    QCOMPARE(planar.byteCount(), 2000);
+    QCOMPARE(planar.startTime(), 1000LL);
+
+    // Planes follow each other
+    const char *base = planar.constData<char>();
+    QVERIFY(planar.constChannelData(0) == base);
+    QVERIFY(planar.constChannelData(1) == base + 1000);
+    QVERIFY(planar.constChannelData(2) == 0);
+    QVERIFY(planar.constChannelData(-1) == 0);
+
+    // Interleaved buffers have no planes
+    QCOMPARE(mEmpty->layout(), QAudioBuffer::Interleaved);
+    QVERIFY(mEmpty->constChannelData(0) == 0);
+    QVERIFY(mNull->constChannelData(0) == 0);
+    QCOMPARE(mNull->layout(), QAudioBuffer::Interleaved);
+
+    // Copies keep the layout, and channelData detaches
+    QAudioBuffer copy(planar);
+    QVERIFY(copy.constChannelData(1) == planar.constChannelData(1));
+    quint16 *right = copy.channelData<quint16>(1);
+    QVERIFY(right != 0);
+    QVERIFY(right != planar.constChannelData<quint16>(1));
+    QCOMPARE(copy.layout(), QAudioBuffer::Planar);
+    right[0] = 0x1234;
+    QCOMPARE(planar.constChannelData<quint16>(1)[0], quint16(0));
+}
+
+void tst_QAudioBuffer::planarConversion_data()
+{
+    QTest::addColumn<int>("channels");
+    QTest::addColumn<int>("sampleSize");
+    QTest::addColumn<int>("frames");
+
+    // Odd frame counts cover the tails of the vectorised paths
+    QTest::newRow("mono 16 bit") << 1 << 16 << 37;
+    QTest::newRow("stereo 8 bit") << 2 << 8 << 37;
+    QTest::newRow("stereo 16 bit") << 2 << 16 << 37;
+    QTest::newRow("stereo 32 bit") << 2 << 32 << 37;
+    QTest::newRow("stereo 32 bit short") << 2 << 32 << 3;
+    QTest::newRow("5.1 16 bit") << 6 << 16 << 37;
+    QTest::newRow("stereo 24 bit") << 2 << 24 << 37;
+}
+
+void tst_QAudioBuffer::planarConversion()
+{
+    QFETCH(int, channels);
+    QFETCH(int, sampleSize);
+    QFETCH(int, frames);
+
+    QAudioFormat format;
+    format.setChannelCount(channels);
+    format.setSampleSize(sampleSize);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setSampleRate(44100);
+    format.setCodec("audio/pcm");
+
+    QByteArray data(format.bytesForFrames(frames), Qt::Uninitialized);
+    for (int i = 0; i < data.size(); ++i)
+        data[i] = char(i * 7 + i / 3);
+
+    QAudioBuffer interleaved(data, format, 500);
+    QAudioBuffer planar = interleaved.toPlanar();
+    QCOMPARE(planar.layout(), QAudioBuffer::Planar);
+    QCOMPARE(planar.frameCount(), frames);
+    QCOMPARE(planar.startTime(), 500LL);
+
+    const int sampleBytes = sampleSize / 8;
+    for (int c = 0; c < channels; ++c) {
+        const char *plane = planar.constChannelData<char>(c);
+        for (int i = 0; i < frames; ++i) {
+            QCOMPARE(QByteArray(plane + i * sampleBytes, sampleBytes),
+                     data.mid((i * channels + c) * sampleBytes, sampleBytes));
+        }
+    }
+
+    // Converting to the current layout shares the samples
+    QVERIFY(planar.toPlanar().constData() == planar.constData());
+    QVERIFY(interleaved.toInterleaved().constData() == interleaved.constData());
+
+    QAudioBuffer roundTrip = planar.toInterleaved();
+    QCOMPARE(roundTrip.layout(), QAudioBuffer::Interleaved);
+    QCOMPARE(QByteArray(roundTrip.constData<char>(), roundTrip.byteCount()), data);
+}
+
+void tst_QAudioBuffer::convertToFloat()
+{
+    QAudioFormat format;
+    format.setChannelCount(2);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setSampleRate(44100);
+    format.setCodec("audio/pcm");
+
+    QAudioBuffer buffer(3, format);
+    QAudioBuffer::S16S *frames = buffer.data<QAudioBuffer::S16S>();
+    frames[0] = QAudioBuffer::S16S(0, -32768);
+    frames[1] = QAudioBuffer::S16S(16384, -16384);
+    frames[2] = QAudioBuffer::S16S(8192, 0);
+
+    float samples[6];
+    QVERIFY(buffer.convertToFloat(samples));
+    QCOMPARE(samples[0], 0.0f);
+    QCOMPARE(samples[1], -1.0f);
+    QCOMPARE(samples[2], 0.5f);
+    QCOMPARE(samples[3], -0.5f);
+    QCOMPARE(samples[4], 0.25f);
+    QCOMPARE(samples[5], 0.0f);
+
+    // The layout is kept
+    QVERIFY(buffer.toPlanar().convertToFloat(samples));
+    QCOMPARE(samples[0], 0.0f);
+    QCOMPARE(samples[1], 0.5f);
+    QCOMPARE(samples[2], 0.25f);
+    QCOMPARE(samples[3], -1.0f);
+    QCOMPARE(samples[4], -0.5f);
+    QCOMPARE(samples[5], 0.0f);
+
+    QVERIFY(!mNull->convertToFloat(samples));
+}
+
+void tst_QAudioBuffer::pool()
+{
+    QAudioBufferPool *pool = new QAudioBufferPool(2);
+    QCOMPARE(pool->maximumFreeBuffers(), 2);
+    QCOMPARE(pool->freeBufferCount(), 0);
+
+    QVERIFY(!pool->acquire(0, mFormat).isValid());
+    QVERIFY(!pool->acquire(100, QAudioFormat()).isValid());
+
+    const void *storage = 0;
+    {
+        QAudioBuffer buffer = pool->acquire(500, mFormat, 1000);
+        QVERIFY(buffer.isValid());
+        QCOMPARE(buffer.layout(), QAudioBuffer::Interleaved);
+        QCOMPARE(buffer.frameCount(), 500);
+        QCOMPARE(buffer.byteCount(), 2000);
+        QCOMPARE(buffer.startTime(), 1000LL);
+        storage = buffer.constData();
+
+        // Writing does not detach an unshared buffer
+        QVERIFY(buffer.data() == storage);
+        QCOMPARE(pool->freeBufferCount(), 0);
+    }
+    QCOMPARE(pool->freeBufferCount(), 1);
+
+    // Smaller requests reuse the storage, with the requested layout
+    {
+        QAudioBuffer buffer = pool->acquire(250, mFormat, QAudioBuffer::Planar);
+        QVERIFY(buffer.constData() == storage);
+        QCOMPARE(buffer.layout(), QAudioBuffer::Planar);
+        QCOMPARE(buffer.frameCount(), 250);
+        QCOMPARE(buffer.startTime(), -1LL);
+        QVERIFY(buffer.constChannelData<char>(1) == static_cast<const char *>(storage) + 500);
+        QCOMPARE(pool->freeBufferCount(), 0);
+
+        // Detached copies are not pooled
+        QAudioBuffer copy(buffer);
+        QVERIFY(copy.data() != storage);
+    }
+    QCOMPARE(pool->freeBufferCount(), 1);
+
+    // Only maximumFreeBuffers blocks are kept
+    {
+        QAudioBuffer a = pool->acquire(100, mFormat);
+        QAudioBuffer b = pool->acquire(100, mFormat);
+        QAudioBuffer c = pool->acquire(100, mFormat);
+        QCOMPARE(pool->freeBufferCount(), 0);
+    }
+    QCOMPARE(pool->freeBufferCount(), 2);
+
+    pool->clear();
+    QCOMPARE(pool->freeBufferCount(), 0);
+
+    // Buffers may outlive the pool
+    QAudioBuffer survivor = pool->acquire(100, mFormat);
+    delete pool;
+    QVERIFY(survivor.isValid());
+    QVERIFY(survivor.data() != 0);
+    survivor = QAudioBuffer();
+}
+
 
 QTEST_APPLESS_MAIN(tst_QAudioBuffer);
 
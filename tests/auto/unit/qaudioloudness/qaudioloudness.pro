@@ -0,0 +1,6 @@
+CONFIG += testcase
+TARGET = tst_qaudioloudness
+
+QT += core multimedia-private testlib
+
+SOURCES += tst_qaudioloudness.cpp
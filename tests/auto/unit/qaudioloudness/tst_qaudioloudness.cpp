@@ -0,0 +1,231 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <qaudioloudness.h>
+#include <private/qaudioloudnessmeter_p.h>
+
+#include <QtCore/qmath.h>
+
+#include <limits>
+
+class tst_QAudioLoudness : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void defaults();
+    void sine_data();
+    void sine();
+    void gating();
+    void truePeak();
+    void integerSamples();
+    void notifyInterval();
+    void disabled();
+
+private:
+    static QAudioFormat floatFormat(int channels = 2);
+    static QByteArray sine(const QAudioFormat &format, qreal dbfs, qreal seconds,
+                           qreal frequency = 1000.0, qreal phase = 0.0);
+};
+
+QAudioFormat tst_QAudioLoudness::floatFormat(int channels)
+{
+    QAudioFormat format;
+    format.setSampleRate(48000);
+    format.setChannelCount(channels);
+    format.setSampleSize(32);
+    format.setSampleType(QAudioFormat::Float);
+    format.setByteOrder(QAudioFormat::Endian(QSysInfo::ByteOrder));
+    format.setCodec("audio/pcm");
+    return format;
+}
+
+QByteArray tst_QAudioLoudness::sine(const QAudioFormat &format, qreal dbfs, qreal seconds,
+                                    qreal frequency, qreal phase)
+{
+    const int frames = int(format.sampleRate() * seconds);
+    const int channels = format.channelCount();
+    const qreal amplitude = qPow(10.0, dbfs / 20.0);
+
+    QByteArray data(frames * format.bytesPerFrame(), Qt::Uninitialized);
+    for (int i = 0; i < frames; ++i) {
+        const qreal value = amplitude * qSin(2 * M_PI * frequency * i / format.sampleRate() + phase);
+        for (int c = 0; c < channels; ++c) {
+            if (format.sampleType() == QAudioFormat::Float)
+                reinterpret_cast<float *>(data.data())[i * channels + c] = float(value);
+            else
+                reinterpret_cast<qint16 *>(data.data())[i * channels + c] = qint16(qRound(value * 32767));
+        }
+    }
+    return data;
+}
+
+void tst_QAudioLoudness::defaults()
+{
+    QAudioLoudness loudness;
+    QVERIFY(!loudness.isValid());
+    QCOMPARE(loudness.momentary(), -std::numeric_limits<qreal>::infinity());
+    QCOMPARE(loudness.shortTerm(), -std::numeric_limits<qreal>::infinity());
+    QCOMPARE(loudness.integrated(), -std::numeric_limits<qreal>::infinity());
+    QCOMPARE(loudness.truePeak(), -std::numeric_limits<qreal>::infinity());
+    QCOMPARE(loudness.duration(), qint64(0));
+
+    loudness.setIntegrated(-23.0);
+    loudness.setDuration(1000);
+    QAudioLoudness copy = loudness;
+    loudness.setIntegrated(-16.0);
+    QVERIFY(copy.isValid());
+    QCOMPARE(copy.integrated(), qreal(-23.0));
+    QCOMPARE(loudness.integrated(), qreal(-16.0));
+}
+
+void tst_QAudioLoudness::sine_data()
+{
+    QTest::addColumn<qreal>("dbfs");
+    QTest::addColumn<int>("sampleRate");
+
+    // EBU Tech 3341 test cases 1 and 2, a stereo 1 kHz sine reads its level
+    QTest::newRow("-23 dBFS, 48 kHz") << qreal(-23.0) << 48000;
+    QTest::newRow("-33 dBFS, 48 kHz") << qreal(-33.0) << 48000;
+    QTest::newRow("-23 dBFS, 44.1 kHz") << qreal(-23.0) << 44100;
+}
+
+void tst_QAudioLoudness::sine()
+{
+    QFETCH(qreal, dbfs);
+    QFETCH(int, sampleRate);
+
+    QAudioFormat format = floatFormat();
+    format.setSampleRate(sampleRate);
+
+    QAudioLoudnessMeter meter;
+    meter.setEnabled(true);
+    const QByteArray data = sine(format, dbfs, 20.0);
+    // Odd sized writes to cross block boundaries and split frames
+    for (int offset = 0; offset < data.size(); offset += 4099)
+        meter.process(format, data.constData() + offset, qMin(4099, data.size() - offset));
+
+    const QAudioLoudness loudness = meter.loudness();
+    QVERIFY(loudness.isValid());
+    QVERIFY(qAbs(loudness.momentary() - dbfs) < 0.1);
+    QVERIFY(qAbs(loudness.shortTerm() - dbfs) < 0.1);
+    QVERIFY(qAbs(loudness.integrated() - dbfs) < 0.1);
+    QVERIFY(qAbs(loudness.truePeak() - dbfs) < 0.2);
+    QVERIFY(qAbs(loudness.duration() - qint64(20000000)) <= 100000);
+}
+
+void tst_QAudioLoudness::gating()
+{
+    // EBU Tech 3341 test case 3, the quiet parts fall below the relative gate
+    const QAudioFormat format = floatFormat();
+
+    QAudioLoudnessMeter meter;
+    meter.setEnabled(true);
+    const QByteArray quiet = sine(format, -36.0, 10.0);
+    const QByteArray loud = sine(format, -23.0, 60.0);
+    meter.process(format, quiet.constData(), quiet.size());
+    meter.process(format, loud.constData(), loud.size());
+    meter.process(format, quiet.constData(), quiet.size());
+
+    QVERIFY(qAbs(meter.loudness().integrated() - qreal(-23.0)) < 0.1);
+
+    // Silence is below the absolute gate and doesn't count
+    QAudioLoudnessMeter silence;
+    silence.setEnabled(true);
+    const QByteArray zeros(format.bytesForDuration(2000000), 0);
+    silence.process(format, zeros.constData(), zeros.size());
+    QVERIFY(silence.loudness().isValid());
+    QCOMPARE(silence.loudness().integrated(), -std::numeric_limits<qreal>::infinity());
+    QCOMPARE(silence.loudness().truePeak(), -std::numeric_limits<qreal>::infinity());
+}
+
+void tst_QAudioLoudness::truePeak()
+{
+    // A quarter of the sample rate sampled at 45 degrees misses the peaks
+    // by 3 dB, the oversampled signal finds them
+    const QAudioFormat format = floatFormat(1);
+
+    QAudioLoudnessMeter meter;
+    meter.setEnabled(true);
+    const QByteArray data = sine(format, -6.0, 1.0, format.sampleRate() / 4.0, M_PI / 4);
+    meter.process(format, data.constData(), data.size());
+
+    QVERIFY(qAbs(meter.loudness().truePeak() - qreal(-6.0)) < 0.5);
+}
+
+void tst_QAudioLoudness::integerSamples()
+{
+    QAudioFormat format = floatFormat();
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+
+    QAudioLoudnessMeter meter;
+    meter.setEnabled(true);
+    const QByteArray data = sine(format, -23.0, 5.0);
+    meter.process(format, data.constData(), data.size());
+
+    QVERIFY(qAbs(meter.loudness().integrated() - qreal(-23.0)) < 0.1);
+
+    meter.reset();
+    QVERIFY(!meter.loudness().isValid());
+}
+
+void tst_QAudioLoudness::notifyInterval()
+{
+    const QAudioFormat format = floatFormat();
+
+    QAudioLoudnessMeter meter;
+    meter.setEnabled(true);
+    QCOMPARE(meter.notifyInterval(), 100);
+    meter.setNotifyInterval(250);
+
+    QSignalSpy spy(&meter, SIGNAL(loudnessChanged(QAudioLoudness)));
+    const QByteArray data = sine(format, -23.0, 0.05);
+    for (int i = 0; i < 20; ++i)
+        meter.process(format, data.constData(), data.size());
+
+    QCOMPARE(spy.count(), 4);
+    QVERIFY(spy.last().at(0).value<QAudioLoudness>().isValid());
+}
+
+void tst_QAudioLoudness::disabled()
+{
+    const QAudioFormat format = floatFormat();
+
+    QAudioLoudnessMeter meter;
+    QVERIFY(!meter.isEnabled());
+    const QByteArray data = sine(format, -23.0, 1.0);
+    meter.process(format, data.constData(), data.size());
+    QVERIFY(!meter.loudness().isValid());
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioLoudness)
+
+#include "tst_qaudioloudness.moc"
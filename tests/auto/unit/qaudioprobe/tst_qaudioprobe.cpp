@@ -55,6 +55,11 @@ private slots:
     void testRecorderDeleteRecorder();
     void testRecorderDeleteProbe();
     void testMediaObject();
+    void testReduction_data();
+    void testReduction();
+    void testReductionDiscontinuity();
+    void testQueuedDelivery();
+    void testDirectDelivery();
 
 private:
     QAudioRecorder *recorder;
@@ -178,6 +183,204 @@ void tst_QAudioProbe::testMediaObject()
     delete object;
 }
 
+void tst_QAudioProbe::testReduction_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::addColumn<QVector<float> >("expected");
+
+    // Two windows of a stereo signal, the left channel a square wave of
+    // amplitude 0.5, the right channel silent
+    QTest::newRow("peak") << int(QAudioProbe::PeakReduction)
+                          << (QVector<float>() << 0.5f << 0.0f << 0.5f << 0.0f);
+    QTest::newRow("rms") << int(QAudioProbe::RmsReduction)
+                         << (QVector<float>() << 0.5f << 0.0f << 0.5f << 0.0f);
+    QTest::newRow("envelope") << int(QAudioProbe::EnvelopeReduction)
+                              << (QVector<float>() << -0.5f << 0.5f << 0.0f << 0.0f
+                                                   << -0.5f << 0.5f << 0.0f << 0.0f);
+}
+
+void tst_QAudioProbe::testReduction()
+{
+    QFETCH(int, mode);
+    QFETCH(QVector<float>, expected);
+
+    recorder = new QAudioRecorder;
+
+    QAudioProbe probe;
+    QCOMPARE(probe.reductionMode(), QAudioProbe::NoReduction);
+    probe.setReductionMode(QAudioProbe::ReductionMode(mode));
+    probe.setReductionWindow(10);
+    QCOMPARE(probe.reductionMode(), QAudioProbe::ReductionMode(mode));
+    QCOMPARE(probe.reductionWindow(), 10);
+    QVERIFY(probe.setSource(recorder));
+
+    QSignalSpy bufferSpy(&probe, SIGNAL(audioBufferProbed(QAudioBuffer)));
+    QSignalSpy levelsSpy(&probe, SIGNAL(levelsProbed(QVector<float>,int,qint64)));
+
+    QAudioFormat format;
+    format.setSampleRate(8000);
+    format.setChannelCount(2);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec("audio/pcm");
+
+    // 10ms at 8kHz are 80 frames, deliver 200 frames so that the last
+    // 40 frames stay in an unfinished window
+    QByteArray data(200 * format.bytesPerFrame(), 0);
+    qint16 *samples = reinterpret_cast<qint16 *>(data.data());
+    for (int i = 0; i < 200; ++i)
+        samples[2 * i] = qToLittleEndian<qint16>(i % 2 ? 16384 : -16384);
+
+    // Split into two buffers to check that windows span buffers
+    const int split = 50 * format.bytesPerFrame();
+    mockMediaRecorderService->mockAudioProbeControl->probeBuffer(QAudioBuffer(data.left(split), format, 1000));
+    mockMediaRecorderService->mockAudioProbeControl->probeBuffer(QAudioBuffer(data.mid(split), format, 7250));
+
+    QTRY_COMPARE(levelsSpy.count(), 1);
+    QVERIFY(bufferSpy.isEmpty());
+
+    const QVector<float> levels = levelsSpy.at(0).at(0).value<QVector<float> >();
+    QCOMPARE(levelsSpy.at(0).at(1).toInt(), 2);
+    QCOMPARE(levelsSpy.at(0).at(2).toLongLong(), qint64(1000));
+    QCOMPARE(levels.size(), expected.size());
+    for (int i = 0; i < levels.size(); ++i)
+        QVERIFY(qAbs(levels.at(i) - expected.at(i)) < 0.001f);
+
+    // Switching back delivers the buffers again
+    probe.setReductionMode(QAudioProbe::NoReduction);
+    mockMediaRecorderService->mockAudioProbeControl->probeBuffer(QAudioBuffer(data, format));
+    QCOMPARE(bufferSpy.count(), 1);
+    QCoreApplication::processEvents();
+    QCOMPARE(levelsSpy.count(), 1);
+}
+
+void tst_QAudioProbe::testReductionDiscontinuity()
+{
+    recorder = new QAudioRecorder;
+
+    QAudioProbe probe;
+    probe.setReductionMode(QAudioProbe::PeakReduction);
+    probe.setReductionWindow(10);
+    QVERIFY(probe.setSource(recorder));
+
+    QSignalSpy levelsSpy(&probe, SIGNAL(levelsProbed(QVector<float>,int,qint64)));
+
+    QAudioFormat format;
+    format.setSampleRate(8000);
+    format.setChannelCount(1);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec("audio/pcm");
+
+    QByteArray quiet(200 * format.bytesPerFrame(), 0);
+    qint16 *samples = reinterpret_cast<qint16 *>(quiet.data());
+    for (int i = 0; i < 200; ++i)
+        samples[i] = qToLittleEndian<qint16>(8192);
+    QByteArray loud(80 * format.bytesPerFrame(), 0);
+    samples = reinterpret_cast<qint16 *>(loud.data());
+    for (int i = 0; i < 80; ++i)
+        samples[i] = qToLittleEndian<qint16>(16384);
+
+    // Two full windows and half of a third, then a seek to one second.
+    // Nothing is delivered in between, but the windows on either side of
+    // the seek must not end up in one batch.
+    mockMediaRecorderService->mockAudioProbeControl->probeBuffer(QAudioBuffer(quiet, format, 0));
+    mockMediaRecorderService->mockAudioProbeControl->probeBuffer(QAudioBuffer(loud, format, 1000000));
+
+    QTRY_COMPARE(levelsSpy.count(), 2);
+
+    const QVector<float> before = levelsSpy.at(0).at(0).value<QVector<float> >();
+    QCOMPARE(levelsSpy.at(0).at(2).toLongLong(), qint64(0));
+    QCOMPARE(before.size(), 3);
+    for (float level : before)
+        QVERIFY(qAbs(level - 0.25f) < 0.001f);
+
+    const QVector<float> after = levelsSpy.at(1).at(0).value<QVector<float> >();
+    QCOMPARE(levelsSpy.at(1).at(2).toLongLong(), qint64(1000000));
+    QCOMPARE(after.size(), 1);
+    QVERIFY(qAbs(after.at(0) - 0.5f) < 0.001f);
+}
+
+void tst_QAudioProbe::testQueuedDelivery()
+{
+    recorder = new QAudioRecorder;
+
+    QAudioProbe probe;
+    QCOMPARE(probe.deliveryMode(), QAudioProbe::LatestDelivery);
+    QCOMPARE(probe.queueLimit(), 8);
+    QCOMPARE(probe.overflowPolicy(), QAudioProbe::DropOldest);
+    probe.setDeliveryMode(QAudioProbe::QueuedDelivery);
+    probe.setQueueLimit(3);
+    QCOMPARE(probe.queueLimit(), 3);
+    QVERIFY(probe.setSource(recorder));
+
+    QSignalSpy bufferSpy(&probe, SIGNAL(audioBufferProbed(QAudioBuffer)));
+
+    QAudioFormat format;
+    format.setSampleRate(8000);
+    format.setChannelCount(1);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec("audio/pcm");
+
+    // Nothing is delivered before the event loop runs, so only the last
+    // three of five buffers fit into the queue
+    const QByteArray data(80 * format.bytesPerFrame(), 0);
+    for (int i = 0; i < 5; ++i)
+        mockMediaRecorderService->mockAudioProbeControl->probeBuffer(QAudioBuffer(data, format, i * 10000));
+    QVERIFY(bufferSpy.isEmpty());
+
+    QTRY_COMPARE(bufferSpy.count(), 3);
+    for (int i = 0; i < 3; ++i)
+        QCOMPARE(bufferSpy.at(i).at(0).value<QAudioBuffer>().startTime(), qint64((i + 2) * 10000));
+    QCOMPARE(probe.droppedBufferCount(), quint64(2));
+
+    // The queue is emptied, so further buffers are all delivered
+    bufferSpy.clear();
+    mockMediaRecorderService->mockAudioProbeControl->probeBuffer(QAudioBuffer(data, format));
+    QTRY_COMPARE(bufferSpy.count(), 1);
+    QCOMPARE(probe.droppedBufferCount(), quint64(2));
+}
+
+void tst_QAudioProbe::testDirectDelivery()
+{
+    recorder = new QAudioRecorder;
+
+    QAudioProbe probe;
+    QVector<qint64> startTimes;
+    probe.setDeliveryMode(QAudioProbe::DirectDelivery);
+    probe.setBufferCallback([](const QAudioBuffer &buffer, void *userData) {
+        static_cast<QVector<qint64> *>(userData)->append(buffer.startTime());
+    }, &startTimes);
+    QVERIFY(probe.setSource(recorder));
+
+    QSignalSpy bufferSpy(&probe, SIGNAL(audioBufferProbed(QAudioBuffer)));
+
+    QAudioFormat format;
+    format.setSampleRate(8000);
+    format.setChannelCount(1);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec("audio/pcm");
+
+    const QByteArray data(80 * format.bytesPerFrame(), 0);
+    mockMediaRecorderService->mockAudioProbeControl->probeBuffer(QAudioBuffer(data, format, 1000));
+    mockMediaRecorderService->mockAudioProbeControl->probeBuffer(QAudioBuffer(data, format, 2000));
+    QCOMPARE(startTimes, QVector<qint64>() << 1000 << 2000);
+
+    QCoreApplication::processEvents();
+    QVERIFY(bufferSpy.isEmpty());
+
+    // The callback is no longer called once the probe is detached
+    probe.setSource((QMediaRecorder*)0);
+    mockMediaRecorderService->mockAudioProbeControl->probeBuffer(QAudioBuffer(data, format, 3000));
+    QCOMPARE(startTimes.size(), 2);
+}
+
 QTEST_GUILESS_MAIN(tst_QAudioProbe)
 
 #include "tst_qaudioprobe.moc"
@@ -0,0 +1,10 @@
+CONFIG += testcase
+TARGET = tst_qaudiospectrumprobe
+
+QT += multimedia-private testlib
+
+SOURCES += tst_qaudiospectrumprobe.cpp
+
+include (../qmultimedia_common/mock.pri)
+include (../qmultimedia_common/mockrecorder.pri)
+
@@ -0,0 +1,253 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QDebug>
+
+#include <qaudiospectrumprobe.h>
+#include <qaudiorecorder.h>
+
+#include <QtCore/qmath.h>
+
+//TESTED_COMPONENT=src/multimedia
+
+#include "mockmediaserviceprovider.h"
+#include "mockmediarecorderservice.h"
+#include "mockmediaobject.h"
+
+QT_USE_NAMESPACE
+
+class tst_QAudioSpectrumProbe: public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void init();
+    void cleanup();
+
+private slots:
+    void testSettings();
+    void testRecorder();
+    void testUnsupportedControl();
+    void testSpectrum();
+    void testBands();
+
+private:
+    static QAudioFormat format(int channels);
+    static QByteArray sine(const QAudioFormat &format, int frames, qreal frequency, qreal amplitude);
+
+    QAudioRecorder *recorder;
+    MockMediaRecorderControl *mockMediaRecorderControl;
+    MockMediaRecorderService  *mockMediaRecorderService;
+    MockMediaServiceProvider *mockProvider;
+};
+
+void tst_QAudioSpectrumProbe::init()
+{
+    mockMediaRecorderControl = new MockMediaRecorderControl(this);
+    mockMediaRecorderService = new MockMediaRecorderService(this, mockMediaRecorderControl);
+    mockProvider = new MockMediaServiceProvider(mockMediaRecorderService);
+    mockProvider->deleteServiceOnRelease = true;
+    recorder = 0;
+
+    QMediaServiceProvider::setDefaultServiceProvider(mockProvider);
+}
+
+void tst_QAudioSpectrumProbe::cleanup()
+{
+    delete recorder;
+    delete mockProvider;
+    delete mockMediaRecorderControl;
+    mockMediaRecorderControl = 0;
+    mockMediaRecorderService = 0;
+    mockProvider = 0;
+    recorder = 0;
+}
+
+QAudioFormat tst_QAudioSpectrumProbe::format(int channels)
+{
+    QAudioFormat format;
+    format.setSampleRate(8000);
+    format.setChannelCount(channels);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec("audio/pcm");
+    return format;
+}
+
+QByteArray tst_QAudioSpectrumProbe::sine(const QAudioFormat &format, int frames, qreal frequency, qreal amplitude)
+{
+    const int channels = format.channelCount();
+    QByteArray data(frames * format.bytesPerFrame(), 0);
+    qint16 *samples = reinterpret_cast<qint16 *>(data.data());
+    for (int i = 0; i < frames; ++i) {
+        const qreal value = amplitude * qSin(2 * M_PI * frequency * i / format.sampleRate());
+        for (int c = 0; c < channels; ++c)
+            samples[i * channels + c] = qToLittleEndian<qint16>(qint16(qRound(value * 32767)));
+    }
+    return data;
+}
+
+void tst_QAudioSpectrumProbe::testSettings()
+{
+    QAudioSpectrumProbe probe;
+    QVERIFY(!probe.isActive());
+    QCOMPARE(probe.fftSize(), 2048);
+    QCOMPARE(probe.overlap(), qreal(0.5));
+    QCOMPARE(probe.windowFunction(), QAudioSpectrumProbe::HannWindow);
+    QCOMPARE(probe.bandCount(), 0);
+    QCOMPARE(probe.minimumFrequency(), qreal(20));
+    QCOMPARE(probe.maximumFrequency(), qreal(20000));
+    QCOMPARE(probe.targetRate(), 30);
+    QVERIFY(probe.frequencies().isEmpty());
+
+    probe.setFftSize(1000);
+    QCOMPARE(probe.fftSize(), 1024);
+    probe.setFftSize(1);
+    QCOMPARE(probe.fftSize(), 64);
+    probe.setOverlap(2.0);
+    QCOMPARE(probe.overlap(), qreal(0.95));
+    probe.setBandCount(-1);
+    QCOMPARE(probe.bandCount(), 0);
+    probe.setFrequencyRange(50, 10);
+    QCOMPARE(probe.minimumFrequency(), qreal(50));
+    QCOMPARE(probe.maximumFrequency(), qreal(50));
+    probe.setTargetRate(60);
+    QCOMPARE(probe.targetRate(), 60);
+}
+
+void tst_QAudioSpectrumProbe::testRecorder()
+{
+    recorder = new QAudioRecorder;
+    QVERIFY(recorder->isAvailable());
+
+    QAudioSpectrumProbe probe;
+    QVERIFY(probe.setSource(recorder));
+    QVERIFY(probe.isActive());
+    probe.setSource((QMediaRecorder*)0);
+    QVERIFY(!probe.isActive());
+
+    // Deleting the recorder deactivates the probe
+    QVERIFY(probe.setSource(recorder));
+    delete recorder;
+    recorder = 0;
+    QVERIFY(!probe.isActive());
+}
+
+void tst_QAudioSpectrumProbe::testUnsupportedControl()
+{
+    recorder = new QAudioRecorder;
+    QMediaAudioProbeControlPrivate::get(mockMediaRecorderService->mockAudioProbeControl)->setListenersSupported(false);
+
+    // A control that only emits audioBufferProbed() can't feed the analyser
+    QAudioSpectrumProbe probe;
+    QVERIFY(!probe.setSource(recorder));
+    QVERIFY(!probe.isActive());
+}
+
+void tst_QAudioSpectrumProbe::testSpectrum()
+{
+    recorder = new QAudioRecorder;
+
+    QAudioSpectrumProbe probe;
+    probe.setFftSize(256);
+    probe.setOverlap(0);
+    probe.setTargetRate(0);
+    QVERIFY(probe.setSource(recorder));
+
+    QSignalSpy spectrumSpy(&probe, SIGNAL(spectrumProbed(QVector<float>,qint64)));
+    QSignalSpy frequenciesSpy(&probe, SIGNAL(frequenciesChanged(QVector<float>)));
+
+    // 500 Hz falls on bin 16 of 256 at 8 kHz. The stereo channels are
+    // mixed down, and the transforms span the two buffers.
+    const QAudioFormat stereo = format(2);
+    const QByteArray data = sine(stereo, 512, 500, 0.5);
+    const int split = 100 * stereo.bytesPerFrame();
+    mockMediaRecorderService->mockAudioProbeControl->probeBuffer(QAudioBuffer(data.left(split), stereo, 0));
+    mockMediaRecorderService->mockAudioProbeControl->probeBuffer(QAudioBuffer(data.mid(split), stereo, 12500));
+
+    QTRY_COMPARE(spectrumSpy.count(), 2);
+    QCOMPARE(frequenciesSpy.count(), 1);
+
+    const QVector<float> frequencies = probe.frequencies();
+    QCOMPARE(frequencies.size(), 129);
+    QCOMPARE(frequencies.at(16), 500.0f);
+
+    QCOMPARE(spectrumSpy.at(0).at(1).toLongLong(), qint64(0));
+    QCOMPARE(spectrumSpy.at(1).at(1).toLongLong(), qint64(32000));
+    for (int i = 0; i < 2; ++i) {
+        const QVector<float> magnitudes = spectrumSpy.at(i).at(0).value<QVector<float> >();
+        QCOMPARE(magnitudes.size(), 129);
+        QVERIFY(qAbs(magnitudes.at(16) - 0.5f) < 0.01f);
+        QVERIFY(magnitudes.at(0) < 0.01f);
+        QVERIFY(magnitudes.at(64) < 0.01f);
+    }
+}
+
+void tst_QAudioSpectrumProbe::testBands()
+{
+    recorder = new QAudioRecorder;
+
+    QAudioSpectrumProbe probe;
+    probe.setFftSize(256);
+    probe.setOverlap(0.5);
+    probe.setBandCount(4);
+    probe.setFrequencyRange(100, 3200);
+    probe.setTargetRate(25);
+    QVERIFY(probe.setSource(recorder));
+
+    QSignalSpy spectrumSpy(&probe, SIGNAL(spectrumProbed(QVector<float>,qint64)));
+
+    // One second of 1 kHz, which falls into the third band of 566 Hz to 1345 Hz
+    const QAudioFormat mono = format(1);
+    const QByteArray data = sine(mono, 8000, 1000, 0.25);
+    for (int i = 0; i < 10; ++i) {
+        const int size = data.size() / 10;
+        mockMediaRecorderService->mockAudioProbeControl->probeBuffer(
+                    QAudioBuffer(data.mid(i * size, size), mono, i * 100000));
+    }
+
+    // The 61 transforms are delivered at about 25 spectra per second
+    QTRY_VERIFY(spectrumSpy.count() >= 24);
+    QTest::qWait(50);
+    QVERIFY(spectrumSpy.count() <= 26);
+
+    QCOMPARE(probe.frequencies().size(), 4);
+    QVERIFY(qAbs(probe.frequencies().at(2) - 872.5f) < 1.0f);
+
+    const QVector<float> magnitudes = spectrumSpy.last().at(0).value<QVector<float> >();
+    QCOMPARE(magnitudes.size(), 4);
+    QVERIFY(qAbs(magnitudes.at(2) - 0.25f) < 0.01f);
+    QVERIFY(magnitudes.at(0) < 0.01f);
+    QVERIFY(magnitudes.at(3) < 0.01f);
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioSpectrumProbe)
+
+#include "tst_qaudiospectrumprobe.moc"
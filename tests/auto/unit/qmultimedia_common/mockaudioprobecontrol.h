@@ -30,6 +30,8 @@
 #define MOCKAUDIOPROBECONTROL_H
 
 #include "qmediaaudioprobecontrol.h"
+#include "qaudiobuffer.h"
+#include <private/qmediaaudioprobecontrol_p.h>
 
 class MockAudioProbeControl : public QMediaAudioProbeControl
 {
@@ -38,10 +40,17 @@ public:
     MockAudioProbeControl(QObject *parent):
         QMediaAudioProbeControl(parent)
     {
+        QMediaAudioProbeControlPrivate::get(this)->setListenersSupported(true);
     }
 
     ~MockAudioProbeControl() {}
 
+    void probeBuffer(const QAudioBuffer &buffer)
+    {
+        QMediaAudioProbeControlPrivate::get(this)->probeBuffer(buffer);
+        emit audioBufferProbed(buffer);
+    }
+
 private:
 };
 
@@ -30,6 +30,8 @@
 #define MOCKVIDEOPROBECONTROL_H
 
 #include "qmediavideoprobecontrol.h"
+#include "qvideoframe.h"
+#include <private/qmediavideoprobecontrol_p.h>
 
 class MockVideoProbeControl : public QMediaVideoProbeControl
 {
@@ -42,6 +44,24 @@ public:
 
     ~MockVideoProbeControl() {}
 
+    void probeFrame(const QVideoFrame &frame)
+    {
+        QMediaVideoProbeControlPrivate::get(this)->probeFrame(frame);
+        emit videoFrameProbed(frame);
+    }
+
+    // What a backend does when a newer frame replaces an undelivered one
+    void dropFrame()
+    {
+        QMediaVideoProbeControlPrivate::get(this)->frameDropped();
+    }
+
+    void flushFrames()
+    {
+        QMediaVideoProbeControlPrivate::get(this)->flush();
+        emit flush();
+    }
+
 private:
 };
 
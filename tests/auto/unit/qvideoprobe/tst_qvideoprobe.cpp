@@ -56,6 +56,9 @@ private slots:
     void testPlayerDeleteRecorder();
     void testPlayerDeleteProbe();
     void testRecorder();
+    void testQueuedDelivery();
+    void testDirectDelivery();
+    void testLatestDeliveryDrops();
 
 private:
     QMediaPlayer *player;
@@ -171,6 +174,100 @@ void tst_QVideoProbe::testRecorder()
     QVERIFY(!probe.isActive());
 }
 
+void tst_QVideoProbe::testQueuedDelivery()
+{
+    player = new QMediaPlayer;
+
+    QVideoProbe probe;
+    QCOMPARE(probe.deliveryMode(), QVideoProbe::LatestDelivery);
+    probe.setDeliveryMode(QVideoProbe::QueuedDelivery);
+    probe.setQueueLimit(2);
+    QVERIFY(probe.setSource(player));
+
+    QSignalSpy frameSpy(&probe, SIGNAL(videoFrameProbed(QVideoFrame)));
+
+    for (int i = 0; i < 4; ++i) {
+        QVideoFrame frame(4 * 4 * 4, QSize(4, 4), 4 * 4, QVideoFrame::Format_ARGB32);
+        frame.setStartTime(i * 40000);
+        mockMediaPlayerService->mockVideoProbeControl->probeFrame(frame);
+    }
+
+    QTRY_COMPARE(frameSpy.count(), 2);
+    QCOMPARE(frameSpy.at(0).at(0).value<QVideoFrame>().startTime(), qint64(80000));
+    QCOMPARE(frameSpy.at(1).at(0).value<QVideoFrame>().startTime(), qint64(120000));
+    QCOMPARE(probe.droppedFrameCount(), quint64(2));
+
+    // Flushing releases queued frames without delivering them
+    frameSpy.clear();
+    QSignalSpy flushSpy(&probe, SIGNAL(flush()));
+    mockMediaPlayerService->mockVideoProbeControl->probeFrame(
+                QVideoFrame(4 * 4 * 4, QSize(4, 4), 4 * 4, QVideoFrame::Format_ARGB32));
+    mockMediaPlayerService->mockVideoProbeControl->flushFrames();
+    QCOMPARE(flushSpy.count(), 1);
+    QCoreApplication::processEvents();
+    QVERIFY(frameSpy.isEmpty());
+}
+
+void tst_QVideoProbe::testDirectDelivery()
+{
+    player = new QMediaPlayer;
+
+    QVideoProbe probe;
+    int frames = 0;
+    probe.setDeliveryMode(QVideoProbe::DirectDelivery);
+    probe.setFrameCallback([](const QVideoFrame &frame, void *userData) {
+        if (frame.isValid())
+            ++*static_cast<int *>(userData);
+    }, &frames);
+    QVERIFY(probe.setSource(player));
+
+    QSignalSpy frameSpy(&probe, SIGNAL(videoFrameProbed(QVideoFrame)));
+
+    mockMediaPlayerService->mockVideoProbeControl->probeFrame(
+                QVideoFrame(4 * 4 * 4, QSize(4, 4), 4 * 4, QVideoFrame::Format_ARGB32));
+    QCOMPARE(frames, 1);
+    QCoreApplication::processEvents();
+    QVERIFY(frameSpy.isEmpty());
+
+    // Back to the default mode the signal is emitted again
+    probe.setDeliveryMode(QVideoProbe::LatestDelivery);
+    mockMediaPlayerService->mockVideoProbeControl->probeFrame(
+                QVideoFrame(4 * 4 * 4, QSize(4, 4), 4 * 4, QVideoFrame::Format_ARGB32));
+    QCOMPARE(frames, 1);
+    QCOMPARE(frameSpy.count(), 1);
+}
+
+void tst_QVideoProbe::testLatestDeliveryDrops()
+{
+    player = new QMediaPlayer;
+    MockVideoProbeControl *control = mockMediaPlayerService->mockVideoProbeControl;
+
+    // Frames replaced before the probe was connected are not its own
+    control->dropFrame();
+
+    QVideoProbe probe;
+    QVERIFY(probe.setSource(player));
+    QCOMPARE(probe.droppedFrameCount(), quint64(0));
+
+    control->dropFrame();
+    control->dropFrame();
+    QCOMPARE(probe.droppedFrameCount(), quint64(2));
+
+    QVideoProbe other;
+    QVERIFY(other.setSource(player));
+    control->dropFrame();
+    QCOMPARE(other.droppedFrameCount(), quint64(1));
+    QCOMPARE(probe.droppedFrameCount(), quint64(3));
+
+    // The queue keeps its own count
+    probe.setDeliveryMode(QVideoProbe::QueuedDelivery);
+    QCOMPARE(probe.droppedFrameCount(), quint64(0));
+
+    QVERIFY(probe.setSource(static_cast<QMediaObject *>(0)));
+    probe.setDeliveryMode(QVideoProbe::LatestDelivery);
+    QCOMPARE(probe.droppedFrameCount(), quint64(0));
+}
+
 QTEST_GUILESS_MAIN(tst_QVideoProbe)
 
 #include "tst_qvideoprobe.moc"